@@ -2,9 +2,11 @@
 #include "SharedPathUtils.h"
 #include <iostream>
 #include <cstring>
+#include <cstddef>
 #include <chrono>
 #include <fstream>
 #include <filesystem>
+#include <algorithm>
 
 //==============================================================================
 M1MemoryShare::M1MemoryShare(const std::string& memoryName,
@@ -25,10 +27,10 @@ M1MemoryShare::M1MemoryShare(const std::string& memoryName,
     , m_queuedBuffersSize(0)
     , m_explicitFilePath(explicitFilePath)
 {
-    // Ensure minimum size for header and queue
-    size_t minSize = sizeof(SharedMemoryHeader) + 
-                    (maxQueueSize * sizeof(QueuedBuffer)) + 
-                    4096; // minimum data buffer
+    // Ensure minimum size for header, ring slots and control ring
+    size_t minSize = M1MemoryShareRing::segmentSizeFor(std::max(1u, maxQueueSize),
+                                                       M1MemoryShareRing::slotStrideFor(4096), // minimum block size
+                                                       MAX_CONTROL_MESSAGES * sizeof(ControlMessage));
     
     if (m_totalSize < minSize)
     {
@@ -62,6 +64,17 @@ M1MemoryShare::~M1MemoryShare()
     {
         m_mappedFile.reset();
     }
+
+#if defined(M1_MEMORYSHARE_FD_TRANSPORT)
+    if (m_segmentMapping != nullptr)
+    {
+        munmap(m_segmentMapping, m_segmentMappingSize);
+    }
+    if (m_segmentFd >= 0)
+    {
+        close(m_segmentFd);
+    }
+#endif
     
     // Clean up temp file if not persistent
     if (!m_persistent && m_tempFile.exists())
@@ -70,6 +83,134 @@ M1MemoryShare::~M1MemoryShare()
     }
 }
 
+M1MemoryShare::M1MemoryShare(DescriptorSegment, const std::string& memoryName, uint32_t maxQueueSize, bool createMode)
+    : m_memoryName(memoryName)
+    , m_totalSize(0)
+    , m_maxQueueSize(maxQueueSize)
+    , m_persistent(false)
+    , m_createMode(createMode)
+    , m_header(nullptr)
+    , m_dataBuffer(nullptr)
+    , m_dataBufferSize(0)
+    , m_queuedBuffers(nullptr)
+    , m_queuedBuffersSize(0)
+{
+}
+
+std::unique_ptr<M1MemoryShare> M1MemoryShare::createAnonymous(const std::string& memoryName,
+                                                             size_t totalSize,
+                                                             uint32_t maxQueueSize,
+                                                             uint32_t options)
+{
+#if defined(M1_MEMORYSHARE_FD_TRANSPORT)
+    // Open mode with an explicit path that can't exist, so the constructor maps nothing
+    std::unique_ptr<M1MemoryShare> share(new M1MemoryShare(DescriptorSegment{}, memoryName, maxQueueSize, true));
+
+    const size_t minSize = M1MemoryShareRing::segmentSizeFor(std::max(1u, maxQueueSize),
+                                                             M1MemoryShareRing::slotStrideFor(4096),
+                                                             MAX_CONTROL_MESSAGES * sizeof(ControlMessage));
+    size_t actualSize = 0;
+    int fd = M1MemoryShareFdTransport::createSegment(memoryName, std::max(totalSize, minSize), options, actualSize);
+    if (fd < 0 || !share->mapSegmentDescriptor(fd))
+    {
+        std::cerr << "[M1MemoryShare] Failed to create memfd segment: " << memoryName << std::endl;
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return nullptr;
+    }
+
+    if (!share->m_ring.create(share->m_segmentMapping, share->m_segmentMappingSize, share->m_maxQueueSize,
+                              MAX_CONTROL_MESSAGES * sizeof(ControlMessage), memoryName.c_str()))
+    {
+        std::cerr << "[M1MemoryShare] Failed to format memfd segment: " << memoryName << std::endl;
+        return nullptr;
+    }
+
+    share->setupMemoryPointers();
+    return share->isValid() ? std::move(share) : nullptr;
+#else
+    (void) memoryName; (void) totalSize; (void) maxQueueSize; (void) options;
+    return nullptr;
+#endif
+}
+
+std::unique_ptr<M1MemoryShare> M1MemoryShare::openFileDescriptor(int fd, const std::string& memoryName)
+{
+#if defined(M1_MEMORYSHARE_FD_TRANSPORT)
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    // An unsealed memfd can be truncated under the mapping, and reading it would then SIGBUS
+    if (!M1MemoryShareFdTransport::isSizeSealed(fd))
+    {
+        std::cerr << "[M1MemoryShare] Refusing segment " << memoryName << ": not size-sealed" << std::endl;
+        close(fd);
+        return nullptr;
+    }
+
+    std::unique_ptr<M1MemoryShare> share(new M1MemoryShare(DescriptorSegment{}, memoryName, 8, false));
+    if (!share->mapSegmentDescriptor(fd))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    share->setupMemoryPointers();
+    return share->isValid() ? std::move(share) : nullptr;
+#else
+    (void) fd; (void) memoryName;
+    return nullptr;
+#endif
+}
+
+bool M1MemoryShare::mapSegmentDescriptor(int fd)
+{
+#if defined(M1_MEMORYSHARE_FD_TRANSPORT)
+    size_t size = M1MemoryShareFdTransport::getSegmentSize(fd);
+    if (size == 0)
+    {
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_segmentFd = fd;
+    m_segmentMapping = mapping;
+    m_segmentMappingSize = size;
+    m_totalSize = size;
+    return true;
+#else
+    (void) fd;
+    return false;
+#endif
+}
+
+void* M1MemoryShare::getMappedData() const
+{
+    if (m_segmentMapping != nullptr)
+    {
+        return m_segmentMapping;
+    }
+    return m_mappedFile ? m_mappedFile->getData() : nullptr;
+}
+
+size_t M1MemoryShare::getMappedSize() const
+{
+    if (m_segmentMapping != nullptr)
+    {
+        return m_segmentMappingSize;
+    }
+    return m_mappedFile ? m_mappedFile->getSize() : 0;
+}
+
 //==============================================================================
 bool M1MemoryShare::createSharedMemoryFile()
 {
@@ -121,23 +262,16 @@ bool M1MemoryShare::createSharedMemoryFile()
     
     std::cout << "[M1MemoryShare] Successfully created and mapped file: " << m_tempFile.getFullPathName() << std::endl;
     
-    setupMemoryPointers();
-    
-    // Initialize header if we're in create mode
-    if (m_createMode)
+    // New segments always use the ring layout, one slot per queue entry
+    if (!m_ring.create(m_mappedFile->getData(), m_mappedFile->getSize(), m_maxQueueSize,
+                       MAX_CONTROL_MESSAGES * sizeof(ControlMessage), m_memoryName.toStdString().c_str()))
     {
-        *m_header = SharedMemoryHeader(); // Initialize with defaults
-        m_header->bufferSize = static_cast<uint32_t>(m_dataBufferSize);
-        m_header->maxQueueSize = m_maxQueueSize;
-        strncpy(m_header->name, m_memoryName.toStdString().c_str(), sizeof(m_header->name) - 1);
-        
-        // Initialize queued buffers array
-        for (uint32_t i = 0; i < m_maxQueueSize; ++i)
-        {
-            m_queuedBuffers[i] = QueuedBuffer();
-        }
+        std::cout << "[M1MemoryShare] Failed to format ring segment" << std::endl;
+        return false;
     }
     
+    setupMemoryPointers();
+    
     return true;
 }
 
@@ -206,12 +340,39 @@ bool M1MemoryShare::openSharedMemoryFile()
 
 void M1MemoryShare::setupMemoryPointers()
 {
-    if (!m_mappedFile || !m_mappedFile->getData())
+    if (getMappedData() == nullptr)
+    {
+        return;
+    }
+    
+    uint8_t* basePtr = static_cast<uint8_t*>(getMappedData());
+    size_t actualFileSize = getMappedSize();
+    
+    // Ring layout: RingSegmentHeader | slots | control ring
+    if (M1MemoryShareRing::isRingSegment(basePtr, actualFileSize))
     {
+        m_header = nullptr;
+        m_queuedBuffers = nullptr;
+        m_queuedBuffersSize = 0;
+        m_dataBuffer = nullptr;
+        m_dataBufferSize = 0;
+        
+        const size_t controlBytes = MAX_CONTROL_MESSAGES * sizeof(ControlMessage);
+        if (!m_ring.attach(basePtr, actualFileSize) ||
+            static_cast<size_t>(m_ring.getTrailingArea() - basePtr) + controlBytes > actualFileSize)
+        {
+            std::cerr << "[M1MemoryShare] Ring segment has an invalid geometry: " << m_memoryName << std::endl;
+            m_ring.detach();
+            return;
+        }
+        
+        m_layoutVersion = LAYOUT_RING;
+        m_maxQueueSize = m_ring.getSlotCount();
         return;
     }
     
-    uint8_t* basePtr = static_cast<uint8_t*>(m_mappedFile->getData());
+    m_ring.detach();
+    m_layoutVersion = LAYOUT_LEGACY;
     
     // Set up header first (always at offset 0)
     m_header = reinterpret_cast<SharedMemoryHeader*>(basePtr);
@@ -223,7 +384,7 @@ void M1MemoryShare::setupMemoryPointers()
         m_maxQueueSize = m_header->maxQueueSize;
     }
     
-    // Memory layout (must match panner's M1MemoryShare):
+    // Legacy memory layout (must match older panners' M1MemoryShare):
     // 1. SharedMemoryHeader (200 bytes)
     // 2. QueuedBuffer array (maxQueueSize * sizeof(QueuedBuffer))
     // 3. Data buffer (remaining space)
@@ -236,7 +397,6 @@ void M1MemoryShare::setupMemoryPointers()
     m_dataBuffer = basePtr + sizeof(SharedMemoryHeader) + m_queuedBuffersSize;
     
     // Calculate actual data buffer size from file size
-    size_t actualFileSize = m_mappedFile->getSize();
     m_dataBufferSize = actualFileSize - sizeof(SharedMemoryHeader) - m_queuedBuffersSize;
 }
 
@@ -248,6 +408,15 @@ bool M1MemoryShare::initializeForAudio(uint32_t sampleRate, uint32_t numChannels
         return false;
     }
 
+    if (isRingLayout())
+    {
+        RingSegmentInfo* ringHeader = m_ring.getHeader();
+        ringHeader->sampleRate = sampleRate;
+        ringHeader->numChannels = numChannels;
+        ringHeader->samplesPerBlock = samplesPerBlock;
+        return true;
+    }
+
     m_header->sampleRate = sampleRate;
     m_header->numChannels = numChannels;
     m_header->samplesPerBlock = samplesPerBlock;
@@ -265,6 +434,21 @@ bool M1MemoryShare::registerConsumer(uint32_t consumerId)
         return false;
     }
 
+    if (isRingLayout())
+    {
+        // An ID that is still registered belongs to an earlier run of the same consumer:
+        // the ring re-arms its cursor at the head, so blocks from before the restart are not replayed
+        if (m_ring.registerConsumer(consumerId) < 0)
+        {
+            std::cerr << "[M1MemoryShare] Maximum consumers reached" << std::endl;
+            return false;
+        }
+
+        std::cout << "[M1MemoryShare] Registered consumer " << consumerId << 
+                     " (total consumers: " << m_ring.getConsumerCount() << ")" << std::endl;
+        return true;
+    }
+
     std::lock_guard<std::mutex> lock(m_queueMutex);
     
     // Check if consumer is already registered
@@ -296,6 +480,18 @@ bool M1MemoryShare::unregisterConsumer(uint32_t consumerId)
         return false;
     }
 
+    if (isRingLayout())
+    {
+        if (!m_ring.unregisterConsumer(consumerId))
+        {
+            return false; // Consumer not found
+        }
+
+        std::cout << "[M1MemoryShare] Unregistered consumer " << consumerId << 
+                     " (total consumers: " << m_ring.getConsumerCount() << ")" << std::endl;
+        return true;
+    }
+
     std::lock_guard<std::mutex> lock(m_queueMutex);
     
     int index = findConsumerIndex(consumerId);
@@ -316,10 +512,6 @@ bool M1MemoryShare::unregisterConsumer(uint32_t consumerId)
     return true;
 }
 
-// Implementation continues with buffer acknowledgment system...
-// This is a substantial implementation that would continue with the rest of the methods
-// For brevity, I'll provide a placeholder for the key methods:
-
 uint64_t M1MemoryShare::writeAudioBufferWithGenericParameters(
     const std::vector<std::vector<float>>& audioBuffer,
     const ParameterMap& parameters,
@@ -327,11 +519,113 @@ uint64_t M1MemoryShare::writeAudioBufferWithGenericParameters(
     double playheadPositionInSeconds,
     bool isPlaying,
     bool requiresAcknowledgment,
-    uint32_t updateSource)
+    uint32_t updateSource,
+    uint32_t audioLayout)
 {
-    // Implementation would write audio data with acknowledgment tracking
-    // Returns buffer ID for acknowledgment
-    return 0; // Placeholder
+    if (!isValid())
+    {
+        return 0;
+    }
+
+    constexpr uint32_t MAX_CHANNELS = 64;
+    const uint32_t numChannels = static_cast<uint32_t>(std::min<size_t>(audioBuffer.size(), MAX_CHANNELS));
+    uint32_t numSamples = 0;
+    if (numChannels > 0)
+    {
+        numSamples = static_cast<uint32_t>(audioBuffer[0].size());
+        for (uint32_t channel = 1; channel < numChannels; ++channel)
+        {
+            numSamples = std::min(numSamples, static_cast<uint32_t>(audioBuffer[channel].size()));
+        }
+    }
+
+    const float* channels[MAX_CHANNELS];
+    for (uint32_t channel = 0; channel < numChannels; ++channel)
+    {
+        channels[channel] = audioBuffer[channel].data();
+    }
+
+    // Parameters are encoded once and used for both the block and the state page
+    uint8_t parameterData[ParameterStatePage::DATA_CAPACITY];
+    uint32_t parameterCount = 0;
+    size_t parameterBytes = M1MemoryShareBlock::encodeParameters(parameters, parameterData, sizeof(parameterData), parameterCount);
+
+    GenericAudioBufferHeader header;
+    header.dawTimestamp = dawTimestamp;
+    header.playheadPositionInSeconds = playheadPositionInSeconds;
+    header.isPlaying = isPlaying ? 1 : 0;
+    header.updateSource = updateSource;
+    header.bufferTimestamp = getCurrentTimestamp();
+    header.requiresAcknowledgment = requiresAcknowledgment ? 1 : 0;
+
+    if (isRingLayout())
+    {
+        const RingSegmentInfo* ringHeader = m_ring.getHeader();
+        header.sampleRate = ringHeader->sampleRate;
+        header.startSamplePosition = static_cast<int64_t>(playheadPositionInSeconds * ringHeader->sampleRate);
+        header.consumerCount = m_ring.getConsumerCount();
+
+        uint64_t sequence = 0;
+        uint8_t* slot = m_ring.beginWrite(sequence);
+        if (slot == nullptr)
+        {
+            return 0; // Ring full, counted in droppedBlocks
+        }
+
+        // Dropped blocks take a sequence number too, so consumers see a gap where they were
+        header.bufferId = sequence + 1;
+        header.sequenceNumber = static_cast<uint32_t>(sequence + m_ring.getDroppedBlocks());
+
+        size_t blockSize = M1MemoryShareBlock::write(slot, m_ring.getPayloadCapacity(), header,
+                                                     parameterData, parameterBytes, parameterCount,
+                                                     channels, numChannels, numSamples, audioLayout);
+
+        // An oversized block is published empty so the slot is not left busy
+        m_ring.commitWrite(sequence, static_cast<uint32_t>(blockSize));
+        if (blockSize == 0)
+        {
+            return 0;
+        }
+
+        ParameterStateFields fields = {};
+        fields.parameterCount = parameterCount;
+        fields.dataSize = static_cast<uint32_t>(parameterBytes);
+        fields.updateSource = updateSource;
+        fields.isPlaying = header.isPlaying;
+        fields.dawTimestamp = dawTimestamp;
+        fields.playheadPositionInSeconds = playheadPositionInSeconds;
+        M1MemoryShareStatePage::write(*m_ring.getStatePage(), fields, parameterData);
+
+        m_writeCount++;
+        return header.bufferId;
+    }
+
+    // Legacy layout: a single block at the start of the data buffer, control ring at its end
+    header.sampleRate = m_header->sampleRate;
+    header.startSamplePosition = static_cast<int64_t>(playheadPositionInSeconds * m_header->sampleRate);
+    header.consumerCount = m_header->consumerCount;
+    header.bufferId = getNextBufferId();
+    header.sequenceNumber = getNextSequenceNumber();
+
+    const size_t capacity = m_dataBufferSize - std::min<size_t>(m_dataBufferSize, MAX_CONTROL_MESSAGES * sizeof(ControlMessage));
+    m_header->hasData = false;
+    size_t blockSize = M1MemoryShareBlock::write(m_dataBuffer, capacity, header,
+                                                 parameterData, parameterBytes, parameterCount,
+                                                 channels, numChannels, numSamples, audioLayout);
+    if (blockSize == 0)
+    {
+        return 0;
+    }
+
+    m_header->dataSize = static_cast<uint32_t>(blockSize);
+    m_header->writeIndex = static_cast<uint32_t>(blockSize);
+    m_header->hasData = true;
+
+    addToQueue(header.bufferId, header.sequenceNumber, header.bufferTimestamp,
+               static_cast<uint32_t>(blockSize), 0, requiresAcknowledgment);
+
+    m_writeCount++;
+    return header.bufferId;
 }
 
 bool M1MemoryShare::acknowledgeBuffer(uint64_t bufferId, uint32_t consumerId)
@@ -341,6 +635,37 @@ bool M1MemoryShare::acknowledgeBuffer(uint64_t bufferId, uint32_t consumerId)
         return false;
     }
 
+    // Ring segments: set the consumer's bit in the slot's ack mask; the cursor moves past
+    // contiguous acknowledged blocks and the producer reclaims slots behind the slowest cursor
+    if (isRingLayout())
+    {
+        int consumerIndex = m_ring.findConsumer(consumerId);
+        if (consumerIndex < 0)
+        {
+            return false;
+        }
+
+        const uint64_t head = m_ring.getHead();
+        for (uint64_t sequence = m_ring.getCursor(consumerIndex); sequence < head; ++sequence)
+        {
+            uint32_t payloadSize = 0;
+            const uint8_t* block = m_ring.peekSequence(sequence, payloadSize);
+            if (block == nullptr || payloadSize < sizeof(GenericAudioBufferHeader))
+            {
+                continue;
+            }
+
+            uint64_t blockId = 0;
+            std::memcpy(&blockId, block + offsetof(GenericAudioBufferHeader, bufferId), sizeof(blockId));
+            if (blockId == bufferId)
+            {
+                return m_ring.acknowledge(consumerIndex, sequence);
+            }
+        }
+
+        return true; // Not pending for this consumer, already released through its view
+    }
+
     std::lock_guard<std::mutex> lock(m_queueMutex);
     
     QueuedBuffer* buffer = findQueuedBuffer(bufferId);
@@ -369,9 +694,6 @@ bool M1MemoryShare::acknowledgeBuffer(uint64_t bufferId, uint32_t consumerId)
     buffer->acknowledged[consumerIndex] = true;
     buffer->acknowledgedCount++;
 
-    std::cout << "[M1MemoryShare] Consumer " << consumerId << " acknowledged buffer " << bufferId << 
-                 " (" << buffer->acknowledgedCount << "/" << buffer->consumerCount << ")" << std::endl;
-
     // If all consumers have acknowledged, mark buffer as fully consumed
     if (buffer->acknowledgedCount >= buffer->consumerCount)
     {
@@ -390,18 +712,90 @@ bool M1MemoryShare::acknowledgeBuffer(uint64_t bufferId, uint32_t consumerId)
 //==============================================================================
 bool M1MemoryShare::isValid() const
 {
-    return (m_mappedFile && m_mappedFile->getData() != nullptr && 
+    if (isRingLayout())
+    {
+        return (getMappedData() != nullptr && m_ring.isAttached());
+    }
+
+    return (getMappedData() != nullptr && 
             m_header != nullptr && 
             m_dataBuffer != nullptr && 
             m_queuedBuffers != nullptr);
 }
 
+bool M1MemoryShare::isFormatted() const
+{
+    if (isRingLayout())
+    {
+        return isValid();   // attach() already required the ring magic
+    }
+
+    // Legacy producers set the buffer size once their header is initialized
+    return isValid() && m_header->bufferSize != 0;
+}
+
 uint64_t M1MemoryShare::getCurrentTimestamp() const
 {
     return std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::high_resolution_clock::now().time_since_epoch()).count();
 }
 
+uint64_t M1MemoryShare::getNextBufferId()
+{
+    return m_header->nextBufferId++;
+}
+
+uint32_t M1MemoryShare::getNextSequenceNumber()
+{
+    return m_header->nextSequenceNumber++;
+}
+
+bool M1MemoryShare::addToQueue(uint64_t bufferId, uint32_t sequenceNumber, uint64_t timestamp,
+                               uint32_t dataSize, uint32_t dataOffset, bool requiresAcknowledgment)
+{
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+
+    // Legacy segments hold a single data block, so the oldest entry makes room for the newest
+    if (m_header->queueSize >= m_maxQueueSize && m_header->queueSize > 0)
+    {
+        removeFromQueue(m_queuedBuffers[0].bufferId);
+    }
+
+    QueuedBuffer& buffer = m_queuedBuffers[m_header->queueSize];
+    buffer = QueuedBuffer();
+    buffer.bufferId = bufferId;
+    buffer.sequenceNumber = sequenceNumber;
+    buffer.timestamp = timestamp;
+    buffer.dataSize = dataSize;
+    buffer.dataOffset = dataOffset;
+    buffer.requiresAcknowledgment = requiresAcknowledgment;
+    buffer.consumerCount = std::min(static_cast<uint32_t>(m_header->consumerCount), 16u);
+    for (uint32_t i = 0; i < buffer.consumerCount; ++i)
+    {
+        buffer.consumerIds[i] = m_header->consumerIds[i];
+    }
+
+    m_header->queueSize++;
+    return true;
+}
+
+bool M1MemoryShare::removeFromQueue(uint64_t bufferId)
+{
+    for (uint32_t i = 0; i < m_header->queueSize; ++i)
+    {
+        if (m_queuedBuffers[i].bufferId == bufferId)
+        {
+            for (uint32_t j = i + 1; j < m_header->queueSize; ++j)
+            {
+                m_queuedBuffers[j - 1] = m_queuedBuffers[j];
+            }
+            m_header->queueSize--;
+            return true;
+        }
+    }
+    return false;
+}
+
 M1MemoryShare::QueuedBuffer* M1MemoryShare::findQueuedBuffer(uint64_t bufferId)
 {
     for (uint32_t i = 0; i < m_header->queueSize; ++i)
@@ -456,6 +850,12 @@ void M1MemoryShare::clear()
         return;
     }
 
+    // Ring segments are owned by the producer; consumers catch up through their cursors
+    if (isRingLayout())
+    {
+        return;
+    }
+
     m_header->writeIndex = 0;
     m_header->readIndex = 0;
     m_header->dataSize = 0;
@@ -474,6 +874,40 @@ void M1MemoryShare::clear()
     }
 }
 
+std::vector<uint64_t> M1MemoryShare::getAvailableBufferIds() const
+{
+    std::vector<uint64_t> bufferIds;
+    if (!isValid())
+    {
+        return bufferIds;
+    }
+
+    if (isRingLayout())
+    {
+        const uint64_t head = m_ring.getHead();
+        const uint64_t oldest = head - std::min<uint64_t>(head, m_ring.getSlotCount());
+        for (uint64_t sequence = std::max(m_ring.getTail(), oldest); sequence < head; ++sequence)
+        {
+            uint32_t payloadSize = 0;
+            const uint8_t* block = m_ring.peekSequence(sequence, payloadSize);
+            if (block != nullptr && payloadSize >= sizeof(GenericAudioBufferHeader))
+            {
+                uint64_t bufferId = 0;
+                std::memcpy(&bufferId, block + offsetof(GenericAudioBufferHeader, bufferId), sizeof(bufferId));
+                bufferIds.push_back(bufferId);
+            }
+        }
+        return bufferIds;
+    }
+
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    for (uint32_t i = 0; i < m_header->queueSize; ++i)
+    {
+        bufferIds.push_back(m_queuedBuffers[i].bufferId);
+    }
+    return bufferIds;
+}
+
 uint32_t M1MemoryShare::getUnconsumedBufferCount() const
 {
     if (!isValid())
@@ -481,9 +915,61 @@ uint32_t M1MemoryShare::getUnconsumedBufferCount() const
         return 0;
     }
 
+    if (isRingLayout())
+    {
+        return static_cast<uint32_t>(m_ring.getRetainedCount());
+    }
+
     return m_header->queueSize;
 }
 
+uint64_t M1MemoryShare::getPendingBlockCount(uint32_t consumerId) const
+{
+    if (!isValid())
+    {
+        return 0;
+    }
+
+    if (isRingLayout())
+    {
+        return m_ring.getPendingCount(m_ring.findConsumer(consumerId));
+    }
+
+    return m_header->queueSize;
+}
+
+bool M1MemoryShare::getAudioFormat(uint32_t& sampleRate, uint32_t& numChannels, uint32_t& samplesPerBlock) const
+{
+    if (!isValid())
+    {
+        return false;
+    }
+
+    if (isRingLayout())
+    {
+        const RingSegmentInfo* ringHeader = m_ring.getHeader();
+        sampleRate = ringHeader->sampleRate;
+        numChannels = ringHeader->numChannels;
+        samplesPerBlock = ringHeader->samplesPerBlock;
+        return true;
+    }
+
+    sampleRate = m_header->sampleRate;
+    numChannels = m_header->numChannels;
+    samplesPerBlock = m_header->samplesPerBlock;
+    return true;
+}
+
+uint64_t M1MemoryShare::getDroppedBlockCount() const
+{
+    if (!isValid() || !isRingLayout())
+    {
+        return 0;
+    }
+
+    return m_ring.getDroppedBlocks();
+}
+
 //==============================================================================
 bool M1MemoryShare::deleteSharedMemory(const juce::String& memoryName)
 {
@@ -507,26 +993,48 @@ bool M1MemoryShare::deleteSharedMemory(const juce::String& memoryName)
     return deleted || true; // Consider it deleted if not found
 }
 
+M1MemoryShare::ControlMessage* M1MemoryShare::getControlRing() const
+{
+    if (isRingLayout())
+    {
+        // Ring layout: the control ring follows the last slot
+        return reinterpret_cast<ControlMessage*>(m_ring.getTrailingArea());
+    }
+
+    // Legacy layout: the control ring sits at the END of the data buffer
+    size_t controlRingOffset = m_dataBufferSize - (MAX_CONTROL_MESSAGES * sizeof(ControlMessage));
+    if (controlRingOffset >= m_dataBufferSize)
+        return nullptr;
+
+    return reinterpret_cast<ControlMessage*>(m_dataBuffer + controlRingOffset);
+}
+
 bool M1MemoryShare::writeControlMessage(uint32_t parameterID, ParameterType type, float floatValue, int32_t intValue)
 {
-    if (!isValid() || !m_header)
+    if (!isValid())
         return false;
 
-    uint32_t writeIdx = m_header->controlWriteIndex % MAX_CONTROL_MESSAGES;
+    ControlMessage* ring = getControlRing();
+    if (ring == nullptr)
+        return false;
 
-    // Store control message right after the QueuedBuffer array inside the header reserved space.
-    // The control ring is stored at the very end of the header + queue region.
-    // For simplicity, we store it as fields in the header's control indices (already have controlMessageCount).
-    // Since we can't add a variable-size array to the header without changing layout,
-    // we use the controlWriteIndex / controlReadIndex as a simple counter pair.
-    // The actual control message data is written into the first 256 bytes of the data buffer's tail.
+    if (isRingLayout())
+    {
+        uint32_t writeIdx = m_ring.getControlWriteIndex().load(std::memory_order_relaxed);
+        if (writeIdx - m_ring.getControlReadIndex().load(std::memory_order_acquire) >= MAX_CONTROL_MESSAGES)
+            return false; // Producer has not drained the ring yet
 
-    // Compute offset for control message ring at the END of the data buffer
-    size_t controlRingOffset = m_dataBufferSize - (MAX_CONTROL_MESSAGES * sizeof(ControlMessage));
-    if (controlRingOffset >= m_dataBufferSize)
-        return false;
+        ControlMessage& message = ring[writeIdx % MAX_CONTROL_MESSAGES];
+        message.parameterID = parameterID;
+        message.parameterType = type;
+        message.floatValue = floatValue;
+        message.intValue = intValue;
 
-    ControlMessage* ring = reinterpret_cast<ControlMessage*>(m_dataBuffer + controlRingOffset);
+        m_ring.getControlWriteIndex().store(writeIdx + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t writeIdx = m_header->controlWriteIndex % MAX_CONTROL_MESSAGES;
     ring[writeIdx].parameterID = parameterID;
     ring[writeIdx].parameterType = type;
     ring[writeIdx].floatValue = floatValue;
@@ -540,19 +1048,28 @@ bool M1MemoryShare::writeControlMessage(uint32_t parameterID, ParameterType type
 
 bool M1MemoryShare::readControlMessage(ControlMessage& outMessage)
 {
-    if (!isValid() || !m_header)
+    if (!isValid())
         return false;
 
+    const ControlMessage* ring = getControlRing();
+    if (ring == nullptr)
+        return false;
+
+    if (isRingLayout())
+    {
+        uint32_t readIdx = m_ring.getControlReadIndex().load(std::memory_order_relaxed);
+        if (readIdx == m_ring.getControlWriteIndex().load(std::memory_order_acquire))
+            return false; // No pending messages
+
+        outMessage = ring[readIdx % MAX_CONTROL_MESSAGES];
+        m_ring.getControlReadIndex().store(readIdx + 1, std::memory_order_release);
+        return true;
+    }
+
     if (m_header->controlReadIndex >= m_header->controlWriteIndex)
         return false; // No pending messages
 
     uint32_t readIdx = m_header->controlReadIndex % MAX_CONTROL_MESSAGES;
-
-    size_t controlRingOffset = m_dataBufferSize - (MAX_CONTROL_MESSAGES * sizeof(ControlMessage));
-    if (controlRingOffset >= m_dataBufferSize)
-        return false;
-
-    const ControlMessage* ring = reinterpret_cast<const ControlMessage*>(m_dataBuffer + controlRingOffset);
     outMessage = ring[readIdx];
 
     m_header->controlReadIndex++;
@@ -567,24 +1084,239 @@ bool M1MemoryShare::readAudioBufferWithGenericParameters(juce::AudioBuffer<float
                                                        double& playheadPositionInSeconds,
                                                        bool& isPlaying,
                                                        uint64_t& bufferId,
-                                                       uint32_t& updateSource)
+                                                       uint32_t& updateSource,
+                                                       uint32_t consumerId)
 {
-    if (!isValid() || !m_header->hasData)
+    AudioBlockView view;
+    if (!acquireAudioBlockView(view, consumerId))
     {
         return false;
     }
 
-    std::lock_guard<std::mutex> lock(m_queueMutex);
+    dawTimestamp = view.header->dawTimestamp;
+    playheadPositionInSeconds = view.header->playheadPositionInSeconds;
+    isPlaying = (view.header->isPlaying != 0);
+    bufferId = view.header->bufferId;
+    updateSource = view.header->updateSource;
+
+    readParameters(view, parameters);
+
+    if (view.numChannels > 0 && view.numSamples > 0)
+    {
+        audioBuffer.setSize(static_cast<int>(view.numChannels), static_cast<int>(view.numSamples), false, false, true);
+
+        for (uint32_t channel = 0; channel < view.numChannels; ++channel)
+        {
+            view.copyChannel(channel, audioBuffer.getWritePointer(static_cast<int>(channel)), view.numSamples);
+        }
+    }
+    else
+    {
+        audioBuffer.clear();
+    }
 
-    // Read the GenericAudioBufferHeader from the data buffer
+    return releaseAudioBlockView(view);
+}
+
+bool M1MemoryShare::acquireAudioBlockView(AudioBlockView& view, uint32_t consumerId)
+{
+    view = AudioBlockView();
+
+    if (!isValid())
+    {
+        return false;
+    }
+
+    if (isRingLayout())
+    {
+        uint64_t sequence = 0;
+        uint32_t payloadSize = 0;
+        const uint8_t* block = nullptr;
+        int consumerIndex = m_ring.findConsumer(consumerId);
+
+        if (consumerIndex >= 0)
+        {
+            // Registered consumer: take the oldest block it has not read yet
+            uint64_t lostBlocks = 0;
+            block = m_ring.acquireNext(consumerIndex, sequence, payloadSize, lostBlocks);
+        }
+        else
+        {
+            // Unregistered reader: look at the latest block, validated again on release
+            block = m_ring.peekLatest(sequence, payloadSize);
+        }
+
+        if (block == nullptr)
+        {
+            return false;
+        }
+
+        if (!parseAudioBlock(block, payloadSize, view))
+        {
+            // Don't let a malformed block stall this consumer
+            if (consumerIndex >= 0)
+            {
+                m_ring.release(consumerIndex, sequence);
+            }
+            return false;
+        }
+
+        view.sequence = sequence;
+        view.consumerIndex = consumerIndex;
+        return true;
+    }
+
+    if (!m_header->hasData)
+    {
+        return false;
+    }
+
+    return parseAudioBlock(m_dataBuffer, std::min<size_t>(m_header->dataSize, m_dataBufferSize), view);
+}
+
+bool M1MemoryShare::releaseAudioBlockView(const AudioBlockView& view)
+{
+    if (view.header == nullptr || !isValid())
+    {
+        return false;
+    }
+
+    if (isRingLayout())
+    {
+        if (view.consumerIndex >= 0)
+        {
+            return m_ring.release(view.consumerIndex, view.sequence);
+        }
+        return m_ring.isStillValid(view.sequence);
+    }
+
+    // Legacy segments have a single data slot and no way to detect overwrites
+    return true;
+}
+
+bool M1MemoryShare::canWaitForData() const
+{
+    return isValid() && isRingLayout() && M1MemoryShareDoorbell::isNativeWaitAvailable();
+}
+
+bool M1MemoryShare::waitForData(uint32_t consumerId, int timeoutMs)
+{
+    if (!canWaitForData())
+    {
+        return false;
+    }
+
+    return m_ring.waitForPublish(m_ring.findConsumer(consumerId), timeoutMs);
+}
+
+void M1MemoryShare::readParameters(const AudioBlockView& view, ParameterMap& parameters)
+{
+    if (view.header == nullptr)
+    {
+        parameters.clear();
+        return;
+    }
+
+    M1MemoryShareBlock::decodeParameters(view.parameterData, view.parameterBytes, view.header->parameterCount, parameters);
+}
+
+bool M1MemoryShare::writeParameterState(const ParameterMap& parameters,
+                                        uint64_t dawTimestamp,
+                                        double playheadPositionInSeconds,
+                                        bool isPlaying,
+                                        uint32_t updateSource)
+{
+    if (!isValid() || !isRingLayout())
+    {
+        return false;
+    }
+
+    // Encode on the stack first so the page is only held odd for the duration of two memcpys
+    uint8_t data[ParameterStatePage::DATA_CAPACITY];
+    ParameterStateFields fields = {};
+    fields.dataSize = static_cast<uint32_t>(M1MemoryShareBlock::encodeParameters(parameters, data, sizeof(data), fields.parameterCount));
+    fields.updateSource = updateSource;
+    fields.isPlaying = isPlaying ? 1 : 0;
+    fields.dawTimestamp = dawTimestamp;
+    fields.playheadPositionInSeconds = playheadPositionInSeconds;
+
+    return M1MemoryShareStatePage::write(*m_ring.getStatePage(), fields, data);
+}
+
+uint32_t M1MemoryShare::getParameterStateVersion() const
+{
+    if (!isValid() || !isRingLayout())
+    {
+        return 0;
+    }
+
+    return M1MemoryShareStatePage::getVersion(*m_ring.getStatePage());
+}
+
+bool M1MemoryShare::readGenericParameters(ParameterMap& parameters,
+                                          uint64_t& dawTimestamp,
+                                          double& playheadPositionInSeconds,
+                                          bool& isPlaying,
+                                          uint32_t& updateSource)
+{
+    if (!isValid())
+    {
+        return false;
+    }
+
+    if (hasParameterState())
+    {
+        ParameterStateSnapshot snapshot;
+        if (!M1MemoryShareStatePage::read(*m_ring.getStatePage(), snapshot))
+        {
+            std::cerr << "[M1MemoryShare] Parameter state stayed busy after " << snapshot.tornReads << " attempts: " << m_memoryName << std::endl;
+            return false;
+        }
+
+        M1MemoryShareBlock::decodeParameters(snapshot.data, snapshot.fields.dataSize, snapshot.fields.parameterCount, parameters);
+        dawTimestamp = snapshot.fields.dawTimestamp;
+        playheadPositionInSeconds = snapshot.fields.playheadPositionInSeconds;
+        isPlaying = (snapshot.fields.isPlaying != 0);
+        updateSource = snapshot.fields.updateSource;
+        return true;
+    }
+
+    // Producer doesn't publish a state page (legacy panner): use the latest audio block's parameters
+    AudioBlockView view;
+    if (!acquireAudioBlockView(view))
+    {
+        return false;
+    }
+
+    ParameterMap blockParameters = parameters;
+    readParameters(view, blockParameters);
+    uint64_t blockTimestamp = view.header->dawTimestamp;
+    double blockPlayhead = view.header->playheadPositionInSeconds;
+    bool blockPlaying = (view.header->isPlaying != 0);
+    uint32_t blockSource = view.header->updateSource;
+
+    if (!releaseAudioBlockView(view))
+    {
+        return false; // Overwritten while decoding
+    }
+
+    parameters = blockParameters;
+    dawTimestamp = blockTimestamp;
+    playheadPositionInSeconds = blockPlayhead;
+    isPlaying = blockPlaying;
+    updateSource = blockSource;
+    return true;
+}
+
+bool M1MemoryShare::parseAudioBlock(const uint8_t* block, size_t blockSize, AudioBlockView& view)
+{
     // The panner writes: GenericAudioBufferHeader + GenericParameter entries + Audio data
-    if (m_header->dataSize < sizeof(GenericAudioBufferHeader))
+    if (blockSize < sizeof(GenericAudioBufferHeader))
     {
         return false;
     }
     
-    const uint8_t* readPtr = m_dataBuffer;
-    const GenericAudioBufferHeader* header = reinterpret_cast<const GenericAudioBufferHeader*>(readPtr);
+    const GenericAudioBufferHeader* header = reinterpret_cast<const GenericAudioBufferHeader*>(block);
     
     // Validate header
     if (header->version != 1 || header->headerSize < sizeof(GenericAudioBufferHeader))
@@ -592,82 +1324,62 @@ bool M1MemoryShare::readAudioBufferWithGenericParameters(juce::AudioBuffer<float
         return false;
     }
     
-    // Extract header fields
-    int numChannels = static_cast<int>(header->channels);
-    int numSamples = static_cast<int>(header->samples);
-    dawTimestamp = header->dawTimestamp;
-    playheadPositionInSeconds = header->playheadPositionInSeconds;
-    isPlaying = (header->isPlaying != 0);
-    bufferId = header->bufferId;
-    updateSource = header->updateSource;
-    
-    // Clear existing parameters
-    parameters.clear();
-    
-    // Parse parameters from the buffer
-    readPtr += sizeof(GenericAudioBufferHeader);
-    uint32_t paramCount = header->parameterCount;
-    
-    for (uint32_t i = 0; i < paramCount && (readPtr - m_dataBuffer) < m_header->dataSize; ++i)
+    // Walk the parameter entries to find where they end, without decoding them
+    size_t offset = sizeof(GenericAudioBufferHeader);
+    for (uint32_t i = 0; i < header->parameterCount; ++i)
     {
-        const GenericParameter* param = reinterpret_cast<const GenericParameter*>(readPtr);
-        readPtr += sizeof(GenericParameter);
-        
-        // Make sure we don't read past buffer
-        if ((readPtr - m_dataBuffer) + param->dataSize > m_header->dataSize)
+        if (offset + sizeof(GenericParameter) > blockSize)
         {
-            break;
+            return false;
         }
         
-        switch (param->parameterType)
+        const GenericParameter* param = reinterpret_cast<const GenericParameter*>(block + offset);
+        offset += sizeof(GenericParameter);
+        
+        // Make sure we don't read past buffer
+        if (param->dataSize > blockSize - offset)
         {
-            case ParameterType::FLOAT:
-                parameters.addFloat(param->parameterID, *reinterpret_cast<const float*>(readPtr));
-                break;
-            case ParameterType::INT:
-                parameters.addInt(param->parameterID, *reinterpret_cast<const int32_t*>(readPtr));
-                break;
-            case ParameterType::BOOL:
-                parameters.addBool(param->parameterID, *reinterpret_cast<const bool*>(readPtr));
-                break;
-            case ParameterType::STRING:
-                parameters.addString(param->parameterID, std::string(reinterpret_cast<const char*>(readPtr)));
-                break;
-            case ParameterType::DOUBLE:
-                parameters.addDouble(param->parameterID, *reinterpret_cast<const double*>(readPtr));
-                break;
-            case ParameterType::UINT32:
-                parameters.addUInt32(param->parameterID, *reinterpret_cast<const uint32_t*>(readPtr));
-                break;
-            case ParameterType::UINT64:
-                parameters.addUInt64(param->parameterID, *reinterpret_cast<const uint64_t*>(readPtr));
-                break;
+            return false;
         }
-        
-        readPtr += param->dataSize;
+        offset += param->dataSize;
     }
     
-    // Set the audio buffer size and copy audio data
-    if (numChannels > 0 && numSamples > 0)
+    view.header = header;
+    view.parameterData = block + sizeof(GenericAudioBufferHeader);
+    view.parameterBytes = offset - sizeof(GenericAudioBufferHeader);
+    view.numChannels = header->channels;
+    view.numSamples = header->samples;
+    
+    if (view.numChannels == 0 || view.numSamples == 0)
     {
-        audioBuffer.setSize(numChannels, numSamples);
-        
-        // Audio data follows the header (readPtr should now point to audio data)
-        const float* audioDataPtr = reinterpret_cast<const float*>(readPtr);
-        
-        // Copy interleaved audio data to JUCE buffer (deinterleave)
-        for (int sample = 0; sample < numSamples; ++sample)
-        {
-            for (int channel = 0; channel < numChannels; ++channel)
-            {
-                audioBuffer.setSample(channel, sample, audioDataPtr[sample * numChannels + channel]);
-            }
-        }
+        return true;
+    }
+    
+    // Audio starts after the parameters, or at headerSize if the producer padded for alignment
+    size_t audioOffset = std::max<size_t>(offset, header->headerSize);
+    size_t audioBytes = static_cast<size_t>(view.numChannels) * view.numSamples * sizeof(float);
+    if (audioOffset > blockSize || audioBytes > blockSize - audioOffset)
+    {
+        return false;
+    }
+    
+    // Legacy panners don't pad the parameters, so only hand out a float pointer when it is aligned
+    view.audioBytes = block + audioOffset;
+    if (reinterpret_cast<uintptr_t>(view.audioBytes) % alignof(float) == 0)
+    {
+        view.audioData = reinterpret_cast<const float*>(view.audioBytes);
+    }
+    
+    if (header->audioLayout == GenericAudioBufferHeader::AUDIO_PLANAR)
+    {
+        view.sampleStride = 1;
+        view.channelStride = view.numSamples;
     }
     else
     {
-        audioBuffer.clear();
+        view.sampleStride = view.numChannels;
+        view.channelStride = 1;
     }
 
     return true;
-} 
\ No newline at end of file
+}
@@ -11,6 +11,9 @@
 #include <vector>
 #include "Common.h"
 #include "TypesForDataExchange.h"
+#include "M1MemoryShareRing.h"
+#include "M1MemoryShareBlock.h"
+#include "M1MemoryShareFdTransport.h"
 
 // Platform-specific includes
 #ifdef _WIN32
@@ -26,12 +29,17 @@
  * using JUCE's MemoryMappedFile for sharing audio data and control data between processes.
  *
  * Enhanced with buffer acknowledgment system for handling multiple unconsumed buffers.
+ *
+ * Two segment layouts are supported and detected when a segment is opened:
+ * - Layout 1 (legacy panners): SharedMemoryHeader + QueuedBuffer array + a single data slot
+ * - Layout 2: RingSegmentHeader + parameter state page + multi-slot lock-free ring (see M1MemoryShareRing.h);
+ *   the ring header has its own version (3 when created here, 2 from older panners)
  */
 class M1MemoryShare
 {
 public:
     /**
-     * Header structure that prefixes all shared memory segments
+     * Header structure that prefixes layout 1 (legacy) shared memory segments
      * Contains metadata about the shared data and buffer queue
      */
     struct SharedMemoryHeader
@@ -111,6 +119,74 @@ public:
 
     static constexpr uint32_t MAX_CONTROL_MESSAGES = 16;
 
+    /**
+     * Read-only view of one audio block, pointing straight into the mapped segment.
+     * Valid until releaseAudioBlockView() is called; release reports whether the producer
+     * overwrote the block while it was being read.
+     */
+    struct AudioBlockView
+    {
+        const GenericAudioBufferHeader* header = nullptr;
+        const uint8_t* parameterData = nullptr;    // First GenericParameter entry
+        size_t parameterBytes = 0;                  // Bytes from parameterData to the end of the last parameter
+        const uint8_t* audioBytes = nullptr;        // Start of the audio data
+        const float* audioData = nullptr;           // Same as audioBytes when it is float aligned, otherwise nullptr
+        uint32_t numChannels = 0;
+        uint32_t numSamples = 0;
+        size_t sampleStride = 1;                    // Floats between consecutive samples of one channel
+        size_t channelStride = 0;                   // Floats between sample 0 of consecutive channels
+        uint64_t sequence = 0;                      // Ring sequence number (0 on legacy segments)
+        int consumerIndex = -1;                     // Ring cursor to release, -1 for peeked blocks
+
+        size_t getAudioSize() const { return static_cast<size_t>(numChannels) * numSamples * sizeof(float); }
+        bool isInterleaved() const { return channelStride == 1 || numChannels <= 1; }
+
+        /**
+         * Direct pointer to a channel's samples (stride sampleStride), or nullptr if the audio is not float aligned
+         */
+        const float* getChannel(uint32_t channel) const
+        {
+            return audioData != nullptr ? audioData + channel * channelStride : nullptr;
+        }
+
+        float getSample(uint32_t channel, uint32_t sample) const
+        {
+            float value;
+            std::memcpy(&value, audioBytes + (channel * channelStride + sample * sampleStride) * sizeof(float), sizeof(float));
+            return value;
+        }
+
+        /**
+         * Copy one channel into contiguous memory, applying a gain
+         */
+        void copyChannel(uint32_t channel, float* dest, uint32_t count, float gain = 1.0f) const
+        {
+            const float* src = getChannel(channel);
+            if (src != nullptr && sampleStride == 1 && gain == 1.0f)
+            {
+                std::memcpy(dest, src, count * sizeof(float));
+            }
+            else if (src != nullptr)
+            {
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    dest[i] = src[i * sampleStride] * gain;
+                }
+            }
+            else
+            {
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    dest[i] = getSample(channel, i) * gain;
+                }
+            }
+        }
+    };
+
+    // Segment layout versions
+    static constexpr uint32_t LAYOUT_LEGACY = 1;
+    static constexpr uint32_t LAYOUT_RING = 2;     // Any RingSegmentHeader version (see M1MemoryShareRing::getHeaderVersion)
+
     /**
      * Constructor for creating/opening a shared memory segment
      * @param memoryName Unique name for the shared memory segment (OS-wide)
@@ -129,6 +205,33 @@ public:
 
     ~M1MemoryShare();
 
+    /**
+     * Create a segment backed by an anonymous memfd instead of a .mem file (Linux only)
+     *
+     * The segment never touches the filesystem; hand getFileDescriptor() to
+     * M1MemoryShareFdTransport::announceSegment so the helper can map it.
+     *
+     * @param options M1MemoryShareFdTransport::SEGMENT_SEALED / SEGMENT_HUGE_PAGES
+     * @return The segment, or nullptr if memfd segments are unavailable
+     */
+    static std::unique_ptr<M1MemoryShare> createAnonymous(const std::string& memoryName,
+                                                          size_t totalSize,
+                                                          uint32_t maxQueueSize = 8,
+                                                          uint32_t options = M1MemoryShareFdTransport::SEGMENT_SEALED);
+
+    /**
+     * Open a segment from a descriptor received over the fd transport (Linux only)
+     * Takes ownership of fd, which is closed when the segment is destroyed.
+     * The segment must be sealed against shrinking (SEGMENT_SEALED).
+     * @return The segment, or nullptr if the descriptor is not sealed or could not be mapped
+     */
+    static std::unique_ptr<M1MemoryShare> openFileDescriptor(int fd, const std::string& memoryName);
+
+    /**
+     * Descriptor of a memfd-backed segment, -1 for file-backed segments
+     */
+    int getFileDescriptor() const { return m_segmentFd; }
+
     /**
      * Initialize the shared memory for audio data
      * @param sampleRate Audio sample rate
@@ -140,6 +243,8 @@ public:
 
     /**
      * Register a consumer for buffer acknowledgment
+     * On ring segments reading starts at the next block published, also when the ID is
+     * already registered (a consumer restarting under the same ID)
      * @param consumerId Unique ID for the consumer
      * @return true if registration successful
      */
@@ -154,6 +259,13 @@ public:
 
     /**
      * Write audio buffer to shared memory with generic parameter system and acknowledgment
+     *
+     * Serializes one block in the panner's layout (see M1MemoryShareBlock.h). On ring
+     * segments it is published to the next free slot and the parameter state page is
+     * refreshed; if every slot is still held by a consumer the block is dropped and
+     * counted (getDroppedBlockCount) instead of blocking the caller. A dropped block
+     * still uses up a sequence number, so consumers see the drop as a sequence gap.
+     *
      * @param audioBuffer Audio buffer containing the audio data (vector of channels)
      * @param parameters Generic parameter map containing all settings
      * @param dawTimestamp DAW/host timestamp
@@ -161,6 +273,8 @@ public:
      * @param isPlaying Whether DAW is currently playing
      * @param requiresAcknowledgment Whether this buffer requires acknowledgment
      * @param updateSource Source of the update (HOST, UI, MEMORYSHARE)
+     * @param audioLayout GenericAudioBufferHeader::AUDIO_INTERLEAVED (what legacy panners send)
+     *                    or AUDIO_PLANAR (channels copied as they are, no interleave pass)
      * @return buffer ID if write was successful, 0 otherwise
      */
     uint64_t writeAudioBufferWithGenericParameters(const std::vector<std::vector<float>>& audioBuffer,
@@ -169,10 +283,16 @@ public:
                                                   double playheadPositionInSeconds,
                                                   bool isPlaying,
                                                   bool requiresAcknowledgment = false,
-                                                  uint32_t updateSource = 1);
+                                                  uint32_t updateSource = 1,
+                                                  uint32_t audioLayout = GenericAudioBufferHeader::AUDIO_INTERLEAVED);
 
     /**
-     * Read the oldest unacknowledged audio buffer from shared memory
+     * Read an audio buffer from shared memory
+     *
+     * With a registered consumerId on a ring segment, this consumes the oldest block the
+     * consumer has not read yet. With consumerId 0 (or on a legacy segment) it returns the
+     * most recently published block without consuming anything.
+     *
      * @param audioBuffer JUCE AudioBuffer to store the read data
      * @param parameters Output parameter map to store all parameters
      * @param dawTimestamp Output DAW timestamp
@@ -180,6 +300,7 @@ public:
      * @param isPlaying Output playing state
      * @param bufferId Output buffer ID
      * @param updateSource Output update source
+     * @param consumerId Registered consumer to read for, or 0 to peek at the latest block
      * @return true if read was successful and data was available
      */
     bool readAudioBufferWithGenericParameters(juce::AudioBuffer<float>& audioBuffer,
@@ -188,7 +309,52 @@ public:
                                             double& playheadPositionInSeconds,
                                             bool& isPlaying,
                                             uint64_t& bufferId,
-                                            uint32_t& updateSource);
+                                            uint32_t& updateSource,
+                                            uint32_t consumerId = 0);
+
+    /**
+     * Acquire a zero-copy view of an audio block
+     *
+     * Uses the same consumer semantics as readAudioBufferWithGenericParameters. Every
+     * successful acquire must be paired with releaseAudioBlockView().
+     *
+     * @param view Output view into the mapped segment
+     * @param consumerId Registered consumer to read for, or 0 to peek at the latest block
+     * @return true if a well-formed block was available
+     */
+    bool acquireAudioBlockView(AudioBlockView& view, uint32_t consumerId = 0);
+
+    /**
+     * Release a view obtained from acquireAudioBlockView
+     * @return false if the block was overwritten while the view was in use (discard anything read from it)
+     */
+    bool releaseAudioBlockView(const AudioBlockView& view);
+
+    /**
+     * Check whether waitForData() can block until the producer publishes
+     * @return true on ring segments when the platform has a cross-process wait primitive
+     */
+    bool canWaitForData() const;
+
+    /**
+     * Block until a block is available, instead of polling
+     *
+     * For a registered consumerId this returns as soon as the consumer has unread blocks;
+     * with consumerId 0 it waits for the next publish. Returns immediately with false if
+     * canWaitForData() is false, so callers should fall back to sleeping.
+     *
+     * @param consumerId Registered consumer to wait for, or 0
+     * @param timeoutMs Maximum time to block
+     * @return true if data became available before the timeout
+     */
+    bool waitForData(uint32_t consumerId, int timeoutMs);
+
+    /**
+     * Decode the parameters of a block into a ParameterMap
+     * @param view View obtained from acquireAudioBlockView
+     * @param parameters Output parameter map (cleared first)
+     */
+    static void readParameters(const AudioBlockView& view, ParameterMap& parameters);
 
     /**
      * Read a specific buffer by ID
@@ -229,8 +395,46 @@ public:
      */
     uint32_t getUnconsumedBufferCount() const;
 
+    /**
+     * Get one consumer's backlog
+     * @return Blocks published but not yet released by consumerId on ring segments;
+     *         the queue size on legacy segments (which have no per-consumer cursor)
+     */
+    uint64_t getPendingBlockCount(uint32_t consumerId) const;
+
+    /**
+     * Publish the current parameters and transport to the segment's state page (producer side)
+     *
+     * Rewrites the seqlock-protected page in place, independently of the audio ring, so
+     * consumers can follow parameter changes without reading audio blocks.
+     *
+     * @return false on legacy segments or if the parameters do not fit in the page
+     */
+    bool writeParameterState(const ParameterMap& parameters,
+                             uint64_t dawTimestamp,
+                             double playheadPositionInSeconds,
+                             bool isPlaying,
+                             uint32_t updateSource = 1);
+
+    /**
+     * Check whether the producer publishes a parameter state page
+     * @return true on ring segments once the page has been written at least once
+     */
+    bool hasParameterState() const { return getParameterStateVersion() != 0; }
+
+    /**
+     * Version of the parameter state page, bumped on every write (0 if never written)
+     * Compare against a previously seen value to skip decoding unchanged parameters.
+     */
+    uint32_t getParameterStateVersion() const;
+
     /**
      * Read only the generic parameters from shared memory (without audio data)
+     *
+     * Uses the state page when the producer publishes one; the copy is retried while the
+     * producer is writing, and the read fails rather than returning a torn snapshot.
+     * Otherwise falls back to the parameters of the latest audio block.
+     *
      * @param parameters Output parameter map to store all parameters
      * @param dawTimestamp Output DAW timestamp
      * @param playheadPositionInSeconds Output DAW playhead position
@@ -286,12 +490,36 @@ public:
      */
     bool isValid() const;
 
+    /**
+     * Check if the producer has finished formatting the segment
+     * A newly created file is zero-filled (and reads as an empty legacy segment) until then.
+     * @return true once the segment can be consumed
+     */
+    bool isFormatted() const;
+
     /**
      * Get the current data size in the shared memory
      * @return Size of available data in bytes
      */
     size_t getDataSize() const;
 
+    /**
+     * Get the audio format the producer announced with initializeForAudio
+     * @return false if the segment is invalid
+     */
+    bool getAudioFormat(uint32_t& sampleRate, uint32_t& numChannels, uint32_t& samplesPerBlock) const;
+
+    /**
+     * Get the layout version detected when the segment was opened
+     * @return LAYOUT_LEGACY or LAYOUT_RING
+     */
+    uint32_t getLayoutVersion() const { return m_layoutVersion; }
+
+    /**
+     * Get the number of blocks the producer dropped because the ring was full (ring layout only)
+     */
+    uint64_t getDroppedBlockCount() const;
+
     /**
      * Clear all data in the shared memory
      */
@@ -334,6 +562,13 @@ public:
     static bool deleteSharedMemory(const juce::String& memoryName);
 
 private:
+    struct DescriptorSegment {};
+
+    /**
+     * Constructor for memfd-backed segments: maps nothing, see createAnonymous/openFileDescriptor
+     */
+    M1MemoryShare(DescriptorSegment, const std::string& memoryName, uint32_t maxQueueSize, bool createMode);
+
     juce::String m_memoryName;
     size_t m_totalSize;
     uint32_t m_maxQueueSize;
@@ -343,6 +578,11 @@ private:
     std::unique_ptr<juce::MemoryMappedFile> m_mappedFile;
     juce::File m_tempFile;
 
+    // memfd-backed segments (Linux fd transport) are mapped directly instead of through m_mappedFile
+    int m_segmentFd = -1;
+    void* m_segmentMapping = nullptr;
+    size_t m_segmentMappingSize = 0;
+
     SharedMemoryHeader* m_header;
     uint8_t* m_dataBuffer;
     size_t m_dataBufferSize;
@@ -350,14 +590,27 @@ private:
     // Queue management
     QueuedBuffer* m_queuedBuffers;  // Array of queued buffers
     size_t m_queuedBuffersSize;     // Size of queued buffers area
+
+    // Ring layout (layout 2)
+    uint32_t m_layoutVersion = LAYOUT_LEGACY;
+    M1MemoryShareRing m_ring;
     
     mutable std::atomic<uint32_t> m_writeCount{0};
     mutable std::atomic<uint32_t> m_readCount{0};
-    mutable std::mutex m_queueMutex;
+    mutable std::mutex m_queueMutex;  // Serializes in-process readers of legacy segments only
 
     bool createSharedMemoryFile();
     bool openSharedMemoryFile();
+    bool mapSegmentDescriptor(int fd);
+    void* getMappedData() const;
+    size_t getMappedSize() const;
     void setupMemoryPointers();
+    bool isRingLayout() const { return m_layoutVersion == LAYOUT_RING; }
+    ControlMessage* getControlRing() const;
+    
+    // Validate one serialized block (GenericAudioBufferHeader + parameters + audio) and fill a view of it
+    static bool parseAudioBlock(const uint8_t* block, size_t blockSize, AudioBlockView& view);
+
     
     // Buffer management
     uint64_t getNextBufferId();
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "TypesForDataExchange.h"
+
+/**
+ * Serialization of one M1MemoryShare audio block, as written by the panner:
+ *   GenericAudioBufferHeader | GenericParameter entries | padding | audio
+ *
+ * headerSize points at the audio so readers that don't walk the parameters can still
+ * find it; the padding keeps the audio float (and SIMD) aligned. Audio is interleaved by
+ * default, matching what legacy panners send and what the capture files store; producers
+ * holding separate channel buffers can write it planar instead and skip the interleave.
+ *
+ * Plain C++ (no JUCE), shared with the standalone tools in Tests/.
+ */
+namespace M1MemoryShareBlock
+{
+    static constexpr size_t AUDIO_ALIGNMENT = 16;
+
+    /**
+     * Offset of the audio data for a block with parameterBytes of GenericParameter entries
+     */
+    inline size_t audioOffsetFor(size_t parameterBytes)
+    {
+        size_t offset = sizeof(GenericAudioBufferHeader) + parameterBytes;
+        return (offset + AUDIO_ALIGNMENT - 1) & ~(AUDIO_ALIGNMENT - 1);
+    }
+
+    /**
+     * Total bytes of a serialized block
+     */
+    inline size_t blockSizeFor(size_t parameterBytes, uint32_t numChannels, uint32_t numSamples)
+    {
+        return audioOffsetFor(parameterBytes) + static_cast<size_t>(numChannels) * numSamples * sizeof(float);
+    }
+
+    /**
+     * Encode the parameters of a map as a GenericParameter stream
+     * @param parameterCount Output number of entries written
+     * @return Bytes written; parameters that don't fit in capacity are left out
+     */
+    inline size_t encodeParameters(const ParameterMap& parameters, uint8_t* dest, size_t capacity, uint32_t& parameterCount)
+    {
+        size_t offset = 0;
+        parameterCount = 0;
+
+        for (uint32_t index = 0; index < ParameterMap::CAPACITY; ++index)
+        {
+            if ((parameters.presentMask & (1ull << index)) == 0)
+                continue;
+
+            const ParameterMap::Slot& slot = parameters.slots[index];
+            const void* value = &slot.value;
+            uint32_t valueSize = 0;
+
+            switch (slot.type)
+            {
+                case ParameterType::FLOAT: valueSize = sizeof(float); break;
+                case ParameterType::INT: valueSize = sizeof(int32_t); break;
+                case ParameterType::BOOL: valueSize = sizeof(bool); break;
+                case ParameterType::DOUBLE: valueSize = sizeof(double); break;
+                case ParameterType::UINT32: valueSize = sizeof(uint32_t); break;
+                case ParameterType::UINT64: valueSize = sizeof(uint64_t); break;
+                case ParameterType::STRING:
+                    value = parameters.strings[slot.stringIndex].data;
+                    valueSize = parameters.strings[slot.stringIndex].length + 1; // Include the terminator
+                    break;
+            }
+
+            if (offset + sizeof(GenericParameter) + valueSize > capacity)
+                break;
+
+            GenericParameter param(slot.id, slot.type, valueSize);
+            std::memcpy(dest + offset, &param, sizeof(param));
+            offset += sizeof(GenericParameter);
+            std::memcpy(dest + offset, value, valueSize);
+            offset += valueSize;
+            ++parameterCount;
+        }
+
+        return offset;
+    }
+
+    /**
+     * Decode a GenericParameter stream into a map (cleared first); stops at the first truncated entry
+     */
+    inline void decodeParameters(const uint8_t* data, size_t dataSize, uint32_t parameterCount, ParameterMap& parameters)
+    {
+        parameters.clear();
+
+        const uint8_t* readPtr = data;
+        const uint8_t* endPtr = data + dataSize;
+
+        for (uint32_t i = 0; i < parameterCount && readPtr + sizeof(GenericParameter) <= endPtr; ++i)
+        {
+            GenericParameter param;
+            std::memcpy(&param, readPtr, sizeof(param));
+            readPtr += sizeof(GenericParameter);
+
+            if (param.dataSize > static_cast<size_t>(endPtr - readPtr))
+                break;
+
+            switch (param.parameterType)
+            {
+                case ParameterType::FLOAT: { float v; std::memcpy(&v, readPtr, sizeof(v)); parameters.addFloat(param.parameterID, v); break; }
+                case ParameterType::INT: { int32_t v; std::memcpy(&v, readPtr, sizeof(v)); parameters.addInt(param.parameterID, v); break; }
+                case ParameterType::BOOL: parameters.addBool(param.parameterID, *readPtr != 0); break;
+                case ParameterType::STRING:
+                    parameters.addString(param.parameterID, reinterpret_cast<const char*>(readPtr),
+                                         strnlen(reinterpret_cast<const char*>(readPtr), param.dataSize));
+                    break;
+                case ParameterType::DOUBLE: { double v; std::memcpy(&v, readPtr, sizeof(v)); parameters.addDouble(param.parameterID, v); break; }
+                case ParameterType::UINT32: { uint32_t v; std::memcpy(&v, readPtr, sizeof(v)); parameters.addUInt32(param.parameterID, v); break; }
+                case ParameterType::UINT64: { uint64_t v; std::memcpy(&v, readPtr, sizeof(v)); parameters.addUInt64(param.parameterID, v); break; }
+            }
+
+            readPtr += param.dataSize;
+        }
+    }
+
+    /**
+     * Serialize a block
+     * @param header Block header; channels, samples, parameterCount, headerSize and audioLayout are filled in here
+     * @param parameterData Encoded GenericParameter stream (see encodeParameters)
+     * @param channels One pointer per channel, numSamples floats each
+     * @param audioLayout GenericAudioBufferHeader::AUDIO_INTERLEAVED or AUDIO_PLANAR
+     * @return Bytes written, or 0 if the block does not fit in capacity
+     */
+    inline size_t write(uint8_t* dest, size_t capacity, GenericAudioBufferHeader header,
+                        const uint8_t* parameterData, size_t parameterBytes, uint32_t parameterCount,
+                        const float* const* channels, uint32_t numChannels, uint32_t numSamples,
+                        uint32_t audioLayout = GenericAudioBufferHeader::AUDIO_INTERLEAVED)
+    {
+        const size_t audioOffset = audioOffsetFor(parameterBytes);
+        const size_t blockSize = blockSizeFor(parameterBytes, numChannels, numSamples);
+        if (dest == nullptr || blockSize > capacity)
+            return 0;
+
+        header.channels = numChannels;
+        header.samples = numSamples;
+        header.parameterCount = parameterCount;
+        header.headerSize = static_cast<uint32_t>(audioOffset);
+        header.audioLayout = audioLayout == GenericAudioBufferHeader::AUDIO_PLANAR ? GenericAudioBufferHeader::AUDIO_PLANAR
+                                                                                  : GenericAudioBufferHeader::AUDIO_INTERLEAVED;
+
+        std::memcpy(dest, &header, sizeof(header));
+        std::memcpy(dest + sizeof(header), parameterData, parameterBytes);
+        std::memset(dest + sizeof(header) + parameterBytes, 0, audioOffset - sizeof(header) - parameterBytes);
+
+        float* audio = reinterpret_cast<float*>(dest + audioOffset);
+        if (numChannels == 1 || header.audioLayout == GenericAudioBufferHeader::AUDIO_PLANAR)
+        {
+            for (uint32_t channel = 0; channel < numChannels; ++channel)
+                std::memcpy(audio + static_cast<size_t>(channel) * numSamples, channels[channel], numSamples * sizeof(float));
+        }
+        else
+        {
+            for (uint32_t channel = 0; channel < numChannels; ++channel)
+            {
+                const float* src = channels[channel];
+                float* out = audio + channel;
+                for (uint32_t sample = 0; sample < numSamples; ++sample)
+                    out[sample * numChannels] = src[sample];
+            }
+        }
+
+        return blockSize;
+    }
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+    #include <cerrno>
+    #include <limits.h>
+    #include <poll.h>
+    #include <sys/eventfd.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+    #define M1_MEMORYSHARE_DIRECTORY_WATCHER 1
+#endif
+
+/**
+ * Event-driven discovery of M1MemoryShare segment files.
+ *
+ * Watches the shared directories for segment files appearing and disappearing, so the
+ * helper can connect to a new panner as soon as its file exists instead of listing every
+ * directory on a timer. Only names matching prefix*suffix are reported.
+ *
+ * Linux uses inotify. Elsewhere start() returns false and the caller keeps polling.
+ * When the kernel drops events (queue overflow) or a watched directory goes away, a
+ * RESCAN event asks the caller for one full scan to resynchronize.
+ *
+ * wait() is meant to run on its own thread; wake() (from any thread) returns it early.
+ *
+ * Plain C++ (no JUCE).
+ */
+class M1MemoryShareDirectoryWatcher
+{
+public:
+    struct Event
+    {
+        enum Type
+        {
+            CREATED,    // File created, moved in, or closed after writing (may repeat for one file)
+            REMOVED,    // File deleted or moved away
+            RESCAN      // Events were lost; scan the directories once
+        };
+
+        Type type;
+        std::string path;
+    };
+
+    ~M1MemoryShareDirectoryWatcher() { stop(); }
+
+    /**
+     * Watch directories for files named prefix*suffix
+     * @return false if no directory could be watched (caller should fall back to polling)
+     */
+    bool start(const std::vector<std::string>& directories, const std::string& prefix, const std::string& suffix)
+    {
+#if defined(M1_MEMORYSHARE_DIRECTORY_WATCHER)
+        stop();
+
+        m_prefix = prefix;
+        m_suffix = suffix;
+        m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        m_wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_inotify < 0 || m_wake < 0)
+        {
+            stop();
+            return false;
+        }
+
+        const uint32_t mask = IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM
+                            | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+        for (const auto& directory : directories)
+        {
+            int watch = inotify_add_watch(m_inotify, directory.c_str(), mask);
+            if (watch >= 0)
+                m_watches.emplace_back(watch, directory);
+        }
+
+        if (m_watches.empty())
+        {
+            stop();
+            return false;
+        }
+        return true;
+#else
+        (void) directories; (void) prefix; (void) suffix;
+        return false;
+#endif
+    }
+
+    void stop()
+    {
+#if defined(M1_MEMORYSHARE_DIRECTORY_WATCHER)
+        if (m_inotify >= 0)
+            close(m_inotify);
+        if (m_wake >= 0)
+            close(m_wake);
+#endif
+        m_inotify = -1;
+        m_wake = -1;
+        m_watches.clear();
+    }
+
+    bool isWatching() const { return m_inotify >= 0; }
+
+    /**
+     * Number of directories being watched
+     */
+    size_t getWatchCount() const { return m_watches.size(); }
+
+    /**
+     * Block until something happens in the watched directories
+     * @param timeoutMs Maximum time to block (-1 = until an event or wake())
+     * @param events Output events, appended in the order they happened
+     */
+    void wait(int timeoutMs, std::vector<Event>& events)
+    {
+#if defined(M1_MEMORYSHARE_DIRECTORY_WATCHER)
+        if (m_inotify < 0)
+            return;
+
+        pollfd fds[2] = { { m_inotify, POLLIN, 0 }, { m_wake, POLLIN, 0 } };
+        if (poll(fds, 2, timeoutMs) <= 0)
+            return;
+
+        if ((fds[1].revents & POLLIN) != 0)
+        {
+            uint64_t count = 0;
+            (void) read(m_wake, &count, sizeof(count));
+        }
+
+        if ((fds[0].revents & POLLIN) != 0)
+            readEvents(events);
+#else
+        (void) timeoutMs; (void) events;
+#endif
+    }
+
+    /**
+     * Return from a blocked wait() (thread-safe)
+     */
+    void wake()
+    {
+#if defined(M1_MEMORYSHARE_DIRECTORY_WATCHER)
+        if (m_wake >= 0)
+        {
+            uint64_t one = 1;
+            (void) write(m_wake, &one, sizeof(one));
+        }
+#endif
+    }
+
+private:
+#if defined(M1_MEMORYSHARE_DIRECTORY_WATCHER)
+    void readEvents(std::vector<Event>& events)
+    {
+        alignas(inotify_event) char buffer[16 * (sizeof(inotify_event) + NAME_MAX + 1)];
+
+        for (;;)
+        {
+            ssize_t bytes = read(m_inotify, buffer, sizeof(buffer));
+            if (bytes <= 0)
+                return;
+
+            for (ssize_t offset = 0; offset < bytes;)
+            {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if ((event->mask & (IN_Q_OVERFLOW | IN_DELETE_SELF | IN_MOVE_SELF)) != 0)
+                {
+                    events.push_back({ Event::RESCAN, std::string() });
+                    continue;
+                }
+
+                if (event->len == 0 || (event->mask & IN_ISDIR) != 0 || !matches(event->name))
+                    continue;
+
+                const std::string* directory = findDirectory(event->wd);
+                if (directory == nullptr)
+                    continue;
+
+                const bool removed = (event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0;
+                events.push_back({ removed ? Event::REMOVED : Event::CREATED, *directory + "/" + event->name });
+            }
+        }
+    }
+
+    bool matches(const char* name) const
+    {
+        const std::string file(name);
+        return file.size() >= m_prefix.size() + m_suffix.size()
+            && file.compare(0, m_prefix.size(), m_prefix) == 0
+            && file.compare(file.size() - m_suffix.size(), m_suffix.size(), m_suffix) == 0;
+    }
+
+    const std::string* findDirectory(int watch) const
+    {
+        for (const auto& entry : m_watches)
+        {
+            if (entry.first == watch)
+                return &entry.second;
+        }
+        return nullptr;
+    }
+#endif
+
+    int m_inotify = -1;
+    int m_wake = -1;
+    std::vector<std::pair<int, std::string>> m_watches;
+    std::string m_prefix;
+    std::string m_suffix;
+};
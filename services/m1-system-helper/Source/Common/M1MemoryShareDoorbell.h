@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+    #include <climits>
+    #include <ctime>
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#elif defined(__APPLE__) && __has_include(<os/os_sync_wait_on_address.h>)
+    #include <os/os_sync_wait_on_address.h>
+    #define M1_DOORBELL_OS_SYNC 1
+#endif
+
+/**
+ * Cross-process wait/wake on a 32-bit word inside a shared mapping.
+ *
+ * Linux uses a shared (non-private) futex, macOS 14.4+ uses os_sync_wait_on_address
+ * with the shared flag. Anywhere else, wait() degrades to a short sleep so callers
+ * behave exactly like the old polling loops.
+ */
+namespace M1MemoryShareDoorbell
+{
+    /** Fallback sleep when no native wait primitive is available */
+    static constexpr int POLL_FALLBACK_MS = 1;
+
+    /**
+     * True if wait() actually blocks until wake() on this platform/OS version
+     */
+    inline bool isNativeWaitAvailable()
+    {
+#if defined(__linux__)
+        return true;
+#elif defined(M1_DOORBELL_OS_SYNC)
+        if (__builtin_available(macOS 14.4, *))
+            return true;
+        return false;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Block while word == expected, for at most timeoutMs
+     * Spurious returns are possible; callers must re-check their condition.
+     */
+    inline void wait(std::atomic<uint32_t>& word, uint32_t expected, int timeoutMs)
+    {
+        if (word.load(std::memory_order_acquire) != expected || timeoutMs <= 0)
+            return;
+
+#if defined(__linux__)
+        struct timespec timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000L;
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+        return;
+#elif defined(M1_DOORBELL_OS_SYNC)
+        if (__builtin_available(macOS 14.4, *))
+        {
+            os_sync_wait_on_address_with_timeout(reinterpret_cast<void*>(&word), expected, sizeof(uint32_t),
+                                                 OS_SYNC_WAIT_ON_ADDRESS_SHARED, OS_CLOCK_MACH_ABSOLUTE_TIME,
+                                                 static_cast<uint64_t>(timeoutMs) * 1000000ull);
+            return;
+        }
+#endif
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs < POLL_FALLBACK_MS ? timeoutMs : POLL_FALLBACK_MS));
+    }
+
+    /**
+     * Wake every process/thread blocked in wait() on this word
+     */
+    inline void wakeAll(std::atomic<uint32_t>& word)
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#elif defined(M1_DOORBELL_OS_SYNC)
+        if (__builtin_available(macOS 14.4, *))
+            os_sync_wake_by_address_all(reinterpret_cast<void*>(&word), sizeof(uint32_t), OS_SYNC_WAKE_BY_ADDRESS_SHARED);
+#else
+        (void) word;
+#endif
+    }
+}
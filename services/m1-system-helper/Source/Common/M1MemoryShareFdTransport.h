@@ -0,0 +1,389 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <sys/mman.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+    #define M1_MEMORYSHARE_FD_TRANSPORT 1
+#endif
+
+/**
+ * Optional Linux transport for M1MemoryShare segments that never touch the filesystem.
+ *
+ * The panner creates its segment with memfd_create (optionally sealed against resizing
+ * and backed by huge pages) and sends the descriptor to the helper over a local unix
+ * socket (SCM_RIGHTS), together with the identity that file-backed segments encode in
+ * their file name. The connection stays open for the life of the segment, so the helper
+ * learns that a panner went away from the hang-up instead of from scanning and pid checks.
+ *
+ * The socket lives in the abstract namespace (no socket file to clean up). Such sockets
+ * have no file permissions, so the name only keeps users apart by convention: both ends
+ * check the peer's credentials (SO_PEERCRED) and talk only to their own user, and the
+ * helper takes a producer's process ID from those credentials, never from what it sends.
+ *
+ * Plain C++ (no JUCE); on other platforms everything here reports "unavailable" and the
+ * file-backed segments remain the only transport.
+ */
+namespace M1MemoryShareFdTransport
+{
+    /**
+     * Identity of a segment, sent with its descriptor
+     */
+    struct SegmentAnnouncement
+    {
+        static constexpr uint32_t MAGIC = 0x4146314D;   // "M1FA"
+        static constexpr uint32_t VERSION = 1;
+
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint32_t processId = 0;
+        uint32_t reserved = 0;
+        uint64_t memoryAddress = 0;         // Producer instance pointer, as in the _PTR part of file names
+        uint64_t creationTimestamp = 0;
+        uint64_t segmentSize = 0;
+        char name[128] = {};                // Segment name (same as the file-backed base name)
+    };
+
+    // memfd segment options
+    static constexpr uint32_t SEGMENT_SEALED = 1 << 0;      // Seal size so a consumer can't SIGBUS on truncation
+    static constexpr uint32_t SEGMENT_HUGE_PAGES = 1 << 1;  // Try MFD_HUGETLB, fall back to normal pages
+
+    /**
+     * A segment received by the listener
+     */
+    struct ReceivedSegment
+    {
+        int connection = -1;                // Identifies the producer until it hangs up
+        int fd = -1;                        // Segment descriptor; the receiver owns it
+        uint32_t processId = 0;             // Producer's process, from the connection's credentials
+        SegmentAnnouncement announcement;   // As sent: its processId is not trusted
+    };
+
+    inline bool isAvailable()
+    {
+#if defined(M1_MEMORYSHARE_FD_TRANSPORT)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+#if defined(M1_MEMORYSHARE_FD_TRANSPORT)
+
+    /**
+     * Abstract socket address for the current user (leading NUL, not NUL terminated)
+     */
+    inline socklen_t makeAddress(sockaddr_un& address, const std::string& channel = "M1SystemHelper.segments")
+    {
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+
+        std::string name = channel + "." + std::to_string(static_cast<unsigned long>(getuid()));
+        size_t length = std::min(name.size(), sizeof(address.sun_path) - 1);
+        std::memcpy(address.sun_path + 1, name.data(), length);
+        return static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 + length);
+    }
+
+    /**
+     * Process on the other end of a connection, if it runs as the current user
+     * @return false if its credentials are unavailable or belong to another user
+     */
+    inline bool getSameUserPeer(int connection, pid_t& processId)
+    {
+        ucred credentials = {};
+        socklen_t length = sizeof(credentials);
+        if (getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0
+            || length != sizeof(credentials) || credentials.uid != getuid())
+            return false;
+
+        processId = credentials.pid;
+        return true;
+    }
+
+    /**
+     * Create an anonymous segment of at least size bytes
+     * @param actualSize Output size after rounding (huge pages round up to 2 MiB)
+     * @return Descriptor, or -1 on failure
+     */
+    inline int createSegment(const std::string& name, size_t size, uint32_t options, size_t& actualSize)
+    {
+        actualSize = size;
+        int fd = -1;
+
+    #if defined(MFD_HUGETLB)
+        if ((options & SEGMENT_HUGE_PAGES) != 0)
+        {
+            const size_t hugePage = 2 * 1024 * 1024;
+            size_t rounded = (size + hugePage - 1) & ~(hugePage - 1);
+            fd = memfd_create(name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING | MFD_HUGETLB);
+
+            // ftruncate succeeds without reserved huge pages; only a mapping reserves them
+            void* probe = MAP_FAILED;
+            if (fd >= 0 && ftruncate(fd, static_cast<off_t>(rounded)) == 0)
+                probe = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+            if (probe != MAP_FAILED)
+            {
+                munmap(probe, rounded);
+                actualSize = rounded;
+            }
+            else if (fd >= 0)
+            {
+                close(fd);
+                fd = -1;    // No huge pages reserved; use normal pages
+            }
+        }
+    #endif
+
+        if (fd < 0)
+        {
+            fd = memfd_create(name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+            if (fd < 0)
+                return -1;
+
+            if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+            {
+                close(fd);
+                return -1;
+            }
+            actualSize = size;
+        }
+
+        if ((options & SEGMENT_SEALED) != 0)
+            fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
+        return fd;
+    }
+
+    /**
+     * Check that a received descriptor can't be shrunk underneath its mapping
+     */
+    inline bool isSizeSealed(int fd)
+    {
+        int seals = fcntl(fd, F_GET_SEALS);
+        return seals >= 0 && (seals & F_SEAL_SHRINK) != 0;
+    }
+
+    /**
+     * Size of the segment behind a descriptor, 0 on failure
+     */
+    inline size_t getSegmentSize(int fd)
+    {
+        struct stat info;
+        return fstat(fd, &info) == 0 && info.st_size > 0 ? static_cast<size_t>(info.st_size) : 0;
+    }
+
+    /**
+     * Send a segment to the helper (producer side)
+     * @return Connection to keep open for the life of the segment (close it to retract), or -1 if no helper
+     *         of this user is listening
+     */
+    inline int announceSegment(int segmentFd, const SegmentAnnouncement& announcement)
+    {
+        int connection = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (connection < 0)
+            return -1;
+
+        // Anyone can take the name first: only hand the segment to a helper of our own user
+        sockaddr_un address;
+        socklen_t length = makeAddress(address);
+        pid_t helper = 0;
+        if (connect(connection, reinterpret_cast<sockaddr*>(&address), length) != 0
+            || !getSameUserPeer(connection, helper))
+        {
+            close(connection);
+            return -1;
+        }
+
+        iovec payload;
+        payload.iov_base = const_cast<SegmentAnnouncement*>(&announcement);
+        payload.iov_len = sizeof(announcement);
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+        msghdr message = {};
+        message.msg_iov = &payload;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        cmsghdr* rights = CMSG_FIRSTHDR(&message);
+        rights->cmsg_level = SOL_SOCKET;
+        rights->cmsg_type = SCM_RIGHTS;
+        rights->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(rights), &segmentFd, sizeof(int));
+
+        if (sendmsg(connection, &message, MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(announcement)))
+        {
+            close(connection);
+            return -1;
+        }
+
+        return connection;
+    }
+
+    /**
+     * Helper-side listener: accepts producers and receives their segments
+     */
+    class Listener
+    {
+    public:
+        ~Listener() { stop(); }
+
+        /**
+         * Start listening
+         * @return false if the socket is unavailable or another helper already listens
+         */
+        bool start()
+        {
+            if (m_socket >= 0)
+                return true;
+
+            m_socket = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+            if (m_socket < 0)
+                return false;
+
+            sockaddr_un address;
+            socklen_t length = makeAddress(address);
+            if (bind(m_socket, reinterpret_cast<sockaddr*>(&address), length) != 0 || listen(m_socket, 64) != 0)
+            {
+                stop();
+                return false;
+            }
+            return true;
+        }
+
+        void stop()
+        {
+            for (int connection : m_connections)
+                close(connection);
+            m_connections.clear();
+
+            if (m_socket >= 0)
+                close(m_socket);
+            m_socket = -1;
+        }
+
+        bool isListening() const { return m_socket >= 0; }
+
+        /**
+         * Accept new producers and collect their segments and hang-ups
+         * @param timeoutMs Time to block waiting for activity (0 = just check)
+         * @param received Output segments announced since the last call
+         * @param closed Output connections whose producer hung up (their segments are gone)
+         */
+        void poll(int timeoutMs, std::vector<ReceivedSegment>& received, std::vector<int>& closed)
+        {
+            if (m_socket < 0)
+                return;
+
+            std::vector<pollfd> fds;
+            fds.push_back({ m_socket, POLLIN, 0 });
+            for (int connection : m_connections)
+                fds.push_back({ connection, POLLIN, 0 });
+
+            if (::poll(fds.data(), fds.size(), timeoutMs) <= 0)
+                return;
+
+            for (size_t i = 1; i < fds.size(); ++i)
+            {
+                if (fds[i].revents == 0)
+                    continue;
+
+                ReceivedSegment segment;
+                segment.connection = fds[i].fd;
+                if ((fds[i].revents & POLLIN) != 0 && receive(fds[i].fd, segment))
+                {
+                    received.push_back(segment);
+                }
+                else if ((fds[i].revents & (POLLHUP | POLLERR)) != 0 || (fds[i].revents & POLLIN) != 0)
+                {
+                    closed.push_back(fds[i].fd);
+                    close(fds[i].fd);
+                    m_connections.erase(std::find(m_connections.begin(), m_connections.end(), fds[i].fd));
+                }
+            }
+
+            if ((fds[0].revents & POLLIN) != 0)
+            {
+                int connection;
+                while ((connection = accept4(m_socket, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK)) >= 0)
+                {
+                    pid_t producer = 0;
+                    if (!getSameUserPeer(connection, producer))
+                    {
+                        close(connection);
+                        continue;
+                    }
+                    m_connections.push_back(connection);
+
+                    // The announcement is normally already queued; pick it up without another poll round
+                    ReceivedSegment segment;
+                    segment.connection = connection;
+                    if (receive(connection, segment))
+                        received.push_back(segment);
+                }
+            }
+        }
+
+    private:
+        static bool receive(int connection, ReceivedSegment& segment)
+        {
+            pid_t producer = 0;
+            if (!getSameUserPeer(connection, producer))
+                return false;
+
+            iovec payload;
+            payload.iov_base = &segment.announcement;
+            payload.iov_len = sizeof(segment.announcement);
+
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+            msghdr message = {};
+            message.msg_iov = &payload;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+
+            ssize_t bytes = recvmsg(connection, &message, MSG_CMSG_CLOEXEC | MSG_DONTWAIT);
+            if (bytes <= 0)
+                return false;
+
+            int fd = -1;
+            for (cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header))
+            {
+                if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS)
+                    std::memcpy(&fd, CMSG_DATA(header), sizeof(int));
+            }
+
+            const SegmentAnnouncement& announcement = segment.announcement;
+            if (bytes != static_cast<ssize_t>(sizeof(SegmentAnnouncement)) || fd < 0
+                || announcement.magic != SegmentAnnouncement::MAGIC || announcement.version != SegmentAnnouncement::VERSION)
+            {
+                if (fd >= 0)
+                    close(fd);
+                return false;
+            }
+
+            segment.announcement.name[sizeof(segment.announcement.name) - 1] = '\0';
+            segment.fd = fd;
+            segment.processId = static_cast<uint32_t>(producer);
+            return true;
+        }
+
+        int m_socket = -1;
+        std::vector<int> m_connections;
+    };
+
+#endif
+}
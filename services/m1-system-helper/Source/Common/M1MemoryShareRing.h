@@ -0,0 +1,938 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "M1MemoryShareDoorbell.h"
+#include "M1MemoryShareStatePage.h"
+
+#if defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <cerrno>
+    #include <signal.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * Layout and lock-free algorithms for the multi-slot audio ring used by
+ * M1MemoryShare segments (layout version 2). New segments use RingSegmentHeader version 3
+ * (one cache line per writer); segments with the packed version 2 header are still read.
+ *
+ * Segment layout:
+ *   RingSegmentHeader | parameter state page | slot[0] | ... | slot[slotCount - 1] | control ring
+ * Each slot is a RingSlotHeader followed by one serialized block
+ * (GenericAudioBufferHeader + GenericParameter entries + audio data). The state page
+ * holds the latest parameters on their own (see M1MemoryShareStatePage.h).
+ *
+ * The panner is the single producer. Every registered consumer owns a read cursor
+ * in the mapped header, and the producer never overwrites a slot that a registered
+ * consumer has not released yet; when the ring is full the block is dropped and
+ * counted instead of blocking the audio thread. Unregistered readers may still peek
+ * at the latest block and use the per-slot sequence number to detect overwrites.
+ *
+ * A consumer that dies while registered would hold the tail forever, so each registration
+ * records its owner's process ID (version 3 headers). When the ring is full the producer
+ * checks those processes (on the first drop, then every LIVENESS_CHECK_DROPS drops) and
+ * evicts consumers whose process has exited; registerConsumer does the same when every
+ * consumer slot is taken.
+ *
+ * Consumers acknowledge blocks by setting their bit in the slot's ackMask, which may
+ * happen out of order; a consumer's cursor advances over every contiguous block it has
+ * acknowledged. Slots are reclaimed from the minimum cursor across consumers (tail),
+ * so nothing is ever copied or compacted and consumers never write producer state.
+ *
+ * Everything here is plain C++ (no JUCE) so that the panner, the helper and the
+ * standalone tools in Tests/ can share it.
+ */
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Ring atomics must be address-free across processes");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Ring atomics must be address-free across processes");
+
+/**
+ * Fields every ring header version starts with, written once when the producer formats
+ * the segment (sampleRate/numChannels/samplesPerBlock again when the audio format changes)
+ */
+struct RingSegmentInfo
+{
+    static constexpr uint32_t MAGIC = 0x4252314D;   // "M1RB"
+
+    uint32_t magic;                         // MAGIC once the producer has formatted the segment
+    uint32_t version;                       // Header version (RingSegmentHeader::VERSION when created)
+    uint32_t headerSize;                    // sizeof() of that header version as seen by the producer
+    uint32_t slotCount;                     // Number of slots (power of two)
+    uint32_t slotStride;                    // Bytes per slot including RingSlotHeader
+    uint32_t sampleRate;                    // Audio sample rate
+    uint32_t numChannels;                   // Number of audio channels
+    uint32_t samplesPerBlock;               // Samples per processing block
+    char name[64];                          // Name identifier for debugging
+    uint32_t statePageOffset;               // Byte offset of the ParameterStatePage
+    uint32_t statePageSize;                 // sizeof(ParameterStatePage)
+};
+
+/**
+ * Header at offset 0 of a ring segment (version 3)
+ *
+ * Shared fields are grouped by writer, one 64-byte cache line per group, so the producer's
+ * audio thread and each consumer only invalidate lines the others merely read:
+ *   - info: written at format time, read-mostly
+ *   - producer line: head, droppedBlocks, doorbell, controlReadIndex
+ *   - consumer line: tail, doorbellWaiters, controlWriteIndex (written by consumers, read by the producer)
+ *   - consumerIds: written on (un)registration only
+ *   - one line per consumer cursor, written by that consumer only
+ *
+ * Memory ordering:
+ *   - head, slot sequence: release by the producer after the payload, acquire by readers
+ *   - consumer cursors: release by their consumer, acquire by the tail computation
+ *   - consumer owner pid: set before the ID is published, cleared (CAS) on unregistration or eviction
+ *   - tail: CAS (acq_rel) by whichever side advances it, acquire by the producer before reusing a slot
+ *   - doorbell / doorbellWaiters: seq_cst pair, see M1MemoryShareRing::commitWrite / waitForPublish
+ *   - control indices: release by their owner after the message, acquire by the other side
+ *   - droppedBlocks: relaxed statistics
+ */
+struct RingSegmentHeader
+{
+    static constexpr uint32_t MAGIC = RingSegmentInfo::MAGIC;
+    static constexpr uint32_t VERSION = 3;
+    static constexpr uint32_t MIN_VERSION = 2;      // Oldest header version attach() accepts
+    static constexpr uint32_t MAX_CONSUMERS = 16;
+    static constexpr size_t CACHE_LINE = 64;
+
+    RingSegmentInfo info;
+
+    // Producer-owned
+    alignas(CACHE_LINE) std::atomic<uint64_t> head;             // Next sequence the producer will publish
+    std::atomic<uint64_t> droppedBlocks;    // Blocks discarded by the producer because the ring was full
+    std::atomic<uint32_t> doorbell;         // Bumped on every publish, waited on by consumers (see M1MemoryShareDoorbell.h)
+    std::atomic<uint32_t> controlReadIndex; // Control messages the producer has drained
+
+    // Written by consumers, read by the producer
+    alignas(CACHE_LINE) std::atomic<uint64_t> tail;             // Oldest sequence still held for a registered consumer
+    std::atomic<uint32_t> doorbellWaiters;  // Consumers currently blocked; the producer skips the wake syscall at 0
+    std::atomic<uint32_t> controlWriteIndex;// Control messages queued by consumers
+
+    alignas(CACHE_LINE) std::atomic<uint32_t> consumerIds[MAX_CONSUMERS];  // 0 = free, CONSUMER_ARMING = being claimed
+
+    struct alignas(CACHE_LINE) ConsumerCursor
+    {
+        std::atomic<uint64_t> value;        // Next sequence the consumer will read
+        std::atomic<uint32_t> ownerPid;     // Process that registered the slot (0 = unknown: never evicted)
+    };
+    ConsumerCursor consumerCursors[MAX_CONSUMERS];
+};
+
+static_assert(sizeof(RingSegmentInfo) == 104, "RingSegmentInfo is shared by every header version");
+static_assert(offsetof(RingSegmentHeader, head) % RingSegmentHeader::CACHE_LINE == 0, "Producer fields start a cache line");
+static_assert(offsetof(RingSegmentHeader, tail) - offsetof(RingSegmentHeader, head) == RingSegmentHeader::CACHE_LINE, "Consumer fields have their own line");
+static_assert(sizeof(RingSegmentHeader::ConsumerCursor) == RingSegmentHeader::CACHE_LINE, "One cursor per cache line");
+
+/**
+ * Header version 2 (packed): still produced by older panners, attach() maps it field by field
+ */
+struct RingSegmentHeaderV2
+{
+    RingSegmentInfo info;
+
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+    std::atomic<uint64_t> droppedBlocks;
+
+    std::atomic<uint32_t> consumerIds[RingSegmentHeader::MAX_CONSUMERS];
+    std::atomic<uint64_t> consumerCursors[RingSegmentHeader::MAX_CONSUMERS];
+
+    std::atomic<uint32_t> controlWriteIndex;
+    std::atomic<uint32_t> controlReadIndex;
+
+    std::atomic<uint32_t> doorbell;
+    std::atomic<uint32_t> doorbellWaiters;
+};
+
+/**
+ * Per-slot header, followed by the serialized block
+ */
+struct RingSlotHeader
+{
+    static constexpr uint64_t BUSY = ~0ull;
+
+    std::atomic<uint64_t> sequence;         // sequence + 1 once published, BUSY while being written, 0 if never used
+    uint32_t payloadSize;                   // Size of the serialized block in bytes
+    std::atomic<uint32_t> ackMask;          // Bit per consumer index that acknowledged this sequence
+};
+
+static_assert(RingSegmentHeader::MAX_CONSUMERS <= 32, "ackMask holds one bit per consumer");
+
+/**
+ * Non-owning view over a mapped ring segment
+ */
+class M1MemoryShareRing
+{
+public:
+    static constexpr size_t SLOT_ALIGNMENT = 64;
+
+    /**
+     * Check whether a mapped region starts with a ring header
+     */
+    static bool isRingSegment(const void* base, size_t size)
+    {
+        if (base == nullptr || size < sizeof(RingSegmentInfo))
+            return false;
+
+        uint32_t magic = 0;
+        std::memcpy(&magic, base, sizeof(magic));
+        return magic == RingSegmentInfo::MAGIC;
+    }
+
+    /**
+     * Bytes needed for one slot that can hold payloadBytes
+     */
+    static size_t slotStrideFor(size_t payloadBytes)
+    {
+        size_t stride = sizeof(RingSlotHeader) + payloadBytes;
+        return (stride + SLOT_ALIGNMENT - 1) & ~(SLOT_ALIGNMENT - 1);
+    }
+
+    /**
+     * Bytes needed for a segment with the given slot geometry and trailing control area
+     */
+    static size_t segmentSizeFor(uint32_t slotCount, size_t slotStride, size_t controlBytes)
+    {
+        return slotsOffset() + static_cast<size_t>(slotCount) * slotStride + controlBytes;
+    }
+
+    /**
+     * Format a zeroed mapping as an empty ring (producer side)
+     * @param slotCount Requested slot count, rounded down to a power of two
+     * @param controlBytes Bytes reserved after the slots for the control ring
+     * @return true if the mapping was large enough
+     */
+    bool create(void* base, size_t size, uint32_t slotCount, size_t controlBytes, const char* name)
+    {
+        if (base == nullptr || slotCount == 0)
+            return false;
+
+        uint32_t count = 1;
+        while (count * 2 <= slotCount)
+            count *= 2;
+
+        if (size < slotsOffset() + controlBytes + count * slotStrideFor(0))
+            return false;
+
+        size_t stride = (size - slotsOffset() - controlBytes) / count;
+        stride &= ~(SLOT_ALIGNMENT - 1);
+
+        std::memset(base, 0, slotsOffset());
+        auto* header = static_cast<RingSegmentInfo*>(base);
+        header->version = RingSegmentHeader::VERSION;
+        header->headerSize = static_cast<uint32_t>(sizeof(RingSegmentHeader));
+        header->slotCount = count;
+        header->slotStride = static_cast<uint32_t>(stride);
+        header->statePageOffset = static_cast<uint32_t>(headerBytesFor(sizeof(RingSegmentHeader)));
+        header->statePageSize = static_cast<uint32_t>(sizeof(ParameterStatePage));
+        if (name != nullptr)
+            std::strncpy(header->name, name, sizeof(header->name) - 1);
+
+        for (uint32_t i = 0; i < count; ++i)
+            std::memset(static_cast<uint8_t*>(base) + slotsOffset() + i * stride, 0, sizeof(RingSlotHeader));
+
+        // Publish the magic last so readers never see a half-formatted header
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = RingSegmentInfo::MAGIC;
+
+        return attach(base, size);
+    }
+
+    /**
+     * Attach to an already formatted ring, validating its geometry against the mapping size
+     *
+     * Accepts header versions MIN_VERSION..VERSION; the shared fields are located per version,
+     * so everything below works the same on older segments.
+     */
+    bool attach(void* base, size_t size)
+    {
+        detach();
+
+        if (!isRingSegment(base, size))
+            return false;
+
+        auto* header = static_cast<RingSegmentInfo*>(base);
+        size_t headerSize = 0;
+        if (header->version == RingSegmentHeader::VERSION)
+            headerSize = sizeof(RingSegmentHeader);
+        else if (header->version == 2)
+            headerSize = sizeof(RingSegmentHeaderV2);
+
+        if (headerSize == 0 || header->headerSize != headerSize || size < headerSize)
+            return false;
+
+        const uint32_t count = header->slotCount;
+        if (count == 0 || (count & (count - 1)) != 0)
+            return false;
+
+        if (header->slotStride < sizeof(RingSlotHeader) || (header->slotStride % alignof(RingSlotHeader)) != 0)
+            return false;
+
+        const size_t slotsStart = headerBytesFor(headerSize) + sizeof(ParameterStatePage);
+        if (header->statePageOffset != headerBytesFor(headerSize) || header->statePageSize != sizeof(ParameterStatePage))
+            return false;
+
+        if (slotsStart + static_cast<size_t>(count) * header->slotStride > size)
+            return false;
+
+        if (header->version == RingSegmentHeader::VERSION)
+        {
+            auto* fields = static_cast<RingSegmentHeader*>(base);
+            bindFields(*fields, &fields->consumerCursors[0].value, sizeof(RingSegmentHeader::ConsumerCursor));
+            m_ownerPids = reinterpret_cast<uint8_t*>(&fields->consumerCursors[0].ownerPid);
+        }
+        else
+        {
+            auto* fields = static_cast<RingSegmentHeaderV2*>(base);
+            bindFields(*fields, &fields->consumerCursors[0], sizeof(std::atomic<uint64_t>));
+        }
+
+        m_header = header;
+        m_slots = static_cast<uint8_t*>(base) + slotsStart;
+        m_slotMask = count - 1;
+        return true;
+    }
+
+    void detach()
+    {
+        m_header = nullptr;
+        m_slots = nullptr;
+        m_slotMask = 0;
+        m_ownerPids = nullptr;
+    }
+
+    bool isAttached() const { return m_header != nullptr; }
+
+    RingSegmentInfo* getHeader() const { return m_header; }
+    uint32_t getHeaderVersion() const { return m_header != nullptr ? m_header->version : 0; }
+    uint32_t getSlotCount() const { return m_header != nullptr ? m_header->slotCount : 0; }
+    size_t getPayloadCapacity() const { return m_header != nullptr ? m_header->slotStride - sizeof(RingSlotHeader) : 0; }
+
+    /**
+     * Seqlock-protected parameter page between the header and the slots
+     */
+    ParameterStatePage* getStatePage() const
+    {
+        return m_header != nullptr ? reinterpret_cast<ParameterStatePage*>(reinterpret_cast<uint8_t*>(m_header) + m_header->statePageOffset) : nullptr;
+    }
+
+    /**
+     * Pointer to the first byte after the slots (start of the control ring)
+     */
+    uint8_t* getTrailingArea() const
+    {
+        return m_header != nullptr ? m_slots + static_cast<size_t>(m_header->slotCount) * m_header->slotStride : nullptr;
+    }
+
+    //==========================================================================
+    // Consumer registration
+
+    // Consumer ID held by a slot while registerConsumer arms its cursor (not a valid ID)
+    static constexpr uint32_t CONSUMER_ARMING = 0xFFFFFFFFu;
+
+    // Full-ring drops between two checks for consumers that died while registered
+    static constexpr uint64_t LIVENESS_CHECK_DROPS = 64;
+
+    /**
+     * Register a consumer; an already registered ID is re-armed at the current head
+     * Slots held by other consumers are never touched: a free slot is claimed as
+     * CONSUMER_ARMING, its cursor set, and only then published under the real ID.
+     * If every slot is taken, consumers whose process has exited are evicted first.
+     * @param ownerPid Process the registration belongs to (0 = never evict it)
+     * @return Consumer index, or -1 if all consumer slots are taken
+     */
+    int registerConsumer(uint32_t consumerId, uint32_t ownerPid = getCurrentProcessId())
+    {
+        if (m_header == nullptr || consumerId == 0 || consumerId == CONSUMER_ARMING)
+            return -1;
+
+        int index = findConsumer(consumerId);
+        if (index >= 0)
+        {
+            setOwner(index, ownerPid);
+            cursorFor(index).store(m_head->load(std::memory_order_acquire), std::memory_order_release);
+            return index;
+        }
+
+        index = claimConsumerSlot(consumerId, ownerPid);
+        if (index < 0 && evictDeadConsumers() > 0)
+            index = claimConsumerSlot(consumerId, ownerPid);
+        return index;
+    }
+
+    bool unregisterConsumer(uint32_t consumerId)
+    {
+        int index = findConsumer(consumerId);
+        if (index < 0)
+            return false;
+
+        setOwner(index, 0);
+        m_consumerIds[index].store(0, std::memory_order_release);
+        advanceTail();
+        return true;
+    }
+
+    /**
+     * Free the slots of registered consumers whose process has exited, so their cursors
+     * stop holding the tail. Slots without an owner (version 2 headers, older consumers)
+     * are left alone. Makes one process check per owned slot.
+     * @return Number of consumers evicted
+     */
+    uint32_t evictDeadConsumers()
+    {
+        if (m_header == nullptr || m_ownerPids == nullptr)
+            return 0;
+
+        uint32_t evicted = 0;
+        for (uint32_t i = 0; i < RingSegmentHeader::MAX_CONSUMERS; ++i)
+        {
+            uint32_t id = m_consumerIds[i].load(std::memory_order_acquire);
+            uint32_t pid = ownerPidFor(static_cast<int>(i)).load(std::memory_order_acquire);
+            if (id == 0 || id == CONSUMER_ARMING || pid == 0 || !isProcessGone(pid))
+                continue;
+
+            // Only if the slot still holds that registration; a new owner's pid is kept
+            if (m_consumerIds[i].compare_exchange_strong(id, 0, std::memory_order_acq_rel))
+            {
+                ownerPidFor(static_cast<int>(i)).compare_exchange_strong(pid, 0, std::memory_order_acq_rel);
+                ++evicted;
+            }
+        }
+
+        if (evicted > 0)
+            advanceTail();
+        return evicted;
+    }
+
+    /**
+     * Process that registered a consumer slot (0 = unknown or free)
+     */
+    uint32_t getConsumerOwner(int consumerIndex) const
+    {
+        if (m_ownerPids == nullptr || consumerIndex < 0 || consumerIndex >= static_cast<int>(RingSegmentHeader::MAX_CONSUMERS))
+            return 0;
+        return ownerPidFor(consumerIndex).load(std::memory_order_acquire);
+    }
+
+    static uint32_t getCurrentProcessId()
+    {
+#if defined(_WIN32)
+        return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+        return static_cast<uint32_t>(getpid());
+#endif
+    }
+
+    /**
+     * True only if the process has certainly exited (a process we may not signal is alive)
+     */
+    static bool isProcessGone(uint32_t processId)
+    {
+#if defined(_WIN32)
+        HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(processId));
+        if (process == nullptr)
+            return GetLastError() == ERROR_INVALID_PARAMETER;
+
+        const bool exited = WaitForSingleObject(process, 0) == WAIT_OBJECT_0;
+        CloseHandle(process);
+        return exited;
+#else
+        return kill(static_cast<pid_t>(processId), 0) != 0 && errno == ESRCH;
+#endif
+    }
+
+    int findConsumer(uint32_t consumerId) const
+    {
+        if (m_header == nullptr || consumerId == 0)
+            return -1;
+
+        for (uint32_t i = 0; i < RingSegmentHeader::MAX_CONSUMERS; ++i)
+        {
+            if (m_consumerIds[i].load(std::memory_order_acquire) == consumerId)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    /**
+     * ID registered in a consumer slot (0 = free)
+     */
+    uint32_t getConsumerId(int consumerIndex) const
+    {
+        if (m_header == nullptr || consumerIndex < 0 || consumerIndex >= static_cast<int>(RingSegmentHeader::MAX_CONSUMERS))
+            return 0;
+        return m_consumerIds[consumerIndex].load(std::memory_order_acquire);
+    }
+
+    uint32_t getConsumerCount() const
+    {
+        uint32_t count = 0;
+        if (m_header != nullptr)
+        {
+            for (uint32_t i = 0; i < RingSegmentHeader::MAX_CONSUMERS; ++i)
+                count += m_consumerIds[i].load(std::memory_order_relaxed) != 0 ? 1 : 0;
+        }
+        return count;
+    }
+
+    //==========================================================================
+    // Producer (single writer)
+
+    /**
+     * Reserve the next slot for writing
+     * @param sequence Output sequence number of the reserved slot
+     * @return Pointer to payloadCapacity bytes, or nullptr if the ring is full (block dropped)
+     */
+    uint8_t* beginWrite(uint64_t& sequence)
+    {
+        if (m_header == nullptr)
+            return nullptr;
+
+        const uint64_t seq = m_head->load(std::memory_order_relaxed);
+        if (seq - m_tail->load(std::memory_order_acquire) >= m_header->slotCount)
+        {
+            advanceTail();
+
+            // A consumer that died while registered would hold the tail for good; checking
+            // costs a syscall per consumer, so only on the first drop and then now and again
+            if (seq - m_tail->load(std::memory_order_acquire) >= m_header->slotCount
+                && m_droppedBlocks->load(std::memory_order_relaxed) % LIVENESS_CHECK_DROPS == 0)
+                evictDeadConsumers();
+
+            if (seq - m_tail->load(std::memory_order_acquire) >= m_header->slotCount)
+            {
+                m_droppedBlocks->fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+
+        RingSlotHeader* slot = slotFor(seq);
+        slot->sequence.store(RingSlotHeader::BUSY, std::memory_order_relaxed);
+        slot->ackMask.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        sequence = seq;
+        return reinterpret_cast<uint8_t*>(slot + 1);
+    }
+
+    /**
+     * Publish a slot previously reserved with beginWrite
+     */
+    void commitWrite(uint64_t sequence, uint32_t payloadSize)
+    {
+        RingSlotHeader* slot = slotFor(sequence);
+        slot->payloadSize = payloadSize;
+        slot->sequence.store(sequence + 1, std::memory_order_release);
+        m_head->store(sequence + 1, std::memory_order_release);
+
+        // Pairs with the waiter count increment in waitForPublish (both seq_cst)
+        m_doorbell->fetch_add(1, std::memory_order_seq_cst);
+        if (m_doorbellWaiters->load(std::memory_order_seq_cst) != 0)
+            M1MemoryShareDoorbell::wakeAll(*m_doorbell);
+    }
+
+    //==========================================================================
+    // Consumers
+
+    /**
+     * Get the next unread block for a registered consumer without consuming it.
+     * The slot stays reserved until release() is called.
+     * @param lostBlocks Output number of blocks skipped because they were overwritten
+     * @return Pointer to the payload, or nullptr if nothing is pending
+     */
+    const uint8_t* acquireNext(int consumerIndex, uint64_t& sequence, uint32_t& payloadSize, uint64_t& lostBlocks)
+    {
+        lostBlocks = 0;
+        if (m_header == nullptr || consumerIndex < 0 || consumerIndex >= static_cast<int>(RingSegmentHeader::MAX_CONSUMERS))
+            return nullptr;
+
+        auto& cursor = cursorFor(consumerIndex);
+        uint64_t next = cursor.load(std::memory_order_relaxed);
+        const uint64_t head = m_head->load(std::memory_order_acquire);
+
+        // Only possible if the producer wrote before it saw our registration
+        if (head > next + m_header->slotCount)
+        {
+            lostBlocks = head - m_header->slotCount - next;
+            next = head - m_header->slotCount;
+            cursor.store(next, std::memory_order_release);
+        }
+
+        const RingSlotHeader* slot = nullptr;
+        for (; next < head; ++next)
+        {
+            slot = slotFor(next);
+            if (slot->sequence.load(std::memory_order_acquire) == next + 1)
+                break;
+
+            // Published but already rewritten for a later sequence
+            ++lostBlocks;
+            cursor.store(next + 1, std::memory_order_release);
+        }
+
+        if (next >= head)
+            return nullptr;
+
+        sequence = next;
+        payloadSize = slot->payloadSize;
+        if (payloadSize > getPayloadCapacity())
+            payloadSize = static_cast<uint32_t>(getPayloadCapacity());
+
+        return reinterpret_cast<const uint8_t*>(slot + 1);
+    }
+
+    /**
+     * Release a block obtained from acquireNext and advance the consumer's cursor
+     * @return false if the slot was overwritten while it was being read
+     */
+    bool release(int consumerIndex, uint64_t sequence)
+    {
+        if (m_header == nullptr || consumerIndex < 0 || consumerIndex >= static_cast<int>(RingSegmentHeader::MAX_CONSUMERS))
+            return false;
+
+        const bool intact = isStillValid(sequence);
+        slotFor(sequence)->ackMask.fetch_or(1u << consumerIndex, std::memory_order_acq_rel);
+        advanceCursor(consumerIndex, sequence + 1);
+        return intact;
+    }
+
+    /**
+     * Acknowledge any unread block, in or out of order
+     *
+     * Sets the consumer's bit in the slot. If the block is the one at the consumer's cursor,
+     * the cursor moves past it and past every following block already acknowledged.
+     *
+     * @return false if the sequence was never published or has been overwritten
+     */
+    bool acknowledge(int consumerIndex, uint64_t sequence)
+    {
+        if (m_header == nullptr || consumerIndex < 0 || consumerIndex >= static_cast<int>(RingSegmentHeader::MAX_CONSUMERS))
+            return false;
+
+        const uint64_t cursor = cursorFor(consumerIndex).load(std::memory_order_acquire);
+        if (sequence < cursor)
+            return true;    // Already consumed
+
+        if (sequence >= m_head->load(std::memory_order_acquire))
+            return false;
+
+        // The slot can't be reused while our cursor is at or below it, so the check stays valid
+        RingSlotHeader* slot = slotFor(sequence);
+        if (slot->sequence.load(std::memory_order_acquire) != sequence + 1)
+            return false;
+
+        slot->ackMask.fetch_or(1u << consumerIndex, std::memory_order_acq_rel);
+        if (sequence == cursor)
+            advanceCursor(consumerIndex, sequence + 1);
+        return true;
+    }
+
+    /**
+     * Check whether a consumer has acknowledged a block (released it or acknowledged it out of order)
+     */
+    bool isAcknowledged(int consumerIndex, uint64_t sequence) const
+    {
+        if (m_header == nullptr || consumerIndex < 0 || consumerIndex >= static_cast<int>(RingSegmentHeader::MAX_CONSUMERS))
+            return false;
+
+        if (sequence < cursorFor(consumerIndex).load(std::memory_order_acquire))
+            return true;
+
+        const RingSlotHeader* slot = slotFor(sequence);
+        return slot->sequence.load(std::memory_order_acquire) == sequence + 1
+            && (slot->ackMask.load(std::memory_order_acquire) & (1u << consumerIndex)) != 0;
+    }
+
+    /**
+     * Get the most recently published block without reserving it
+     * @return Pointer to the payload, or nullptr if nothing was published yet
+     */
+    const uint8_t* peekLatest(uint64_t& sequence, uint32_t& payloadSize) const
+    {
+        if (m_header == nullptr)
+            return nullptr;
+
+        const uint64_t head = m_head->load(std::memory_order_acquire);
+        if (head == 0)
+            return nullptr;
+
+        const uint64_t latest = head - 1;
+        const RingSlotHeader* slot = slotFor(latest);
+        if (slot->sequence.load(std::memory_order_acquire) != latest + 1)
+            return nullptr;
+
+        sequence = latest;
+        payloadSize = slot->payloadSize;
+        if (payloadSize > getPayloadCapacity())
+            payloadSize = static_cast<uint32_t>(getPayloadCapacity());
+
+        return reinterpret_cast<const uint8_t*>(slot + 1);
+    }
+
+    /**
+     * Get a specific published block without reserving it
+     * @return Pointer to the payload, or nullptr if the slot no longer (or not yet) holds sequence
+     */
+    const uint8_t* peekSequence(uint64_t sequence, uint32_t& payloadSize) const
+    {
+        if (m_header == nullptr)
+            return nullptr;
+
+        const RingSlotHeader* slot = slotFor(sequence);
+        if (slot->sequence.load(std::memory_order_acquire) != sequence + 1)
+            return nullptr;
+
+        payloadSize = slot->payloadSize;
+        if (payloadSize > getPayloadCapacity())
+            payloadSize = static_cast<uint32_t>(getPayloadCapacity());
+
+        return reinterpret_cast<const uint8_t*>(slot + 1);
+    }
+
+    /**
+     * Check that a slot still holds the given sequence after its payload was read
+     */
+    bool isStillValid(uint64_t sequence) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slotFor(sequence)->sequence.load(std::memory_order_relaxed) == sequence + 1;
+    }
+
+    /**
+     * Block until there is something to read or the timeout expires
+     * @param consumerIndex Registered consumer to wait for, or -1 to wait for the next publish
+     * @return true if data is available (registered) or a block was published (-1)
+     */
+    bool waitForPublish(int consumerIndex, int timeoutMs)
+    {
+        if (m_header == nullptr)
+            return false;
+
+        const uint32_t bell = m_doorbell->load(std::memory_order_acquire);
+        if (consumerIndex >= 0 && getPendingCount(consumerIndex) > 0)
+            return true;
+
+        m_doorbellWaiters->fetch_add(1, std::memory_order_seq_cst);
+        if (consumerIndex < 0 || getPendingCount(consumerIndex) == 0)
+            M1MemoryShareDoorbell::wait(*m_doorbell, bell, timeoutMs);
+        m_doorbellWaiters->fetch_sub(1, std::memory_order_seq_cst);
+
+        if (consumerIndex >= 0)
+            return getPendingCount(consumerIndex) > 0;
+        return m_doorbell->load(std::memory_order_acquire) != bell;
+    }
+
+    /**
+     * Number of published blocks a consumer has not released yet
+     */
+    uint64_t getPendingCount(int consumerIndex) const
+    {
+        if (m_header == nullptr || consumerIndex < 0 || consumerIndex >= static_cast<int>(RingSegmentHeader::MAX_CONSUMERS))
+            return 0;
+
+        const uint64_t head = m_head->load(std::memory_order_acquire);
+        const uint64_t next = cursorFor(consumerIndex).load(std::memory_order_acquire);
+        return head > next ? head - next : 0;
+    }
+
+    /**
+     * Number of published blocks still held for at least one consumer
+     */
+    uint64_t getRetainedCount() const
+    {
+        if (m_header == nullptr)
+            return 0;
+
+        const uint64_t head = m_head->load(std::memory_order_acquire);
+        return head - std::min(head, getSlowestCursor(head));
+    }
+
+    /**
+     * Move the tail up to the slowest registered consumer (or to head if there are none)
+     */
+    void advanceTail()
+    {
+        if (m_header == nullptr)
+            return;
+
+        const uint64_t minCursor = getSlowestCursor(m_head->load(std::memory_order_acquire));
+        uint64_t current = m_tail->load(std::memory_order_relaxed);
+        while (minCursor > current && !m_tail->compare_exchange_weak(current, minCursor, std::memory_order_acq_rel))
+        {
+            // CAS loop
+        }
+    }
+
+    /**
+     * First sequence still held for a registered consumer (everything in [tail, head) is readable)
+     */
+    uint64_t getTail() const
+    {
+        return m_header != nullptr ? m_tail->load(std::memory_order_acquire) : 0;
+    }
+
+    uint64_t getHead() const
+    {
+        return m_header != nullptr ? m_head->load(std::memory_order_acquire) : 0;
+    }
+
+    /**
+     * Blocks the producer discarded because the ring was full
+     */
+    uint64_t getDroppedBlocks() const
+    {
+        return m_header != nullptr ? m_droppedBlocks->load(std::memory_order_relaxed) : 0;
+    }
+
+    /**
+     * Indices of the control ring after the slots: consumers advance the write index, the producer the read index
+     * (valid while attached)
+     */
+    std::atomic<uint32_t>& getControlWriteIndex() const { return *m_controlWriteIndex; }
+    std::atomic<uint32_t>& getControlReadIndex() const { return *m_controlReadIndex; }
+
+    /**
+     * Next sequence a consumer will read (everything before it is acknowledged)
+     */
+    uint64_t getCursor(int consumerIndex) const
+    {
+        if (m_header == nullptr || consumerIndex < 0 || consumerIndex >= static_cast<int>(RingSegmentHeader::MAX_CONSUMERS))
+            return 0;
+        return cursorFor(consumerIndex).load(std::memory_order_acquire);
+    }
+
+private:
+    int claimConsumerSlot(uint32_t consumerId, uint32_t ownerPid)
+    {
+        for (uint32_t i = 0; i < RingSegmentHeader::MAX_CONSUMERS; ++i)
+        {
+            uint32_t expected = 0;
+            if (m_consumerIds[i].load(std::memory_order_relaxed) != 0
+                || !m_consumerIds[i].compare_exchange_strong(expected, CONSUMER_ARMING, std::memory_order_acq_rel))
+                continue;
+
+            // The slot is ours; the producer ignores it until the ID is published
+            setOwner(static_cast<int>(i), ownerPid);
+            cursorFor(i).store(m_head->load(std::memory_order_acquire), std::memory_order_relaxed);
+            m_consumerIds[i].store(consumerId, std::memory_order_release);
+
+            // Re-arm at head: the tail may have passed the first cursor before the producer
+            // saw the slot, but cannot pass this one
+            cursorFor(i).store(m_head->load(std::memory_order_acquire), std::memory_order_release);
+            return static_cast<int>(i);
+        }
+
+        return -1;
+    }
+
+    void setOwner(int consumerIndex, uint32_t ownerPid)
+    {
+        if (m_ownerPids != nullptr)
+            ownerPidFor(consumerIndex).store(ownerPid, std::memory_order_release);
+    }
+
+    /**
+     * Move a consumer's cursor to next, then past any blocks it already acknowledged out of order
+     */
+    void advanceCursor(int consumerIndex, uint64_t next)
+    {
+        const uint64_t head = m_head->load(std::memory_order_acquire);
+        const uint32_t bit = 1u << consumerIndex;
+
+        while (next < head)
+        {
+            const RingSlotHeader* slot = slotFor(next);
+            if (slot->sequence.load(std::memory_order_acquire) != next + 1
+                || (slot->ackMask.load(std::memory_order_acquire) & bit) == 0)
+                break;
+            ++next;
+        }
+
+        cursorFor(consumerIndex).store(next, std::memory_order_release);
+        advanceTail();
+    }
+
+    uint64_t getSlowestCursor(uint64_t head) const
+    {
+        uint64_t minCursor = head;
+        for (uint32_t i = 0; i < RingSegmentHeader::MAX_CONSUMERS; ++i)
+        {
+            const uint32_t id = m_consumerIds[i].load(std::memory_order_acquire);
+            if (id == 0 || id == CONSUMER_ARMING)
+                continue;
+
+            const uint64_t cursor = cursorFor(i).load(std::memory_order_acquire);
+            if (cursor < minCursor)
+                minCursor = cursor;
+        }
+        return minCursor;
+    }
+
+    static constexpr size_t headerBytesFor(size_t headerSize)
+    {
+        return (headerSize + SLOT_ALIGNMENT - 1) & ~(SLOT_ALIGNMENT - 1);
+    }
+
+    // Slot area of newly created (current version) segments
+    static constexpr size_t slotsOffset()
+    {
+        return headerBytesFor(sizeof(RingSegmentHeader)) + sizeof(ParameterStatePage);
+    }
+
+    template <typename Header>
+    void bindFields(Header& header, std::atomic<uint64_t>* firstCursor, size_t cursorStride)
+    {
+        m_head = &header.head;
+        m_tail = &header.tail;
+        m_droppedBlocks = &header.droppedBlocks;
+        m_doorbell = &header.doorbell;
+        m_doorbellWaiters = &header.doorbellWaiters;
+        m_controlWriteIndex = &header.controlWriteIndex;
+        m_controlReadIndex = &header.controlReadIndex;
+        m_consumerIds = header.consumerIds;
+        m_cursors = reinterpret_cast<uint8_t*>(firstCursor);
+        m_cursorStride = cursorStride;
+    }
+
+    std::atomic<uint64_t>& cursorFor(int consumerIndex) const
+    {
+        return *reinterpret_cast<std::atomic<uint64_t>*>(m_cursors + static_cast<size_t>(consumerIndex) * m_cursorStride);
+    }
+
+    // Version 3 only (m_ownerPids != nullptr), beside the consumer's cursor
+    std::atomic<uint32_t>& ownerPidFor(int consumerIndex) const
+    {
+        return *reinterpret_cast<std::atomic<uint32_t>*>(m_ownerPids + static_cast<size_t>(consumerIndex) * m_cursorStride);
+    }
+
+    RingSlotHeader* slotFor(uint64_t sequence) const
+    {
+        return reinterpret_cast<RingSlotHeader*>(m_slots + static_cast<size_t>(sequence & m_slotMask) * m_header->slotStride);
+    }
+
+    RingSegmentInfo* m_header = nullptr;
+    uint8_t* m_slots = nullptr;
+    uint32_t m_slotMask = 0;
+
+    // Shared fields of the attached header version
+    std::atomic<uint64_t>* m_head = nullptr;
+    std::atomic<uint64_t>* m_tail = nullptr;
+    std::atomic<uint64_t>* m_droppedBlocks = nullptr;
+    std::atomic<uint32_t>* m_doorbell = nullptr;
+    std::atomic<uint32_t>* m_doorbellWaiters = nullptr;
+    std::atomic<uint32_t>* m_controlWriteIndex = nullptr;
+    std::atomic<uint32_t>* m_controlReadIndex = nullptr;
+    std::atomic<uint32_t>* m_consumerIds = nullptr;
+    uint8_t* m_cursors = nullptr;
+    size_t m_cursorStride = 0;
+    uint8_t* m_ownerPids = nullptr;         // Owner pid of each consumer slot, m_cursorStride apart
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+/**
+ * Seqlock-protected parameter page for M1MemoryShare ring segments.
+ *
+ * The panner rewrites the page in place whenever its parameters or transport change,
+ * independently of the audio ring. Readers copy the page out and retry if the sequence
+ * counter moved while they were copying, so a snapshot is always internally consistent
+ * and never requires touching the audio slots.
+ *
+ * The page body uses the same GenericParameter stream encoding as the audio blocks
+ * (GenericParameter + data, repeated parameterCount times).
+ *
+ * Plain C++ (no JUCE), shared with the panner and the standalone tools in Tests/.
+ */
+
+/**
+ * Transport and bookkeeping fields published alongside the parameters
+ */
+struct ParameterStateFields
+{
+    uint32_t parameterCount;                // Number of GenericParameter entries in data
+    uint32_t dataSize;                      // Bytes of data in use
+    uint32_t updateSource;                  // Source of update (0=HOST, 1=UI, 2=MEMORYSHARE)
+    uint32_t isPlaying;                     // Is DAW playing (1) or stopped (0)
+    uint64_t dawTimestamp;                  // DAW/host timestamp in milliseconds
+    double playheadPositionInSeconds;       // DAW playhead position
+};
+
+/**
+ * Page as laid out in the mapped segment
+ */
+struct ParameterStatePage
+{
+    static constexpr size_t SIZE = 4096;
+    static constexpr size_t DATA_CAPACITY = SIZE - 8 - sizeof(ParameterStateFields);
+
+    std::atomic<uint32_t> sequence;         // Even when stable, odd while being written, 0 if never written
+    uint32_t reserved;
+    ParameterStateFields fields;
+    uint8_t data[DATA_CAPACITY];            // GenericParameter stream
+};
+
+static_assert(sizeof(ParameterStatePage) == ParameterStatePage::SIZE, "State page must fill exactly one page");
+
+/**
+ * Consistent private copy of a ParameterStatePage
+ */
+struct ParameterStateSnapshot
+{
+    uint32_t sequence = 0;                  // Page sequence the copy was taken at
+    uint32_t tornReads = 0;                 // Copies discarded because the producer was writing
+    ParameterStateFields fields = {};
+    uint8_t data[ParameterStatePage::DATA_CAPACITY];
+};
+
+namespace M1MemoryShareStatePage
+{
+    /** Copies attempted before a read gives up on a producer that keeps rewriting the page */
+    static constexpr int MAX_READ_ATTEMPTS = 64;
+
+    /**
+     * Publish new contents (single writer)
+     * @return false if the parameter stream does not fit in the page
+     */
+    inline bool write(ParameterStatePage& page, const ParameterStateFields& fields, const uint8_t* data)
+    {
+        if (fields.dataSize > ParameterStatePage::DATA_CAPACITY)
+            return false;
+
+        const uint32_t sequence = page.sequence.load(std::memory_order_relaxed);
+
+        // Odd sequence: readers that overlap this write will see the counter move and retry
+        page.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(&page.fields, &fields, sizeof(fields));
+        std::memcpy(page.data, data, fields.dataSize);
+
+        page.sequence.store(sequence + 2, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Sequence of the last completed write, 0 if the page was never written
+     * Cheap enough to poll before deciding whether a full read is needed.
+     */
+    inline uint32_t getVersion(const ParameterStatePage& page)
+    {
+        return page.sequence.load(std::memory_order_acquire) & ~1u;
+    }
+
+    /**
+     * Copy the page out, retrying while the producer is writing
+     * @return false if the page was never written, is malformed, or stayed busy for MAX_READ_ATTEMPTS copies
+     */
+    inline bool read(const ParameterStatePage& page, ParameterStateSnapshot& snapshot)
+    {
+        snapshot.tornReads = 0;
+
+        for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt)
+        {
+            const uint32_t before = page.sequence.load(std::memory_order_acquire);
+            if (before == 0)
+                return false;
+
+            if ((before & 1u) == 0)
+            {
+                std::memcpy(&snapshot.fields, &page.fields, sizeof(snapshot.fields));
+                const size_t dataSize = snapshot.fields.dataSize <= ParameterStatePage::DATA_CAPACITY
+                                      ? snapshot.fields.dataSize : ParameterStatePage::DATA_CAPACITY;
+                std::memcpy(snapshot.data, page.data, dataSize);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (page.sequence.load(std::memory_order_relaxed) == before)
+                {
+                    snapshot.sequence = before;
+                    return snapshot.fields.dataSize <= ParameterStatePage::DATA_CAPACITY;
+                }
+            }
+
+            // Writer active or finished mid-copy; a write is a few hundred bytes, so spin briefly first
+            ++snapshot.tornReads;
+            if (attempt >= 8)
+                std::this_thread::yield();
+        }
+
+        return false;
+    }
+}
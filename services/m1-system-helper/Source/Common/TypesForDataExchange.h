@@ -1,9 +1,11 @@
 #pragma once
 
 #include <atomic>
+#include <bitset>
 #include <mutex>
 #include <string>
 #include <cstdint>
+#include <cstring>
 #include <map>
 #include <vector>
 #include <chrono>
@@ -114,6 +116,10 @@ struct BufferAcknowledgment
  */
 struct GenericAudioBufferHeader
 {
+    // Audio data layouts (audioLayout field)
+    static constexpr uint32_t AUDIO_INTERLEAVED = 0;    // s0c0 s0c1 ... s1c0 s1c1 ...
+    static constexpr uint32_t AUDIO_PLANAR = 1;         // c0s0 c0s1 ... c1s0 c1s1 ...
+
     uint32_t version;           // Version of header format (for future compatibility)
     uint32_t channels;          // Number of audio channels
     uint32_t samples;           // Number of samples per channel
@@ -137,7 +143,7 @@ struct GenericAudioBufferHeader
     int64_t startSamplePosition; // Sample position in DAW timeline (calculated from playheadPositionInSeconds * sampleRate)
     uint32_t sampleRate;         // Sample rate for this buffer (for startSamplePosition calculation)
     
-    uint32_t reserved[1];       // Reserved for future expansion
+    uint32_t audioLayout;        // AUDIO_INTERLEAVED or AUDIO_PLANAR (formerly reserved, so older panners send 0)
 
     // Parameters follow immediately after this struct
     // Each parameter is: GenericParameter + parameter data
@@ -147,86 +153,280 @@ struct GenericAudioBufferHeader
                                 headerSize(sizeof(GenericAudioBufferHeader)), updateSource(1),
                                 isUpdatingFromExternal(0), bufferId(0), sequenceNumber(0),
                                 bufferTimestamp(0), requiresAcknowledgment(0), consumerCount(0),
-                                acknowledgedCount(0), startSamplePosition(0), sampleRate(44100)
+                                acknowledgedCount(0), startSamplePosition(0), sampleRate(44100),
+                                audioLayout(AUDIO_INTERLEAVED)
     {
-        std::memset(reserved, 0, sizeof(reserved));
     }
 };
 
 /**
  * Generic parameter map for flexible parameter passing
+ *
+ * Fixed-size and allocation free, so it can be filled on every block and copied by value.
+ * IDs from M1SystemHelperParameterIDs have a fixed slot each; any other ID goes into a
+ * small open-addressed overflow area. Each ID holds one value of one type (adding it again
+ * with another type replaces it). A dirty bitmask tracks which slots changed value since
+ * the last clearDirty().
  */
 struct ParameterMap
 {
-    std::map<uint32_t, float> floatParams;
-    std::map<uint32_t, int32_t> intParams;
-    std::map<uint32_t, bool> boolParams;
-    std::map<uint32_t, std::string> stringParams;
-    std::map<uint32_t, double> doubleParams;
-    std::map<uint32_t, uint32_t> uint32Params;
-    std::map<uint32_t, uint64_t> uint64Params;
-
-    // Convenience methods for adding parameters
-    void addFloat(uint32_t id, float value) { floatParams[id] = value; }
-    void addInt(uint32_t id, int32_t value) { intParams[id] = value; }
-    void addBool(uint32_t id, bool value) { boolParams[id] = value; }
-    void addString(uint32_t id, const std::string& value) { stringParams[id] = value; }
-    void addDouble(uint32_t id, double value) { doubleParams[id] = value; }
-    void addUInt32(uint32_t id, uint32_t value) { uint32Params[id] = value; }
-    void addUInt64(uint32_t id, uint64_t value) { uint64Params[id] = value; }
+    static constexpr uint32_t KNOWN_SLOTS = 24;
+    static constexpr uint32_t CAPACITY = 64;                // KNOWN_SLOTS + overflow, one dirty bit each
+    static constexpr uint32_t MAX_STRINGS = 4;
+    static constexpr uint32_t MAX_STRING_LENGTH = 63;       // Longer strings are truncated
+
+    struct Slot
+    {
+        uint32_t id = 0;
+        ParameterType type = ParameterType::FLOAT;
+        uint32_t stringIndex = 0;                           // Index into strings[] for STRING slots
+        union
+        {
+            float f;
+            int32_t i;
+            bool b;
+            double d;
+            uint32_t u32;
+            uint64_t u64;
+        } value = {};
+    };
+
+    struct StringValue
+    {
+        uint32_t length = 0;
+        char data[MAX_STRING_LENGTH + 1] = {};
+    };
+
+    Slot slots[CAPACITY];
+    StringValue strings[MAX_STRINGS];
+    uint32_t stringCount = 0;
+    uint64_t presentMask = 0;
+    uint64_t dirtyMask = 0;
+
+    // Convenience methods for adding parameters (false if the table or string pool is full)
+    bool addFloat(uint32_t id, float value) { return store(id, ParameterType::FLOAT, [&](Slot& s) { return exchange(s.value.f, value); }); }
+    bool addInt(uint32_t id, int32_t value) { return store(id, ParameterType::INT, [&](Slot& s) { return exchange(s.value.i, value); }); }
+    bool addBool(uint32_t id, bool value) { return store(id, ParameterType::BOOL, [&](Slot& s) { return exchange(s.value.b, value); }); }
+    bool addDouble(uint32_t id, double value) { return store(id, ParameterType::DOUBLE, [&](Slot& s) { return exchange(s.value.d, value); }); }
+    bool addUInt32(uint32_t id, uint32_t value) { return store(id, ParameterType::UINT32, [&](Slot& s) { return exchange(s.value.u32, value); }); }
+    bool addUInt64(uint32_t id, uint64_t value) { return store(id, ParameterType::UINT64, [&](Slot& s) { return exchange(s.value.u64, value); }); }
+    bool addString(uint32_t id, const std::string& value) { return addString(id, value.data(), value.size()); }
+
+    bool addString(uint32_t id, const char* value, size_t length)
+    {
+        int index = findOrInsert(id);
+        if (index < 0)
+            return false;
+
+        Slot& slot = slots[index];
+        bool sameSlot = holds(index, id, ParameterType::STRING);
+        uint32_t stringIndex = slot.stringIndex;
+        if (!sameSlot || (presentMask & bit(index)) == 0)
+        {
+            if (stringCount >= MAX_STRINGS)
+                return false;
+            stringIndex = stringCount++;
+        }
+
+        StringValue& str = strings[stringIndex];
+        uint32_t clamped = static_cast<uint32_t>(length < MAX_STRING_LENGTH ? length : MAX_STRING_LENGTH);
+        bool changed = !sameSlot || stringIndex != slot.stringIndex
+                    || str.length != clamped || std::memcmp(str.data, value, clamped) != 0;
+        std::memcpy(str.data, value, clamped);
+        str.data[clamped] = '\0';
+        str.length = clamped;
+        slot.stringIndex = stringIndex;
+
+        markStored(index, id, ParameterType::STRING, changed);
+        return true;
+    }
 
     // Convenience methods for getting parameters
     float getFloat(uint32_t id, float defaultValue = 0.0f) const
     {
-        auto it = floatParams.find(id);
-        return it != floatParams.end() ? it->second : defaultValue;
+        const Slot* slot = find(id, ParameterType::FLOAT);
+        return slot != nullptr ? slot->value.f : defaultValue;
     }
 
     int32_t getInt(uint32_t id, int32_t defaultValue = 0) const
     {
-        auto it = intParams.find(id);
-        return it != intParams.end() ? it->second : defaultValue;
+        const Slot* slot = find(id, ParameterType::INT);
+        return slot != nullptr ? slot->value.i : defaultValue;
     }
 
     bool getBool(uint32_t id, bool defaultValue = false) const
     {
-        auto it = boolParams.find(id);
-        return it != boolParams.end() ? it->second : defaultValue;
+        const Slot* slot = find(id, ParameterType::BOOL);
+        return slot != nullptr ? slot->value.b : defaultValue;
     }
 
     std::string getString(uint32_t id, const std::string& defaultValue = "") const
     {
-        auto it = stringParams.find(id);
-        return it != stringParams.end() ? it->second : defaultValue;
+        const Slot* slot = find(id, ParameterType::STRING);
+        return slot != nullptr ? std::string(strings[slot->stringIndex].data, strings[slot->stringIndex].length) : defaultValue;
     }
 
     double getDouble(uint32_t id, double defaultValue = 0.0) const
     {
-        auto it = doubleParams.find(id);
-        return it != doubleParams.end() ? it->second : defaultValue;
+        const Slot* slot = find(id, ParameterType::DOUBLE);
+        return slot != nullptr ? slot->value.d : defaultValue;
     }
 
     uint32_t getUInt32(uint32_t id, uint32_t defaultValue = 0) const
     {
-        auto it = uint32Params.find(id);
-        return it != uint32Params.end() ? it->second : defaultValue;
+        const Slot* slot = find(id, ParameterType::UINT32);
+        return slot != nullptr ? slot->value.u32 : defaultValue;
     }
 
     uint64_t getUInt64(uint32_t id, uint64_t defaultValue = 0) const
     {
-        auto it = uint64Params.find(id);
-        return it != uint64Params.end() ? it->second : defaultValue;
+        const Slot* slot = find(id, ParameterType::UINT64);
+        return slot != nullptr ? slot->value.u64 : defaultValue;
+    }
+
+    /**
+     * Check whether a parameter is present with the given type
+     */
+    bool contains(uint32_t id, ParameterType type) const { return find(id, type) != nullptr; }
+
+    uint32_t size() const { return static_cast<uint32_t>(std::bitset<CAPACITY>(presentMask).count()); }
+    bool empty() const { return presentMask == 0; }
+
+    // Change tracking
+    bool isDirty(uint32_t id) const
+    {
+        int index = indexOf(id);
+        return index >= 0 && (dirtyMask & bit(index)) != 0;
     }
+    bool hasChanges() const { return dirtyMask != 0; }
+    void clearDirty() { dirtyMask = 0; }
 
+    /**
+     * Remove all parameters. Values are kept in their slots so that refilling the map
+     * with the same values does not mark them dirty.
+     */
     void clear()
     {
-        floatParams.clear();
-        intParams.clear();
-        boolParams.clear();
-        stringParams.clear();
-        doubleParams.clear();
-        uint32Params.clear();
-        uint64Params.clear();
+        presentMask = 0;
+        stringCount = 0;
+    }
+
+    /**
+     * Fixed slot for IDs from M1SystemHelperParameterIDs, -1 for anything else
+     */
+    static constexpr int knownSlot(uint32_t id)
+    {
+        switch (id)
+        {
+            case M1SystemHelperParameterIDs::AZIMUTH: return 0;
+            case M1SystemHelperParameterIDs::ELEVATION: return 1;
+            case M1SystemHelperParameterIDs::DIVERGE: return 2;
+            case M1SystemHelperParameterIDs::GAIN: return 3;
+            case M1SystemHelperParameterIDs::STEREO_ORBIT_AZIMUTH: return 4;
+            case M1SystemHelperParameterIDs::STEREO_SPREAD: return 5;
+            case M1SystemHelperParameterIDs::STEREO_INPUT_BALANCE: return 6;
+            case M1SystemHelperParameterIDs::AUTO_ORBIT: return 7;
+            case M1SystemHelperParameterIDs::ISOTROPIC_MODE: return 8;
+            case M1SystemHelperParameterIDs::EQUALPOWER_MODE: return 9;
+            case M1SystemHelperParameterIDs::GAIN_COMPENSATION_MODE: return 10;
+            case M1SystemHelperParameterIDs::LOCK_OUTPUT_LAYOUT: return 11;
+            case M1SystemHelperParameterIDs::INPUT_MODE: return 12;
+            case M1SystemHelperParameterIDs::OUTPUT_MODE: return 13;
+            case M1SystemHelperParameterIDs::PORT: return 14;
+            case M1SystemHelperParameterIDs::STATE: return 15;
+            case M1SystemHelperParameterIDs::COLOR_R: return 16;
+            case M1SystemHelperParameterIDs::COLOR_G: return 17;
+            case M1SystemHelperParameterIDs::COLOR_B: return 18;
+            case M1SystemHelperParameterIDs::COLOR_A: return 19;
+            case M1SystemHelperParameterIDs::DISPLAY_NAME: return 20;
+            case M1SystemHelperParameterIDs::BUFFER_ID: return 21;
+            case M1SystemHelperParameterIDs::BUFFER_SEQUENCE: return 22;
+            case M1SystemHelperParameterIDs::BUFFER_TIMESTAMP: return 23;
+            default: return -1;
+        }
+    }
+
+private:
+    static constexpr uint32_t OVERFLOW_SLOTS = CAPACITY - KNOWN_SLOTS;
+
+    static constexpr uint64_t bit(int index) { return 1ull << index; }
+
+    template <typename T>
+    static bool exchange(T& stored, T value)
+    {
+        bool changed = std::memcmp(&stored, &value, sizeof(T)) != 0;
+        stored = value;
+        return changed;
+    }
+
+    // Slot currently holding id, or -1
+    int indexOf(uint32_t id) const
+    {
+        int known = knownSlot(id);
+        if (known >= 0)
+            return (presentMask & bit(known)) != 0 ? known : -1;
+
+        uint32_t probe = (id * 2654435761u) % OVERFLOW_SLOTS;
+        for (uint32_t n = 0; n < OVERFLOW_SLOTS; ++n)
+        {
+            int index = static_cast<int>(KNOWN_SLOTS + (probe + n) % OVERFLOW_SLOTS);
+            if ((presentMask & bit(index)) == 0)
+                return -1;   // Slots are only freed all at once by clear(), so a gap ends the probe
+            if (slots[index].id == id)
+                return index;
+        }
+        return -1;
+    }
+
+    // Slot for id, claiming a free one if needed; -1 if the overflow area is full
+    int findOrInsert(uint32_t id)
+    {
+        int known = knownSlot(id);
+        if (known >= 0)
+            return known;
+
+        uint32_t probe = (id * 2654435761u) % OVERFLOW_SLOTS;
+        for (uint32_t n = 0; n < OVERFLOW_SLOTS; ++n)
+        {
+            int index = static_cast<int>(KNOWN_SLOTS + (probe + n) % OVERFLOW_SLOTS);
+            if ((presentMask & bit(index)) == 0 || slots[index].id == id)
+                return index;
+        }
+        return -1;
+    }
+
+    const Slot* find(uint32_t id, ParameterType type) const
+    {
+        int index = indexOf(id);
+        return index >= 0 && slots[index].type == type ? &slots[index] : nullptr;
+    }
+
+    template <typename Assign>
+    bool store(uint32_t id, ParameterType type, Assign&& assign)
+    {
+        int index = findOrInsert(id);
+        if (index < 0)
+            return false;
+
+        // Compare against whatever the slot last held, even across clear()
+        bool sameSlot = holds(index, id, type);
+        bool changed = assign(slots[index]) || !sameSlot;
+        markStored(index, id, type, changed);
+        return true;
+    }
+
+    bool holds(int index, uint32_t id, ParameterType type) const
+    {
+        return slots[index].id == id && slots[index].type == type;
+    }
+
+    void markStored(int index, uint32_t id, ParameterType type, bool changed)
+    {
+        slots[index].id = id;
+        slots[index].type = type;
+        presentMask |= bit(index);
+        if (changed)
+            dirtyMask |= bit(index);
     }
 };
 
@@ -0,0 +1,63 @@
+/*
+    AllocationCounter.cpp
+    ---------------------
+    Replacement global operator new / delete that count allocations per thread
+    (instrumented builds only, see AllocationCounter.h).
+*/
+
+#include "AllocationCounter.h"
+
+#if M1_COUNT_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local uint64_t threadAllocations = 0;
+
+void* allocate(std::size_t size)
+{
+    ++threadAllocations;
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* allocateOrThrow(std::size_t size)
+{
+    while (true)
+    {
+        if (void* pointer = allocate(size))
+            return pointer;
+
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+} // namespace
+
+namespace Mach1 {
+
+uint64_t AllocationCounter::getThreadAllocations()
+{
+    return threadAllocations;
+}
+
+} // namespace Mach1
+
+//==============================================================================
+void* operator new(std::size_t size)                                    { return allocateOrThrow(size); }
+void* operator new[](std::size_t size)                                  { return allocateOrThrow(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept    { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept  { return allocate(size); }
+
+void operator delete(void* pointer) noexcept                                    { std::free(pointer); }
+void operator delete[](void* pointer) noexcept                                  { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept                       { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept                     { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept             { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept           { std::free(pointer); }
+
+#endif // M1_COUNT_ALLOCATIONS
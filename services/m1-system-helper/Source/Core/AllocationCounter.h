@@ -0,0 +1,36 @@
+/*
+    AllocationCounter.h
+    -------------------
+    Per-thread count of heap allocations, for checking that real-time paths (the capture
+    workers) stay allocation-free once warmed up.
+
+    Only in instrumented builds (CMake option M1_COUNT_ALLOCATIONS): AllocationCounter.cpp
+    then replaces the global operator new / delete of the program with malloc / free plus
+    a thread-local counter; nothing else changes. Over-aligned allocations keep the
+    standard library's implementation and are not counted. Other builds keep the standard
+    allocator and count nothing.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#ifndef M1_COUNT_ALLOCATIONS
+    #define M1_COUNT_ALLOCATIONS 0
+#endif
+
+namespace Mach1 {
+
+namespace AllocationCounter
+{
+    /**
+     * Heap allocations made by the calling thread so far (always 0 unless M1_COUNT_ALLOCATIONS)
+     */
+#if M1_COUNT_ALLOCATIONS
+    uint64_t getThreadAllocations();
+#else
+    inline uint64_t getThreadAllocations() { return 0; }
+#endif
+}
+
+} // namespace Mach1
@@ -5,12 +5,130 @@
 */
 
 #include "CaptureEngine.h"
+#include "AllocationCounter.h"
+#include "CoverageRebuilder.h"
+#include "Crc32c.h"
 #include <cstring>
 #include <random>
 #include <map>
+#include <set>
 
 namespace Mach1 {
 
+//==============================================================================
+/**
+ * Capture thread for one panner.
+ *
+ * Owns its own mapping of the panner's segment, so it never touches the tracker's panner
+ * list, and sleeps on that segment's doorbell until the panner publishes. Each wake-up
+ * drains everything pending. Panners without a doorbell (legacy segments, or platforms
+ * without futex/WaitOnAddress) are polled at POLL_INTERVAL_MS instead.
+ */
+class CaptureEngine::PannerWorker : public juce::Thread
+{
+public:
+    PannerWorker(CaptureEngine& engine, const PannerInfo& panner, std::unique_ptr<M1MemoryShare> share)
+        : juce::Thread("CaptureWorker " + juce::String(panner.name))
+        , m_engine(engine)
+        , m_pannerId(engine.createPannerId(panner))
+        , m_coverageHandle(engine.m_coverageModel.internPanner(m_pannerId))
+        , m_name(panner.name)
+        , m_processId(panner.processId)
+        , m_share(std::move(share))
+    {
+        // Ring segments keep every block for a registered consumer, so drain all pending blocks.
+        // Legacy segments only expose the latest block and are read once per pass.
+        m_drainRing = m_share->getLayoutVersion() == M1MemoryShare::LAYOUT_RING
+                   && m_share->registerConsumer(CAPTURE_CONSUMER_ID);
+        m_consumerId = m_drainRing ? CAPTURE_CONSUMER_ID : LEGACY_CONSUMER_ID;
+        setPannerInfo(panner);
+    }
+    
+    ~PannerWorker() override
+    {
+        stopThread(IDLE_WAIT_MS * 4);
+        
+        // Release our ring cursor so the panner stops retaining blocks for us
+        if (m_drainRing)
+            m_share->unregisterConsumer(CAPTURE_CONSUMER_ID);
+    }
+    
+    /**
+     * Latest tracked panner parameters (called by the engine thread): the state of blocks
+     * that do not carry a parameter themselves
+     */
+    void setPannerInfo(const PannerInfo& panner)
+    {
+        StateSnapshot snapshot = m_engine.createStateSnapshot(panner);
+        const juce::ScopedLock lock(m_infoMutex);
+        m_snapshot = snapshot;
+        m_sampleRate = panner.sampleRate > 0 ? panner.sampleRate : 44100;
+    }
+    
+    void getPannerInfo(StateSnapshot& snapshot, uint32_t& sampleRate) const
+    {
+        const juce::ScopedLock lock(m_infoMutex);
+        snapshot = m_snapshot;
+        sampleRate = m_sampleRate;
+    }
+    
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            // A full batch means more is pending: go again without waiting
+            const uint64_t allocationsBefore = AllocationCounter::getThreadAllocations();
+            const bool morePending = m_engine.drainPanner(*this);
+            const uint64_t allocations = AllocationCounter::getThreadAllocations() - allocationsBefore;
+            if (allocations > 0)
+            {
+                m_allocations.fetch_add(allocations);
+                m_engine.m_captureAllocations.fetch_add(allocations);
+            }
+            if (morePending)
+                continue;
+            
+            if (!m_share->waitForData(m_consumerId, IDLE_WAIT_MS) && !m_share->canWaitForData())
+                wait(POLL_INTERVAL_MS);
+        }
+    }
+    
+    PannerCaptureStats getStats() const
+    {
+        PannerCaptureStats stats;
+        stats.name = m_name;
+        stats.processId = m_processId;
+        stats.pendingBlocks = m_pendingBlocks.load();
+        stats.maxPendingBlocks = m_maxPendingBlocks.load();
+        stats.blocksCaptured = m_blocksCaptured.load();
+        stats.allocations = m_allocations.load();
+        stats.eventDriven = m_share->canWaitForData();
+        return stats;
+    }
+    
+    CaptureEngine& m_engine;
+    const PannerId m_pannerId;
+    const CoverageModel::PannerHandle m_coverageHandle;
+    const juce::String m_name;
+    const uint32_t m_processId;
+    std::unique_ptr<M1MemoryShare> m_share;
+    bool m_drainRing = false;
+    uint32_t m_consumerId = LEGACY_CONSUMER_ID;
+    PannerCaptureState* m_state = nullptr;       // Resolved on the first block
+    ParameterMap m_blockParameters;              // Parameters of the block being captured
+    
+    // Backlog statistics (written by the worker, read by getPannerStats)
+    std::atomic<uint64_t> m_pendingBlocks{0};
+    std::atomic<uint64_t> m_maxPendingBlocks{0};
+    std::atomic<uint64_t> m_blocksCaptured{0};
+    std::atomic<uint64_t> m_allocations{0};
+    
+private:
+    mutable juce::CriticalSection m_infoMutex;
+    StateSnapshot m_snapshot;
+    uint32_t m_sampleRate = 44100;
+};
+
 //==============================================================================
 CaptureEngine::CaptureEngine(PannerTrackingManager& pannerManager)
     : juce::Thread("CaptureEngine")
@@ -69,9 +187,22 @@ bool CaptureEngine::startCapture(const juce::String& sessionId, const juce::File
     m_totalChunksWritten.store(0);
     m_totalBytesWritten.store(0);
     m_totalDropoutsDetected.store(0);
-    
-    // Reset coverage model
+    m_stateChangesWritten.store(0);
+    m_captureAllocations.store(0);
+    m_segmentsSealed.store(0);
+    m_audioBytesCaptured.store(0);
+    m_audioBytesStored.store(0);
+    
+    // Reset coverage model, then bring back what earlier captures of this session covered:
+    // from its coverage file, or rebuilt from the chunk indexes if there is none
     m_coverageModel.reset();
+    const juce::File coverageFile = CoverageStore::getCoverageFile(sessionDir);
+    if (!CoverageStore::load(coverageFile, m_coverageModel))
+        CoverageRebuilder().rebuild(sessionDir, m_coverageModel);
+    m_coverageStore.open(coverageFile, m_coverageModel);
+    
+    // Start the disk writer before anything can be captured
+    m_chunkWriter.start();
     
     // Start background thread
     startThread(juce::Thread::Priority::normal);
@@ -88,11 +219,15 @@ void CaptureEngine::stopCapture()
     
     m_capturing.store(false);
     
-    // Stop thread
+    // Stop the engine thread, then the workers (which release their ring cursors)
     stopThread(2000);  // 2 second timeout
+    stopAllWorkers();
     
-    // Close all panner states
+    // Close all panner states, then let the writer finish their files
     closeAllPannerStates();
+    m_chunkWriter.stop();
+    m_coverageStore.close();
+    m_coverageModel.publishSnapshot();
     
     DBG("[CaptureEngine] Stopped capture");
     
@@ -115,13 +250,45 @@ CaptureEngine::CaptureStats CaptureEngine::getStats() const
     stats.totalChunksWritten = m_totalChunksWritten.load();
     stats.totalBytesWritten = m_totalBytesWritten.load();
     stats.totalDropoutsDetected = m_totalDropoutsDetected.load();
+    stats.stateChangesWritten = m_stateChangesWritten.load();
+    stats.captureAllocations = m_captureAllocations.load();
+    stats.segmentsSealed = m_segmentsSealed.load();
     
-    // Calculate captured duration from coverage model
-    auto globalStats = m_coverageModel.getGlobalStats();
+    // Calculate captured duration from the published coverage (never waits on capture)
+    auto coverage = m_coverageModel.getSnapshot();
     uint32_t sampleRate = m_coverageModel.getSampleRate();
-    if (sampleRate > 0)
+    if (coverage != nullptr && sampleRate > 0)
     {
-        stats.capturedDurationSeconds = static_cast<double>(globalStats.totalCapturedSamples) / sampleRate;
+        stats.capturedDurationSeconds = static_cast<double>(coverage->stats.totalCapturedSamples) / sampleRate;
+    }
+    
+    auto writerStats = m_chunkWriter.getStats();
+    stats.writeBytesPerSecond = writerStats.writeBytesPerSecond;
+    stats.writeQueueDepth = writerStats.queueDepth;
+    stats.writeQueuedBytes = writerStats.queuedBytes;
+    stats.writeDroppedChunks = writerStats.droppedChunks;
+    stats.writeCheckpoints = writerStats.checkpoints;
+    stats.lastCheckpointMs = writerStats.lastCheckpointMs;
+    
+    stats.audioBytesCaptured = m_audioBytesCaptured.load();
+    stats.audioBytesStored = m_audioBytesStored.load();
+    if (stats.audioBytesStored > 0)
+    {
+        stats.compressionRatio = static_cast<double>(stats.audioBytesCaptured) / static_cast<double>(stats.audioBytesStored);
+    }
+    
+    return stats;
+}
+
+std::vector<CaptureEngine::PannerCaptureStats> CaptureEngine::getPannerStats() const
+{
+    std::vector<PannerCaptureStats> stats;
+    
+    const juce::ScopedLock lock(m_workersMutex);
+    stats.reserve(m_workers.size());
+    for (const auto& pair : m_workers)
+    {
+        stats.push_back(pair.second->getStats());
     }
     
     return stats;
@@ -138,239 +305,458 @@ void CaptureEngine::run()
 {
     DBG("[CaptureEngine] Background thread started");
     
+    // Capture itself happens on the per-panner workers; this thread only schedules them
+    juce::uint32 lastCoverageSave = juce::Time::getMillisecondCounter();
+    juce::uint32 lastSummary = lastCoverageSave;
     while (!threadShouldExit() && m_capturing.load())
     {
-        processCapture();
+        if (m_debugFakeBlocks)
+            generateDebugFakeBlocks();
+        else
+            updateWorkers();
+        
+        if (m_changePending.exchange(false))
+            sendChangeMessage();
+        
+        // Readers (UI, getStats) take the published coverage without touching the model's lock
+        m_coverageModel.publishSnapshot();
         
-        // Sleep briefly to avoid busy-waiting
-        // Adjust this based on expected block rate (e.g., 10ms for ~100 blocks/sec)
-        Thread::sleep(5);
+        const juce::uint32 now = juce::Time::getMillisecondCounter();
+        if (now - lastCoverageSave >= static_cast<juce::uint32>(COVERAGE_SAVE_INTERVAL_MS))
+        {
+            m_coverageStore.update();
+            lastCoverageSave = now;
+        }
+        
+        if (now - lastSummary >= static_cast<juce::uint32>(SUMMARY_INTERVAL_MS))
+        {
+            logSummary();
+            lastSummary = now;
+        }
+        
+        wait(SCHEDULE_INTERVAL_MS);
     }
     
     DBG("[CaptureEngine] Background thread exiting");
 }
 
-void CaptureEngine::processCapture()
+void CaptureEngine::updateWorkers()
 {
-    // Handle debug mode
-    if (m_debugFakeBlocks)
-    {
-        generateDebugFakeBlocks();
-        return;
-    }
-    
     // Get active panners from tracking manager
     auto panners = m_pannerManager.getActivePanners();
     
-    // Periodic debug logging (every 5 seconds)
-    static juce::int64 lastDebugTime = 0;
-    auto now = juce::Time::currentTimeMillis();
-    if (now - lastDebugTime > 5000)
+    std::set<std::string> activeKeys;
+    for (const auto& panner : panners)
     {
-        lastDebugTime = now;
-        DBG("[CaptureEngine] processCapture: " + juce::String(panners.size()) + " panners found");
-        for (const auto& p : panners)
+        if (!panner.isMemoryShareBased)
+            continue;  // Only capture from memory share panners
+        
+        std::string key = createPannerId(panner).toString();
+        activeKeys.insert(key);
+        
+        auto it = m_workers.find(key);
+        if (it != m_workers.end())
         {
-            juce::String statusStr = "Unknown";
-            switch (p.connectionStatus) {
-                case PannerConnectionStatus::Active: statusStr = "Active"; break;
-                case PannerConnectionStatus::Stale: statusStr = "Stale"; break;
-                case PannerConnectionStatus::Disconnected: statusStr = "Disconnected"; break;
-            }
-            DBG("  - " + juce::String(p.name) + " [PID:" + juce::String(p.processId) + 
-                "] status=" + statusStr + 
-                " isPlaying=" + juce::String(p.isPlaying ? "yes" : "no") +
-                " playhead=" + juce::String(p.playheadPositionInSeconds, 2) + "s" +
-                " isMemShare=" + juce::String(p.isMemoryShareBased ? "yes" : "no"));
+            it->second->setPannerInfo(panner);
+            continue;
         }
+        
+        auto share = openWorkerConnection(panner);
+        if (!share)
+        {
+            // Retried on every pass: reported once per summary
+            m_unconnectedPanners[panner.processId] = juce::String(panner.name);
+            continue;
+        }
+        
+        auto worker = std::make_unique<PannerWorker>(*this, panner, std::move(share));
+        worker->startThread(juce::Thread::Priority::high);
+        DBG("[CaptureEngine] Started capture worker for " + juce::String(panner.name)
+            + (worker->m_share->canWaitForData() ? " (doorbell)" : " (polling)"));
+        
+        const juce::ScopedLock lock(m_workersMutex);
+        m_workers[key] = std::move(worker);
     }
     
-    for (const auto& panner : panners)
+    // Retire workers whose panner went away; their capture state stays open in case it returns
+    std::vector<std::unique_ptr<PannerWorker>> retired;
     {
-        if (!panner.isMemoryShareBased)
-            continue;  // Only capture from memory share panners
-        
-        processPannerData(panner);
+        const juce::ScopedLock lock(m_workersMutex);
+        for (auto it = m_workers.begin(); it != m_workers.end();)
+        {
+            if (activeKeys.count(it->first) != 0)
+            {
+                ++it;
+                continue;
+            }
+            retired.push_back(std::move(it->second));
+            it = m_workers.erase(it);
+        }
     }
+    retired.clear();  // Joins the threads outside the lock
 }
 
-void CaptureEngine::processPannerData(const PannerInfo& panner)
+void CaptureEngine::logSummary()
 {
-    // Create panner ID
-    PannerId pannerId = createPannerId(panner);
+    const auto panners = m_pannerManager.getActivePanners();
+    DBG("[CaptureEngine] " + juce::String(static_cast<int>(panners.size())) + " panners found, "
+        + juce::String(static_cast<int>(m_workers.size())) + " capture workers");
+    for (const auto& p : panners)
+    {
+        juce::String statusStr = "Unknown";
+        switch (p.connectionStatus) {
+            case PannerConnectionStatus::Active: statusStr = "Active"; break;
+            case PannerConnectionStatus::Stale: statusStr = "Stale"; break;
+            case PannerConnectionStatus::Disconnected: statusStr = "Disconnected"; break;
+        }
+        DBG("  - " + juce::String(p.name) + " [PID:" + juce::String(p.processId) + 
+            "] status=" + statusStr + 
+            " isPlaying=" + juce::String(p.isPlaying ? "yes" : "no") +
+            " playhead=" + juce::String(p.playheadPositionInSeconds, 2) + "s" +
+            " isMemShare=" + juce::String(p.isMemoryShareBased ? "yes" : "no"));
+    }
+    for (const auto& pair : m_workers)
+    {
+        auto workerStats = pair.second->getStats();
+        DBG("  - worker " + workerStats.name + ": captured=" + juce::String((juce::int64)workerStats.blocksCaptured)
+            + " pending=" + juce::String((juce::int64)workerStats.pendingBlocks)
+            + " maxPending=" + juce::String((juce::int64)workerStats.maxPendingBlocks)
+            + " allocations=" + juce::String((juce::int64)workerStats.allocations));
+    }
+    for (const auto& pair : m_unconnectedPanners)
+    {
+        DBG("  - not connected: " + pair.second + " [PID:" + juce::String(pair.first) + "], segment not found in tracker");
+    }
+    m_unconnectedPanners.clear();
+}
+
+void CaptureEngine::stopAllWorkers()
+{
+    std::map<std::string, std::unique_ptr<PannerWorker>> workers;
+    {
+        const juce::ScopedLock lock(m_workersMutex);
+        workers.swap(m_workers);
+    }
     
-    // Get the memory share tracker to read audio data
-    auto* tracker = m_pannerManager.getMemoryShareTracker();
-    if (!tracker)
+    // Signal every worker first so they wind down together
+    for (auto& pair : workers)
     {
-        DBG("[CaptureEngine] No memory share tracker available");
-        return;
+        pair.second->signalThreadShouldExit();
+        pair.second->notify();
     }
+    workers.clear();
+}
+
+std::unique_ptr<M1MemoryShare> CaptureEngine::openWorkerConnection(const PannerInfo& panner)
+{
+    auto* tracker = m_pannerManager.getMemoryShareTracker();
+    if (!tracker)
+        return nullptr;
     
-    // Find the panner in the tracker
     auto* memPanner = tracker->findPanner(panner.processId);
-    if (!memPanner || !memPanner->memoryShare)
+    if (!memPanner || !memPanner->memoryShare || !memPanner->isConnected)
+        return nullptr;
+    
+    // Map the segment again rather than sharing the tracker's instance, which the tracker
+    // may replace or destroy while the worker is reading
+    std::unique_ptr<M1MemoryShare> share;
+#if defined(M1_MEMORYSHARE_FD_TRANSPORT)
+    int fd = memPanner->memoryShare->getFileDescriptor();
+    if (fd >= 0)
     {
-        // Reduced logging - only log occasionally
-        static std::map<uint32_t, juce::int64> lastLogTime;
-        auto now = juce::Time::currentTimeMillis();
-        if (now - lastLogTime[panner.processId] > 10000) // Every 10s per panner
-        {
-            lastLogTime[panner.processId] = now;
-            DBG("[CaptureEngine] Panner not found in tracker: " + juce::String(panner.name) + 
-                " PID=" + juce::String(panner.processId));
-        }
-        return;
+        int workerFd = ::dup(fd);
+        if (workerFd >= 0)
+            share = M1MemoryShare::openFileDescriptor(workerFd, memPanner->memorySegmentName);
     }
-    
-    // Read audio buffer with parameters
-    juce::AudioBuffer<float> audioBuffer;
-    ParameterMap parameters;
-    uint64_t dawTimestamp = 0;
-    double playheadPosition = 0.0;
-    bool isPlaying = false;
-    uint64_t bufferId = 0;
-    uint32_t updateSource = 0;
-    
-    if (!memPanner->memoryShare->readAudioBufferWithGenericParameters(
-            audioBuffer, parameters, dawTimestamp, playheadPosition, isPlaying, bufferId, updateSource))
+    else
+#endif
+    if (!memPanner->memoryFilePath.empty())
     {
-        return;  // No new data available
+        share = std::make_unique<M1MemoryShare>(memPanner->memorySegmentName,
+                                                1024 * 1024, // 1MB default size
+                                                8,           // maxQueueSize
+                                                true,        // persistent
+                                                false,       // createMode = false (open existing)
+                                                memPanner->memoryFilePath);
     }
     
-    // Get or create panner state
-    PannerCaptureState& state = getOrCreatePannerState(pannerId);
+    if (!share || !share->isValid() || !share->isFormatted())
+        return nullptr;
     
-    // Skip if we've already processed this buffer
-    if (bufferId == state.lastBufferId)
-        return;
+    return share;
+}
+
+bool CaptureEngine::drainPanner(PannerWorker& worker)
+{
+    M1MemoryShare& share = *worker.m_share;
+    const CoverageModel::PannerHandle coverageHandle = worker.m_coverageHandle;
     
-    // Debug logging for new buffer
-    static std::map<std::string, juce::int64> lastBufferLogTime;
-    auto now = juce::Time::currentTimeMillis();
-    std::string key = pannerId.toString();
-    if (now - lastBufferLogTime[key] > 2000) // Every 2s per panner
-    {
-        lastBufferLogTime[key] = now;
-        DBG("[CaptureEngine] New buffer from " + juce::String(panner.name) + 
-            ": bufferId=" + juce::String((juce::int64)bufferId) +
-            " playhead=" + juce::String(playheadPosition, 3) + "s" +
-            " isPlaying=" + juce::String(isPlaying ? "yes" : "no") +
-            " channels=" + juce::String(audioBuffer.getNumChannels()) +
-            " samples=" + juce::String(audioBuffer.getNumSamples()));
-    }
+    // Backlog at wake-up
+    uint64_t pending = share.getPendingBlockCount(worker.m_consumerId);
+    worker.m_pendingBlocks.store(pending);
+    if (pending > worker.m_maxPendingBlocks.load())
+        worker.m_maxPendingBlocks.store(pending);
     
-    // Calculate start sample position
-    uint32_t sampleRate = memPanner->sampleRate > 0 ? memPanner->sampleRate : 44100;
-    int64_t startSample = static_cast<int64_t>(playheadPosition * sampleRate);
-    int32_t numSamples = audioBuffer.getNumSamples();
-    int16_t numChannels = static_cast<int16_t>(audioBuffer.getNumChannels());
+    StateSnapshot pannerSnapshot;
+    uint32_t sampleRate = 44100;
+    worker.getPannerInfo(pannerSnapshot, sampleRate);
     
-    // Detect dropout (sequence gap)
-    uint32_t sequenceNumber = memPanner->sequenceNumber;
-    if (state.lastBufferId > 0 && sequenceNumber > state.lastSequenceNumber + 1)
+    for (int blockIndex = 0; blockIndex < MAX_BLOCKS_PER_PASS; ++blockIndex)
     {
-        uint32_t missed = sequenceNumber - state.lastSequenceNumber - 1;
-        m_totalDropoutsDetected.fetch_add(missed);
+        // View the next block in place (no copy out of shared memory)
+        M1MemoryShare::AudioBlockView view;
+        if (!share.acquireAudioBlockView(view, worker.m_consumerId))
+        {
+            // No new data available: let partly filled write buffers go to disk
+            if (worker.m_state != nullptr && worker.m_state->output)
+                worker.m_state->output->flushIfStale();
+            if (worker.m_state != nullptr && worker.m_state->indexOutput)
+                worker.m_state->indexOutput->flushIfStale();
+            if (worker.m_state != nullptr && worker.m_state->stateOutput)
+                worker.m_state->stateOutput->flushIfStale();
+            return false;
+        }
+        
+        uint64_t dawTimestamp = view.header->dawTimestamp;
+        double playheadPosition = view.header->playheadPositionInSeconds;
+        uint64_t bufferId = view.header->bufferId;
         
-        // Record dropout in coverage model
-        int64_t dropoutStart = state.lastEndSample;
-        int64_t dropoutEnd = startSample;
-        if (dropoutEnd > dropoutStart)
+        // Get or create panner state (the map never moves its entries), with its scratch
+        // buffers sized for the segment's block format so capture doesn't grow them
+        if (worker.m_state == nullptr)
         {
-            m_coverageModel.addDropout(pannerId, dropoutStart, dropoutEnd, missed, true);
+            worker.m_state = &getOrCreatePannerState(worker.m_pannerId);
+            
+            uint32_t formatSampleRate = 0, formatChannels = 0, formatBlockSize = 0;
+            if (share.getAudioFormat(formatSampleRate, formatChannels, formatBlockSize))
+                worker.m_state->reserveScratch(static_cast<size_t>(formatChannels) * formatBlockSize);
         }
-    }
-    
-    // Skip if no audio data
-    if (numChannels <= 0 || numSamples <= 0)
-    {
-        return;
-    }
-    
-    // Create chunk header
-    ChunkHeader header;
-    header.startSample = startSample;
-    header.numSamples = numSamples;
-    header.numChannels = numChannels;
-    header.sampleRate = sampleRate;
-    header.bufferId = bufferId;
-    header.sequenceNumber = sequenceNumber;
-    header.dawTimestampMs = dawTimestamp;
-    header.wallClockMs = static_cast<uint64_t>(juce::Time::currentTimeMillis());
-    header.audioDataSize = static_cast<uint32_t>(numChannels * numSamples * sizeof(float));
-    
-    // Create state snapshot from panner info
-    StateSnapshot snapshot = createStateSnapshot(panner);
-    snapshot.captureTimestampMs = header.wallClockMs;
-    snapshot.stateSeq = sequenceNumber;
-    
-    // Interleave audio data for storage
-    std::vector<float> interleavedAudio(static_cast<size_t>(numChannels * numSamples));
-    for (int sample = 0; sample < numSamples; ++sample)
-    {
-        for (int channel = 0; channel < numChannels; ++channel)
+        PannerCaptureState& state = *worker.m_state;
+        
+        // Skip if we've already processed this buffer
+        if (bufferId == state.lastBufferId)
+        {
+            share.releaseAudioBlockView(view);
+            return false;
+        }
+        
+        // Calculate start sample position
+        int64_t startSample = static_cast<int64_t>(playheadPosition * sampleRate);
+        int32_t numSamples = static_cast<int32_t>(view.numSamples);
+        int16_t numChannels = static_cast<int16_t>(view.numChannels);
+        
+        // Detect dropout (sequence gap: blocks the panner dropped on a full ring, or that
+        // were overwritten, still used up their sequence numbers). The coverage model
+        // records the dropout over the missing samples when this block is added to it.
+        uint32_t sequenceNumber = view.header->sequenceNumber;
+        if (state.lastBufferId > 0 && sequenceNumber > state.lastSequenceNumber + 1)
+        {
+            uint32_t missed = sequenceNumber - state.lastSequenceNumber - 1;
+            m_totalDropoutsDetected.fetch_add(missed);
+        }
+        
+        // Skip if no audio data
+        if (numChannels <= 0 || numSamples <= 0)
+        {
+            share.releaseAudioBlockView(view);
+            if (!worker.m_drainRing)
+                return false;
+            continue;
+        }
+        
+        // Create chunk header
+        ChunkHeader header;
+        header.startSample = startSample;
+        header.numSamples = numSamples;
+        header.numChannels = numChannels;
+        header.sampleRate = sampleRate;
+        header.bufferId = bufferId;
+        header.sequenceNumber = sequenceNumber;
+        header.dawTimestampMs = dawTimestamp;
+        header.wallClockMs = static_cast<uint64_t>(juce::Time::currentTimeMillis());
+        header.audioDataSize = static_cast<uint32_t>(numChannels * numSamples * sizeof(float));
+        
+        // Chunks store interleaved audio: write interleaved blocks straight from shared memory,
+        // and interleave planar blocks into the panner's scratch buffer
+        const void* audioData = view.audioBytes;
+        if (!view.isInterleaved())
+        {
+            state.interleaveScratch.resize(static_cast<size_t>(numChannels) * static_cast<size_t>(numSamples));
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                for (int sample = 0; sample < numSamples; ++sample)
+                {
+                    state.interleaveScratch[static_cast<size_t>(sample * numChannels + channel)] = view.getSample(static_cast<uint32_t>(channel), static_cast<uint32_t>(sample));
+                }
+            }
+            audioData = state.interleaveScratch.data();
+        }
+        
+        // The block's own parameters, so the state stream changes at the block the panner
+        // changed in rather than at the tracker's next refresh
+        StateSnapshot blockSnapshot = pannerSnapshot;
+        M1MemoryShare::readParameters(view, worker.m_blockParameters);
+        applyBlockParameters(worker.m_blockParameters, blockSnapshot);
+        
+        // Hand the chunk to the disk writer
+        bool written = writeChunk(state, header, blockSnapshot, audioData);
+        
+        // A peeked block may have been rewritten while it was being written out
+        if (!share.releaseAudioBlockView(view))
+        {
+            m_totalDropoutsDetected.fetch_add(1);
+        }
+        
+        // Update coverage model (a chunk the writer had no room for is a dropout)
+        if (written)
+        {
+            m_coverageModel.addPannerInterval(coverageHandle, startSample, numSamples,
+                                              sampleRate, numChannels, sequenceNumber, bufferId);
+        }
+        else
         {
-            interleavedAudio[static_cast<size_t>(sample * numChannels + channel)] = audioBuffer.getSample(channel, sample);
+            m_totalDropoutsDetected.fetch_add(1);
+            m_coverageModel.addDropout(coverageHandle, startSample, startSample + numSamples, 1, true);
         }
+        
+        // Update state tracking
+        state.lastSequenceNumber = sequenceNumber;
+        state.lastBufferId = bufferId;
+        state.lastEndSample = startSample + numSamples;
+        worker.m_blocksCaptured.fetch_add(1);
+        
+        // Acknowledge the buffer
+        share.acknowledgeBuffer(bufferId, worker.m_consumerId);
+        
+        if (!worker.m_drainRing)
+            return false;
     }
     
-    // Write chunk to disk
-    writeChunk(state, header, snapshot, interleavedAudio.data());
-    
-    // Update coverage model
-    m_coverageModel.addPannerInterval(pannerId, startSample, numSamples,
-                                      sampleRate, numChannels, sequenceNumber, bufferId);
-    
-    // Update state tracking
-    state.lastSequenceNumber = sequenceNumber;
-    state.lastBufferId = bufferId;
-    state.lastEndSample = startSample + numSamples;
-    
-    // Acknowledge the buffer
-    memPanner->memoryShare->acknowledgeBuffer(bufferId, 9001);  // Consumer ID
+    return true;
 }
 
-void CaptureEngine::writeChunk(PannerCaptureState& state, const ChunkHeader& header,
-                               const StateSnapshot& snapshot, const float* audioData)
+bool CaptureEngine::writeChunk(PannerCaptureState& state, ChunkHeader header,
+                               const StateSnapshot& snapshot, const void* audioData)
 {
     if (!state.isOpen())
-        return;
+        return false;
     
-    auto* stream = state.outputStream.get();
+    // Compress on this (capture worker) thread; keep the raw audio if it doesn't get smaller
+    const uint32_t rawAudioSize = audioData != nullptr ? header.audioDataSize : 0u;
+    if (rawAudioSize > 0 && m_audioCodec.load() == ChunkCodec::FloatPredictive)
+    {
+        state.encodeScratch.resize(rawAudioSize);
+        size_t encodedSize = ChunkCodec::encode(static_cast<const float*>(audioData),
+                                                static_cast<uint32_t>(header.numChannels),
+                                                static_cast<uint32_t>(header.numSamples),
+                                                state.encodeScratch.data(), rawAudioSize - 1);
+        if (encodedSize > 0)
+        {
+            header.codec = ChunkCodec::FloatPredictive;
+            header.audioDataSize = static_cast<uint32_t>(encodedSize);
+            audioData = state.encodeScratch.data();
+        }
+    }
     
-    // Write header
-    stream->write(&header, ChunkHeader::SIZE);
+    // Start a new segment rather than take this one past its limits
+    if (shouldRotateSegment(state, ChunkHeader::SIZE + header.audioDataSize))
+    {
+        const uint32_t nextSegment = state.segment.segmentNumber + 1;
+        sealSegment(state);
+        if (!openSegment(state, nextSegment))
+            return false;
+    }
     
-    // Write state snapshot
-    stream->write(&snapshot, StateSnapshot::SIZE);
+    // Buffered in memory; the ChunkWriter thread does the disk I/O
+    ChunkIndexEntry entry;
+    entry.startSample = header.startSample;
+    entry.numSamples = header.numSamples;
+    entry.sequenceNumber = header.sequenceNumber;
+    entry.byteOffset = state.output->getPosition();
     
-    // Write audio data (only if there's data to write)
-    if (audioData != nullptr && header.audioDataSize > 0)
+    // The panner state goes to the segment's state stream, and only when it changed
+    header.stateSize = 0;
+    writeStateChange(state, header, snapshot);
+    
+    // Lets recovery tell a complete chunk from one a crash cut short
+    const uint32_t audioSize = audioData != nullptr ? header.audioDataSize : 0u;
+    header.version = ChunkHeader::VERSION_CHECKSUM;
+    header.checksum = Crc32c::getChunkChecksum(header, audioData, audioSize);
+    
+    if (!state.output->append({ { &header, ChunkHeader::SIZE },
+                                { audioData, audioSize } }))
     {
-        stream->write(audioData, header.audioDataSize);
+        return false;
     }
     
-    // Flush periodically (every 100 chunks)
-    state.chunksWritten++;
-    if (state.chunksWritten % 100 == 0)
+    // Stop indexing after a lost entry: ChunkIndex::repair() re-indexes the tail from the chunk file
+    if (state.indexOutput && !state.indexOutput->append({ { &entry, ChunkIndexEntry::SIZE } }))
     {
-        stream->flush();
+        DBG("[CaptureEngine] Index entry lost, index will be repaired on load: " + state.chunkFile.getFullPathName());
+        state.indexOutput.reset();
     }
     
-    state.bytesWritten += ChunkHeader::SIZE + StateSnapshot::SIZE + header.audioDataSize;
+    // Summary for the segment footer
+    SegmentFooter& segment = state.segment;
+    if (segment.chunkCount == 0)
+    {
+        segment.startSample = entry.startSample;
+        segment.endSample = entry.endSample();
+        segment.firstWallClockMs = header.wallClockMs;
+        segment.firstSequenceNumber = header.sequenceNumber;
+    }
+    segment.startSample = std::min(segment.startSample, entry.startSample);
+    segment.endSample = std::max(segment.endSample, entry.endSample());
+    segment.lastWallClockMs = header.wallClockMs;
+    segment.lastSequenceNumber = header.sequenceNumber;
+    segment.chunkCount++;
+    
+    m_audioBytesCaptured.fetch_add(rawAudioSize);
+    m_audioBytesStored.fetch_add(audioSize);
+    
+    state.chunksWritten++;
+    state.bytesWritten += ChunkHeader::SIZE + header.audioDataSize;
     m_totalChunksWritten.fetch_add(1);
-    m_totalBytesWritten.fetch_add(ChunkHeader::SIZE + StateSnapshot::SIZE + header.audioDataSize);
+    m_totalBytesWritten.fetch_add(ChunkHeader::SIZE + header.audioDataSize);
     
     // Notify listeners less frequently to avoid GUI stalls (every ~500ms worth of chunks)
     // At 48kHz with 512 sample blocks, that's about 47 blocks per 500ms
     if (state.chunksWritten % 100 == 0)
     {
-        // Use async notification to avoid blocking capture thread
-        juce::MessageManager::callAsync([this]() {
-            sendChangeMessage();
-        });
+        // The engine thread sends it, so the capture thread never posts a message
+        m_changePending.store(true);
     }
+    
+    return true;
+}
+
+void CaptureEngine::writeStateChange(PannerCaptureState& state, const ChunkHeader& header, const StateSnapshot& snapshot)
+{
+    if (!state.stateOutput)
+        return;
+    
+    // Deltas need the previous record on disk: after a lost record, write every field again
+    StateRecordHeader record;
+    record.changedFields = state.lastStateWritten ? StateTrack::getChangedFields(state.lastState, snapshot)
+                                                  : StateTrack::ALL_FIELDS;
+    if (record.changedFields == 0)
+        return;
+    
+    // Takes effect at this block: the chunk about to be appended at the current offset
+    record.stateSeq = header.sequenceNumber;
+    record.samplePosition = header.startSample;
+    record.chunkOffset = state.output->getPosition();
+    
+    uint8_t buffer[StateTrack::MAX_RECORD_SIZE];
+    const size_t size = StateTrack::encodeRecord(record, snapshot, buffer);
+    state.lastStateWritten = state.stateOutput->append({ { buffer, size } });
+    if (!state.lastStateWritten)
+        return;
+    
+    state.lastState = snapshot;
+    state.bytesWritten += size;
+    m_totalBytesWritten.fetch_add(size);
+    m_stateChangesWritten.fetch_add(1);
 }
 
 //==============================================================================
@@ -389,36 +775,100 @@ PannerCaptureState& CaptureEngine::getOrCreatePannerState(const PannerId& panner
     state.pannerId = pannerId;
     
     // Create panner capture directory
-    juce::File pannerDir = getPannerCaptureDir(pannerId);
-    if (!pannerDir.exists())
+    state.pannerDir = getPannerCaptureDir(pannerId);
+    if (!state.pannerDir.exists())
     {
-        pannerDir.createDirectory();
+        state.pannerDir.createDirectory();
     }
     
-    // Open chunk file for writing
-    state.chunkFile = pannerDir.getChildFile("chunks.bin");
-    state.outputStream = std::make_unique<juce::FileOutputStream>(state.chunkFile);
+    // An earlier capture that stopped without sealing its last chunk file: bring that
+    // file's index up to date. This capture continues in new segments after it.
+    auto segments = ChunkSegments::findSegments(state.pannerDir);
+    SegmentFooter footer;
+    if (!segments.isEmpty() && !ChunkSegments::readFooter(segments.getLast(), footer))
+    {
+        ChunkIndex::repair(segments.getLast());
+    }
+    
+    openSegment(state, ChunkSegments::getNextSegmentNumber(state.pannerDir));
     
-    if (!state.outputStream->openedOk())
+    return state;
+}
+
+bool CaptureEngine::openSegment(PannerCaptureState& state, uint32_t segmentNumber)
+{
+    state.chunkFile = ChunkSegments::getSegmentFile(state.pannerDir, segmentNumber);
+    state.segment = SegmentFooter();
+    state.segment.segmentNumber = segmentNumber;
+    state.segmentOpenedMs = juce::Time::currentTimeMillis();
+    
+    // Open chunk file for writing
+    state.output = m_chunkWriter.open(state.chunkFile);
+    if (!state.output)
     {
         DBG("[CaptureEngine] Failed to open chunk file: " + state.chunkFile.getFullPathName());
-        state.outputStream.reset();
+        return false;
     }
-    else
+    
+    state.indexOutput = m_chunkWriter.open(ChunkIndex::getIndexFile(state.chunkFile), INDEX_BUFFER_SIZE);
+    if (state.indexOutput && state.indexOutput->getPosition() == 0)
     {
-        DBG("[CaptureEngine] Created chunk file: " + state.chunkFile.getFullPathName());
+        ChunkIndexHeader indexHeader;
+        state.indexOutput->append({ { &indexHeader, ChunkIndexHeader::SIZE } });
     }
     
-    return state;
+    // Each segment's state stream starts with every field, so it reads on its own
+    const juce::File stateFile = StateTrack::getStateFile(state.chunkFile);
+    state.lastStateWritten = false;
+    state.stateOutput = m_chunkWriter.open(stateFile, STATE_BUFFER_SIZE);
+    if (state.stateOutput && state.stateOutput->getPosition() == 0)
+    {
+        StateStreamHeader stateHeader;
+        state.stateOutput->append({ { &stateHeader, StateStreamHeader::SIZE } });
+    }
+    else if (!state.stateOutput)
+    {
+        DBG("[CaptureEngine] Failed to open state stream: " + stateFile.getFullPathName());
+    }
+    
+    DBG("[CaptureEngine] Created chunk file: " + state.chunkFile.getFullPathName());
+    return true;
 }
 
-void CaptureEngine::closePannerState(PannerCaptureState& state)
+void CaptureEngine::sealSegment(PannerCaptureState& state)
 {
-    if (state.outputStream)
+    // The footer marks the segment finished; readers treat a segment without one as still being written
+    if (state.output)
     {
-        state.outputStream->flush();
-        state.outputStream.reset();
+        state.segment.dataSize = state.output->getPosition();
+        if (state.output->append({ { &state.segment, SegmentFooter::SIZE } }))
+            m_segmentsSealed.fetch_add(1);
+        else
+            DBG("[CaptureEngine] Segment footer lost: " + state.chunkFile.getFullPathName());
     }
+    
+    // Hands the buffered tails to the writer, which closes the files once they are written
+    state.output.reset();
+    state.indexOutput.reset();
+    state.stateOutput.reset();
+}
+
+bool CaptureEngine::shouldRotateSegment(const PannerCaptureState& state, uint64_t chunkBytes) const
+{
+    if (state.segment.chunkCount == 0)
+        return false;
+    
+    const uint64_t maxBytes = m_segmentMaxBytes.load();
+    if (maxBytes > 0 && state.output->getPosition() + chunkBytes > maxBytes)
+        return true;
+    
+    const int maxSeconds = m_segmentMaxSeconds.load();
+    return maxSeconds > 0 && juce::Time::currentTimeMillis() - state.segmentOpenedMs >= static_cast<juce::int64>(maxSeconds) * 1000;
+}
+
+void CaptureEngine::closePannerState(PannerCaptureState& state)
+{
+    sealSegment(state);
 }
 
 void CaptureEngine::closeAllPannerStates()
@@ -454,13 +904,32 @@ StateSnapshot CaptureEngine::createStateSnapshot(const PannerInfo& panner) const
     snapshot.stereoSpread = panner.stereoSpread;
     snapshot.stereoInputBalance = panner.stereoInputBalance;
     snapshot.autoOrbit = panner.autoOrbit;
-    snapshot.autoOrbit = panner.autoOrbit;
     snapshot.inputMode = panner.inputMode;
     snapshot.outputMode = panner.outputMode;
     snapshot.pannerMode = panner.pannerMode;
+    snapshot.gainCompensation = panner.gainCompensation + 1;
     return snapshot;
 }
 
+void CaptureEngine::applyBlockParameters(const ParameterMap& parameters, StateSnapshot& snapshot)
+{
+    using IDs = M1SystemHelperParameterIDs;
+    snapshot.azimuthDeg = parameters.getFloat(IDs::AZIMUTH, snapshot.azimuthDeg);
+    snapshot.elevationDeg = parameters.getFloat(IDs::ELEVATION, snapshot.elevationDeg);
+    snapshot.diverge = parameters.getFloat(IDs::DIVERGE, snapshot.diverge);
+    snapshot.gainDb = parameters.getFloat(IDs::GAIN, snapshot.gainDb);
+    snapshot.stereoOrbitAzimuth = parameters.getFloat(IDs::STEREO_ORBIT_AZIMUTH, snapshot.stereoOrbitAzimuth);
+    snapshot.stereoSpread = parameters.getFloat(IDs::STEREO_SPREAD, snapshot.stereoSpread);
+    snapshot.stereoInputBalance = parameters.getFloat(IDs::STEREO_INPUT_BALANCE, snapshot.stereoInputBalance);
+    snapshot.autoOrbit = parameters.getBool(IDs::AUTO_ORBIT, snapshot.autoOrbit);
+    snapshot.inputMode = parameters.getInt(IDs::INPUT_MODE, snapshot.inputMode);
+    snapshot.outputMode = parameters.getInt(IDs::OUTPUT_MODE, snapshot.outputMode);
+    if (parameters.contains(IDs::ISOTROPIC_MODE, ParameterType::BOOL) || parameters.contains(IDs::EQUALPOWER_MODE, ParameterType::BOOL))
+        snapshot.pannerMode = PannerTrackingManager::resolvePannerMode(parameters);
+    if (parameters.contains(IDs::GAIN_COMPENSATION_MODE, ParameterType::BOOL))
+        snapshot.gainCompensation = parameters.getBool(IDs::GAIN_COMPENSATION_MODE) ? 2 : 1;
+}
+
 juce::File CaptureEngine::getPannerCaptureDir(const PannerId& pannerId) const
 {
     return m_captureRoot
@@ -5,99 +5,51 @@
     associates state snapshots, and writes to disk in an append-only chunk format.
     
     Features:
-    - Runs on a background thread (no blocking of message thread)
+    - Runs on background threads (no blocking of message thread)
+    - One capture worker per panner, woken by that panner's doorbell
     - Reads from M1MemoryShare per-panner connections
-    - Writes append-only binary chunk files per panner
-    - Maintains coverage model for UI visualization
-    - Detects dropouts via sequence number gaps or ring buffer overruns
+    - Writes append-only binary chunk files per panner, each chunk checksummed (CRC-32C)
+    - Syncs the files to disk at checkpoints (group commit), not per chunk
+    - Chunk audio is losslessly compressed on the capture workers (ChunkCodec, optional)
+    - Chunk files are written by a ChunkWriter thread; capture never waits on the disk
+    - No heap allocation per block once a panner's buffers are sized (counted in
+      CaptureStats::captureAllocations by builds with M1_COUNT_ALLOCATIONS)
+    - Maintains coverage model for UI visualization, kept in the session folder
+      (coverage.m1cov, see CoverageStore.h) so a resumed session's timeline loads at once
+    - Detects dropouts via sequence number gaps (blocks a panner dropped on a full ring
+      still use up their sequence numbers) or ring buffer overruns
     
     Storage Format (per panner):
     - Folder: <capture_root>/<session_id>/<panner_uuid>/
-    - File: chunks.bin (append-only)
-    - Each chunk: ChunkHeader + StateSnapshot + audio data
+    - Files: chunks_NNNN.bin segments (append-only), rotated at a size or duration limit
+      and sealed with a SegmentFooter (see ChunkSegments.h)
+    - Each chunk: ChunkHeader + audio data (see ChunkFormat.h)
+    - Sidecar per segment: chunks_NNNN.idx, one ChunkIndexEntry per chunk (see ChunkIndex.h)
+    - Sidecar per segment: state_NNNN.bin, panner state recorded only when it changes (see StateTrack.h)
+    - Per session: coverage.m1cov, the coverage of every panner (rebuilt from the indexes if missing)
 */
 
 #pragma once
 
 #include <JuceHeader.h>
 #include "CoverageModel.h"
+#include "CoverageStore.h"
+#include "ChunkFormat.h"
+#include "ChunkCodec.h"
+#include "ChunkWriter.h"
+#include "ChunkIndex.h"
+#include "StateTrack.h"
+#include "ChunkSegments.h"
 #include "../Managers/PannerTrackingManager.h"
 #include "../Common/TypesForDataExchange.h"
 #include <atomic>
 #include <map>
 #include <memory>
 #include <functional>
+#include <vector>
 
 namespace Mach1 {
 
-//==============================================================================
-/**
- * State snapshot captured alongside audio data
- */
-struct StateSnapshot
-{
-    // Spatial parameters
-    float azimuthDeg = 0.0f;
-    float elevationDeg = 0.0f;
-    float diverge = 0.0f;
-    float gainDb = 0.0f;
-    
-    // Stereo parameters
-    float stereoOrbitAzimuth = 0.0f;
-    float stereoSpread = 0.0f;
-    float stereoInputBalance = 0.0f;
-    bool autoOrbit = false;
-    
-    // Mode settings
-    int32_t inputMode = 0;
-    int32_t outputMode = 0;
-    int32_t pannerMode = 0;
-    
-    // Sequence tracking
-    uint32_t stateSeq = 0;
-    uint64_t captureTimestampMs = 0;
-    
-    // Padding for alignment and future expansion
-    uint8_t reserved[24] = {0};
-    
-    static constexpr size_t SIZE = 80;  // Fixed size for binary storage
-};
-static_assert(sizeof(StateSnapshot) == StateSnapshot::SIZE, "StateSnapshot size mismatch");
-
-//==============================================================================
-/**
- * Header for each captured chunk in the binary file
- */
-struct ChunkHeader
-{
-    // Magic number for validation
-    uint32_t magic = 0x4D314348;  // "M1CH"
-    uint32_t version = 1;
-    
-    // Audio metadata
-    int64_t startSample = 0;
-    int32_t numSamples = 0;
-    int16_t numChannels = 0;
-    int16_t reserved1 = 0;
-    uint32_t sampleRate = 44100;
-    
-    // Tracking
-    uint64_t bufferId = 0;
-    uint32_t sequenceNumber = 0;
-    uint64_t dawTimestampMs = 0;
-    uint64_t wallClockMs = 0;
-    
-    // Data sizes
-    uint32_t stateSize = StateSnapshot::SIZE;
-    uint32_t audioDataSize = 0;  // numChannels * numSamples * sizeof(float)
-    
-    // Padding for alignment
-    uint8_t reserved2[8] = {0};
-    
-    static constexpr size_t SIZE = 80;  // Fixed size
-};
-static_assert(sizeof(ChunkHeader) == ChunkHeader::SIZE, "ChunkHeader size mismatch");
-
 //==============================================================================
 /**
  * Per-panner capture state
@@ -105,8 +57,19 @@ static_assert(sizeof(ChunkHeader) == ChunkHeader::SIZE, "ChunkHeader size mismat
 struct PannerCaptureState
 {
     PannerId pannerId;
-    juce::File chunkFile;
-    std::unique_ptr<juce::FileOutputStream> outputStream;
+    juce::File pannerDir;
+    juce::File chunkFile;                               // Current segment
+    std::unique_ptr<ChunkWriter::Stream> output;
+    std::unique_ptr<ChunkWriter::Stream> indexOutput;   // chunks_NNNN.idx (nullptr once an entry was lost)
+    std::unique_ptr<ChunkWriter::Stream> stateOutput;   // state_NNNN.bin
+    
+    // Current segment, summarised in its footer when it is sealed
+    SegmentFooter segment;
+    juce::int64 segmentOpenedMs = 0;
+    
+    // Last state written to the segment's state stream; the next record only carries what changed
+    StateSnapshot lastState;
+    bool lastStateWritten = false;
     
     // Ring buffer tracking for dropout detection
     uint32_t lastSequenceNumber = 0;
@@ -117,7 +80,17 @@ struct PannerCaptureState
     uint32_t chunksWritten = 0;
     uint64_t bytesWritten = 0;
     
-    bool isOpen() const { return outputStream != nullptr && outputStream->openedOk(); }
+    // Reused to interleave planar blocks, and to encode audio, before writing
+    std::vector<float> interleaveScratch;
+    std::vector<uint8_t> encodeScratch;
+    
+    bool isOpen() const { return output != nullptr; }
+    
+    void reserveScratch(size_t samples)
+    {
+        interleaveScratch.reserve(samples);
+        encodeScratch.reserve(samples * sizeof(float));
+    }
 };
 
 //==============================================================================
@@ -180,13 +153,79 @@ public:
         uint32_t totalChunksWritten = 0;
         uint64_t totalBytesWritten = 0;
         uint32_t totalDropoutsDetected = 0;
+        uint32_t stateChangesWritten = 0;   // Records in the state streams
+        uint32_t segmentsSealed = 0;        // Chunk file segments finished
+        uint64_t captureAllocations = 0;    // Heap allocations by the capture workers (stops growing once warm; M1_COUNT_ALLOCATIONS builds only)
         double capturedDurationSeconds = 0.0;
+        
+        // Chunk writer
+        double writeBytesPerSecond = 0.0;
+        uint32_t writeQueueDepth = 0;       // Filled buffers waiting for the disk
+        uint64_t writeQueuedBytes = 0;
+        uint64_t writeDroppedChunks = 0;    // Chunks lost because the disk fell too far behind
+        uint32_t writeCheckpoints = 0;      // Group syncs of the capture files
+        double lastCheckpointMs = 0.0;      // Duration of the last one
+        
+        // Audio compression
+        uint64_t audioBytesCaptured = 0;    // As raw float32
+        uint64_t audioBytesStored = 0;      // After the codec
+        double compressionRatio = 1.0;      // Captured / stored
         juce::Time startTime;
         juce::Time lastUpdateTime;
     };
     
     CaptureStats getStats() const;
     
+    /**
+     * Per-panner capture backlog, one entry per running capture worker
+     */
+    struct PannerCaptureStats
+    {
+        juce::String name;
+        uint32_t processId = 0;
+        uint64_t pendingBlocks = 0;      // Published but not yet captured, at the last wake-up
+        uint64_t maxPendingBlocks = 0;   // Highest backlog seen since the worker started
+        uint64_t blocksCaptured = 0;
+        uint64_t allocations = 0;        // Heap allocations while capturing
+        bool eventDriven = false;        // Woken by the panner's doorbell (false = polling)
+    };
+    
+    std::vector<PannerCaptureStats> getPannerStats() const;
+    
+    //==========================================================================
+    // Compression
+    
+    /**
+     * Codec for newly written chunk audio (default ChunkCodec::FloatPredictive)
+     * Chunks that do not compress are stored raw either way.
+     */
+    void setAudioCodec(ChunkCodec::Type codec) { m_audioCodec = codec; }
+    ChunkCodec::Type getAudioCodec() const { return m_audioCodec.load(); }
+    
+    //==========================================================================
+    // Segments
+    
+    /**
+     * When a panner's chunk file rotates to a new segment (default 256 MB or 5 minutes)
+     * @param maxBytes Chunk bytes per segment (0 = no size limit)
+     * @param maxSeconds Capture time per segment (0 = no time limit)
+     */
+    void setSegmentLimits(uint64_t maxBytes, int maxSeconds)
+    {
+        m_segmentMaxBytes = maxBytes;
+        m_segmentMaxSeconds = maxSeconds;
+    }
+    
+    //==========================================================================
+    // Durability
+    
+    /**
+     * How often everything written so far is synced to disk (default 1000 ms, 0 = leave
+     * it to the OS). Bounds what a crash or power loss can take; each chunk carries a
+     * checksum, so SessionRecovery finds where the intact data ends.
+     */
+    void setCheckpointInterval(int milliseconds) { m_chunkWriter.setSyncInterval(milliseconds); }
+    
     //==========================================================================
     // Debug mode
     
@@ -210,8 +249,33 @@ protected:
     void run() override;
     
 private:
+    // Memory share consumer IDs: the tracker's ID on legacy segments, our own cursor on ring segments
+    static constexpr uint32_t LEGACY_CONSUMER_ID = 9001;
+    static constexpr uint32_t CAPTURE_CONSUMER_ID = 9002;
+    static constexpr int MAX_BLOCKS_PER_PASS = 64;
+    
+    // Worker pacing: poll interval for panners without a doorbell, and the longest doorbell
+    // wait (bounds how long stopping a worker takes)
+    static constexpr int POLL_INTERVAL_MS = 5;
+    static constexpr int IDLE_WAIT_MS = 50;
+    
+    // How often the engine thread matches workers to the tracked panners
+    static constexpr int SCHEDULE_INTERVAL_MS = 20;
+    
+    // How often the engine thread appends the coverage's changes to the session's coverage file
+    static constexpr int COVERAGE_SAVE_INTERVAL_MS = 1000;
+    
+    // How often the engine thread logs its panners and workers (debug builds)
+    static constexpr int SUMMARY_INTERVAL_MS = 5000;
+    
+    // Write buffers for the index (24 bytes per chunk) and state stream (only on changes)
+    static constexpr size_t INDEX_BUFFER_SIZE = 64 * 1024;
+    static constexpr size_t STATE_BUFFER_SIZE = 64 * 1024;
+    
     PannerTrackingManager& m_pannerManager;
     CoverageModel m_coverageModel;
+    CoverageStore m_coverageStore;  // Written by the engine thread while capturing
+    ChunkWriter m_chunkWriter;      // Declared before the panner states, whose streams it writes
     
     // Capture state
     std::atomic<bool> m_capturing{false};
@@ -223,10 +287,30 @@ private:
     juce::CriticalSection m_stateMutex;
     std::map<std::string, PannerCaptureState> m_pannerStates;
     
+    // Per-panner capture workers, keyed like m_pannerStates (added and removed by the engine thread)
+    class PannerWorker;
+    mutable juce::CriticalSection m_workersMutex;
+    std::map<std::string, std::unique_ptr<PannerWorker>> m_workers;
+    
+    // Panners updateWorkers could not connect to since the last summary, by process ID (engine thread only)
+    std::map<uint32_t, juce::String> m_unconnectedPanners;
+    
     // Statistics
     std::atomic<uint32_t> m_totalChunksWritten{0};
     std::atomic<uint64_t> m_totalBytesWritten{0};
     std::atomic<uint32_t> m_totalDropoutsDetected{0};
+    std::atomic<uint32_t> m_stateChangesWritten{0};
+    std::atomic<uint64_t> m_captureAllocations{0};
+    std::atomic<uint32_t> m_segmentsSealed{0};
+    std::atomic<uint64_t> m_audioBytesCaptured{0};
+    std::atomic<uint64_t> m_audioBytesStored{0};
+    
+    std::atomic<ChunkCodec::Type> m_audioCodec{ChunkCodec::FloatPredictive};
+    std::atomic<uint64_t> m_segmentMaxBytes{256 * 1024 * 1024};
+    std::atomic<int> m_segmentMaxSeconds{300};
+    
+    // Set by the capture workers, sent as a change message by the engine thread
+    std::atomic<bool> m_changePending{false};
     
     // Debug mode
     bool m_debugFakeBlocks = false;
@@ -234,19 +318,27 @@ private:
     uint32_t m_debugSequenceNumber = 0;
     
     // Processing
-    void processCapture();
-    void processPannerData(const PannerInfo& panner);
-    void writeChunk(PannerCaptureState& state, const ChunkHeader& header,
-                   const StateSnapshot& snapshot, const float* audioData);
+    void updateWorkers();
+    void logSummary();
+    void stopAllWorkers();
+    std::unique_ptr<M1MemoryShare> openWorkerConnection(const PannerInfo& panner);
+    bool drainPanner(PannerWorker& worker);
+    bool writeChunk(PannerCaptureState& state, ChunkHeader header,
+                   const StateSnapshot& snapshot, const void* audioData);
+    void writeStateChange(PannerCaptureState& state, const ChunkHeader& header, const StateSnapshot& snapshot);
     
     // Panner state management
     PannerCaptureState& getOrCreatePannerState(const PannerId& pannerId);
+    bool openSegment(PannerCaptureState& state, uint32_t segmentNumber);
+    void sealSegment(PannerCaptureState& state);
+    bool shouldRotateSegment(const PannerCaptureState& state, uint64_t chunkBytes) const;
     void closePannerState(PannerCaptureState& state);
     void closeAllPannerStates();
     
     // Helpers
     PannerId createPannerId(const PannerInfo& panner) const;
     StateSnapshot createStateSnapshot(const PannerInfo& panner) const;
+    static void applyBlockParameters(const ParameterMap& parameters, StateSnapshot& snapshot);
     juce::File getPannerCaptureDir(const PannerId& pannerId) const;
     
     // Debug fake data generation
@@ -0,0 +1,120 @@
+/*
+    CapturedIntervalSet.cpp
+    -----------------------
+    Implementation of the ordered, merging interval set.
+*/
+
+#include "CapturedIntervalSet.h"
+
+namespace Mach1 {
+
+namespace {
+
+/**
+ * First interval of tree that ends after sample (the one holding it, or the next one)
+ */
+template <typename Tree>
+typename Tree::const_iterator findFirstEndingAfter(const Tree& tree, int64_t sample)
+{
+    auto it = tree.upper_bound(sample);
+    if (it != tree.begin())
+    {
+        auto previous = std::prev(it);
+        if (previous->second > sample)
+            return previous;
+    }
+    return it;
+}
+
+} // namespace
+
+//==============================================================================
+void CapturedIntervalSet::addInterval(int64_t start, int64_t end)
+{
+    addInterval(start, end, [](int64_t, int64_t) {});
+}
+
+std::vector<SampleInterval> CapturedIntervalSet::getIntervals() const
+{
+    return std::vector<SampleInterval>(begin(), end());
+}
+
+std::vector<SampleInterval> CapturedIntervalSet::getIntervalsInRange(const SampleInterval& range) const
+{
+    std::vector<SampleInterval> intervals;
+    if (range.isEmpty())
+        return intervals;
+
+    for (auto it = findFirstEndingAfter(m_intervals, range.start);
+         it != m_intervals.end() && it->first < range.end; ++it)
+    {
+        intervals.emplace_back(std::max(it->first, range.start), std::min(it->second, range.end));
+    }
+    return intervals;
+}
+
+int64_t CapturedIntervalSet::getCoveredSamples(const SampleInterval& range) const
+{
+    if (range.isEmpty())
+        return 0;
+
+    int64_t covered = 0;
+    for (auto it = findFirstEndingAfter(m_intervals, range.start);
+         it != m_intervals.end() && it->first < range.end; ++it)
+    {
+        covered += std::min(it->second, range.end) - std::max(it->first, range.start);
+    }
+    return covered;
+}
+
+bool CapturedIntervalSet::isCovered(int64_t sample) const
+{
+    return findContaining(sample) != m_intervals.end();
+}
+
+bool CapturedIntervalSet::isCovered(const SampleInterval& range) const
+{
+    if (range.isEmpty())
+        return true;
+
+    // Intervals never touch, so a covered range lies within one of them
+    auto it = findContaining(range.start);
+    return it != m_intervals.end() && it->second >= range.end;
+}
+
+SampleInterval CapturedIntervalSet::getBoundingInterval() const
+{
+    if (m_intervals.empty())
+        return SampleInterval(0, 0);
+
+    return SampleInterval(m_intervals.begin()->first, m_intervals.rbegin()->second);
+}
+
+std::vector<SampleInterval> CapturedIntervalSet::getGaps() const
+{
+    std::vector<SampleInterval> gaps;
+
+    if (m_intervals.size() < 2)
+        return gaps;
+
+    gaps.reserve(m_intervals.size() - 1);
+    auto previous = m_intervals.begin();
+    for (auto it = std::next(previous); it != m_intervals.end(); previous = it++)
+        gaps.emplace_back(previous->second, it->first);
+
+    return gaps;
+}
+
+void CapturedIntervalSet::clear()
+{
+    m_intervals.clear();
+    m_totalSamples = 0;
+}
+
+CapturedIntervalSet::Tree::const_iterator CapturedIntervalSet::findContaining(int64_t sample) const
+{
+    auto it = findFirstEndingAfter(m_intervals, sample);
+    return it != m_intervals.end() && it->first <= sample ? it : m_intervals.end();
+}
+
+} // namespace Mach1
@@ -0,0 +1,259 @@
+/*
+    CapturedIntervalSet.h
+    ---------------------
+    Union of captured [start, end) sample intervals, kept merged and ordered.
+
+    The intervals live in a balanced tree (std::map, start -> end), so:
+    - addInterval is O(log n) amortised: one lookup, then the intervals the new one
+      overlaps or touches are folded into it (each interval is folded away at most once)
+    - adding next to or past the last interval (what capture does block after block) is
+      O(1): the last interval is extended in place, or a new one is appended at the end,
+      without a lookup and, when extending, without allocating
+    - isCovered, getCoveredSamples and getIntervalsInRange are O(log n) (+ the intervals
+      they return or visit)
+    - the total captured sample count and the bounding interval are O(1)
+
+    Plain C++ (no JUCE).
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Represents a sample interval [start, end)
+ */
+struct SampleInterval
+{
+    int64_t start = 0;  // Inclusive
+    int64_t end = 0;    // Exclusive
+
+    SampleInterval() = default;
+    SampleInterval(int64_t s, int64_t e) : start(s), end(e) {}
+
+    int64_t length() const { return end - start; }
+    bool isEmpty() const { return end <= start; }
+    bool contains(int64_t sample) const { return sample >= start && sample < end; }
+    bool overlaps(const SampleInterval& other) const {
+        return start < other.end && other.start < end;
+    }
+    bool adjacentTo(const SampleInterval& other) const {
+        return end == other.start || other.end == start;
+    }
+    bool canMerge(const SampleInterval& other) const {
+        return overlaps(other) || adjacentTo(other);
+    }
+
+    SampleInterval merge(const SampleInterval& other) const {
+        return SampleInterval(std::min(start, other.start), std::max(end, other.end));
+    }
+
+    bool operator<(const SampleInterval& other) const {
+        return start < other.start || (start == other.start && end < other.end);
+    }
+
+    bool operator==(const SampleInterval& other) const {
+        return start == other.start && end == other.end;
+    }
+};
+
+//==============================================================================
+/**
+ * A set of sample intervals with automatic merging of overlapping/adjacent intervals.
+ * Iterates its intervals in order, as SampleInterval values.
+ */
+class CapturedIntervalSet
+{
+    using Tree = std::map<int64_t, int64_t>;   // start -> end, disjoint and never touching
+
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = SampleInterval;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = SampleInterval;
+
+        const_iterator() = default;
+        explicit const_iterator(Tree::const_iterator it) : m_it(it) {}
+
+        SampleInterval operator*() const { return SampleInterval(m_it->first, m_it->second); }
+        const_iterator& operator++() { ++m_it; return *this; }
+        const_iterator operator++(int) { auto old = *this; ++m_it; return old; }
+        const_iterator& operator--() { --m_it; return *this; }
+        const_iterator operator--(int) { auto old = *this; --m_it; return old; }
+        bool operator==(const const_iterator& other) const { return m_it == other.m_it; }
+        bool operator!=(const const_iterator& other) const { return m_it != other.m_it; }
+
+    private:
+        Tree::const_iterator m_it;
+    };
+
+    CapturedIntervalSet() = default;
+
+    /**
+     * Add an interval [start, end) to the set, merging with existing intervals as needed.
+     */
+    void addInterval(int64_t start, int64_t end);
+    void addInterval(const SampleInterval& interval) { addInterval(interval.start, interval.end); }
+
+    /**
+     * Add an interval, calling onAdded(start, end) for each stretch of it that was not
+     * covered yet, in order (what the set gained; nothing if it was already covered)
+     */
+    template <typename Callback>
+    void addInterval(int64_t start, int64_t end, Callback&& onAdded);
+
+    const_iterator begin() const { return const_iterator(m_intervals.begin()); }
+    const_iterator end() const { return const_iterator(m_intervals.end()); }
+
+    /**
+     * Get all intervals (sorted, non-overlapping); a copy, so prefer iterating the set
+     */
+    std::vector<SampleInterval> getIntervals() const;
+
+    /**
+     * Get the intervals that overlap range, clipped to it
+     */
+    std::vector<SampleInterval> getIntervalsInRange(const SampleInterval& range) const;
+
+    /**
+     * Get total captured samples (sum of all interval lengths)
+     */
+    int64_t getTotalCapturedSamples() const { return m_totalSamples; }
+
+    /**
+     * Get the captured samples within range
+     */
+    int64_t getCoveredSamples(const SampleInterval& range) const;
+
+    /**
+     * Check if a sample position is covered
+     */
+    bool isCovered(int64_t sample) const;
+
+    /**
+     * Check if every sample of range is covered
+     */
+    bool isCovered(const SampleInterval& range) const;
+
+    /**
+     * Get the range covered by all intervals
+     */
+    SampleInterval getBoundingInterval() const;
+
+    /**
+     * Get gaps (uncovered intervals) within the bounding range
+     */
+    std::vector<SampleInterval> getGaps() const;
+
+    /**
+     * Clear all intervals
+     */
+    void clear();
+
+    /**
+     * Get number of discrete intervals
+     */
+    size_t getIntervalCount() const { return m_intervals.size(); }
+    bool isEmpty() const { return m_intervals.empty(); }
+
+private:
+    Tree m_intervals;
+    int64_t m_totalSamples = 0;
+
+    /**
+     * The interval containing sample, or m_intervals.end()
+     */
+    Tree::const_iterator findContaining(int64_t sample) const;
+};
+
+//==============================================================================
+template <typename Callback>
+void CapturedIntervalSet::addInterval(int64_t start, int64_t end, Callback&& onAdded)
+{
+    if (end <= start) return;  // Invalid interval
+
+    // Fast path: at or after the start of the last interval, as capture adds blocks
+    if (!m_intervals.empty())
+    {
+        auto last = std::prev(m_intervals.end());
+        if (start >= last->first)
+        {
+            if (start <= last->second)
+            {
+                if (end > last->second)
+                {
+                    onAdded(last->second, end);
+                    m_totalSamples += end - last->second;
+                    last->second = end;
+                }
+            }
+            else
+            {
+                m_intervals.emplace_hint(m_intervals.end(), start, end);
+                m_totalSamples += end - start;
+                onAdded(start, end);
+            }
+            return;
+        }
+    }
+
+    // The first interval that overlaps or touches [start, end), if any
+    auto it = m_intervals.upper_bound(start);
+    if (it != m_intervals.begin() && std::prev(it)->second >= start)
+        --it;
+
+    // It starts at or before start: extend it in place, folding in what it now reaches
+    if (it != m_intervals.end() && it->first <= start)
+    {
+        int64_t covered = it->second;   // Everything before this is in the set
+        auto next = std::next(it);
+        while (next != m_intervals.end() && next->first <= end)
+        {
+            if (next->first > covered)
+                onAdded(covered, next->first);
+            covered = std::max(covered, next->second);
+            m_totalSamples -= next->second - next->first;
+            next = m_intervals.erase(next);
+        }
+        if (end > covered)
+        {
+            onAdded(covered, end);
+            covered = end;
+        }
+        m_totalSamples += covered - it->second;
+        it->second = covered;
+        return;
+    }
+
+    // Otherwise every interval it reaches starts after start: replace them with one
+    int64_t covered = start;
+    while (it != m_intervals.end() && it->first <= end)
+    {
+        if (it->first > covered)
+            onAdded(covered, it->first);
+        covered = std::max(covered, it->second);
+        m_totalSamples -= it->second - it->first;
+        it = m_intervals.erase(it);
+    }
+    if (end > covered)
+    {
+        onAdded(covered, end);
+        covered = end;
+    }
+    m_intervals.emplace_hint(it, start, covered);
+    m_totalSamples += covered - start;
+}
+
+} // namespace Mach1
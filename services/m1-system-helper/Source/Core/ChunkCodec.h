@@ -0,0 +1,372 @@
+/*
+    ChunkCodec.h
+    ------------
+    Lossless codec for the float32 audio in captured chunks.
+
+    Works like FLAC, on the bit patterns of the floats:
+    - each sample's sign and magnitude bits are mapped to a two's complement integer,
+      which is exact (every float, NaNs and -0.0 included, round-trips bit for bit) and
+      keeps neighbouring values close together
+    - each channel picks the fixed predictor (order 0, 1 or 2) with the smallest residuals
+    - residuals are coded in partitions of PARTITION_SIZE samples: low bits that are zero
+      across the whole partition are dropped (float audio from 16/24-bit sources has many),
+      the rest is Rice coded, and silent partitions cost 5 bits
+    - a chunk whose encoding would not be smaller than raw float32 is stored raw
+
+    Plain C++ (no JUCE), no allocation.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Encoder/decoder for interleaved float32 chunk audio
+ */
+class ChunkCodec
+{
+public:
+    /**
+     * How a chunk's audio is stored (ChunkHeader::codec)
+     */
+    enum Type : int16_t
+    {
+        Raw = 0,                // Interleaved float32 as captured
+        FloatPredictive = 1     // This codec
+    };
+
+    static constexpr uint32_t PARTITION_SIZE = 32;
+
+    /**
+     * Encode interleaved float32 audio
+     * @param capacity Bytes available at output; encoding stops once it would not fit
+     * @return Encoded size, or 0 if it does not fit in capacity (store the audio raw)
+     */
+    static size_t encode(const float* interleaved, uint32_t numChannels, uint32_t numSamples,
+                         uint8_t* output, size_t capacity)
+    {
+        if (numChannels == 0 || numSamples == 0)
+            return 0;
+
+        BitWriter writer(output, capacity);
+        for (uint32_t channel = 0; channel < numChannels && !writer.overflow; ++channel)
+        {
+            const ChannelView samples { interleaved + channel, numChannels };
+            const int order = chooseOrder(samples, numSamples);
+            writer.write(static_cast<uint64_t>(order), 2);
+
+            for (uint32_t start = 0; start < numSamples && !writer.overflow; start += PARTITION_SIZE)
+            {
+                const uint32_t end = start + PARTITION_SIZE < numSamples ? start + PARTITION_SIZE : numSamples;
+                encodePartition(samples, order, start, end, writer);
+            }
+        }
+
+        return writer.finish();
+    }
+
+    /**
+     * Decode audio written by encode()
+     * @return false if the data is truncated or corrupt
+     */
+    static bool decode(const uint8_t* input, size_t size, uint32_t numChannels, uint32_t numSamples, float* interleaved)
+    {
+        BitReader reader(input, size);
+        for (uint32_t channel = 0; channel < numChannels; ++channel)
+        {
+            float* samples = interleaved + channel;
+            const int order = static_cast<int>(reader.read(2));
+            if (order > 2)
+                return false;
+
+            uint32_t previous1 = 0, previous2 = 0;
+            for (uint32_t start = 0; start < numSamples; start += PARTITION_SIZE)
+            {
+                const uint32_t end = start + PARTITION_SIZE < numSamples ? start + PARTITION_SIZE : numSamples;
+                const uint32_t k = reader.read(5);
+                const uint32_t shift = k == ZERO_PARTITION ? 0 : reader.read(5);
+
+                for (uint32_t i = start; i < end; ++i)
+                {
+                    uint32_t residual = 0;
+                    if (k != ZERO_PARTITION)
+                    {
+                        reader.refill();
+                        const uint32_t q = countTrailingOnes(reader.peek());
+                        uint32_t folded;
+                        if (q >= ESCAPE_QUOTIENT)
+                        {
+                            reader.skip(ESCAPE_QUOTIENT);
+                            folded = reader.read(32);
+                        }
+                        else
+                        {
+                            reader.skip(q + 1);
+                            folded = (q << k) | reader.read(k);
+                        }
+                        residual = unfold(folded) << shift;
+                    }
+
+                    const uint32_t value = predict(order, previous1, previous2) + residual;
+                    samples[static_cast<size_t>(i) * numChannels] = toFloat(value);
+                    previous2 = previous1;
+                    previous1 = value;
+                }
+
+                if (reader.isOverrun())
+                    return false;
+            }
+        }
+
+        return !reader.isOverrun();
+    }
+
+private:
+    static constexpr uint32_t ZERO_PARTITION = 31;     // Rice parameter value marking an all-zero partition
+    static constexpr uint32_t MAX_RICE_PARAMETER = 30;
+    static constexpr uint32_t ESCAPE_QUOTIENT = 24;    // Unary prefix of a residual stored as 32 raw bits
+
+    struct ChannelView
+    {
+        const float* data;
+        uint32_t stride;
+
+        uint32_t operator[](uint32_t i) const { return toInteger(data[static_cast<size_t>(i) * stride]); }
+    };
+
+    //==========================================================================
+    struct BitWriter
+    {
+        uint8_t* output;
+        size_t capacity;
+        size_t position = 0;
+        uint64_t accumulator = 0;
+        uint32_t bits = 0;
+        bool overflow = false;
+
+        BitWriter(uint8_t* out, size_t size) : output(out), capacity(size) {}
+
+        // count <= 56
+        void write(uint64_t value, uint32_t count)
+        {
+            accumulator |= value << bits;
+            bits += count;
+            while (bits >= 8)
+            {
+                if (position == capacity)
+                {
+                    overflow = true;
+                    bits = 0;
+                    return;
+                }
+                output[position++] = static_cast<uint8_t>(accumulator);
+                accumulator >>= 8;
+                bits -= 8;
+            }
+        }
+
+        size_t finish()
+        {
+            if (bits > 0 && !overflow)
+                write(0, 8 - bits);
+            return overflow ? 0 : position;
+        }
+    };
+
+    struct BitReader
+    {
+        const uint8_t* input;
+        size_t size;
+        size_t position = 0;
+        uint64_t accumulator = 0;
+        uint32_t bits = 0;
+        uint64_t consumedBits = 0;
+
+        BitReader(const uint8_t* in, size_t length) : input(in), size(length) {}
+
+        // Guarantees at least 57 bits to peek at (zeros past the end)
+        void refill()
+        {
+            while (bits <= 56)
+            {
+                const uint64_t byte = position < size ? input[position] : 0u;
+                accumulator |= byte << bits;
+                ++position;
+                bits += 8;
+            }
+        }
+
+        uint64_t peek() const { return accumulator; }
+
+        void skip(uint32_t count)
+        {
+            accumulator >>= count;
+            bits -= count;
+            consumedBits += count;
+        }
+
+        // count <= 32
+        uint32_t read(uint32_t count)
+        {
+            if (count == 0)
+                return 0;
+            refill();
+            const uint32_t value = static_cast<uint32_t>(accumulator & ((uint64_t(1) << count) - 1));
+            skip(count);
+            return value;
+        }
+
+        bool isOverrun() const { return consumedBits > static_cast<uint64_t>(size) * 8; }
+    };
+
+    //==========================================================================
+    // Float bits <-> integers: sign and magnitude to two's complement, -0.0 to the unused INT32_MIN
+
+    static uint32_t toInteger(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        const uint32_t magnitude = bits & 0x7FFFFFFFu;
+        if ((bits & 0x80000000u) == 0)
+            return magnitude;
+        return magnitude == 0 ? 0x80000000u : 0u - magnitude;
+    }
+
+    static float toFloat(uint32_t value)
+    {
+        uint32_t bits;
+        if (value == 0x80000000u)
+            bits = 0x80000000u;
+        else if ((value & 0x80000000u) != 0)
+            bits = 0x80000000u | (0u - value);
+        else
+            bits = value;
+
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    // Fixed predictors in wrapping unsigned arithmetic (every residual is exact)
+    static uint32_t predict(int order, uint32_t previous1, uint32_t previous2)
+    {
+        return order == 0 ? 0u : (order == 1 ? previous1 : 2u * previous1 - previous2);
+    }
+
+    // Zigzag: small negative and positive residuals both become small codes
+    static uint32_t fold(uint32_t residual) { return (residual << 1) ^ (0u - (residual >> 31)); }
+    static uint32_t unfold(uint32_t folded) { return (folded >> 1) ^ (0u - (folded & 1u)); }
+
+    static int chooseOrder(const ChannelView& samples, uint32_t numSamples)
+    {
+        uint64_t cost[3] = {};
+        uint32_t previous1 = 0, previous2 = 0;
+        for (uint32_t i = 0; i < numSamples; ++i)
+        {
+            const uint32_t value = samples[i];
+            for (int order = 0; order < 3; ++order)
+                cost[order] += fold(value - predict(order, previous1, previous2)) >> 1;
+            previous2 = previous1;
+            previous1 = value;
+        }
+
+        int best = 0;
+        for (int order = 1; order < 3; ++order)
+            if (cost[order] < cost[best])
+                best = order;
+        return best;
+    }
+
+    static void encodePartition(const ChannelView& samples, int order, uint32_t start, uint32_t end, BitWriter& writer)
+    {
+        uint32_t residuals[PARTITION_SIZE];
+        const uint32_t count = end - start;
+
+        uint32_t previous1 = start >= 1 ? samples[start - 1] : 0u;
+        uint32_t previous2 = start >= 2 ? samples[start - 2] : 0u;
+        uint32_t anyBits = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const uint32_t value = samples[start + i];
+            residuals[i] = value - predict(order, previous1, previous2);
+            anyBits |= residuals[i];
+            previous2 = previous1;
+            previous1 = value;
+        }
+
+        if (anyBits == 0)
+        {
+            writer.write(ZERO_PARTITION, 5);
+            return;
+        }
+
+        // Drop the low bits that are zero in every residual, then pick the Rice parameter
+        // from the mean: k = floor(log2(mean))
+        const uint32_t shift = countTrailingZeros(anyBits);
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            residuals[i] = fold(static_cast<uint32_t>(static_cast<int32_t>(residuals[i]) >> shift));
+            sum += residuals[i];
+        }
+
+        const uint64_t mean = sum / count;
+        uint32_t k = 0;
+        while (k < MAX_RICE_PARAMETER && (uint64_t(2) << k) <= mean)
+            ++k;
+
+        writer.write(k | (shift << 5), 10);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const uint32_t q = residuals[i] >> k;
+            if (q >= ESCAPE_QUOTIENT)
+            {
+                writer.write((uint64_t(1) << ESCAPE_QUOTIENT) - 1, ESCAPE_QUOTIENT);
+                writer.write(residuals[i], 32);
+            }
+            else
+            {
+                // q ones, a zero, then the low k bits
+                const uint64_t low = residuals[i] & ((uint64_t(1) << k) - 1);
+                writer.write(((uint64_t(1) << q) - 1) | (low << (q + 1)), q + 1 + k);
+            }
+        }
+    }
+
+    static uint32_t countTrailingOnes(uint64_t value)
+    {
+        const uint64_t zeros = ~value;
+        if (zeros == 0)
+            return 64;
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, zeros);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(zeros));
+#endif
+    }
+
+    static uint32_t countTrailingZeros(uint32_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, value);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+    }
+};
+
+} // namespace Mach1
@@ -0,0 +1,237 @@
+/*
+    ChunkFormat.h
+    -------------
+    On-disk layout of the capture engine's chunk files.
+    
+    A panner's capture is split into segments chunks_0000.bin, chunks_0001.bin, ...
+    (see ChunkSegments.h), each with its own sidecars (chunks_NNNN.idx, state_NNNN.bin).
+    Sessions captured before segmenting have a single chunks.bin. Chunk files are
+    append-only; each chunk is
+        ChunkHeader | StateSnapshot (stateSize bytes) | audio (audioDataSize bytes)
+    and a segment the capture engine finished with ends with a SegmentFooter (sealed).
+    
+    The audio is interleaved float32 (numChannels * numSamples) when ChunkHeader::codec
+    is ChunkCodec::Raw, or that audio losslessly encoded by ChunkCodec (version 2).
+    Version 3 chunks also carry a CRC-32C (Crc32c.h), so a chunk torn by a crash, or
+    one whose header made it to disk without its audio, is told apart from a good one.
+    
+    Chunks written with stateSize 0 carry no snapshot: panner state lives in the state
+    stream instead, written only when it changes:
+        StateStreamHeader | (StateRecordHeader | changed field values) * n   (state.bin)
+    
+    chunks.idx is the seek index sidecar:
+        ChunkIndexHeader | ChunkIndexEntry * n   (in write order)
+    
+    The session folder holds the session's coverage (see CoverageStore.h):
+        CoverageFileHeader | (CoverageRecordHeader | panner record) * n   (coverage.m1cov)
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * State snapshot captured alongside audio data
+ */
+struct StateSnapshot
+{
+    // Spatial parameters
+    float azimuthDeg = 0.0f;
+    float elevationDeg = 0.0f;
+    float diverge = 0.0f;
+    float gainDb = 0.0f;
+    
+    // Stereo parameters
+    float stereoOrbitAzimuth = 0.0f;
+    float stereoSpread = 0.0f;
+    float stereoInputBalance = 0.0f;
+    bool autoOrbit = false;
+    
+    // Mode settings
+    int32_t inputMode = 0;
+    int32_t outputMode = 0;
+    int32_t pannerMode = 0;
+    
+    // Sequence tracking
+    uint32_t stateSeq = 0;
+    uint64_t captureTimestampMs = 0;
+    
+    // GAIN_COMPENSATION_MODE as PannerEncodeSettings::gainCompensation + 1: 0 = not captured
+    // (captures from before it was recorded, whose padding reads 0), 1 = off, 2 = on
+    int32_t gainCompensation = 0;
+    
+    // Padding for alignment and future expansion
+    uint8_t reserved[20] = {0};
+    
+    static constexpr size_t SIZE = 80;  // Fixed size for binary storage
+};
+static_assert(sizeof(StateSnapshot) == StateSnapshot::SIZE, "StateSnapshot size mismatch");
+
+//==============================================================================
+/**
+ * Header for each captured chunk in the binary file
+ */
+struct ChunkHeader
+{
+    // Magic number for validation
+    uint32_t magic = MAGIC;       // "M1CH"
+    uint32_t version = 1;         // 1: raw audio; 2: audio may be encoded (see codec); 3: and checksummed
+    
+    // Audio metadata
+    int64_t startSample = 0;
+    int32_t numSamples = 0;
+    int16_t numChannels = 0;
+    int16_t codec = 0;            // ChunkCodec::Type of the audio data
+    uint32_t sampleRate = 44100;
+    
+    // Tracking
+    uint64_t bufferId = 0;
+    uint32_t sequenceNumber = 0;
+    uint64_t dawTimestampMs = 0;
+    uint64_t wallClockMs = 0;
+    
+    // Data sizes
+    uint32_t stateSize = StateSnapshot::SIZE;   // 0: the state is in the state stream
+    uint32_t audioDataSize = 0;  // Stored bytes (numChannels * numSamples * sizeof(float) when raw)
+    
+    // CRC-32C of this header (with checksum 0) and the state and audio that follow (version 3)
+    uint32_t checksum = 0;
+    
+    // Padding for alignment
+    uint8_t reserved2[4] = {0};
+    
+    static constexpr uint32_t MAGIC = 0x4D314348;
+    static constexpr uint32_t VERSION_ENCODED = 2;
+    static constexpr uint32_t VERSION_CHECKSUM = 3;
+    static constexpr size_t SIZE = 80;  // Fixed size
+};
+static_assert(sizeof(ChunkHeader) == ChunkHeader::SIZE, "ChunkHeader size mismatch");
+
+//==============================================================================
+/**
+ * Header of a chunk index sidecar
+ */
+struct ChunkIndexHeader
+{
+    uint32_t magic = MAGIC;       // "M1CI"
+    uint32_t version = 1;         // 1: fixed-size ChunkIndexEntry records follow, in write order
+    uint32_t entrySize = 24;      // sizeof(ChunkIndexEntry)
+    uint32_t reserved = 0;
+    
+    static constexpr uint32_t MAGIC = 0x4D314349;
+    static constexpr size_t SIZE = 16;  // Fixed size
+};
+static_assert(sizeof(ChunkIndexHeader) == ChunkIndexHeader::SIZE, "ChunkIndexHeader size mismatch");
+
+/**
+ * One chunk in the index: where it sits in the timeline and in chunks.bin
+ */
+struct ChunkIndexEntry
+{
+    int64_t startSample = 0;
+    int32_t numSamples = 0;
+    uint32_t sequenceNumber = 0;
+    uint64_t byteOffset = 0;      // Offset of the ChunkHeader in chunks.bin
+    
+    int64_t endSample() const { return startSample + numSamples; }
+    
+    static constexpr size_t SIZE = 24;  // Fixed size
+};
+static_assert(sizeof(ChunkIndexEntry) == ChunkIndexEntry::SIZE, "ChunkIndexEntry size mismatch");
+
+//==============================================================================
+/**
+ * Header of a state stream (state.bin)
+ */
+struct StateStreamHeader
+{
+    uint32_t magic = MAGIC;       // "M1SS"
+    uint32_t version = 1;
+    uint32_t numFields = 12;      // StateTrack::NUM_FIELDS when written
+    uint32_t reserved = 0;
+    
+    static constexpr uint32_t MAGIC = 0x4D315353;
+    static constexpr size_t SIZE = 16;  // Fixed size
+};
+static_assert(sizeof(StateStreamHeader) == StateStreamHeader::SIZE, "StateStreamHeader size mismatch");
+
+/**
+ * One state change: followed by 4 bytes for each field set in changedFields, in field
+ * order (see StateTrack::Field). The first record a capture writes has every field set.
+ */
+struct StateRecordHeader
+{
+    uint16_t magic = MAGIC;       // "SR"
+    uint16_t changedFields = 0;   // Bit per StateTrack::Field
+    uint32_t stateSeq = 0;        // Sequence number of the first block captured with this state
+    int64_t samplePosition = 0;   // First sample captured with this state
+    uint64_t chunkOffset = 0;     // Offset in chunks.bin of the first chunk captured with this state
+    
+    static constexpr uint16_t MAGIC = 0x5253;
+    static constexpr size_t SIZE = 24;  // Fixed size
+};
+static_assert(sizeof(StateRecordHeader) == StateRecordHeader::SIZE, "StateRecordHeader size mismatch");
+
+//==============================================================================
+/**
+ * Last bytes of a sealed segment: what it holds, so readers can tell a finished segment
+ * from one still being written (or cut short) without scanning it
+ */
+struct SegmentFooter
+{
+    uint32_t magic = MAGIC;       // "M1SF"
+    uint32_t version = 1;
+    uint32_t segmentNumber = 0;
+    uint32_t chunkCount = 0;
+    uint64_t dataSize = 0;        // Bytes of chunks before the footer
+    int64_t startSample = 0;      // Lowest startSample of the segment's chunks
+    int64_t endSample = 0;        // Highest chunk end sample
+    uint64_t firstWallClockMs = 0;
+    uint64_t lastWallClockMs = 0;
+    uint32_t firstSequenceNumber = 0;
+    uint32_t lastSequenceNumber = 0;
+    
+    // Padding for alignment and future expansion
+    uint8_t reserved[16] = {0};
+    
+    static constexpr uint32_t MAGIC = 0x4D315346;
+    static constexpr size_t SIZE = 80;  // Fixed size
+};
+static_assert(sizeof(SegmentFooter) == SegmentFooter::SIZE, "SegmentFooter size mismatch");
+
+//==============================================================================
+/**
+ * Header of a session's coverage file (coverage.m1cov)
+ */
+struct CoverageFileHeader
+{
+    uint32_t magic = MAGIC;       // "M1CV"
+    uint32_t version = 1;
+    uint64_t reserved = 0;
+    
+    static constexpr uint32_t MAGIC = 0x4D314356;
+    static constexpr size_t SIZE = 16;  // Fixed size
+};
+static_assert(sizeof(CoverageFileHeader) == CoverageFileHeader::SIZE, "CoverageFileHeader size mismatch");
+
+/**
+ * One panner's coverage, or what changed in it: followed by payloadSize bytes of
+ * varint-coded fields (see CoverageStore.cpp)
+ */
+struct CoverageRecordHeader
+{
+    uint32_t magic = MAGIC;       // "M1CR"
+    uint32_t payloadSize = 0;
+    uint32_t checksum = 0;        // CRC-32C of the payload
+    uint32_t reserved = 0;
+    
+    static constexpr uint32_t MAGIC = 0x4D314352;
+    static constexpr size_t SIZE = 16;  // Fixed size
+};
+static_assert(sizeof(CoverageRecordHeader) == CoverageRecordHeader::SIZE, "CoverageRecordHeader size mismatch");
+
+} // namespace Mach1
@@ -0,0 +1,297 @@
+/*
+    ChunkIndex.cpp
+    --------------
+    Implementation of the chunk file seek index.
+*/
+
+#include "ChunkIndex.h"
+#include "Crc32c.h"
+#include <algorithm>
+
+namespace Mach1 {
+
+//==============================================================================
+juce::File ChunkIndex::getIndexFile(const juce::File& chunkFile)
+{
+    return chunkFile.withFileExtension("idx");
+}
+
+bool ChunkIndex::repair(const juce::File& chunkFile)
+{
+    std::vector<ChunkIndexEntry> entries;
+    return update(chunkFile, entries);
+}
+
+bool ChunkIndex::readSidecar(const juce::File& chunkFile, std::vector<ChunkIndexEntry>& entries)
+{
+    bool wellFormed = false;
+    entries.clear();
+    readEntries(getIndexFile(chunkFile), entries, wellFormed);
+    return wellFormed;
+}
+
+void ChunkIndex::collect(const juce::File& chunkFile, std::vector<ChunkIndexEntry>& entries)
+{
+    update(chunkFile, entries, false);
+}
+
+bool ChunkIndex::writeSidecar(const juce::File& chunkFile, const std::vector<ChunkIndexEntry>& entries)
+{
+    return writeEntries(getIndexFile(chunkFile), entries, 0);
+}
+
+bool ChunkIndex::load(const juce::File& chunkFile, bool repairSidecar)
+{
+    clear();
+
+    // Entries are usable even when the sidecar can't be written (read-only capture)
+    update(chunkFile, m_entries, repairSidecar);
+    build();
+
+    return chunkFile.existsAsFile();
+}
+
+void ChunkIndex::setEntries(std::vector<ChunkIndexEntry> entries)
+{
+    clear();
+    m_entries = std::move(entries);
+    build();
+}
+
+void ChunkIndex::build()
+{
+    std::stable_sort(m_entries.begin(), m_entries.end(),
+                     [](const ChunkIndexEntry& a, const ChunkIndexEntry& b) { return a.startSample < b.startSample; });
+
+    m_maxEndSample.reserve(m_entries.size());
+    int64_t maxEnd = INT64_MIN;
+    for (const auto& entry : m_entries)
+    {
+        maxEnd = std::max(maxEnd, entry.endSample());
+        m_maxEndSample.push_back(maxEnd);
+    }
+}
+
+void ChunkIndex::clear()
+{
+    m_entries.clear();
+    m_maxEndSample.clear();
+}
+
+int64_t ChunkIndex::getStartSample() const
+{
+    return m_entries.empty() ? 0 : m_entries.front().startSample;
+}
+
+int64_t ChunkIndex::getEndSample() const
+{
+    return m_maxEndSample.empty() ? 0 : m_maxEndSample.back();
+}
+
+//==============================================================================
+const ChunkIndexEntry* ChunkIndex::findChunk(int64_t sample) const
+{
+    // Walk back from the last chunk starting at or before sample; the running max end
+    // stops the walk as soon as no earlier chunk can reach the sample
+    for (size_t i = upperBound(sample); i > 0; --i)
+    {
+        if (m_maxEndSample[i - 1] <= sample)
+            break;
+
+        if (m_entries[i - 1].endSample() > sample)
+            return &m_entries[i - 1];
+    }
+
+    return nullptr;
+}
+
+void ChunkIndex::findChunks(int64_t startSample, int64_t endSample, std::vector<ChunkIndexEntry>& result) const
+{
+    result.clear();
+    if (endSample <= startSample)
+        return;
+
+    for (size_t i = upperBound(endSample - 1); i > 0; --i)
+    {
+        if (m_maxEndSample[i - 1] <= startSample)
+            break;
+
+        const auto& entry = m_entries[i - 1];
+        if (entry.numSamples > 0 && entry.endSample() > startSample)
+            result.push_back(entry);
+    }
+
+    std::reverse(result.begin(), result.end());
+}
+
+size_t ChunkIndex::upperBound(int64_t sample) const
+{
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), sample,
+                               [](int64_t value, const ChunkIndexEntry& entry) { return value < entry.startSample; });
+    return static_cast<size_t>(it - m_entries.begin());
+}
+
+//==============================================================================
+bool ChunkIndex::update(const juce::File& chunkFile, std::vector<ChunkIndexEntry>& entries, bool writeSidecar)
+{
+    juce::File indexFile = getIndexFile(chunkFile);
+
+    bool wellFormed = false;
+    entries.clear();
+    readEntries(indexFile, entries, wellFormed);
+
+    int64_t chunkFileSize = chunkFile.existsAsFile() ? chunkFile.getSize() : 0;
+    std::unique_ptr<juce::FileInputStream> input;
+    if (chunkFileSize > 0)
+    {
+        input = std::make_unique<juce::FileInputStream>(chunkFile);
+        if (!input->openedOk())
+        {
+            input.reset();
+            chunkFileSize = 0;
+        }
+    }
+
+    // Drop trailing entries whose chunk is not completely in the chunk file
+    size_t kept = entries.size();
+    ChunkHeader header;
+    std::vector<uint8_t> payload;
+    uint64_t scanOffset = 0;
+    while (kept > 0)
+    {
+        const auto& entry = entries[kept - 1];
+        if (input && readChunk(*input, static_cast<int64_t>(entry.byteOffset), chunkFileSize, header, payload)
+            && header.startSample == entry.startSample && header.sequenceNumber == entry.sequenceNumber)
+        {
+            scanOffset = entry.byteOffset + getChunkSize(header);
+            break;
+        }
+        --kept;
+    }
+
+    const size_t indexed = entries.size();
+    entries.resize(kept);
+
+    // Index whatever follows (stops at a torn chunk at the end of the file, or the segment footer)
+    while (input && readChunk(*input, static_cast<int64_t>(scanOffset), chunkFileSize, header, payload))
+    {
+        const uint64_t chunkSize = getChunkSize(header);
+
+        ChunkIndexEntry entry;
+        entry.startSample = header.startSample;
+        entry.numSamples = header.numSamples;
+        entry.sequenceNumber = header.sequenceNumber;
+        entry.byteOffset = scanOffset;
+        entries.push_back(entry);
+        scanOffset += chunkSize;
+    }
+
+    if (wellFormed && kept == indexed && entries.size() == kept)
+        return true;    // Already up to date
+
+    if (!writeSidecar)
+        return false;
+
+    // Keep the sidecar's valid prefix and append the rest; rewrite it if it was unusable
+    if (!writeEntries(indexFile, entries, wellFormed ? kept : 0))
+        return false;
+
+    DBG("[ChunkIndex] Updated " + indexFile.getFullPathName() + ": kept " + juce::String(static_cast<int>(kept))
+        + " of " + juce::String(static_cast<int>(indexed)) + " entries, indexed "
+        + juce::String(static_cast<int>(entries.size() - kept)) + " chunks");
+    return true;
+}
+
+bool ChunkIndex::writeEntries(const juce::File& indexFile, const std::vector<ChunkIndexEntry>& entries, size_t keep)
+{
+    const int64_t keepBytes = keep > 0 ? static_cast<int64_t>(ChunkIndexHeader::SIZE + keep * ChunkIndexEntry::SIZE) : 0;
+    juce::FileOutputStream output(indexFile);
+    if (!output.openedOk() || !output.setPosition(keepBytes) || output.truncate().failed())
+    {
+        DBG("[ChunkIndex] Failed to update index: " + indexFile.getFullPathName());
+        return false;
+    }
+
+    if (keep == 0)
+    {
+        ChunkIndexHeader indexHeader;
+        output.write(&indexHeader, ChunkIndexHeader::SIZE);
+    }
+
+    if (entries.size() > keep)
+        output.write(entries.data() + keep, (entries.size() - keep) * ChunkIndexEntry::SIZE);
+
+    output.flush();
+    return output.getStatus().wasOk();
+}
+
+void ChunkIndex::readEntries(const juce::File& indexFile, std::vector<ChunkIndexEntry>& entries, bool& wellFormed)
+{
+    wellFormed = false;
+    if (!indexFile.existsAsFile())
+        return;
+
+    juce::FileInputStream input(indexFile);
+    ChunkIndexHeader header;
+    if (!input.openedOk()
+        || input.read(&header, ChunkIndexHeader::SIZE) != static_cast<int>(ChunkIndexHeader::SIZE)
+        || header.magic != ChunkIndexHeader::MAGIC
+        || header.entrySize != ChunkIndexEntry::SIZE)
+        return;
+
+    const int64_t entryBytes = input.getTotalLength() - static_cast<int64_t>(ChunkIndexHeader::SIZE);
+    const size_t count = static_cast<size_t>(entryBytes / static_cast<int64_t>(ChunkIndexEntry::SIZE));
+    entries.resize(count);
+
+    // Read in blocks: InputStream::read takes an int
+    const size_t entriesPerRead = 1 << 20;
+    for (size_t i = 0; i < count; i += entriesPerRead)
+    {
+        const size_t n = std::min(entriesPerRead, count - i);
+        const int bytes = static_cast<int>(n * ChunkIndexEntry::SIZE);
+        if (input.read(entries.data() + i, bytes) != bytes)
+        {
+            entries.resize(i);
+            return;
+        }
+    }
+
+    // A torn record at the end means the sidecar needs rewriting
+    wellFormed = entryBytes % static_cast<int64_t>(ChunkIndexEntry::SIZE) == 0;
+}
+
+bool ChunkIndex::readChunkHeader(juce::FileInputStream& input, int64_t offset, int64_t fileSize, ChunkHeader& header)
+{
+    if (offset < 0 || offset + static_cast<int64_t>(ChunkHeader::SIZE) > fileSize || !input.setPosition(offset))
+        return false;
+
+    if (input.read(&header, ChunkHeader::SIZE) != static_cast<int>(ChunkHeader::SIZE))
+        return false;
+
+    return header.magic == ChunkHeader::MAGIC
+        && (header.stateSize == StateSnapshot::SIZE || header.stateSize == 0)
+        && header.numSamples >= 0;
+}
+
+bool ChunkIndex::readChunk(juce::FileInputStream& input, int64_t offset, int64_t fileSize, ChunkHeader& header,
+                           std::vector<uint8_t>& payload)
+{
+    if (!readChunkHeader(input, offset, fileSize, header)
+        || offset + static_cast<int64_t>(getChunkSize(header)) > fileSize)
+        return false;
+
+    // Header and size check out; a chunk with a checksum must match it too
+    if (header.version < ChunkHeader::VERSION_CHECKSUM)
+        return true;
+
+    payload.resize(static_cast<size_t>(header.stateSize) + header.audioDataSize);
+    return input.read(payload.data(), static_cast<int>(payload.size())) == static_cast<int>(payload.size())
+        && Crc32c::verifyChunk(header, payload.data(), payload.size());
+}
+
+uint64_t ChunkIndex::getChunkSize(const ChunkHeader& header)
+{
+    return ChunkHeader::SIZE + static_cast<uint64_t>(header.stateSize) + header.audioDataSize;
+}
+
+} // namespace Mach1
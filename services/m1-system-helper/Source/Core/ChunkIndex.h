@@ -0,0 +1,133 @@
+/*
+    ChunkIndex.h
+    ------------
+    Seek index for captured chunk files.
+
+    The capture engine appends one ChunkIndexEntry to chunks.idx for every chunk it
+    appends to chunks.bin. ChunkIndex loads that sidecar, sorted by sample position,
+    so export, waveform and verification tools can find the chunks covering a sample
+    range in O(log n) instead of walking every ChunkHeader.
+
+    The sidecar is disposable: repair() rebuilds it from chunks.bin when it is missing
+    or unreadable, and extends it when chunks were written without entries (a crash,
+    or a writer overrun). Only the unindexed tail of chunks.bin is scanned, and it ends at
+    the first chunk that is incomplete or fails its checksum.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChunkFormat.h"
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Sorted, searchable view of a chunk file's index
+ */
+class ChunkIndex
+{
+public:
+    /**
+     * Sidecar path for a chunk file (chunks.bin -> chunks.idx, chunks_NNNN.bin -> chunks_NNNN.idx)
+     */
+    static juce::File getIndexFile(const juce::File& chunkFile);
+
+    /**
+     * Bring the sidecar in line with the chunk file
+     * Drops entries for chunks that never reached the disk, then indexes any chunks
+     * past the last entry. A missing or corrupt sidecar is rebuilt from scratch.
+     * @return false if the sidecar could not be written
+     */
+    static bool repair(const juce::File& chunkFile);
+
+    /**
+     * Read a chunk file's sidecar as it is (write order)
+     * @return false if it is missing, corrupt or ends in a torn entry
+     */
+    static bool readSidecar(const juce::File& chunkFile, std::vector<ChunkIndexEntry>& entries);
+
+    /**
+     * The entries repair() would leave in the sidecar (write order), without writing it:
+     * the sidecar checked against the chunk file, and any chunks written past it
+     */
+    static void collect(const juce::File& chunkFile, std::vector<ChunkIndexEntry>& entries);
+
+    /**
+     * Replace a chunk file's sidecar with entries (write order)
+     */
+    static bool writeSidecar(const juce::File& chunkFile, const std::vector<ChunkIndexEntry>& entries);
+
+    /**
+     * Load a chunk file's index
+     * @param repairSidecar Also bring the sidecar up to date (see repair()); pass false
+     *                      to leave both files untouched, e.g. while still capturing
+     */
+    bool load(const juce::File& chunkFile, bool repairSidecar = true);
+    
+    /**
+     * Index entries given in write order (e.g. the chunks of several segments)
+     */
+    void setEntries(std::vector<ChunkIndexEntry> entries);
+
+    void clear();
+
+    /**
+     * Entries sorted by startSample (ties keep write order)
+     */
+    const std::vector<ChunkIndexEntry>& getEntries() const { return m_entries; }
+    size_t size() const { return m_entries.size(); }
+    bool isEmpty() const { return m_entries.empty(); }
+
+    /**
+     * Covered sample range [start, end) over all chunks
+     */
+    int64_t getStartSample() const;
+    int64_t getEndSample() const;
+
+    /**
+     * The chunk containing a sample; the latest-starting one where chunks overlap
+     * @return nullptr if no chunk covers the sample
+     */
+    const ChunkIndexEntry* findChunk(int64_t sample) const;
+
+    /**
+     * Every chunk overlapping [startSample, endSample), in startSample order
+     */
+    void findChunks(int64_t startSample, int64_t endSample, std::vector<ChunkIndexEntry>& result) const;
+
+private:
+    std::vector<ChunkIndexEntry> m_entries;
+    std::vector<int64_t> m_maxEndSample;     // Running max of endSample over m_entries
+
+    void build();
+
+    /**
+     * Index of the first entry starting after sample
+     */
+    size_t upperBound(int64_t sample) const;
+
+    /**
+     * repair() into entries (write order); entries are valid even if the sidecar can't be written
+     * @param writeSidecar false: only compute the entries
+     */
+    static bool update(const juce::File& chunkFile, std::vector<ChunkIndexEntry>& entries, bool writeSidecar = true);
+
+    static void readEntries(const juce::File& indexFile, std::vector<ChunkIndexEntry>& entries, bool& wellFormed);
+
+    /**
+     * Write entries from keep on after the first keep entries already in the sidecar (0: rewrite it)
+     */
+    static bool writeEntries(const juce::File& indexFile, const std::vector<ChunkIndexEntry>& entries, size_t keep);
+    static bool readChunkHeader(juce::FileInputStream& input, int64_t offset, int64_t fileSize, ChunkHeader& header);
+
+    /**
+     * Read a chunk's header and check that the whole chunk is in the file and matches its checksum
+     */
+    static bool readChunk(juce::FileInputStream& input, int64_t offset, int64_t fileSize, ChunkHeader& header,
+                          std::vector<uint8_t>& payload);
+    static uint64_t getChunkSize(const ChunkHeader& header);
+};
+
+} // namespace Mach1
@@ -0,0 +1,188 @@
+/*
+    ChunkReader.cpp
+    ---------------
+    Implementation of the chunk file reader.
+*/
+
+#include "ChunkReader.h"
+#include "ChunkCodec.h"
+#include "ChunkSegments.h"
+#include "Crc32c.h"
+#include <algorithm>
+
+namespace Mach1 {
+
+//==============================================================================
+bool ChunkReader::open(const juce::Array<juce::File>& chunkFiles)
+{
+    setSegments(chunkFiles);
+    for (size_t i = 0; i < m_segments.size(); ++i)
+        loadSegment(i);
+
+    return finishLoading();
+}
+
+bool ChunkReader::open(const juce::File& chunkFile)
+{
+    return open(juce::Array<juce::File>(chunkFile));
+}
+
+void ChunkReader::close()
+{
+    m_segments.clear();
+    m_index.clear();
+    m_open = false;
+}
+
+void ChunkReader::setSegments(const juce::Array<juce::File>& chunkFiles)
+{
+    close();
+    m_segments.resize(static_cast<size_t>(chunkFiles.size()));
+    for (size_t i = 0; i < m_segments.size(); ++i)
+        m_segments[i].file = chunkFiles[static_cast<int>(i)];
+}
+
+void ChunkReader::loadSegment(size_t index)
+{
+    Segment& segment = m_segments[index];
+
+    // Empty: the segment capture has only just started
+    if (!segment.file.existsAsFile() || segment.file.getSize() == 0)
+        return;
+
+    segment.index.load(segment.file, false);
+    segment.stateTrack.load(StateTrack::getStateFile(segment.file));
+
+    // Map after indexing so every indexed chunk lies inside the mapping
+    segment.map = std::make_unique<juce::MemoryMappedFile>(segment.file, juce::MemoryMappedFile::readOnly);
+    if (segment.map->getData() == nullptr)
+    {
+        DBG("[ChunkReader] Failed to map " + segment.file.getFullPathName());
+        segment.map.reset();
+        segment.index.clear();
+        return;
+    }
+
+    segment.size = static_cast<uint64_t>(segment.map->getSize());
+    if (segment.size >= SegmentFooter::SIZE)
+    {
+        SegmentFooter footer;
+        std::memcpy(&footer, static_cast<const uint8_t*>(segment.map->getData()) + segment.size - SegmentFooter::SIZE,
+                    SegmentFooter::SIZE);
+        segment.sealed = ChunkSegments::isValidFooter(footer, segment.size);
+    }
+}
+
+bool ChunkReader::finishLoading()
+{
+    // Lay the segments end to end; entries move to their stream offsets
+    std::vector<ChunkIndexEntry> entries;
+    uint64_t baseOffset = 0;
+    for (auto& segment : m_segments)
+    {
+        segment.baseOffset = baseOffset;
+        baseOffset += segment.size;
+        m_open = m_open || segment.map != nullptr;
+
+        for (auto entry : segment.index.getEntries())
+        {
+            entry.byteOffset += segment.baseOffset;
+            entries.push_back(entry);
+        }
+        segment.index.clear();
+    }
+
+    // Segments are in write order and each index keeps write order among equal starts
+    m_index.setEntries(std::move(entries));
+    return m_open;
+}
+
+//==============================================================================
+const ChunkReader::Segment* ChunkReader::findSegment(uint64_t offset, uint64_t& localOffset) const
+{
+    auto it = std::upper_bound(m_segments.begin(), m_segments.end(), offset,
+                               [](uint64_t value, const Segment& segment) { return value < segment.baseOffset; });
+    if (it == m_segments.begin())
+        return nullptr;
+
+    // Skip back over empty segments sharing the offset
+    --it;
+    while (it != m_segments.begin() && it->map == nullptr)
+        --it;
+    if (it->map == nullptr)
+        return nullptr;
+
+    localOffset = offset - it->baseOffset;
+    return &*it;
+}
+
+bool ChunkReader::readHeader(const ChunkIndexEntry& entry, ChunkHeader& header) const
+{
+    uint64_t localOffset = 0;
+    const Segment* segment = findSegment(entry.byteOffset, localOffset);
+    return segment != nullptr && readHeader(*segment, localOffset, header);
+}
+
+bool ChunkReader::readHeader(const Segment& segment, uint64_t localOffset, ChunkHeader& header) const
+{
+    if (localOffset + ChunkHeader::SIZE > segment.size)
+        return false;
+
+    std::memcpy(&header, static_cast<const uint8_t*>(segment.map->getData()) + localOffset, ChunkHeader::SIZE);
+
+    return header.magic == ChunkHeader::MAGIC
+        && (header.stateSize == StateSnapshot::SIZE || header.stateSize == 0)
+        && header.numChannels > 0
+        && header.numSamples >= 0
+        && localOffset + ChunkHeader::SIZE + header.stateSize + header.audioDataSize <= segment.size;
+}
+
+bool ChunkReader::read(const ChunkIndexEntry& entry, ChunkHeader& header, StateSnapshot* snapshot, std::vector<float>& audio) const
+{
+    uint64_t localOffset = 0;
+    const Segment* segment = findSegment(entry.byteOffset, localOffset);
+    if (segment == nullptr || !readHeader(*segment, localOffset, header))
+        return false;
+
+    const uint8_t* state = static_cast<const uint8_t*>(segment->map->getData()) + localOffset + ChunkHeader::SIZE;
+    if (!Crc32c::verifyChunk(header, state, static_cast<size_t>(header.stateSize) + header.audioDataSize))
+        return false;
+
+    if (snapshot != nullptr)
+    {
+        if (header.stateSize == StateSnapshot::SIZE)
+        {
+            std::memcpy(snapshot, state, StateSnapshot::SIZE);
+        }
+        else
+        {
+            // Recorded in the segment's state stream when it last changed
+            const StatePoint* point = segment->stateTrack.findForChunk(localOffset);
+            *snapshot = point != nullptr ? point->state : StateSnapshot();
+            snapshot->stateSeq = header.sequenceNumber;
+            snapshot->captureTimestampMs = header.wallClockMs;
+        }
+    }
+
+    const uint8_t* data = state + header.stateSize;
+    const uint32_t numChannels = static_cast<uint32_t>(header.numChannels);
+    const uint32_t numSamples = static_cast<uint32_t>(header.numSamples);
+    audio.resize(static_cast<size_t>(numChannels) * numSamples);
+
+    switch (header.codec)
+    {
+        case ChunkCodec::Raw:
+            if (header.audioDataSize != audio.size() * sizeof(float))
+                return false;
+            std::memcpy(audio.data(), data, header.audioDataSize);
+            return true;
+
+        case ChunkCodec::FloatPredictive:
+            return ChunkCodec::decode(data, header.audioDataSize, numChannels, numSamples, audio.data());
+
+        default:
+            return false;
+    }
+}
+
+} // namespace Mach1
@@ -0,0 +1,108 @@
+/*
+    ChunkReader.h
+    -------------
+    Random access reader for captured chunk files.
+
+    Maps a panner's chunk files (its segments, see ChunkSegments.h) into memory and loads
+    their seek indexes (ChunkIndex) as one, so readers can jump straight to the chunks
+    covering a sample range. The segments read as a single stream: the byteOffset of an
+    indexed chunk is its offset in the segments laid end to end, so offsets stay unique
+    and in write order across segments. Chunk audio is returned as interleaved float32
+    whatever codec it was stored with (see ChunkCodec), and chunk state from the chunk
+    itself or, for chunks written without one, from its segment's state stream
+    (StateTrack).
+
+    Readers never modify chunk files or their sidecars, so a session can be read while it
+    is still being captured. A reader is immutable after open() and can be shared between
+    threads.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChunkFormat.h"
+#include "ChunkIndex.h"
+#include "StateTrack.h"
+#include <memory>
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Memory-mapped, indexed view of a panner's chunk files
+ */
+class ChunkReader
+{
+public:
+    ChunkReader() = default;
+
+    /**
+     * Map chunk files and load their indexes (indexing any chunks the sidecars lack) and
+     * state streams. Chunks and state changes appended after open() are not seen.
+     * @param chunkFiles A panner's segments in write order (ChunkSegments::findSegments)
+     * @return false if none of them has any data
+     */
+    bool open(const juce::Array<juce::File>& chunkFiles);
+    bool open(const juce::File& chunkFile);
+    void close();
+
+    /**
+     * open() in steps, for callers loading many segments on a thread pool: setSegments(),
+     * loadSegment() once for each segment (from any threads), then finishLoading()
+     */
+    void setSegments(const juce::Array<juce::File>& chunkFiles);
+    void loadSegment(size_t segment);
+    bool finishLoading();
+
+    bool isOpen() const { return m_open; }
+    const ChunkIndex& getIndex() const { return m_index; }
+
+    /**
+     * Segments in write order
+     */
+    size_t getNumSegments() const { return m_segments.size(); }
+    const juce::File& getSegmentFile(size_t segment) const { return m_segments[segment].file; }
+    bool isSealed(size_t segment) const { return m_segments[segment].sealed; }
+    const StateTrack& getStateTrack(size_t segment) const { return m_segments[segment].stateTrack; }
+
+    /**
+     * Read and validate an indexed chunk's header
+     */
+    bool readHeader(const ChunkIndexEntry& entry, ChunkHeader& header) const;
+
+    /**
+     * Read an indexed chunk
+     * @param snapshot Receives the chunk's state snapshot (may be nullptr)
+     * @param audio Receives numChannels * numSamples interleaved samples
+     * @return false if the chunk is truncated, fails its checksum, is corrupt or uses an
+     *         unknown codec
+     */
+    bool read(const ChunkIndexEntry& entry, ChunkHeader& header, StateSnapshot* snapshot, std::vector<float>& audio) const;
+
+private:
+    struct Segment
+    {
+        juce::File file;
+        std::unique_ptr<juce::MemoryMappedFile> map;
+        ChunkIndex index;               // Merged into m_index by finishLoading()
+        StateTrack stateTrack;
+        uint64_t baseOffset = 0;        // Where the segment starts in the stream
+        uint64_t size = 0;              // Mapped bytes
+        bool sealed = false;
+    };
+
+    std::vector<Segment> m_segments;
+    ChunkIndex m_index;
+    bool m_open = false;
+
+    /**
+     * Segment holding a stream offset, and the chunk's offset within it
+     */
+    const Segment* findSegment(uint64_t offset, uint64_t& localOffset) const;
+    bool readHeader(const Segment& segment, uint64_t localOffset, ChunkHeader& header) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChunkReader)
+};
+
+} // namespace Mach1
@@ -0,0 +1,96 @@
+/*
+    ChunkSegments.cpp
+    -----------------
+    Implementation of segment naming, discovery and footers.
+*/
+
+#include "ChunkSegments.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+juce::File ChunkSegments::getSegmentFile(const juce::File& pannerDir, uint32_t segmentNumber)
+{
+    return pannerDir.getChildFile("chunks_" + juce::String(segmentNumber).paddedLeft('0', 4) + ".bin");
+}
+
+int64_t ChunkSegments::getSegmentNumber(const juce::File& chunkFile)
+{
+    const juce::String name = chunkFile.getFileName();
+    if (!name.startsWith("chunks_") || !name.endsWith(".bin"))
+        return -1;
+
+    const juce::String digits = name.substring(7, name.length() - 4);
+    if (digits.isEmpty() || !digits.containsOnly("0123456789"))
+        return -1;
+
+    return digits.getLargeIntValue();
+}
+
+uint32_t ChunkSegments::getNextSegmentNumber(const juce::File& pannerDir)
+{
+    int64_t highest = -1;
+    for (const auto& file : pannerDir.findChildFiles(juce::File::findFiles, false, "chunks_*.bin"))
+        highest = std::max(highest, getSegmentNumber(file));
+
+    return static_cast<uint32_t>(highest + 1);
+}
+
+juce::Array<juce::File> ChunkSegments::findSegments(const juce::File& pannerDir, bool sealedOnly)
+{
+    std::vector<std::pair<int64_t, juce::File>> numbered;
+    for (const auto& file : pannerDir.findChildFiles(juce::File::findFiles, false, "chunks_*.bin"))
+    {
+        const int64_t number = getSegmentNumber(file);
+        SegmentFooter footer;
+        if (number >= 0 && (!sealedOnly || readFooter(file, footer)))
+            numbered.emplace_back(number, file);
+    }
+    std::sort(numbered.begin(), numbered.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    juce::Array<juce::File> segments;
+    const juce::File legacy = pannerDir.getChildFile("chunks.bin");
+    if (!sealedOnly && legacy.existsAsFile())
+        segments.add(legacy);
+
+    for (const auto& segment : numbered)
+        segments.add(segment.second);
+
+    return segments;
+}
+
+bool ChunkSegments::readFooter(const juce::File& chunkFile, SegmentFooter& footer)
+{
+    juce::FileInputStream input(chunkFile);
+    const int64_t fileSize = input.openedOk() ? input.getTotalLength() : 0;
+    if (fileSize < static_cast<int64_t>(SegmentFooter::SIZE)
+        || !input.setPosition(fileSize - static_cast<int64_t>(SegmentFooter::SIZE))
+        || input.read(&footer, SegmentFooter::SIZE) != static_cast<int>(SegmentFooter::SIZE))
+        return false;
+
+    return isValidFooter(footer, static_cast<uint64_t>(fileSize));
+}
+
+bool ChunkSegments::isValidFooter(const SegmentFooter& footer, uint64_t fileSize)
+{
+    return footer.magic == SegmentFooter::MAGIC
+        && footer.dataSize + SegmentFooter::SIZE == fileSize;
+}
+
+PannerId ChunkSegments::getPannerId(const juce::File& pannerDir)
+{
+    const juce::String folderName = pannerDir.getFileName();
+    const int separator = folderName.lastIndexOfChar('_');
+    if (separator <= 0)
+        return {};
+
+    return PannerId(pannerDir.getParentDirectory().getFileName().toStdString(),
+                    folderName.substring(0, separator).toStdString(),
+                    static_cast<uint32_t>(folderName.substring(separator + 1).getLargeIntValue()));
+}
+
+} // namespace Mach1
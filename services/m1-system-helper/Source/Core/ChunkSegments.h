@@ -0,0 +1,72 @@
+/*
+    ChunkSegments.h
+    ---------------
+    Segment files of a panner's capture.
+
+    The capture engine does not grow one chunks.bin for the whole capture: it rotates to
+    a new chunks_NNNN.bin once a segment reaches its size or duration limit, and seals
+    the finished one with a SegmentFooter. A sealed segment is never written again, so it
+    can be copied, verified or exported while the capture goes on, and segments can be
+    indexed and read in parallel.
+
+    Every capture of a panner folder starts a new segment after the existing ones, so
+    segment numbers follow write order. A chunks.bin from before segmenting comes first.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChunkFormat.h"
+#include "CoverageModel.h"
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Naming, discovery and footers of chunk file segments
+ */
+class ChunkSegments
+{
+public:
+    /**
+     * Segment file in a panner folder (chunks_0000.bin, chunks_0001.bin, ...)
+     */
+    static juce::File getSegmentFile(const juce::File& pannerDir, uint32_t segmentNumber);
+
+    /**
+     * Segment number of a segment file, -1 for anything else (chunks.bin included)
+     */
+    static int64_t getSegmentNumber(const juce::File& chunkFile);
+
+    /**
+     * Number for the next segment of a panner folder (one past the highest present)
+     */
+    static uint32_t getNextSegmentNumber(const juce::File& pannerDir);
+
+    /**
+     * A panner folder's chunk files in write order: chunks.bin, if present, then the
+     * segments by number
+     * @param sealedOnly Only segments with a footer (not the one capture is writing, and
+     *                   neither chunks.bin nor a segment cut short by a crash)
+     */
+    static juce::Array<juce::File> findSegments(const juce::File& pannerDir, bool sealedOnly = false);
+
+    /**
+     * Read a segment's footer
+     * @return false if the segment is not sealed
+     */
+    static bool readFooter(const juce::File& chunkFile, SegmentFooter& footer);
+
+    /**
+     * Whether the size of a segment and the footer at its end agree
+     */
+    static bool isValidFooter(const SegmentFooter& footer, uint64_t fileSize);
+
+    /**
+     * Panner a capture folder belongs to (<session_id>/<uuid>_<pid>)
+     * @return An invalid PannerId if the folder name has no process ID
+     */
+    static PannerId getPannerId(const juce::File& pannerDir);
+};
+
+} // namespace Mach1
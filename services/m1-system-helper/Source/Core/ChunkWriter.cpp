@@ -0,0 +1,542 @@
+/*
+    ChunkWriter.cpp
+    ---------------
+    Implementation of the asynchronous chunk file writer.
+*/
+
+#include "ChunkWriter.h"
+#include <algorithm>
+#include <cstring>
+
+#if JUCE_LINUX
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Mach1 {
+
+//==============================================================================
+struct ChunkWriter::Buffer
+{
+    std::unique_ptr<uint8_t[]> storage;
+    uint8_t* data = nullptr;        // storage, aligned to IO_ALIGNMENT
+    size_t capacity = 0;
+    size_t used = 0;
+
+    explicit Buffer(size_t size)
+        : storage(new uint8_t[size + IO_ALIGNMENT])
+        , capacity(size)
+    {
+        auto address = reinterpret_cast<uintptr_t>(storage.get());
+        data = storage.get() + ((IO_ALIGNMENT - (address % IO_ALIGNMENT)) % IO_ALIGNMENT);
+    }
+};
+
+struct ChunkWriter::OpenFile
+{
+    juce::File file;
+    size_t bufferSize = 0;
+    uint64_t offset = 0;                // Bytes in the file (writer thread only once opened)
+    std::atomic<bool> direct{false};    // Writes go through O_DIRECT (cleared for the closing tail)
+    bool unsynced = false;              // Written since the last checkpoint (writer thread)
+
+#if JUCE_LINUX
+    int fd = -1;
+    uint64_t allocatedBytes = 0;        // Preallocated up to here
+#else
+    std::unique_ptr<juce::FileOutputStream> stream;
+#endif
+
+    // Buffer pool: every buffer of this file, and those free for the stream to fill
+    juce::CriticalSection poolMutex;
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    std::vector<Buffer*> freeBuffers;
+};
+
+//==============================================================================
+ChunkWriter::ChunkWriter()
+    : ChunkWriter(Options())
+{
+}
+
+ChunkWriter::ChunkWriter(const Options& options)
+    : juce::Thread("ChunkWriter")
+    , m_options(options)
+    , m_syncIntervalMs(options.syncIntervalMs)
+{
+}
+
+ChunkWriter::~ChunkWriter()
+{
+    stop();
+}
+
+void ChunkWriter::start()
+{
+    if (isThreadRunning())
+        return;
+
+    m_stopping.store(false);
+    m_windowStartMs = juce::Time::currentTimeMillis();
+    m_windowBytes = 0;
+    m_lastCheckpointMs = m_windowStartMs;
+    startThread(juce::Thread::Priority::normal);
+}
+
+void ChunkWriter::stop()
+{
+    if (isThreadRunning())
+    {
+        m_stopping.store(true);
+        m_queueEvent.signal();
+        waitForThreadToExit(-1);
+    }
+
+    // Anything queued after the thread left (or without a thread) is written here
+    Job job;
+    while (popJob(job))
+        processJob(job);
+
+    if (m_syncIntervalMs.load() > 0)
+        checkpoint();
+
+    m_writeBytesPerSecond.store(0.0);
+}
+
+std::unique_ptr<ChunkWriter::Stream> ChunkWriter::open(const juce::File& file, size_t bufferSize)
+{
+    auto openFile = std::make_shared<OpenFile>();
+    openFile->file = file;
+    openFile->bufferSize = bufferSize > 0 ? (bufferSize + IO_ALIGNMENT - 1) & ~(IO_ALIGNMENT - 1) : m_options.bufferSize;
+
+#if JUCE_LINUX
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+    openFile->fd = ::open(file.getFullPathName().toRawUTF8(), flags | (m_options.directIo ? O_DIRECT : 0), 0644);
+    if (openFile->fd < 0 && m_options.directIo)
+        openFile->fd = ::open(file.getFullPathName().toRawUTF8(), flags, 0644);     // Filesystem without O_DIRECT
+    else
+        openFile->direct = m_options.directIo;
+
+    if (openFile->fd < 0)
+    {
+        DBG("[ChunkWriter] Failed to open " + file.getFullPathName() + ": " + juce::String(std::strerror(errno)));
+        return nullptr;
+    }
+
+    // Append after any existing chunks
+    struct stat info;
+    if (fstat(openFile->fd, &info) == 0)
+    {
+        openFile->offset = static_cast<uint64_t>(info.st_size);
+        openFile->allocatedBytes = openFile->offset;
+    }
+
+    // An unaligned existing file can't continue under O_DIRECT
+    if (openFile->direct.load() && (openFile->offset & (IO_ALIGNMENT - 1)) != 0)
+    {
+        int fileFlags = fcntl(openFile->fd, F_GETFL);
+        if (fileFlags >= 0)
+            fcntl(openFile->fd, F_SETFL, fileFlags & ~O_DIRECT);
+        openFile->direct.store(false);
+    }
+#else
+    openFile->stream = std::make_unique<juce::FileOutputStream>(file);
+    if (!openFile->stream->openedOk())
+    {
+        DBG("[ChunkWriter] Failed to open " + file.getFullPathName());
+        return nullptr;
+    }
+    openFile->offset = static_cast<uint64_t>(openFile->stream->getPosition());
+#endif
+
+    // Double buffering to start with: one filling, one being written
+    for (int i = 0; i < 2; ++i)
+    {
+        openFile->buffers.push_back(std::make_unique<Buffer>(openFile->bufferSize));
+        openFile->freeBuffers.push_back(openFile->buffers.back().get());
+    }
+
+    return std::unique_ptr<Stream>(new Stream(*this, std::move(openFile)));
+}
+
+ChunkWriter::Stats ChunkWriter::getStats() const
+{
+    Stats stats;
+    stats.bytesWritten = m_bytesWritten.load();
+    stats.writeBytesPerSecond = m_writeBytesPerSecond.load();
+    stats.queueDepth = m_queueDepth.load();
+    stats.maxQueueDepth = m_maxQueueDepth.load();
+    stats.queuedBytes = m_queuedBytes.load();
+    stats.droppedChunks = m_droppedChunks.load();
+    stats.writeErrors = m_writeErrors.load();
+    stats.checkpoints = m_checkpoints.load();
+    stats.lastCheckpointMs = m_lastCheckpointDurationMs.load();
+    stats.lastCheckpointTime = m_lastCheckpointTime.load();
+    return stats;
+}
+
+void ChunkWriter::setSyncInterval(int milliseconds)
+{
+    m_syncIntervalMs = std::max(0, milliseconds);
+    m_queueEvent.signal();
+}
+
+//==============================================================================
+void ChunkWriter::run()
+{
+    while (true)
+    {
+        Job job;
+        if (popJob(job))
+        {
+            processJob(job);
+            checkpointIfDue();
+            continue;
+        }
+
+        if (m_stopping.load())
+            break;
+
+        const int syncIntervalMs = m_syncIntervalMs.load();
+        m_queueEvent.wait(syncIntervalMs > 0 ? std::min(250, syncIntervalMs) : 250);
+        updateBandwidth();
+        checkpointIfDue();
+    }
+}
+
+void ChunkWriter::enqueue(Job job)
+{
+    if (job.buffer != nullptr)
+    {
+        m_queuedBytes.fetch_add(job.buffer->used);
+        uint32_t depth = m_queueDepth.fetch_add(1) + 1;
+        if (depth > m_maxQueueDepth.load())
+            m_maxQueueDepth.store(depth);
+    }
+
+    {
+        const juce::ScopedLock lock(m_queueMutex);
+        m_queue.push_back(std::move(job));
+    }
+    m_queueEvent.signal();
+}
+
+bool ChunkWriter::popJob(Job& job)
+{
+    if (m_batchIndex == m_batch.size())
+    {
+        m_batch.clear();
+        m_batchIndex = 0;
+
+        const juce::ScopedLock lock(m_queueMutex);
+        m_batch.swap(m_queue);
+    }
+
+    if (m_batchIndex == m_batch.size())
+        return false;
+
+    job = std::move(m_batch[m_batchIndex++]);
+    return true;
+}
+
+void ChunkWriter::processJob(Job& job)
+{
+    if (job.buffer == nullptr)
+    {
+        closeFile(*job.file);
+        return;
+    }
+
+    Buffer* buffer = job.buffer;
+    const size_t bytes = buffer->used;
+    writeBuffer(*job.file, *buffer);
+
+    if (!job.file->unsynced && m_syncIntervalMs.load() > 0)
+    {
+        job.file->unsynced = true;
+        m_unsyncedFiles.push_back(job.file);
+    }
+
+    m_queuedBytes.fetch_sub(bytes);
+    m_queueDepth.fetch_sub(1);
+    m_bytesWritten.fetch_add(bytes);
+    m_windowBytes += bytes;
+    updateBandwidth();
+
+    // Back to the stream's pool
+    buffer->used = 0;
+    const juce::ScopedLock lock(job.file->poolMutex);
+    job.file->freeBuffers.push_back(buffer);
+}
+
+void ChunkWriter::writeBuffer(OpenFile& file, Buffer& buffer)
+{
+#if JUCE_LINUX
+    if (file.fd < 0)
+        return;
+
+    // Reserve space well ahead so the file stays contiguous and writes never wait on allocation
+    if (m_options.preallocate && file.offset + buffer.used > file.allocatedBytes)
+    {
+        uint64_t target = file.offset + buffer.used + PREALLOCATE_STEP;
+        if (fallocate(file.fd, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(file.allocatedBytes),
+                      static_cast<off_t>(target - file.allocatedBytes)) == 0)
+            file.allocatedBytes = target;
+        else
+            file.allocatedBytes = UINT64_MAX;   // Unsupported here; stop trying
+    }
+
+    // O_DIRECT needs aligned offsets and sizes; the final tail of a file is written through the cache
+    if (file.direct.load() && ((file.offset | buffer.used) & (IO_ALIGNMENT - 1)) != 0)
+    {
+        int flags = fcntl(file.fd, F_GETFL);
+        if (flags >= 0)
+            fcntl(file.fd, F_SETFL, flags & ~O_DIRECT);
+        file.direct.store(false);
+    }
+
+    size_t written = 0;
+    while (written < buffer.used)
+    {
+        ssize_t result = pwrite(file.fd, buffer.data + written, buffer.used - written,
+                                static_cast<off_t>(file.offset + written));
+        if (result < 0 && errno == EINTR)
+            continue;
+
+        if (result <= 0)
+        {
+            m_writeErrors.fetch_add(1);
+            DBG("[ChunkWriter] Write failed for " + file.file.getFullPathName() + ": " + juce::String(std::strerror(errno)));
+            break;
+        }
+        written += static_cast<size_t>(result);
+    }
+    file.offset += written;
+#else
+    if (!file.stream)
+        return;
+
+    if (!file.stream->write(buffer.data, buffer.used))
+    {
+        m_writeErrors.fetch_add(1);
+        DBG("[ChunkWriter] Write failed for " + file.file.getFullPathName());
+    }
+    file.offset += buffer.used;
+#endif
+}
+
+void ChunkWriter::closeFile(OpenFile& file)
+{
+#if JUCE_LINUX
+    if (file.fd >= 0)
+    {
+        // Give back the preallocated space past the data
+        if (file.allocatedBytes > file.offset && file.allocatedBytes != UINT64_MAX)
+            (void) ftruncate(file.fd, static_cast<off_t>(file.offset));
+
+        // A closed file (e.g. a sealed segment) is durable right away, not at the next checkpoint
+        if (file.unsynced && fdatasync(file.fd) != 0)
+            m_writeErrors.fetch_add(1);
+        ::close(file.fd);
+        file.fd = -1;
+    }
+#else
+    if (file.stream)
+    {
+        file.stream->flush();
+        file.stream.reset();
+    }
+#endif
+}
+
+void ChunkWriter::checkpointIfDue()
+{
+    const int syncIntervalMs = m_syncIntervalMs.load();
+    if (syncIntervalMs > 0 && juce::Time::currentTimeMillis() - m_lastCheckpointMs >= syncIntervalMs)
+        checkpoint();
+}
+
+void ChunkWriter::checkpoint()
+{
+    m_lastCheckpointMs = juce::Time::currentTimeMillis();
+    if (m_unsyncedFiles.empty())
+        return;
+
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+
+#if JUCE_LINUX
+    // Start writeback on every file first, so the disk works on all of them at once,
+    // then wait for each; the later fdatasyncs mostly find their data already written
+    for (const auto& file : m_unsyncedFiles)
+    {
+        if (file->fd >= 0)
+            (void) sync_file_range(file->fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+    }
+
+    for (const auto& file : m_unsyncedFiles)
+    {
+        if (file->fd >= 0 && fdatasync(file->fd) != 0)
+        {
+            m_writeErrors.fetch_add(1);
+            DBG("[ChunkWriter] Sync failed for " + file->file.getFullPathName() + ": " + juce::String(std::strerror(errno)));
+        }
+        file->unsynced = false;
+    }
+#else
+    // FileOutputStream::flush() syncs the file to disk
+    for (const auto& file : m_unsyncedFiles)
+    {
+        if (file->stream)
+            file->stream->flush();
+        file->unsynced = false;
+    }
+#endif
+
+    m_unsyncedFiles.clear();
+    m_checkpoints.fetch_add(1);
+    m_lastCheckpointDurationMs.store(juce::Time::getMillisecondCounterHiRes() - startMs);
+    m_lastCheckpointTime.store(juce::Time::currentTimeMillis());
+}
+
+void ChunkWriter::updateBandwidth()
+{
+    auto now = juce::Time::currentTimeMillis();
+    auto elapsed = now - m_windowStartMs;
+    if (elapsed < 1000)
+        return;
+
+    m_writeBytesPerSecond.store(static_cast<double>(m_windowBytes) * 1000.0 / static_cast<double>(elapsed));
+    m_windowBytes = 0;
+    m_windowStartMs = now;
+}
+
+ChunkWriter::Buffer* ChunkWriter::acquireBuffer(OpenFile& file)
+{
+    const juce::ScopedLock lock(file.poolMutex);
+
+    if (!file.freeBuffers.empty())
+    {
+        Buffer* buffer = file.freeBuffers.back();
+        file.freeBuffers.pop_back();
+        return buffer;
+    }
+
+    // The disk is behind: grow the pool rather than wait, up to the cap
+    if ((file.buffers.size() + 1) * file.bufferSize > m_options.maxBufferedBytes)
+        return nullptr;
+
+    file.buffers.push_back(std::make_unique<Buffer>(file.bufferSize));
+    return file.buffers.back().get();
+}
+
+//==============================================================================
+ChunkWriter::Stream::Stream(ChunkWriter& writer, std::shared_ptr<OpenFile> file)
+    : m_writer(writer)
+    , m_file(std::move(file))
+    , m_position(m_file->offset)
+{
+}
+
+ChunkWriter::Stream::~Stream()
+{
+    seal(true);
+    m_writer.enqueue({ m_file, nullptr });
+}
+
+bool ChunkWriter::Stream::append(std::initializer_list<Part> parts)
+{
+    size_t total = 0;
+    for (const auto& part : parts)
+        total += part.size;
+
+    // Room is kept for an O_DIRECT tail carried into the next buffer
+    const size_t capacity = m_file->bufferSize;
+    if (total > capacity - IO_ALIGNMENT)
+    {
+        m_writer.m_droppedChunks.fetch_add(1);
+        return false;
+    }
+
+    if (m_active != nullptr && m_active->used + total > m_active->capacity && !seal(false))
+    {
+        m_writer.m_droppedChunks.fetch_add(1);
+        return false;
+    }
+
+    if (m_active == nullptr)
+    {
+        m_active = m_writer.acquireBuffer(*m_file);
+        if (m_active == nullptr)
+        {
+            m_writer.m_droppedChunks.fetch_add(1);
+            return false;
+        }
+        m_activeSinceMs = juce::Time::currentTimeMillis();
+    }
+
+    uint8_t* destination = m_active->data + m_active->used;
+    for (const auto& part : parts)
+    {
+        if (part.size == 0)
+            continue;
+        std::memcpy(destination, part.data, part.size);
+        destination += part.size;
+    }
+    m_active->used += total;
+    m_position += total;
+
+    if (m_active->used == m_active->capacity)
+        seal(false);
+
+    return true;
+}
+
+void ChunkWriter::Stream::flushIfStale()
+{
+    if (m_active != nullptr && m_active->used > 0
+        && juce::Time::currentTimeMillis() - m_activeSinceMs >= m_writer.m_options.flushIntervalMs)
+    {
+        seal(false);
+    }
+}
+
+juce::File ChunkWriter::Stream::getFile() const
+{
+    return m_file->file;
+}
+
+bool ChunkWriter::Stream::seal(bool closing)
+{
+    if (m_active == nullptr || m_active->used == 0)
+        return true;
+
+    // Under O_DIRECT only whole pages go out; the tail moves to the next buffer
+    size_t writable = m_active->used;
+    if (m_file->direct.load() && !closing)
+        writable &= ~(IO_ALIGNMENT - 1);
+
+    const size_t carry = m_active->used - writable;
+    if (writable == 0)
+        return true;
+
+    Buffer* next = nullptr;
+    if (carry > 0)
+    {
+        next = m_writer.acquireBuffer(*m_file);
+        if (next == nullptr)
+            return false;
+        std::memcpy(next->data, m_active->data + writable, carry);
+        next->used = carry;
+    }
+
+    m_active->used = writable;
+    m_writer.enqueue({ m_file, m_active });
+
+    m_active = next;
+    m_activeSinceMs = juce::Time::currentTimeMillis();
+    return true;
+}
+
+} // namespace Mach1
@@ -0,0 +1,216 @@
+/*
+    ChunkWriter.h
+    -------------
+    Asynchronous writer for the capture engine's append-only chunk files.
+
+    Capture workers append chunks to large preallocated in-memory buffers and never
+    touch the filesystem; one writer thread turns filled buffers into large sequential
+    writes.
+
+    Design:
+    - ChunkWriter: the writer thread and its queue of filled buffers (one per engine)
+    - ChunkWriter::Stream: append handle for one file, used by one capture thread
+    - Each file starts with two buffers (one filling while the other is written) and
+      grows its pool while the disk is behind, up to Options::maxBufferedBytes; past
+      that, appends fail and the caller counts the chunk as dropped
+    - A partly filled buffer is handed over after Options::flushIntervalMs, so a quiet
+      panner's chunks still reach the disk
+    - Linux: files are preallocated with fallocate and can bypass the page cache with
+      O_DIRECT (buffers are page aligned, writes page sized until the file is closed)
+    - Checkpoints (group commit): every sync interval the writer thread makes everything
+      it has written since the last checkpoint durable, for all files at once (Linux:
+      writeback is started on every file, then each is fdatasync'd), instead of syncing
+      per chunk. A crash loses at most the last interval plus what the streams still
+      buffered (see flushIntervalMs). Files are also synced when they close.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Background writer for chunk files
+ */
+class ChunkWriter : private juce::Thread
+{
+public:
+    struct Options
+    {
+        size_t bufferSize = 1024 * 1024;                // Bytes per in-memory buffer (one write each)
+        size_t maxBufferedBytes = 64 * 1024 * 1024;     // Per-file cap on data waiting for the disk
+        int flushIntervalMs = 250;                      // Longest a partly filled buffer waits
+        bool preallocate = true;                        // Reserve file space ahead of the writes (Linux)
+        bool directIo = false;                          // Bypass the page cache with O_DIRECT (Linux)
+        int syncIntervalMs = 1000;                      // Checkpoint interval (0 = leave it to the OS)
+    };
+
+    struct Stats
+    {
+        uint64_t bytesWritten = 0;
+        double writeBytesPerSecond = 0.0;   // Over the last second
+        uint32_t queueDepth = 0;            // Buffers waiting for the writer thread
+        uint32_t maxQueueDepth = 0;
+        uint64_t queuedBytes = 0;
+        uint64_t droppedChunks = 0;         // Appends refused because a file hit maxBufferedBytes
+        uint32_t writeErrors = 0;
+        uint32_t checkpoints = 0;           // Group syncs done
+        double lastCheckpointMs = 0.0;      // How long the last one took
+        juce::int64 lastCheckpointTime = 0; // When it finished (Time::currentTimeMillis, 0 = none yet)
+    };
+
+    /**
+     * One piece of a chunk (header, snapshot, audio)
+     */
+    struct Part
+    {
+        const void* data;
+        size_t size;
+    };
+
+    class Stream;
+
+    ChunkWriter();
+    explicit ChunkWriter(const Options& options);
+    ~ChunkWriter() override;
+
+    /**
+     * Start the writer thread
+     */
+    void start();
+
+    /**
+     * Write everything queued, then stop the writer thread
+     */
+    void stop();
+
+    /**
+     * Open a file for appending (created if missing)
+     * @param bufferSize Bytes per buffer for this file (0 = Options::bufferSize)
+     * @return nullptr if the file could not be opened
+     */
+    std::unique_ptr<Stream> open(const juce::File& file, size_t bufferSize = 0);
+
+    Stats getStats() const;
+
+    /**
+     * Change the checkpoint interval (0 = no syncing)
+     */
+    void setSyncInterval(int milliseconds);
+
+    /**
+     * Alignment of buffers, and of writes while O_DIRECT is in use
+     */
+    static constexpr size_t IO_ALIGNMENT = 4096;
+
+private:
+    struct Buffer;
+    struct OpenFile;
+
+    struct Job
+    {
+        std::shared_ptr<OpenFile> file;
+        Buffer* buffer = nullptr;       // nullptr: close the file
+    };
+
+    // How far ahead of the written data files are preallocated
+    static constexpr uint64_t PREALLOCATE_STEP = 64 * 1024 * 1024;
+
+    const Options m_options;
+
+    juce::CriticalSection m_queueMutex;
+    std::vector<Job> m_queue;           // Filled by the streams
+    std::vector<Job> m_batch;           // Writer thread: jobs taken from m_queue in one swap (both keep their capacity)
+    size_t m_batchIndex = 0;
+    juce::WaitableEvent m_queueEvent;
+    std::atomic<bool> m_stopping{false};
+
+    // Checkpoints (writer thread): files written since the last one
+    std::atomic<int> m_syncIntervalMs;
+    std::vector<std::shared_ptr<OpenFile>> m_unsyncedFiles;
+    juce::int64 m_lastCheckpointMs = 0;
+
+    // Statistics
+    std::atomic<uint64_t> m_bytesWritten{0};
+    std::atomic<uint64_t> m_queuedBytes{0};
+    std::atomic<uint32_t> m_queueDepth{0};
+    std::atomic<uint32_t> m_maxQueueDepth{0};
+    std::atomic<uint64_t> m_droppedChunks{0};
+    std::atomic<uint32_t> m_writeErrors{0};
+    std::atomic<double> m_writeBytesPerSecond{0.0};
+    std::atomic<uint32_t> m_checkpoints{0};
+    std::atomic<double> m_lastCheckpointDurationMs{0.0};
+    std::atomic<juce::int64> m_lastCheckpointTime{0};
+    juce::int64 m_windowStartMs = 0;    // Writer thread only
+    uint64_t m_windowBytes = 0;
+
+    void run() override;
+    void enqueue(Job job);
+    bool popJob(Job& job);
+    void processJob(Job& job);
+    void writeBuffer(OpenFile& file, Buffer& buffer);
+    void closeFile(OpenFile& file);
+    void checkpointIfDue();
+    void checkpoint();
+    void updateBandwidth();
+    Buffer* acquireBuffer(OpenFile& file);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChunkWriter)
+};
+
+//==============================================================================
+/**
+ * Append handle for one chunk file. Not thread-safe: one capture thread appends.
+ * Destroying the stream hands over what is buffered; the file closes once written.
+ */
+class ChunkWriter::Stream
+{
+public:
+    ~Stream();
+
+    /**
+     * Append one chunk (its parts are stored back to back, never split across writes)
+     * Never blocks on the disk.
+     * @return false if the chunk was dropped because the writer is too far behind
+     */
+    bool append(std::initializer_list<Part> parts);
+
+    /**
+     * Hand over a partly filled buffer once it has waited Options::flushIntervalMs
+     * (call when the capture thread goes idle)
+     */
+    void flushIfStale();
+
+    juce::File getFile() const;
+
+    /**
+     * File offset the next appended chunk will start at
+     */
+    uint64_t getPosition() const { return m_position; }
+
+private:
+    friend class ChunkWriter;
+    Stream(ChunkWriter& writer, std::shared_ptr<OpenFile> file);
+
+    /**
+     * Queue the active buffer for writing
+     * @param closing Write everything, even an unaligned tail under O_DIRECT
+     */
+    bool seal(bool closing);
+
+    ChunkWriter& m_writer;
+    std::shared_ptr<OpenFile> m_file;
+    Buffer* m_active = nullptr;
+    juce::int64 m_activeSinceMs = 0;
+    uint64_t m_position = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(Stream)
+};
+
+} // namespace Mach1
@@ -0,0 +1,90 @@
+/*
+    CoverageCounts.cpp
+    ------------------
+    Implementation of the incremental per-stretch panner counts.
+*/
+
+#include "CoverageCounts.h"
+#include <algorithm>
+
+namespace Mach1 {
+
+//==============================================================================
+void CoverageCounts::add(int64_t start, int64_t end)
+{
+    add(start, end, [](int64_t, int64_t) {});
+}
+
+void CoverageCounts::setNumPanners(uint32_t numPanners)
+{
+    if (numPanners == m_numPanners)
+        return;
+
+    m_numPanners = numPanners;
+    rebuildAllCoverage();
+}
+
+CapturedIntervalSet CoverageCounts::getCoverage(uint32_t minPanners) const
+{
+    CapturedIntervalSet coverage;
+    minPanners = std::max(1u, minPanners);
+    for (auto it = m_steps.begin(); it != m_steps.end() && std::next(it) != m_steps.end(); ++it)
+    {
+        if (it->second >= minPanners)
+            coverage.addInterval(it->first, std::next(it)->first);
+    }
+    return coverage;
+}
+
+void CoverageCounts::clear()
+{
+    m_steps.clear();
+    m_spareNode = Steps::node_type();
+    m_anyCoverage.clear();
+    m_allCoverage.clear();
+    m_numPanners = 0;
+}
+
+//==============================================================================
+CoverageCounts::Steps::iterator CoverageCounts::split(int64_t position)
+{
+    auto next = m_steps.upper_bound(position);
+    uint32_t count = 0;     // Before the first step
+    if (next != m_steps.begin())
+    {
+        auto step = std::prev(next);
+        if (step->first == position)
+            return step;
+        count = step->second;
+    }
+
+    if (!m_spareNode.empty())
+    {
+        m_spareNode.key() = position;
+        m_spareNode.mapped() = count;
+        return m_steps.insert(next, std::move(m_spareNode));
+    }
+
+    return m_steps.emplace_hint(next, position, count);
+}
+
+void CoverageCounts::mergeWithPrevious(Steps::iterator step)
+{
+    if (step != m_steps.begin() && std::prev(step)->second == step->second)
+        m_spareNode = m_steps.extract(step);
+}
+
+void CoverageCounts::rebuildAllCoverage()
+{
+    m_allCoverage.clear();
+    if (m_numPanners == 0)
+        return;
+
+    for (auto it = m_steps.begin(); it != m_steps.end() && std::next(it) != m_steps.end(); ++it)
+    {
+        if (it->second >= m_numPanners)
+            m_allCoverage.addInterval(it->first, std::next(it)->first);
+    }
+}
+
+} // namespace Mach1
@@ -0,0 +1,111 @@
+/*
+    CoverageCounts.h
+    ----------------
+    How many panners cover each stretch of the session, kept up to date as coverage
+    arrives, with the any and all coverage that follows from it.
+
+    The counts are a step function: an ordered map from each position where the count
+    changes to the count from there on (the last step is always 0). Adding a stretch a
+    panner newly covers splits the steps at its ends and raises the ones in between, in
+    O(log n + steps touched); a stretch going from 0 to 1 extends any coverage, and one
+    reaching the number of panners extends all coverage. Steps that end up equal to
+    their neighbour are merged, so the map stays as small as the coverage is fragmented.
+    During capture every block lands at the end, so each update touches one or two steps
+    and reuses a node it just released instead of allocating.
+
+    Counts only go up: a panner leaving needs a rebuild (clear() and add everything
+    again). A change in the number of panners recomputes all coverage from the steps.
+
+    Plain C++ (no JUCE).
+*/
+
+#pragma once
+
+#include "CapturedIntervalSet.h"
+#include <cstdint>
+#include <map>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Per-stretch panner counts, with any and all coverage
+ */
+class CoverageCounts
+{
+public:
+    /**
+     * Count a stretch one panner newly covers (it must not have covered any of it before)
+     */
+    void add(int64_t start, int64_t end);
+
+    /**
+     * Count a stretch, calling onAnyAdded(start, end) for each piece of it that no panner
+     * covered yet, in order (what any coverage gained)
+     */
+    template <typename Callback>
+    void add(int64_t start, int64_t end, Callback&& onAnyAdded);
+
+    /**
+     * Number of panners all coverage requires
+     */
+    void setNumPanners(uint32_t numPanners);
+    uint32_t getNumPanners() const { return m_numPanners; }
+
+    const CapturedIntervalSet& getAnyCoverage() const { return m_anyCoverage; }
+    const CapturedIntervalSet& getAllCoverage() const { return m_allCoverage; }
+
+    /**
+     * Where at least minPanners panners have coverage, O(steps)
+     */
+    CapturedIntervalSet getCoverage(uint32_t minPanners) const;
+
+    /**
+     * Steps in the count function (for diagnostics and benchmarks)
+     */
+    size_t getNumSteps() const { return m_steps.size(); }
+
+    void clear();
+
+private:
+    using Steps = std::map<int64_t, uint32_t>;   // position -> panners covering from there on
+
+    Steps m_steps;
+    Steps::node_type m_spareNode;   // Released by a merge, reused by the next split
+    CapturedIntervalSet m_anyCoverage;
+    CapturedIntervalSet m_allCoverage;
+    uint32_t m_numPanners = 0;
+
+    Steps::iterator split(int64_t position);
+    void mergeWithPrevious(Steps::iterator step);
+    void rebuildAllCoverage();
+};
+
+//==============================================================================
+template <typename Callback>
+void CoverageCounts::add(int64_t start, int64_t end, Callback&& onAnyAdded)
+{
+    if (end <= start)
+        return;
+
+    auto first = split(start);
+    auto last = split(end);
+    for (auto it = first; it != last; ++it)
+    {
+        const int64_t stepEnd = std::next(it)->first;
+        const uint32_t count = ++it->second;
+        if (count == 1)
+        {
+            m_anyCoverage.addInterval(it->first, stepEnd);
+            onAnyAdded(it->first, stepEnd);
+        }
+        if (count == m_numPanners)
+            m_allCoverage.addInterval(it->first, stepEnd);
+    }
+
+    // Only the steps at the ends can now equal their neighbour
+    mergeWithPrevious(last);
+    mergeWithPrevious(first);
+}
+
+} // namespace Mach1
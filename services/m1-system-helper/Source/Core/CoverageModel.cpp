@@ -10,110 +10,6 @@
 
 namespace Mach1 {
 
-//==============================================================================
-// CapturedIntervalSet Implementation
-//==============================================================================
-
-void CapturedIntervalSet::addInterval(int64_t start, int64_t end)
-{
-    if (end <= start) return;  // Invalid interval
-    
-    m_intervals.push_back(SampleInterval(start, end));
-    mergeOverlapping();
-}
-
-int64_t CapturedIntervalSet::getTotalCapturedSamples() const
-{
-    int64_t total = 0;
-    for (const auto& interval : m_intervals)
-    {
-        total += interval.length();
-    }
-    return total;
-}
-
-bool CapturedIntervalSet::isCovered(int64_t sample) const
-{
-    for (const auto& interval : m_intervals)
-    {
-        if (interval.contains(sample))
-            return true;
-    }
-    return false;
-}
-
-SampleInterval CapturedIntervalSet::getBoundingInterval() const
-{
-    if (m_intervals.empty())
-        return SampleInterval(0, 0);
-    
-    int64_t minStart = m_intervals.front().start;
-    int64_t maxEnd = m_intervals.back().end;
-    
-    for (const auto& interval : m_intervals)
-    {
-        minStart = std::min(minStart, interval.start);
-        maxEnd = std::max(maxEnd, interval.end);
-    }
-    
-    return SampleInterval(minStart, maxEnd);
-}
-
-std::vector<SampleInterval> CapturedIntervalSet::getGaps() const
-{
-    std::vector<SampleInterval> gaps;
-    
-    if (m_intervals.size() < 2)
-        return gaps;
-    
-    for (size_t i = 0; i < m_intervals.size() - 1; ++i)
-    {
-        int64_t gapStart = m_intervals[i].end;
-        int64_t gapEnd = m_intervals[i + 1].start;
-        
-        if (gapEnd > gapStart)
-        {
-            gaps.push_back(SampleInterval(gapStart, gapEnd));
-        }
-    }
-    
-    return gaps;
-}
-
-void CapturedIntervalSet::clear()
-{
-    m_intervals.clear();
-}
-
-void CapturedIntervalSet::mergeOverlapping()
-{
-    if (m_intervals.size() < 2)
-        return;
-    
-    // Sort by start position
-    std::sort(m_intervals.begin(), m_intervals.end());
-    
-    std::vector<SampleInterval> merged;
-    merged.push_back(m_intervals[0]);
-    
-    for (size_t i = 1; i < m_intervals.size(); ++i)
-    {
-        SampleInterval& last = merged.back();
-        const SampleInterval& current = m_intervals[i];
-        
-        if (last.canMerge(current))
-        {
-            last = last.merge(current);
-        }
-        else
-        {
-            merged.push_back(current);
-        }
-    }
-    
-    m_intervals = std::move(merged);
-}
-
 //==============================================================================
 // PannerCoverage Implementation
 //==============================================================================
@@ -149,6 +45,23 @@ double PannerCoverage::getDropoutDurationSeconds() const
     return static_cast<double>(totalDropoutSamples) / sampleRate;
 }
 
+bool PannerCoverage::findSequenceGap(int64_t startSample, uint32_t sequenceNumber,
+                                     SampleInterval& missing, uint32_t& missedBuffers) const
+{
+    // Nothing to compare with before the first block
+    if (lastBufferId == 0 || lastEndSample <= 0)
+        return false;
+    
+    // Estimate the dropout region from the expected vs actual position. A position gap
+    // without a sequence gap could be the DAW seeking, and is not one.
+    if (sequenceNumber <= lastSequenceNumber + 1 || startSample <= lastEndSample)
+        return false;
+    
+    missing = SampleInterval(lastEndSample, startSample);
+    missedBuffers = sequenceNumber - lastSequenceNumber - 1;
+    return true;
+}
+
 //==============================================================================
 // CoverageModel Implementation
 //==============================================================================
@@ -161,55 +74,96 @@ CoverageModel::~CoverageModel()
 {
 }
 
+CoverageModel::PannerHandle CoverageModel::internPanner(const PannerId& pannerId)
+{
+    const juce::ScopedLock lock(m_mutex);
+    return internPannerLocked(pannerId);
+}
+
+CoverageModel::PannerHandle CoverageModel::internPannerLocked(const PannerId& pannerId)
+{
+    std::string key = pannerId.toString();
+    auto it = m_pannerHandles.find(key);
+    if (it != m_pannerHandles.end())
+        return it->second;
+    
+    PannerHandle handle = static_cast<PannerHandle>(m_internedPanners.size());
+    InternedPanner interned;
+    interned.pannerId = pannerId;
+    interned.key = key;
+    m_internedPanners.push_back(std::move(interned));
+    m_pannerHandles.emplace(std::move(key), handle);
+    return handle;
+}
+
+PannerCoverage* CoverageModel::findCoverageLocked(PannerHandle handle, bool create)
+{
+    if (handle >= m_internedPanners.size())
+        return nullptr;
+    
+    InternedPanner& interned = m_internedPanners[handle];
+    if (interned.coverage != nullptr || !interned.pannerId.isValid())
+        return interned.coverage;
+    
+    // First use since the panner was interned, removed or the model reset
+    auto it = m_pannerCoverages.find(interned.key);
+    if (it == m_pannerCoverages.end())
+    {
+        if (!create)
+            return nullptr;
+        it = m_pannerCoverages.emplace(interned.key, PannerCoverage()).first;
+        it->second.pannerId = interned.pannerId;
+        m_counts.setNumPanners(static_cast<uint32_t>(m_pannerCoverages.size()));
+    }
+    
+    interned.coverage = &it->second;
+    return interned.coverage;
+}
+
 void CoverageModel::addPannerInterval(const PannerId& pannerId, int64_t startSample, int64_t numSamples,
                                       uint32_t sampleRate, uint32_t channels, uint32_t sequenceNumber, uint64_t bufferId)
 {
     if (!pannerId.isValid() || numSamples <= 0)
         return;
     
+    addPannerInterval(internPanner(pannerId), startSample, numSamples, sampleRate, channels, sequenceNumber, bufferId);
+}
+
+void CoverageModel::addPannerInterval(PannerHandle handle, int64_t startSample, int64_t numSamples,
+                                      uint32_t sampleRate, uint32_t channels, uint32_t sequenceNumber, uint64_t bufferId)
+{
+    if (numSamples <= 0)
+        return;
+    
     int64_t endSample = startSample + numSamples;
     
     {
         const juce::ScopedLock lock(m_mutex);
         
-        std::string key = pannerId.toString();
-        
         // Get or create panner coverage
-        auto& coverage = m_pannerCoverages[key];
-        if (!coverage.pannerId.isValid())
-        {
-            coverage.pannerId = pannerId;
-        }
+        PannerCoverage* found = findCoverageLocked(handle, true);
+        if (found == nullptr)
+            return;
+        auto& coverage = *found;
         
-        // Detect dropout (gap in sequence or sample position)
-        if (coverage.lastBufferId > 0 && coverage.lastEndSample > 0)
+        // Detect dropout (gap in sequence and sample position)
+        SampleInterval missing;
+        uint32_t missed = 0;
+        if (coverage.findSequenceGap(startSample, sequenceNumber, missing, missed))
         {
-            // Check for sequence gap
-            if (sequenceNumber > coverage.lastSequenceNumber + 1)
-            {
-                uint32_t missed = sequenceNumber - coverage.lastSequenceNumber - 1;
-                // Estimate dropout region based on expected vs actual position
-                int64_t expectedStart = coverage.lastEndSample;
-                if (startSample > expectedStart)
-                {
-                    coverage.dropouts.push_back(DropoutInterval(
-                        expectedStart, startSample,
-                        juce::Time::currentTimeMillis(),
-                        missed, true
-                    ));
-                    coverage.totalDropoutsDetected += missed;
-                }
-            }
-            // Check for sample position gap (without sequence gap - could be DAW seeking)
-            else if (startSample > coverage.lastEndSample + numSamples)
-            {
-                // Significant gap - record as potential dropout
-                // (Could also be DAW timeline jump, but we track it anyway)
-            }
+            coverage.dropouts.push_back(DropoutInterval(
+                missing.start, missing.end,
+                juce::Time::currentTimeMillis(),
+                missed, true
+            ));
+            addDropoutLocked(coverage, missing.start, missing.end);
+            coverage.totalDropoutsDetected += missed;
+            m_totalDropoutsDetected += missed;
         }
         
         // Add the interval
-        coverage.capturedIntervals.addInterval(startSample, endSample);
+        addCoveredLocked(coverage, startSample, endSample);
+        markChangedLocked(coverage, startSample, endSample);
         
         // Update tracking
         coverage.sampleRate = sampleRate;
@@ -218,20 +172,16 @@ void CoverageModel::addPannerInterval(const PannerId& pannerId, int64_t startSam
         coverage.lastBufferId = bufferId;
         coverage.lastEndSample = endSample;
         coverage.totalBlocksReceived++;
+        m_totalBlocksReceived++;
+        m_generation++;
         
         // Update global sample rate
         m_globalSampleRate.store(sampleRate);
     }
     
-    // Update global range (outside lock for atomics)
+    // Update global range and latest position (outside lock for atomics)
     updateGlobalRange(startSample, endSample);
-    
-    // Update latest position
-    int64_t currentLatest = m_latestSamplePosition.load();
-    while (endSample > currentLatest && !m_latestSamplePosition.compare_exchange_weak(currentLatest, endSample))
-    {
-        // CAS loop
-    }
+    updateLatestSample(endSample);
 }
 
 void CoverageModel::addDropout(const PannerId& pannerId, int64_t startSample, int64_t endSample,
@@ -240,26 +190,44 @@ void CoverageModel::addDropout(const PannerId& pannerId, int64_t startSample, in
     if (!pannerId.isValid())
         return;
     
+    addDropout(internPanner(pannerId), startSample, endSample, missedBufferCount, boundsKnown);
+}
+
+void CoverageModel::addDropout(PannerHandle handle, int64_t startSample, int64_t endSample,
+                               uint32_t missedBufferCount, bool boundsKnown)
+{
     const juce::ScopedLock lock(m_mutex);
     
-    std::string key = pannerId.toString();
-    auto it = m_pannerCoverages.find(key);
-    
-    if (it != m_pannerCoverages.end())
+    PannerCoverage* coverage = findCoverageLocked(handle, false);
+    if (coverage != nullptr)
     {
-        it->second.dropouts.push_back(DropoutInterval(
+        coverage->dropouts.push_back(DropoutInterval(
             startSample, endSample,
             juce::Time::currentTimeMillis(),
             missedBufferCount, boundsKnown
         ));
-        it->second.totalDropoutsDetected++;
+        addDropoutLocked(*coverage, startSample, endSample);
+        markChangedLocked(*coverage, 0, 0);
+        coverage->totalDropoutsDetected++;
+        m_totalDropoutsDetected++;
+        m_generation++;
     }
 }
 
 void CoverageModel::removePanner(const PannerId& pannerId)
 {
     const juce::ScopedLock lock(m_mutex);
-    m_pannerCoverages.erase(pannerId.toString());
+    
+    std::string key = pannerId.toString();
+    auto handle = m_pannerHandles.find(key);
+    if (handle != m_pannerHandles.end())
+        m_internedPanners[handle->second].coverage = nullptr;
+    
+    if (m_pannerCoverages.erase(key) > 0)
+    {
+        rebuildAggregatesLocked();
+        m_changesReset = true;
+    }
 }
 
 const PannerCoverage* CoverageModel::getPannerCoverage(const PannerId& pannerId) const
@@ -274,6 +242,18 @@ const PannerCoverage* CoverageModel::getPannerCoverage(const PannerId& pannerId)
     return nullptr;
 }
 
+std::vector<DropoutInterval> CoverageModel::getPannerDropouts(const PannerId& pannerId) const
+{
+    const juce::ScopedLock lock(m_mutex);
+    
+    auto it = m_pannerCoverages.find(pannerId.toString());
+    if (it != m_pannerCoverages.end())
+    {
+        return it->second.dropouts;
+    }
+    return {};
+}
+
 std::vector<PannerId> CoverageModel::getPannerIds() const
 {
     const juce::ScopedLock lock(m_mutex);
@@ -316,150 +296,353 @@ void CoverageModel::setGlobalRange(int64_t start, int64_t end)
 CapturedIntervalSet CoverageModel::getAnyCoverage() const
 {
     const juce::ScopedLock lock(m_mutex);
+    return m_counts.getAnyCoverage();
+}
+
+CapturedIntervalSet CoverageModel::getAllCoverage() const
+{
+    const juce::ScopedLock lock(m_mutex);
+    return m_counts.getAllCoverage();
+}
+
+CapturedIntervalSet CoverageModel::getCoverage(uint32_t minPanners) const
+{
+    const juce::ScopedLock lock(m_mutex);
+    return sweepLocked(minPanners).minCoverage;
+}
+
+std::vector<SampleInterval> CoverageModel::getAnyDropouts() const
+{
+    const juce::ScopedLock lock(m_mutex);
+    return m_anyDropouts.getIntervals();
+}
+
+std::vector<SampleInterval> CoverageModel::getAllDropouts() const
+{
+    const juce::ScopedLock lock(m_mutex);
+    
+    // Gaps in the any-coverage: no panner has the samples
+    return m_counts.getAnyCoverage().getGaps();
+}
+
+CoverageModel::GlobalStats CoverageModel::getGlobalStats() const
+{
+    const juce::ScopedLock lock(m_mutex);
+    return getGlobalStatsLocked();
+}
+
+CoverageModel::GlobalCoverage CoverageModel::getGlobalCoverage() const
+{
+    const juce::ScopedLock lock(m_mutex);
+    return getGlobalCoverageLocked();
+}
+
+void CoverageModel::getCoverageColumns(int64_t viewStart, int64_t viewEnd, int numColumns,
+                                       std::vector<CoverageColumn>& columns) const
+{
+    if (const auto snapshot = getSnapshot())
+        snapshot->getCoverageColumns(viewStart, viewEnd, numColumns, columns);
+    else
+        columns.assign(static_cast<size_t>(juce::jmax(0, numColumns)), CoverageColumn());
+}
+
+bool CoverageModel::getPannerCoverageColumns(const PannerId& pannerId, int64_t viewStart, int64_t viewEnd, int numColumns,
+                                             std::vector<CoverageColumn>& columns) const
+{
+    const auto snapshot = getSnapshot();
+    if (snapshot != nullptr)
+        return snapshot->getPannerCoverageColumns(pannerId, viewStart, viewEnd, numColumns, columns);
+    
+    columns.assign(static_cast<size_t>(juce::jmax(0, numColumns)), CoverageColumn());
+    return false;
+}
+
+void CoverageModel::Snapshot::getCoverageColumns(int64_t viewStart, int64_t viewEnd, int numColumns,
+                                                 std::vector<CoverageColumn>& columns) const
+{
+    columns.resize(static_cast<size_t>(juce::jmax(0, numColumns)));
+    if (!columns.empty() && anyPyramid != nullptr)
+        anyPyramid->getColumns(viewStart, viewEnd, numColumns, columns.data());
+}
+
+bool CoverageModel::Snapshot::getPannerCoverageColumns(const PannerId& pannerId, int64_t viewStart, int64_t viewEnd,
+                                                       int numColumns, std::vector<CoverageColumn>& columns) const
+{
+    columns.resize(static_cast<size_t>(juce::jmax(0, numColumns)));
     
-    CapturedIntervalSet combined;
+    auto it = pannerPyramids.find(pannerId.toString());
+    if (it == pannerPyramids.end())
+        return false;
     
-    for (const auto& pair : m_pannerCoverages)
+    if (!columns.empty())
+        it->second->getColumns(viewStart, viewEnd, numColumns, columns.data());
+    return true;
+}
+
+bool CoverageModel::publishSnapshot()
+{
+    std::shared_ptr<const Snapshot> snapshot;
     {
-        for (const auto& interval : pair.second.capturedIntervals.getIntervals())
+        const juce::ScopedLock lock(m_mutex);
+        
+        // The range moves outside the lock, after the change that moved it
+        const auto current = std::atomic_load(&m_snapshot);
+        const auto range = getGlobalRange();
+        if (current != nullptr && current->generation == m_generation
+            && current->stats.globalStartSample == range.start && current->stats.globalEndSample == range.end)
+            return false;
+        
+        auto next = std::make_shared<Snapshot>();
+        next->stats = getGlobalStatsLocked();
+        next->generation = m_generation;
+        
+        // Spare copies take the blocks written since; unchanged pyramids keep their last copy
+        next->anyPyramid = m_anyPublishedPyramid.publish(m_anyPyramid);
+        for (auto& pair : m_pannerCoverages)
         {
-            combined.addInterval(interval);
+            PannerCoverage& coverage = pair.second;
+            next->pannerPyramids.emplace_hint(next->pannerPyramids.end(), pair.first,
+                                              coverage.publishedPyramid.publish(coverage.pyramid));
         }
+        snapshot = std::move(next);
     }
     
-    return combined;
+    std::atomic_store(&m_snapshot, std::move(snapshot));
+    return true;
 }
 
-CapturedIntervalSet CoverageModel::getAllCoverage() const
+const CoverageSweep::Result& CoverageModel::sweepLocked(uint32_t minPanners) const
 {
-    const juce::ScopedLock lock(m_mutex);
+    const uint32_t numPanners = static_cast<uint32_t>(m_pannerCoverages.size());
+    const uint32_t clampedMinPanners = juce::jlimit(1u, juce::jmax(1u, numPanners), minPanners);
+    if (m_sweepGeneration == m_generation && m_sweep.minPanners == clampedMinPanners)
+        return m_sweep;
+    
+    CoverageSweep sweep;
+    for (const auto& pair : m_pannerCoverages)
+        sweep.addPanner(pair.second.capturedIntervals, &pair.second.dropoutIntervals);
+    
+    m_sweep = sweep.run(clampedMinPanners);
+    m_sweepGeneration = m_generation;
+    return m_sweep;
+}
+
+CoverageModel::GlobalStats CoverageModel::getGlobalStatsLocked() const
+{
+    GlobalStats stats;
+    
+    auto range = getGlobalRange();
+    stats.globalStartSample = range.start;
+    stats.globalEndSample = range.end;
+    stats.totalRangeSamples = range.length();
     
-    if (m_pannerCoverages.empty())
-        return CapturedIntervalSet();
+    stats.pannerCount = static_cast<uint32_t>(m_pannerCoverages.size());
+    stats.totalBlocksReceived = m_totalBlocksReceived;
+    stats.totalDropoutsDetected = m_totalDropoutsDetected;
+    
+    // Calculate coverage stats
+    stats.totalCapturedSamples = m_counts.getAnyCoverage().getTotalCapturedSamples();
+    stats.fullCoverageSamples = m_counts.getAllCoverage().getTotalCapturedSamples();
     
-    // Start with the first panner's intervals
-    auto it = m_pannerCoverages.begin();
-    std::vector<SampleInterval> result = it->second.capturedIntervals.getIntervals();
-    ++it;
+    stats.partialDropoutSamples = stats.totalCapturedSamples - stats.fullCoverageSamples;
+    stats.totalDropoutSamples = stats.totalRangeSamples - stats.totalCapturedSamples;
     
-    // Intersect with each subsequent panner
-    while (it != m_pannerCoverages.end())
+    return stats;
+}
+
+CoverageModel::GlobalCoverage CoverageModel::getGlobalCoverageLocked() const
+{
+    GlobalCoverage coverage;
+    coverage.stats = getGlobalStatsLocked();
+    coverage.anyCoverage = m_counts.getAnyCoverage().getIntervals();
+    coverage.anyDropouts = m_anyDropouts.getIntervals();
+    coverage.allDropouts = m_counts.getAnyCoverage().getGaps();
+    coverage.generation = m_generation;
+    return coverage;
+}
+
+void CoverageModel::addCoveredLocked(PannerCoverage& coverage, int64_t startSample, int64_t endSample)
+{
+    // What the panner did not have yet raises the global counts, and what no panner had
+    // extends the any coverage
+    coverage.capturedIntervals.addInterval(startSample, endSample, [this, &coverage](int64_t start, int64_t end)
     {
-        const auto& otherIntervals = it->second.capturedIntervals.getIntervals();
-        std::vector<SampleInterval> intersection;
-        
-        for (const auto& r : result)
-        {
-            for (const auto& o : otherIntervals)
-            {
-                // Calculate intersection
-                int64_t iStart = std::max(r.start, o.start);
-                int64_t iEnd = std::min(r.end, o.end);
-                
-                if (iStart < iEnd)
-                {
-                    intersection.push_back(SampleInterval(iStart, iEnd));
-                }
-            }
-        }
-        
-        result = std::move(intersection);
-        ++it;
-    }
+        coverage.pyramid.addCovered(start, end);
+        m_counts.add(start, end, [this](int64_t anyStart, int64_t anyEnd) { m_anyPyramid.addCovered(anyStart, anyEnd); });
+    });
+}
+
+void CoverageModel::addDropoutLocked(PannerCoverage& coverage, int64_t startSample, int64_t endSample)
+{
+    coverage.dropoutIntervals.addInterval(startSample, endSample);
+    coverage.pyramid.addDropout(startSample, endSample);
+    m_anyDropouts.addInterval(startSample, endSample);
+    m_anyPyramid.addDropout(startSample, endSample);
+}
+
+void CoverageModel::markChangedLocked(PannerCoverage& coverage, int64_t startSample, int64_t endSample)
+{
+    if (!m_trackChanges)
+        return;
     
-    CapturedIntervalSet allCoverage;
-    for (const auto& interval : result)
+    coverage.changed = true;
+    if (endSample > startSample)
     {
-        allCoverage.addInterval(interval);
+        coverage.changedRange = coverage.changedRange.isEmpty()
+            ? SampleInterval(startSample, endSample)
+            : coverage.changedRange.merge(SampleInterval(startSample, endSample));
     }
-    
-    return allCoverage;
 }
 
-std::vector<SampleInterval> CoverageModel::getAnyDropouts() const
+void CoverageModel::rebuildAggregatesLocked()
 {
-    const juce::ScopedLock lock(m_mutex);
-    
-    CapturedIntervalSet dropoutSet;
+    // Counts only go up, so a panner leaving starts them over (the other panners' own
+    // pyramids are unaffected)
+    m_counts.clear();
+    m_counts.setNumPanners(static_cast<uint32_t>(m_pannerCoverages.size()));
+    m_anyDropouts.clear();
+    m_anyPyramid.clear();
+    m_totalBlocksReceived = 0;
+    m_totalDropoutsDetected = 0;
     
     for (const auto& pair : m_pannerCoverages)
     {
-        for (const auto& dropout : pair.second.dropouts)
+        const PannerCoverage& coverage = pair.second;
+        for (const auto& interval : coverage.capturedIntervals)
+            m_counts.add(interval.start, interval.end,
+                         [this](int64_t start, int64_t end) { m_anyPyramid.addCovered(start, end); });
+        for (const auto& dropout : coverage.dropoutIntervals)
         {
-            dropoutSet.addInterval(dropout.startSample, dropout.endSample);
+            m_anyDropouts.addInterval(dropout);
+            m_anyPyramid.addDropout(dropout.start, dropout.end);
         }
+        m_totalBlocksReceived += coverage.totalBlocksReceived;
+        m_totalDropoutsDetected += coverage.totalDropoutsDetected;
     }
     
-    return dropoutSet.getIntervals();
+    m_generation++;
 }
 
-std::vector<SampleInterval> CoverageModel::getAllDropouts() const
+//==============================================================================
+void CoverageModel::setTrackChanges(bool track)
 {
     const juce::ScopedLock lock(m_mutex);
     
-    if (m_pannerCoverages.empty())
-        return {};
-    
-    // Find regions where ALL panners have gaps
-    auto globalRange = getGlobalRange();
-    if (globalRange.isEmpty())
-        return {};
+    // The first take after tracking starts has everything
+    m_changesReset = m_changesReset || (track && !m_trackChanges);
+    m_trackChanges = track;
+}
+
+bool CoverageModel::takeChanges(std::vector<PannerCoverage>& changes, bool everything)
+{
+    changes.clear();
     
-    // For each position in the global range, check if ALL panners are missing
-    // This is expensive for large ranges, so we'll use interval arithmetic
+    const juce::ScopedLock lock(m_mutex);
     
-    // Get the union of all coverage (any panner)
-    auto anyCoverage = getAnyCoverage();
+    everything = everything || m_changesReset;
+    m_changesReset = false;
+    for (auto& pair : m_pannerCoverages)
+    {
+        PannerCoverage& coverage = pair.second;
+        if (!everything && !coverage.changed)
+            continue;
+        
+        PannerCoverage taken;
+        taken.pannerId = coverage.pannerId;
+        taken.sampleRate = coverage.sampleRate;
+        taken.channels = coverage.channels;
+        taken.lastSequenceNumber = coverage.lastSequenceNumber;
+        taken.lastBufferId = coverage.lastBufferId;
+        taken.lastEndSample = coverage.lastEndSample;
+        taken.totalBlocksReceived = coverage.totalBlocksReceived;
+        taken.totalDropoutsDetected = coverage.totalDropoutsDetected;
+        
+        if (everything)
+        {
+            taken.capturedIntervals = coverage.capturedIntervals;
+            taken.dropouts = coverage.dropouts;
+        }
+        else
+        {
+            for (const auto& interval : coverage.capturedIntervals.getIntervalsInRange(coverage.changedRange))
+                taken.capturedIntervals.addInterval(interval);
+            taken.dropouts.assign(coverage.dropouts.begin() + static_cast<std::ptrdiff_t>(coverage.takenDropouts),
+                                  coverage.dropouts.end());
+        }
+        
+        coverage.changed = false;
+        coverage.changedRange = SampleInterval();
+        coverage.takenDropouts = coverage.dropouts.size();
+        changes.push_back(std::move(taken));
+    }
     
-    // Get gaps in the any-coverage - these are total dropouts
-    return anyCoverage.getGaps();
+    return everything;
 }
 
-CoverageModel::GlobalStats CoverageModel::getGlobalStats() const
+void CoverageModel::restorePanner(const PannerCoverage& saved)
 {
-    GlobalStats stats;
-    
-    auto range = getGlobalRange();
-    stats.globalStartSample = range.start;
-    stats.globalEndSample = range.end;
-    stats.totalRangeSamples = range.length();
+    if (!saved.pannerId.isValid())
+        return;
     
+    const SampleInterval bounds = saved.capturedIntervals.getBoundingInterval();
     {
         const juce::ScopedLock lock(m_mutex);
         
-        stats.pannerCount = static_cast<uint32_t>(m_pannerCoverages.size());
+        PannerCoverage* found = findCoverageLocked(internPannerLocked(saved.pannerId), true);
+        if (found == nullptr)
+            return;
+        auto& coverage = *found;
         
-        for (const auto& pair : m_pannerCoverages)
+        for (const auto& interval : saved.capturedIntervals)
+            addCoveredLocked(coverage, interval.start, interval.end);
+        for (const auto& dropout : saved.dropouts)
         {
-            stats.totalBlocksReceived += pair.second.totalBlocksReceived;
-            stats.totalDropoutsDetected += pair.second.totalDropoutsDetected;
+            coverage.dropouts.push_back(dropout);
+            addDropoutLocked(coverage, dropout.startSample, dropout.endSample);
         }
+        markChangedLocked(coverage, bounds.start, bounds.end);
+        
+        coverage.sampleRate = saved.sampleRate;
+        coverage.channels = saved.channels;
+        coverage.lastSequenceNumber = saved.lastSequenceNumber;
+        coverage.lastBufferId = saved.lastBufferId;
+        coverage.lastEndSample = saved.lastEndSample;
+        m_totalBlocksReceived += saved.totalBlocksReceived - coverage.totalBlocksReceived;
+        m_totalDropoutsDetected += saved.totalDropoutsDetected - coverage.totalDropoutsDetected;
+        coverage.totalBlocksReceived = saved.totalBlocksReceived;
+        coverage.totalDropoutsDetected = saved.totalDropoutsDetected;
+        m_generation++;
+        
+        m_globalSampleRate.store(saved.sampleRate);
     }
     
-    // Calculate coverage stats
-    auto anyCoverage = getAnyCoverage();
-    stats.totalCapturedSamples = anyCoverage.getTotalCapturedSamples();
-    
-    auto allCoverage = getAllCoverage();
-    stats.fullCoverageSamples = allCoverage.getTotalCapturedSamples();
-    
-    stats.partialDropoutSamples = stats.totalCapturedSamples - stats.fullCoverageSamples;
-    stats.totalDropoutSamples = stats.totalRangeSamples - stats.totalCapturedSamples;
-    
-    return stats;
+    if (!bounds.isEmpty())
+    {
+        updateGlobalRange(bounds.start, bounds.end);
+        updateLatestSample(bounds.end);
+    }
 }
 
 void CoverageModel::reset()
 {
-    const juce::ScopedLock lock(m_mutex);
+    {
+        const juce::ScopedLock lock(m_mutex);
+        
+        m_pannerCoverages.clear();
+        rebuildAggregatesLocked();
+        m_changesReset = true;
+        for (auto& interned : m_internedPanners)
+            interned.coverage = nullptr;
+        m_globalStartSample.store(INT64_MAX);
+        m_globalEndSample.store(INT64_MIN);
+        m_latestSamplePosition.store(0);
+        m_rangeLocked = false;
+        m_lockedStartSample = 0;
+        m_lockedEndSample = 0;
+    }
     
-    m_pannerCoverages.clear();
-    m_globalStartSample.store(INT64_MAX);
-    m_globalEndSample.store(INT64_MIN);
-    m_latestSamplePosition.store(0);
-    m_rangeLocked = false;
-    m_lockedStartSample = 0;
-    m_lockedEndSample = 0;
+    // Readers see the cleared model right away, not the last capture
+    publishSnapshot();
 }
 
 void CoverageModel::updateGlobalRange(int64_t startSample, int64_t endSample)
@@ -482,5 +665,13 @@ void CoverageModel::updateGlobalRange(int64_t startSample, int64_t endSample)
     }
 }
 
-} // namespace Mach1
+void CoverageModel::updateLatestSample(int64_t endSample)
+{
+    int64_t currentLatest = m_latestSamplePosition.load();
+    while (endSample > currentLatest && !m_latestSamplePosition.compare_exchange_weak(currentLatest, endSample))
+    {
+        // CAS loop
+    }
+}
 
+} // namespace Mach1
@@ -6,14 +6,27 @@
     
     Design:
     - CapturedIntervalSet: stores union of [start, end) sample intervals with auto-merge
+      (ordered tree, O(log n) insert and lookup; see CapturedIntervalSet.h)
     - DropoutInterval: represents a known dropout (ring buffer overrun)
     - PannerCoverage: per-panner coverage data
-    - GlobalCoverage: aggregated view across all panners
+    - GlobalCoverage: aggregated view across all panners, kept up to date as intervals and
+      dropouts arrive (CoverageCounts), and published as an immutable snapshot
+      (publishSnapshot) that readers take without locking, so the UI never blocks capture
+    - CoveragePyramid: coverage and dropouts per power-of-two bucket, per panner and for
+      the any coverage, so a view of any length is drawn one pixel column at a time;
+      the snapshot carries copies refreshed on the publishing thread, so drawing takes no
+      lock either and capture never copies a block
+    - takeChanges / restorePanner: what changed since the last take, and merging saved
+      coverage back in, for CoverageStore (the session's coverage file) and CoverageRebuilder
 */
 
 #pragma once
 
 #include <JuceHeader.h>
+#include "CapturedIntervalSet.h"
+#include "CoverageCounts.h"
+#include "CoveragePyramid.h"
+#include "CoverageSweep.h"
 #include <vector>
 #include <map>
 #include <set>
@@ -21,104 +34,10 @@
 #include <mutex>
 #include <atomic>
 #include <algorithm>
+#include <memory>
 
 namespace Mach1 {
 
-//==============================================================================
-/**
- * Represents a sample interval [start, end)
- */
-struct SampleInterval
-{
-    int64_t start = 0;  // Inclusive
-    int64_t end = 0;    // Exclusive
-    
-    SampleInterval() = default;
-    SampleInterval(int64_t s, int64_t e) : start(s), end(e) {}
-    
-    int64_t length() const { return end - start; }
-    bool isEmpty() const { return end <= start; }
-    bool contains(int64_t sample) const { return sample >= start && sample < end; }
-    bool overlaps(const SampleInterval& other) const {
-        return start < other.end && other.start < end;
-    }
-    bool adjacentTo(const SampleInterval& other) const {
-        return end == other.start || other.end == start;
-    }
-    bool canMerge(const SampleInterval& other) const {
-        return overlaps(other) || adjacentTo(other);
-    }
-    
-    SampleInterval merge(const SampleInterval& other) const {
-        return SampleInterval(std::min(start, other.start), std::max(end, other.end));
-    }
-    
-    bool operator<(const SampleInterval& other) const {
-        return start < other.start || (start == other.start && end < other.end);
-    }
-    
-    bool operator==(const SampleInterval& other) const {
-        return start == other.start && end == other.end;
-    }
-};
-
-//==============================================================================
-/**
- * A set of sample intervals with automatic merging of overlapping/adjacent intervals.
- * Maintains a sorted, non-overlapping list of intervals.
- */
-class CapturedIntervalSet
-{
-public:
-    CapturedIntervalSet() = default;
-    
-    /**
-     * Add an interval [start, end) to the set, merging with existing intervals as needed.
-     */
-    void addInterval(int64_t start, int64_t end);
-    void addInterval(const SampleInterval& interval) { addInterval(interval.start, interval.end); }
-    
-    /**
-     * Get all intervals (sorted, non-overlapping)
-     */
-    const std::vector<SampleInterval>& getIntervals() const { return m_intervals; }
-    
-    /**
-     * Get total captured samples (sum of all interval lengths)
-     */
-    int64_t getTotalCapturedSamples() const;
-    
-    /**
-     * Check if a sample position is covered
-     */
-    bool isCovered(int64_t sample) const;
-    
-    /**
-     * Get the range covered by all intervals
-     */
-    SampleInterval getBoundingInterval() const;
-    
-    /**
-     * Get gaps (uncovered intervals) within the bounding range
-     */
-    std::vector<SampleInterval> getGaps() const;
-    
-    /**
-     * Clear all intervals
-     */
-    void clear();
-    
-    /**
-     * Get number of discrete intervals
-     */
-    size_t getIntervalCount() const { return m_intervals.size(); }
-    
-private:
-    std::vector<SampleInterval> m_intervals;  // Sorted, non-overlapping
-    
-    void mergeOverlapping();
-};
-
 //==============================================================================
 /**
  * Represents a detected dropout (ring buffer overrun)
@@ -176,6 +95,8 @@ struct PannerCoverage
     PannerId pannerId;
     CapturedIntervalSet capturedIntervals;
     std::vector<DropoutInterval> dropouts;
+    CapturedIntervalSet dropoutIntervals;   // Union of the dropouts, for the sweep
+    CoveragePyramid pyramid;                // Both of the above at every zoom, for drawing
     
     // Audio format info
     uint32_t sampleRate = 44100;
@@ -190,6 +111,22 @@ struct PannerCoverage
     uint32_t totalBlocksReceived = 0;
     uint32_t totalDropoutsDetected = 0;
     
+    // Copies of the pyramid for CoverageModel::publishSnapshot
+    CoveragePyramidPublisher publishedPyramid;
+    
+    // Changed since the last CoverageModel::takeChanges (while it tracks changes)
+    bool changed = false;
+    SampleInterval changedRange;            // Samples whose coverage changed
+    size_t takenDropouts = 0;               // Leading dropouts already taken
+    
+    /**
+     * Whether a block arriving after the last one follows a sequence gap with samples
+     * missing in between (a dropout)
+     * @param missing        The samples between the last block and this one
+     * @param missedBuffers  Sequence numbers skipped
+     */
+    bool findSequenceGap(int64_t startSample, uint32_t sequenceNumber, SampleInterval& missing, uint32_t& missedBuffers) const;
+    
     // Get coverage percentage within the bounding interval
     float getCoveragePercent() const;
     
@@ -213,17 +150,28 @@ public:
     //==========================================================================
     // Panner management
     
+    /**
+     * Interned panner: resolved once, so per-block updates don't build or compare its
+     * string key. Handles stay valid for the lifetime of the model, across reset().
+     */
+    using PannerHandle = uint32_t;
+    PannerHandle internPanner(const PannerId& pannerId);
+    
     /**
      * Add or update coverage for a panner
      */
     void addPannerInterval(const PannerId& pannerId, int64_t startSample, int64_t numSamples,
                           uint32_t sampleRate, uint32_t channels, uint32_t sequenceNumber, uint64_t bufferId);
+    void addPannerInterval(PannerHandle handle, int64_t startSample, int64_t numSamples,
+                          uint32_t sampleRate, uint32_t channels, uint32_t sequenceNumber, uint64_t bufferId);
     
     /**
      * Record a dropout for a panner
      */
     void addDropout(const PannerId& pannerId, int64_t startSample, int64_t endSample,
                    uint32_t missedBufferCount = 0, bool boundsKnown = true);
+    void addDropout(PannerHandle handle, int64_t startSample, int64_t endSample,
+                   uint32_t missedBufferCount = 0, bool boundsKnown = true);
     
     /**
      * Remove a panner (when it disconnects)
@@ -232,9 +180,15 @@ public:
     
     /**
      * Get coverage data for a specific panner
+     * The pointer is not locked: only use it while nothing else updates the model.
      */
     const PannerCoverage* getPannerCoverage(const PannerId& pannerId) const;
     
+    /**
+     * Copy of a panner's dropouts, safe while the model is being updated
+     */
+    std::vector<DropoutInterval> getPannerDropouts(const PannerId& pannerId) const;
+    
     /**
      * Get all panner coverages
      */
@@ -272,6 +226,12 @@ public:
      */
     CapturedIntervalSet getAllCoverage() const;
     
+    /**
+     * Get intervals where at least minPanners panners have coverage (k of n); one
+     * CoverageSweep pass, reused until the coverage changes
+     */
+    CapturedIntervalSet getCoverage(uint32_t minPanners) const;
+    
     /**
      * Get intervals where at least one panner has a dropout
      */
@@ -308,6 +268,85 @@ public:
     
     GlobalStats getGlobalStats() const;
     
+    /**
+     * Stats, any coverage and both dropout views together
+     */
+    struct GlobalCoverage
+    {
+        GlobalStats stats;
+        std::vector<SampleInterval> anyCoverage;
+        std::vector<SampleInterval> anyDropouts;
+        std::vector<SampleInterval> allDropouts;
+        uint64_t generation = 0;            // Changes made to the model when it was taken
+    };
+    
+    GlobalCoverage getGlobalCoverage() const;
+    
+    /**
+     * One pixel column of a view: samples shown, how many are covered, dropouts and gaps
+     */
+    using CoverageColumn = CoveragePyramid::Column;
+    
+    /**
+     * What readers take without locking: the stats, the generation they reflect and the
+     * pyramids to draw views from (intervals are not copied). A pyramid's copy is
+     * brought up to date from the blocks written since (CoveragePyramidPublisher), and a
+     * panner that did not change keeps the copy published before.
+     */
+    struct Snapshot
+    {
+        GlobalStats stats;
+        uint64_t generation = 0;
+        std::shared_ptr<const CoveragePyramid> anyPyramid;
+        std::map<std::string, std::shared_ptr<const CoveragePyramid>> pannerPyramids;  // key = PannerId::toString()
+        
+        /**
+         * Split [viewStart, viewEnd) into numColumns columns of any coverage (gap: no
+         * panner has some of the column's samples), O(numColumns) whatever the session
+         * length. Without the intervals, a base bucket that a column edge cuts and that
+         * is only partly covered is estimated (see CoveragePyramid).
+         */
+        void getCoverageColumns(int64_t viewStart, int64_t viewEnd, int numColumns,
+                                std::vector<CoverageColumn>& columns) const;
+        
+        /**
+         * The same for one panner's coverage and dropouts
+         * @return false if the panner is unknown
+         */
+        bool getPannerCoverageColumns(const PannerId& pannerId, int64_t viewStart, int64_t viewEnd, int numColumns,
+                                      std::vector<CoverageColumn>& columns) const;
+    };
+    
+    /**
+     * Latest published Snapshot; never takes the model's lock, so readers (UI,
+     * CaptureEngine::getStats) cannot hold up capture. nullptr until the first publish.
+     */
+    std::shared_ptr<const Snapshot> getSnapshot() const { return std::atomic_load(&m_snapshot); }
+    
+    /**
+     * Publish a new snapshot if the coverage or range changed since the last one
+     * (the capture engine does this on its scheduling thread)
+     * @return true if one was published
+     */
+    bool publishSnapshot();
+    
+    //==========================================================================
+    // Drawing
+    
+    /**
+     * Snapshot::getCoverageColumns of the latest published snapshot: never takes the
+     * model's lock (all empty columns before the first publish)
+     */
+    void getCoverageColumns(int64_t viewStart, int64_t viewEnd, int numColumns,
+                            std::vector<CoverageColumn>& columns) const;
+    
+    /**
+     * Snapshot::getPannerCoverageColumns of the latest published snapshot
+     * @return false if the panner is unknown
+     */
+    bool getPannerCoverageColumns(const PannerId& pannerId, int64_t viewStart, int64_t viewEnd, int numColumns,
+                                  std::vector<CoverageColumn>& columns) const;
+    
     /**
      * Get latest sample position (playhead)
      */
@@ -318,6 +357,30 @@ public:
      */
     uint32_t getSampleRate() const { return m_globalSampleRate.load(); }
     
+    //==========================================================================
+    // Persistence (CoverageStore, CoverageRebuilder)
+    
+    /**
+     * Start or stop recording what changes, for takeChanges
+     */
+    void setTrackChanges(bool track);
+    
+    /**
+     * The panners that changed since the last call: their tracking fields and counters as
+     * they are now, with the intervals and dropouts that changed since (intervals are
+     * those in the changed range, so some may have been taken before)
+     * @param everything Every panner in full, as after a reset (to compact what was taken)
+     * @return true if changes holds every panner in full (asked for, or the model was
+     *         reset or a panner removed since), to replace everything taken before
+     */
+    bool takeChanges(std::vector<PannerCoverage>& changes, bool everything = false);
+    
+    /**
+     * Merge saved coverage of a panner in: its captured intervals and dropouts (the list)
+     * are added to what the panner has, its tracking fields and counters taken as saved
+     */
+    void restorePanner(const PannerCoverage& saved);
+    
     //==========================================================================
     // Reset
     
@@ -330,16 +393,56 @@ private:
     mutable juce::CriticalSection m_mutex;
     std::map<std::string, PannerCoverage> m_pannerCoverages;  // key = PannerId::toString()
     
+    // Interned panners, indexed by PannerHandle (never removed)
+    struct InternedPanner
+    {
+        PannerId pannerId;
+        std::string key;
+        PannerCoverage* coverage = nullptr;   // Entry in m_pannerCoverages, once created
+    };
+    std::vector<InternedPanner> m_internedPanners;
+    std::map<std::string, PannerHandle> m_pannerHandles;
+    
     std::atomic<int64_t> m_globalStartSample{INT64_MAX};
     std::atomic<int64_t> m_globalEndSample{INT64_MIN};
     std::atomic<int64_t> m_latestSamplePosition{0};
     std::atomic<uint32_t> m_globalSampleRate{44100};
     
+    // Global aggregates, updated with every interval and dropout
+    CoverageCounts m_counts;
+    CapturedIntervalSet m_anyDropouts;
+    CoveragePyramid m_anyPyramid;           // m_counts' any coverage and m_anyDropouts
+    CoveragePyramidPublisher m_anyPublishedPyramid;
+    uint32_t m_totalBlocksReceived = 0;
+    uint32_t m_totalDropoutsDetected = 0;
+    uint64_t m_generation = 0;              // Bumped by every change
+    
+    // Last k-of-n sweep, valid while m_generation is unchanged
+    mutable CoverageSweep::Result m_sweep;
+    mutable uint64_t m_sweepGeneration = UINT64_MAX;
+    
+    // Published snapshot (std::atomic_load/atomic_store only)
+    std::shared_ptr<const Snapshot> m_snapshot;
+    
+    // Change tracking (takeChanges)
+    bool m_trackChanges = false;
+    bool m_changesReset = false;            // Reset or a panner removed since the last take
+    
     bool m_rangeLocked = false;
     int64_t m_lockedStartSample = 0;
     int64_t m_lockedEndSample = 0;
     
     void updateGlobalRange(int64_t startSample, int64_t endSample);
+    void updateLatestSample(int64_t endSample);
+    PannerHandle internPannerLocked(const PannerId& pannerId);
+    PannerCoverage* findCoverageLocked(PannerHandle handle, bool create);
+    const CoverageSweep::Result& sweepLocked(uint32_t minPanners) const;
+    GlobalStats getGlobalStatsLocked() const;
+    GlobalCoverage getGlobalCoverageLocked() const;
+    void addCoveredLocked(PannerCoverage& coverage, int64_t startSample, int64_t endSample);
+    void markChangedLocked(PannerCoverage& coverage, int64_t startSample, int64_t endSample);
+    void addDropoutLocked(PannerCoverage& coverage, int64_t startSample, int64_t endSample);
+    void rebuildAggregatesLocked();
 };
 
 } // namespace Mach1
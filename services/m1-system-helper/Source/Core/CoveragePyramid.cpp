@@ -0,0 +1,311 @@
+/*
+    CoveragePyramid.cpp
+    -------------------
+    Implementation of the mip-mapped coverage summary.
+*/
+
+#include "CoveragePyramid.h"
+#include <algorithm>
+#include <atomic>
+
+namespace Mach1 {
+
+namespace {
+
+/**
+ * Bucket holding sample at the given bucket size (rounds towards -infinity)
+ */
+int64_t bucketOf(int64_t sample, int shift)
+{
+    return sample >= 0 ? sample >> shift : -((-sample - 1) >> shift) - 1;
+}
+
+} // namespace
+
+//==============================================================================
+void CoveragePyramid::addCovered(int64_t start, int64_t end)
+{
+    if (end <= start)
+        return;
+
+    beginWrite();
+    m_bounds = m_bounds.isEmpty() ? SampleInterval(start, end)
+                                  : SampleInterval(std::min(m_bounds.start, start), std::max(m_bounds.end, end));
+
+    for (int l = 0; l < NUM_LEVELS; ++l)
+    {
+        const int shift = BASE_SHIFT + l;
+        const int64_t first = bucketOf(start, shift);
+        const int64_t last = bucketOf(end - 1, shift);
+        Level& level = m_levels[l];
+
+        for (int64_t bucket = first; bucket <= last; ++bucket)
+        {
+            const int64_t bucketStart = bucket << shift;
+            const int64_t bucketEnd = bucketStart + (int64_t(1) << shift);
+            const int64_t overlap = std::min(end, bucketEnd) - std::max(start, bucketStart);
+            size_t offset = 0;
+            writeBlock(level, bucket, m_version, offset).covered[offset] += static_cast<uint32_t>(overlap);
+        }
+    }
+}
+
+void CoveragePyramid::addDropout(int64_t start, int64_t end)
+{
+    if (end <= start)
+        return;
+
+    beginWrite();
+    for (int l = 0; l < NUM_LEVELS; ++l)
+    {
+        const int shift = BASE_SHIFT + l;
+        const int64_t first = bucketOf(start, shift);
+        const int64_t last = bucketOf(end - 1, shift);
+        Level& level = m_levels[l];
+
+        for (int64_t bucket = first; bucket <= last; ++bucket)
+        {
+            size_t offset = 0;
+            writeBlock(level, bucket, m_version, offset).dropouts[offset] = 1;
+        }
+    }
+}
+
+void CoveragePyramid::getColumns(int64_t viewStart, int64_t viewEnd, int numColumns, Column* columns,
+                                 const CapturedIntervalSet* exactCoverage,
+                                 const CapturedIntervalSet* exactDropouts) const
+{
+    for (int c = 0; c < numColumns; ++c)
+    {
+        Column& column = columns[c];
+        column = Column();
+        column.start = viewStart + (viewEnd - viewStart) * c / numColumns;
+        column.end = viewStart + (viewEnd - viewStart) * (c + 1) / numColumns;
+        if (column.end <= column.start)
+            continue;
+
+        readBuckets(column, exactCoverage, exactDropouts);
+
+        const int64_t inBounds = std::min(column.end, m_bounds.end) - std::max(column.start, m_bounds.start);
+        column.gap = column.coveredSamples < inBounds;
+    }
+}
+
+void CoveragePyramid::update(const CoveragePyramid& source)
+{
+    if (&source == this)
+        return;
+
+    const bool isCopy = m_sourceId == source.m_id;
+    for (int l = 0; l < NUM_LEVELS; ++l)
+    {
+        Level& level = m_levels[l];
+        const Level& from = source.m_levels[l];
+        alignLevel(level, from.firstBlock, from.blocks.size());
+
+        for (size_t index = 0; index < from.blocks.size(); ++index)
+        {
+            const auto& block = from.blocks[index];
+            auto& copy = level.blocks[index];
+            if (block == nullptr)
+                copy.reset();
+            else if (copy == nullptr)
+                copy = std::make_unique<Block>(*block);
+            else if (!isCopy || level.versions[index] != from.versions[index])
+                *copy = *block;
+            level.versions[index] = from.versions[index];
+        }
+    }
+
+    m_bounds = source.m_bounds;
+    m_version = source.m_version;
+    m_sourceId = source.m_id;
+    m_id = newId();     // Versions may have gone back: copies of this one start over
+}
+
+size_t CoveragePyramid::getMemoryBytes() const
+{
+    size_t bytes = 0;
+    for (const auto& level : m_levels)
+    {
+        bytes += level.blocks.capacity() * sizeof(std::unique_ptr<Block>) + level.versions.capacity() * sizeof(uint64_t);
+        for (const auto& block : level.blocks)
+            bytes += block != nullptr ? sizeof(Block) : 0;
+    }
+    return bytes;
+}
+
+void CoveragePyramid::clear()
+{
+    beginWrite();
+    for (auto& level : m_levels)
+        level = Level();
+    m_bounds = SampleInterval();
+}
+
+//==============================================================================
+void CoveragePyramid::readBuckets(Column& column, const CapturedIntervalSet* exactCoverage,
+                                  const CapturedIntervalSet* exactDropouts) const
+{
+    // Coarsest level whose buckets fit in the column: it spans at most three of them
+    const int64_t length = column.end - column.start;
+    int l = 0;
+    while (l + 1 < NUM_LEVELS && (int64_t(1) << (BASE_SHIFT + l + 1)) <= length)
+        ++l;
+
+    const int shift = BASE_SHIFT + l;
+    for (int64_t bucket = bucketOf(column.start, shift); bucket <= bucketOf(column.end - 1, shift); ++bucket)
+    {
+        const int64_t bucketStart = bucket << shift;
+        const SampleInterval part(std::max(column.start, bucketStart),
+                                  std::min(column.end, bucketStart + (int64_t(1) << shift)));
+        readPart(column, l, bucket, part, true, true, exactCoverage, exactDropouts);
+    }
+}
+
+void CoveragePyramid::readPart(Column& column, int l, int64_t bucket, const SampleInterval& part,
+                               bool countSamples, bool findDropout,
+                               const CapturedIntervalSet* exactCoverage,
+                               const CapturedIntervalSet* exactDropouts) const
+{
+    // Levels cover the same buckets, so nothing here means nothing below either
+    size_t offset = 0;
+    const Block* block = findBlock(m_levels[l], bucket, offset);
+    if (block == nullptr)
+        return;
+
+    const int shift = BASE_SHIFT + l;
+    const int64_t bucketSize = int64_t(1) << shift;
+    const int64_t count = block->covered[offset];
+    const bool whole = part.length() == bucketSize;
+    const bool flagged = block->dropouts[offset] != 0;
+
+    // Whole, empty or full buckets give the part's count directly; a whole flagged bucket its dropout
+    if (countSamples && (whole || count == 0 || count == bucketSize))
+    {
+        column.coveredSamples += count * part.length() / bucketSize;
+        countSamples = false;
+    }
+    if (findDropout && (column.dropout || !flagged || whole))
+    {
+        column.dropout = column.dropout || flagged;
+        findDropout = false;
+    }
+    if (!countSamples && !findDropout)
+        return;
+
+    // A base bucket cut by the column's edge: only the intervals know the part's share
+    if (l == 0)
+    {
+        if (countSamples)
+            column.coveredSamples += exactCoverage != nullptr ? exactCoverage->getCoveredSamples(part)
+                                                              : count * part.length() / bucketSize;
+        if (findDropout)
+            column.dropout = exactDropouts == nullptr || exactDropouts->getCoveredSamples(part) > 0;
+        return;
+    }
+
+    // Otherwise the halves: one lies wholly inside the part or outside it
+    const int64_t half = bucketSize / 2;
+    for (int64_t child = bucket * 2; child <= bucket * 2 + 1; ++child)
+    {
+        const int64_t childStart = child * half;
+        const SampleInterval childPart(std::max(part.start, childStart), std::min(part.end, childStart + half));
+        if (!childPart.isEmpty())
+            readPart(column, l - 1, child, childPart, countSamples, findDropout, exactCoverage, exactDropouts);
+    }
+}
+
+const CoveragePyramid::Block* CoveragePyramid::findBlock(const Level& level, int64_t bucket, size_t& offset)
+{
+    const int64_t number = bucketOf(bucket, BLOCK_SHIFT);
+    const int64_t index = number - level.firstBlock;
+    if (index < 0 || index >= static_cast<int64_t>(level.blocks.size()))
+        return nullptr;
+
+    offset = static_cast<size_t>(bucket - number * BLOCK_SIZE);
+    return level.blocks[static_cast<size_t>(index)].get();
+}
+
+uint64_t CoveragePyramid::newId()
+{
+    static std::atomic<uint64_t> nextId{1};
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CoveragePyramid::beginWrite()
+{
+    ++m_version;
+    m_sourceId = 0;     // A written copy no longer follows its source
+}
+
+CoveragePyramid::Block& CoveragePyramid::writeBlock(Level& level, int64_t bucket, uint64_t version, size_t& offset)
+{
+    const int64_t number = bucketOf(bucket, BLOCK_SHIFT);
+    offset = static_cast<size_t>(bucket - number * BLOCK_SIZE);
+
+    // Only out-of-order blocks or a seek backwards add blocks at the front
+    if (level.blocks.empty())
+        level.firstBlock = number;
+    const int64_t firstBlock = std::min(level.firstBlock, number);
+    const int64_t lastBlock = std::max(level.firstBlock + static_cast<int64_t>(level.blocks.size()) - 1, number);
+    alignLevel(level, firstBlock, static_cast<size_t>(lastBlock - firstBlock + 1));
+
+    const size_t index = static_cast<size_t>(number - level.firstBlock);
+    auto& block = level.blocks[index];
+    if (block == nullptr)
+        block = std::make_unique<Block>();
+    level.versions[index] = version;
+    return *block;
+}
+
+void CoveragePyramid::alignLevel(Level& level, int64_t firstBlock, size_t numBlocks)
+{
+    if (level.blocks.empty())
+        level.firstBlock = firstBlock;
+
+    // Blocks before firstBlock are dropped, and room is made for new ones before the first
+    if (firstBlock > level.firstBlock)
+    {
+        const size_t count = static_cast<size_t>(std::min<int64_t>(firstBlock - level.firstBlock,
+                                                                   static_cast<int64_t>(level.blocks.size())));
+        level.blocks.erase(level.blocks.begin(), level.blocks.begin() + static_cast<std::ptrdiff_t>(count));
+        level.versions.erase(level.versions.begin(), level.versions.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+    else if (firstBlock < level.firstBlock)
+    {
+        const size_t count = static_cast<size_t>(level.firstBlock - firstBlock);
+        level.blocks.resize(level.blocks.size() + count);
+        std::move_backward(level.blocks.begin(), level.blocks.end() - static_cast<std::ptrdiff_t>(count), level.blocks.end());
+        level.versions.insert(level.versions.begin(), count, 0);
+    }
+    level.firstBlock = firstBlock;
+
+    level.blocks.resize(numBlocks);
+    level.versions.resize(numBlocks, 0);
+}
+
+//==============================================================================
+std::shared_ptr<const CoveragePyramid> CoveragePyramidPublisher::publish(const CoveragePyramid& pyramid)
+{
+    const auto& last = m_copies[m_last];
+    if (last != nullptr && last->isUpToDateWith(pyramid))
+        return last;
+
+    auto& spare = m_copies[1 - m_last];
+    if (spare == nullptr || spare.use_count() > 1)
+    {
+        spare = std::make_shared<CoveragePyramid>();    // A reader still has the old one: leave it
+    }
+    else
+    {
+        // Readers that let go of it may have done so on other threads: see their reads done
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+
+    spare->update(pyramid);
+    m_last = 1 - m_last;
+    return spare;
+}
+
+} // namespace Mach1
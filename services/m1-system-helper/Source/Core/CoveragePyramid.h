@@ -0,0 +1,182 @@
+/*
+    CoveragePyramid.h
+    -----------------
+    Mip-mapped summary of one coverage (a panner's, or the global any coverage) for
+    drawing it at any zoom.
+
+    Level 0 splits the timeline into buckets of 2^BASE_SHIFT samples; each level above
+    doubles the bucket size. Every bucket holds how many of its samples are covered and
+    whether a dropout was recorded in it, so:
+    - addCovered / addDropout touch the buckets they overlap on every level, O(levels +
+      buckets touched); a captured block touches one or two buckets per level
+    - getColumns reads each pixel column from the coarsest level whose buckets fit in it,
+      so at most three buckets; a bucket the column's edge cuts is exact if it is empty or
+      fully covered, and otherwise read from its halves, down to the base level: O(1) per
+      column away from gaps and O(levels) next to one, so O(columns) whatever the session
+      length or how fragmented the coverage is
+
+    At the base level, the column's share of a cut, partly covered bucket is estimated
+    from its count (off by less than a base bucket per edge), or, given the exact
+    intervals, read from them in O(log n).
+
+    Buckets live in blocks of BLOCK_SIZE, allocated when one of their buckets is first
+    touched; writing to a pyramid never allocates beyond that, so capture stays
+    allocation-free once its blocks exist. Every block records the pyramid version of its
+    last write, so update() brings a copy up to date by copying only the blocks written
+    since, one or two per level per captured block, into the copy's own blocks.
+    CoveragePyramidPublisher keeps two such copies per pyramid and refreshes the one no
+    reader holds: CoverageModel publishes one with every snapshot, for readers to draw
+    without its lock, and the copying happens on the publishing thread. Counts only go
+    up, like CoverageCounts: removing coverage needs clear() and a re-add.
+
+    Plain C++ (no JUCE).
+*/
+
+#pragma once
+
+#include "CapturedIntervalSet.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Covered-sample counts and dropout flags at power-of-two bucket sizes
+ */
+class CoveragePyramid
+{
+public:
+    CoveragePyramid() = default;
+    CoveragePyramid(const CoveragePyramid& other) { update(other); }
+    CoveragePyramid& operator=(const CoveragePyramid& other) { update(other); return *this; }
+
+    static constexpr int BASE_SHIFT = 13;   // 8192-sample base buckets (~170 ms at 48 kHz)
+    static constexpr int NUM_LEVELS = 19;   // Up to 2^31-sample buckets (~12 h at 48 kHz)
+
+    /**
+     * One pixel column of a view
+     */
+    struct Column
+    {
+        int64_t start = 0;              // Samples [start, end) the column shows
+        int64_t end = 0;
+        int64_t coveredSamples = 0;     // Of them, covered
+        bool dropout = false;           // A dropout was recorded within the column
+        bool gap = false;               // Not covered somewhere between the first and last covered sample
+
+        float getCoveredFraction() const {
+            return end > start ? static_cast<float>(coveredSamples) / static_cast<float>(end - start) : 0.0f;
+        }
+    };
+
+    /**
+     * Count samples that became covered (they must not have been covered before)
+     */
+    void addCovered(int64_t start, int64_t end);
+
+    /**
+     * Flag the buckets a recorded dropout falls in
+     */
+    void addDropout(int64_t start, int64_t end);
+
+    /**
+     * Fill numColumns columns splitting [viewStart, viewEnd) evenly, O(numColumns).
+     * exactCoverage / exactDropouts (the intervals this pyramid summarises) make the
+     * columns exact; without them cut base buckets are estimated.
+     */
+    void getColumns(int64_t viewStart, int64_t viewEnd, int numColumns, Column* columns,
+                    const CapturedIntervalSet* exactCoverage = nullptr,
+                    const CapturedIntervalSet* exactDropouts = nullptr) const;
+
+    /**
+     * First and last covered sample counted so far
+     */
+    SampleInterval getBoundingInterval() const { return m_bounds; }
+
+    bool isEmpty() const { return m_levels[0].blocks.empty(); }
+
+    /**
+     * Make this pyramid equal to source. If it is an unmodified copy of source (made by
+     * copying or updating from it), only the blocks source wrote since are copied, into
+     * the blocks this one already has; otherwise every block is.
+     */
+    void update(const CoveragePyramid& source);
+
+    /**
+     * Whether this is an unmodified copy of source, as source is now
+     */
+    bool isUpToDateWith(const CoveragePyramid& source) const {
+        return m_sourceId == source.m_id && m_version == source.m_version;
+    }
+
+    /**
+     * Bytes of the blocks this pyramid owns
+     */
+    size_t getMemoryBytes() const;
+    void clear();
+
+private:
+    static constexpr int BLOCK_SHIFT = 8;
+    static constexpr int64_t BLOCK_SIZE = int64_t(1) << BLOCK_SHIFT;   // Buckets per block
+
+    struct Block
+    {
+        uint32_t covered[BLOCK_SIZE] = {};  // Covered samples per bucket
+        uint8_t dropouts[BLOCK_SIZE] = {};  // Non-zero if a dropout falls in the bucket
+    };
+
+    struct Level
+    {
+        int64_t firstBlock = 0;                         // Block number of blocks[0]
+        std::vector<std::unique_ptr<Block>> blocks;     // nullptr where no bucket was touched
+        std::vector<uint64_t> versions;                 // Pyramid version of each block's last write
+    };
+
+    Level m_levels[NUM_LEVELS];
+    SampleInterval m_bounds;
+    uint64_t m_id = newId();                // Unique per pyramid, copies included
+    uint64_t m_version = 0;                 // Bumped by every change (a copy: its source's version)
+    uint64_t m_sourceId = 0;                // Pyramid this is an unmodified copy of, or 0
+
+    static uint64_t newId();
+    void beginWrite();
+
+    void readBuckets(Column& column, const CapturedIntervalSet* exactCoverage,
+                     const CapturedIntervalSet* exactDropouts) const;
+    void readPart(Column& column, int level, int64_t bucket, const SampleInterval& part,
+                  bool countSamples, bool findDropout,
+                  const CapturedIntervalSet* exactCoverage, const CapturedIntervalSet* exactDropouts) const;
+    static const Block* findBlock(const Level& level, int64_t bucket, size_t& offset);
+    static Block& writeBlock(Level& level, int64_t bucket, uint64_t version, size_t& offset);
+    static void alignLevel(Level& level, int64_t firstBlock, size_t numBlocks);
+};
+
+//==============================================================================
+/**
+ * Published copies of one pyramid, for readers on other threads: two copies, of which
+ * publish() refreshes the one the last publish did not return, in place (see
+ * CoveragePyramid::update). If a reader still holds that one it is left to the reader
+ * and a new copy takes its place. Not thread-safe: publish from one thread, with the
+ * pyramid not being written meanwhile. Copying a publisher gives one with no copies.
+ */
+class CoveragePyramidPublisher
+{
+public:
+    CoveragePyramidPublisher() = default;
+    CoveragePyramidPublisher(const CoveragePyramidPublisher&) {}
+    CoveragePyramidPublisher& operator=(const CoveragePyramidPublisher&) { return *this; }
+
+    /**
+     * A copy of pyramid as it is now: the last one returned if pyramid did not change since
+     */
+    std::shared_ptr<const CoveragePyramid> publish(const CoveragePyramid& pyramid);
+
+private:
+    std::shared_ptr<CoveragePyramid> m_copies[2];
+    int m_last = 0;                         // Index of the copy publish last returned
+};
+
+} // namespace Mach1
@@ -0,0 +1,148 @@
+/*
+    CoverageRebuilder.cpp
+    ---------------------
+    Implementation of the coverage rebuild from chunk indexes.
+*/
+
+#include "CoverageRebuilder.h"
+#include "ChunkFormat.h"
+#include "ChunkIndex.h"
+#include "ChunkSegments.h"
+#include "ThreadPoolJobs.h"
+#include <memory>
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+struct CoverageRebuilder::Segment
+{
+    juce::File file;
+    std::vector<ChunkIndexEntry> entries;   // Write order
+    ChunkHeader lastHeader;                 // Of the last entry's chunk
+    bool hasLastHeader = false;
+};
+
+struct CoverageRebuilder::Panner
+{
+    PannerId pannerId;
+    std::vector<const Segment*> segments;   // Write order
+};
+
+//==============================================================================
+CoverageRebuilder::CoverageRebuilder(int numThreads)
+    : m_numThreads(numThreads > 0 ? numThreads : juce::SystemStats::getNumCpus())
+{
+}
+
+CoverageRebuilder::Result CoverageRebuilder::rebuild(const juce::File& sessionDir, CoverageModel& model)
+{
+    const double startTime = juce::Time::getMillisecondCounterHiRes();
+    Result result;
+    if (!sessionDir.isDirectory())
+        return result;
+
+    std::vector<std::unique_ptr<Segment>> segments;
+    std::vector<Panner> panners;
+    auto folders = sessionDir.findChildFiles(juce::File::findDirectories, false);
+    folders.sort();
+    for (const auto& folder : folders)
+    {
+        const auto chunkFiles = ChunkSegments::findSegments(folder);
+        const PannerId pannerId = ChunkSegments::getPannerId(folder);
+        if (chunkFiles.isEmpty() || !pannerId.isValid())
+            continue;
+
+        Panner panner;
+        panner.pannerId = pannerId;
+        for (const auto& chunkFile : chunkFiles)
+        {
+            auto segment = std::make_unique<Segment>();
+            segment->file = chunkFile;
+            panner.segments.push_back(segment.get());
+            segments.push_back(std::move(segment));
+        }
+        panners.push_back(std::move(panner));
+    }
+
+    juce::ThreadPool pool(juce::jmax(1, m_numThreads));
+    runOnPool(pool, segments.size(), [&segments](size_t i)
+    {
+        readSegment(*segments[i]);
+    }, 100, nullptr);
+
+    const uint64_t detectedAtMs = static_cast<uint64_t>(juce::Time::currentTimeMillis());
+    runOnPool(pool, panners.size(), [&panners, &model, detectedAtMs](size_t i)
+    {
+        rebuildPanner(panners[i], model, detectedAtMs);
+    }, 100, nullptr);
+    model.publishSnapshot();
+
+    result.panners = static_cast<uint32_t>(panners.size());
+    result.segments = static_cast<uint32_t>(segments.size());
+    for (const auto& segment : segments)
+        result.chunks += segment->entries.size();
+    result.elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    DBG("[CoverageRebuilder] Rebuilt " + juce::String(static_cast<int>(result.panners)) + " panners from "
+        + juce::String(static_cast<juce::int64>(result.chunks)) + " index entries in "
+        + juce::String(result.elapsedSeconds, 3) + "s");
+    return result;
+}
+
+//==============================================================================
+void CoverageRebuilder::readSegment(Segment& segment)
+{
+    ChunkIndex::collect(segment.file, segment.entries);
+    if (segment.entries.empty())
+        return;
+
+    // The format is the same for every chunk of a capture: the last one's will do
+    juce::FileInputStream input(segment.file);
+    segment.hasLastHeader = input.openedOk()
+        && input.setPosition(static_cast<juce::int64>(segment.entries.back().byteOffset))
+        && input.read(&segment.lastHeader, ChunkHeader::SIZE) == static_cast<int>(ChunkHeader::SIZE)
+        && segment.lastHeader.magic == ChunkHeader::MAGIC;
+}
+
+void CoverageRebuilder::rebuildPanner(const Panner& panner, CoverageModel& model, uint64_t detectedAtMs)
+{
+    // What addPannerInterval would have made of the chunks, built without the model's lock
+    PannerCoverage coverage;
+    coverage.pannerId = panner.pannerId;
+    for (const Segment* segment : panner.segments)
+    {
+        for (const auto& entry : segment->entries)
+        {
+            if (entry.numSamples <= 0)
+                continue;
+
+            SampleInterval missing;
+            uint32_t missed = 0;
+            if (coverage.findSequenceGap(entry.startSample, entry.sequenceNumber, missing, missed))
+            {
+                coverage.dropouts.push_back(DropoutInterval(missing.start, missing.end, detectedAtMs, missed, true));
+                coverage.totalDropoutsDetected += missed;
+            }
+
+            const int64_t endSample = entry.endSample();
+            coverage.capturedIntervals.addInterval(entry.startSample, endSample);
+            coverage.lastSequenceNumber = entry.sequenceNumber;
+            coverage.lastEndSample = endSample;
+            coverage.lastBufferId = 1;      // Not indexed: only marks a block as seen
+            coverage.totalBlocksReceived++;
+        }
+
+        if (segment->hasLastHeader)
+        {
+            coverage.sampleRate = segment->lastHeader.sampleRate;
+            coverage.channels = static_cast<uint32_t>(segment->lastHeader.numChannels);
+            coverage.lastBufferId = juce::jmax<uint64_t>(1, segment->lastHeader.bufferId);
+        }
+    }
+
+    if (coverage.totalBlocksReceived > 0)
+        model.restorePanner(coverage);
+}
+
+} // namespace Mach1
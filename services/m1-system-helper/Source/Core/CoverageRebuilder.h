@@ -0,0 +1,64 @@
+/*
+    CoverageRebuilder.h
+    -------------------
+    Rebuilds a session's coverage from its chunk indexes, for when its coverage file
+    (CoverageStore) is missing or unreadable.
+
+    No audio is read: each segment's index sidecar (ChunkIndex::collect, which also
+    indexes chunks written past it) gives the captured intervals and sequence numbers,
+    and the header of its last chunk the format. Segments are read in parallel, then
+    panners are rebuilt in parallel, each from its segments' entries in write order,
+    with the sequence gap dropouts the capture engine would have found (the time they
+    were detected is lost). A session of hours takes about as long as reading its
+    index files, a fraction of a second.
+
+    Unlike SessionRecovery nothing is checked beyond what ChunkIndex checks, and nothing
+    is written; it may run on a session that is being captured.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoverageModel.h"
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Parallel coverage rebuild from chunk indexes
+ */
+class CoverageRebuilder
+{
+public:
+    struct Result
+    {
+        uint32_t panners = 0;
+        uint32_t segments = 0;
+        uint64_t chunks = 0;
+        double elapsedSeconds = 0.0;
+    };
+
+    /**
+     * @param numThreads Segments and panners read at once (0 = one per CPU core)
+     */
+    explicit CoverageRebuilder(int numThreads = 0);
+
+    /**
+     * Merge the coverage of every panner folder of sessionDir into model (see
+     * CoverageModel::restorePanner) and publish it
+     */
+    Result rebuild(const juce::File& sessionDir, CoverageModel& model);
+
+private:
+    struct Segment;
+    struct Panner;
+
+    const int m_numThreads;
+
+    static void readSegment(Segment& segment);
+    static void rebuildPanner(const Panner& panner, CoverageModel& model, uint64_t detectedAtMs);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoverageRebuilder)
+};
+
+} // namespace Mach1
@@ -0,0 +1,360 @@
+/*
+    CoverageStore.cpp
+    -----------------
+    Implementation of the session coverage file.
+
+    A record's payload, every integer a little-endian base-128 varint (signed ones
+    zigzag-coded first):
+        sessionId, instanceUuid      length, then the bytes
+        processId, sampleRate, channels, lastSequenceNumber, lastBufferId
+        lastEndSample                signed
+        totalBlocksReceived, totalDropoutsDetected
+        interval count, then per interval: start - previous end (signed), length
+        dropout count, then per dropout: start - previous end (signed), length,
+                                         detectedAtMs, missedBufferCount, boundsKnown
+*/
+
+#include "CoverageStore.h"
+#include "ChunkFormat.h"
+#include "Crc32c.h"
+#include <cstring>
+
+namespace Mach1 {
+
+namespace {
+
+const char* const COVERAGE_FILE_NAME = "coverage.m1cov";
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void putSigned(std::vector<uint8_t>& out, int64_t value)
+{
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void putString(std::vector<uint8_t>& out, const std::string& value)
+{
+    putVarint(out, value.size());
+    out.insert(out.end(), value.begin(), value.end());
+}
+
+/**
+ * Reads a payload, failing (for good) at its end or on a malformed varint
+ */
+struct PayloadReader
+{
+    const uint8_t* data;
+    const uint8_t* end;
+    bool ok = true;
+
+    uint64_t varint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; ok && shift < 64; shift += 7)
+        {
+            if (data == end)
+                break;
+            const uint8_t byte = *data++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        ok = false;
+        return 0;
+    }
+
+    int64_t signedVarint()
+    {
+        const uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    uint32_t u32()
+    {
+        const uint64_t value = varint();
+        ok = ok && value <= UINT32_MAX;
+        return static_cast<uint32_t>(value);
+    }
+
+    std::string string()
+    {
+        const uint64_t length = varint();
+        if (!ok || length > static_cast<uint64_t>(end - data))
+        {
+            ok = false;
+            return {};
+        }
+        std::string value(reinterpret_cast<const char*>(data), static_cast<size_t>(length));
+        data += length;
+        return value;
+    }
+
+    /**
+     * An element count: every element takes at least minBytes
+     */
+    uint64_t count(uint64_t minBytes)
+    {
+        const uint64_t value = varint();
+        ok = ok && value <= static_cast<uint64_t>(end - data) / minBytes;
+        return ok ? value : 0;
+    }
+};
+
+void encodePanner(const PannerCoverage& coverage, std::vector<uint8_t>& out)
+{
+    putString(out, coverage.pannerId.sessionId);
+    putString(out, coverage.pannerId.instanceUuid);
+    putVarint(out, coverage.pannerId.processId);
+    putVarint(out, coverage.sampleRate);
+    putVarint(out, coverage.channels);
+    putVarint(out, coverage.lastSequenceNumber);
+    putVarint(out, coverage.lastBufferId);
+    putSigned(out, coverage.lastEndSample);
+    putVarint(out, coverage.totalBlocksReceived);
+    putVarint(out, coverage.totalDropoutsDetected);
+
+    putVarint(out, coverage.capturedIntervals.getIntervalCount());
+    int64_t previousEnd = 0;
+    for (const auto& interval : coverage.capturedIntervals)
+    {
+        putSigned(out, interval.start - previousEnd);
+        putVarint(out, static_cast<uint64_t>(interval.length()));
+        previousEnd = interval.end;
+    }
+
+    putVarint(out, coverage.dropouts.size());
+    previousEnd = 0;
+    for (const auto& dropout : coverage.dropouts)
+    {
+        putSigned(out, dropout.startSample - previousEnd);
+        putSigned(out, dropout.length());
+        putVarint(out, dropout.detectedAtMs);
+        putVarint(out, dropout.missedBufferCount);
+        putVarint(out, dropout.boundsKnown ? 1 : 0);
+        previousEnd = dropout.endSample;
+    }
+}
+
+bool decodePanner(const uint8_t* data, size_t size, PannerCoverage& coverage)
+{
+    PayloadReader reader{ data, data + size };
+    coverage = PannerCoverage();
+    coverage.pannerId.sessionId = reader.string();
+    coverage.pannerId.instanceUuid = reader.string();
+    coverage.pannerId.processId = reader.u32();
+    coverage.sampleRate = reader.u32();
+    coverage.channels = reader.u32();
+    coverage.lastSequenceNumber = reader.u32();
+    coverage.lastBufferId = reader.varint();
+    coverage.lastEndSample = reader.signedVarint();
+    coverage.totalBlocksReceived = reader.u32();
+    coverage.totalDropoutsDetected = reader.u32();
+
+    int64_t previousEnd = 0;
+    for (uint64_t i = reader.count(2); i > 0 && reader.ok; --i)
+    {
+        const int64_t start = previousEnd + reader.signedVarint();
+        const int64_t length = static_cast<int64_t>(reader.varint());
+        reader.ok = reader.ok && length > 0;
+        coverage.capturedIntervals.addInterval(start, start + length);
+        previousEnd = start + length;
+    }
+
+    previousEnd = 0;
+    for (uint64_t i = reader.count(5); i > 0 && reader.ok; --i)
+    {
+        DropoutInterval dropout;
+        dropout.startSample = previousEnd + reader.signedVarint();
+        dropout.endSample = dropout.startSample + reader.signedVarint();
+        dropout.detectedAtMs = reader.varint();
+        dropout.missedBufferCount = reader.u32();
+        dropout.boundsKnown = reader.varint() != 0;
+        coverage.dropouts.push_back(dropout);
+        previousEnd = dropout.endSample;
+    }
+
+    return reader.ok && reader.data == reader.end && coverage.pannerId.isValid();
+}
+
+} // namespace
+
+//==============================================================================
+CoverageStore::CoverageStore() = default;
+
+CoverageStore::~CoverageStore()
+{
+    close();
+}
+
+juce::File CoverageStore::getCoverageFile(const juce::File& sessionDir)
+{
+    return sessionDir.getChildFile(COVERAGE_FILE_NAME);
+}
+
+bool CoverageStore::load(const juce::File& coverageFile, CoverageModel& model)
+{
+    // Compact enough to read whole
+    juce::MemoryBlock data;
+    if (!coverageFile.existsAsFile() || !coverageFile.loadFileAsData(data) || data.getSize() < CoverageFileHeader::SIZE)
+        return false;
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data.getData());
+    const size_t size = data.getSize();
+    CoverageFileHeader fileHeader;
+    std::memcpy(&fileHeader, bytes, CoverageFileHeader::SIZE);
+    if (fileHeader.magic != CoverageFileHeader::MAGIC || fileHeader.version != 1)
+        return false;
+
+    size_t offset = CoverageFileHeader::SIZE;
+    int records = 0;
+    PannerCoverage panner;
+    while (offset + CoverageRecordHeader::SIZE <= size)
+    {
+        CoverageRecordHeader header;
+        std::memcpy(&header, bytes + offset, CoverageRecordHeader::SIZE);
+        const uint8_t* payload = bytes + offset + CoverageRecordHeader::SIZE;
+        if (header.magic != CoverageRecordHeader::MAGIC
+            || header.payloadSize > size - offset - CoverageRecordHeader::SIZE
+            || Crc32c::compute(payload, header.payloadSize) != header.checksum
+            || !decodePanner(payload, header.payloadSize, panner))
+            break;
+
+        model.restorePanner(panner);
+        offset += CoverageRecordHeader::SIZE + header.payloadSize;
+        records++;
+    }
+
+    model.publishSnapshot();
+
+    if (offset < size)
+    {
+        DBG("[CoverageStore] " + coverageFile.getFullPathName() + ": ignoring "
+            + juce::String(static_cast<juce::int64>(size - offset)) + " torn bytes after "
+            + juce::String(records) + " records");
+    }
+    return true;
+}
+
+//==============================================================================
+bool CoverageStore::open(const juce::File& coverageFile, CoverageModel& model)
+{
+    close();
+
+    m_file = coverageFile;
+    m_model = &model;
+    m_model->setTrackChanges(true);     // The first take has every panner: rewrite()
+    return update();
+}
+
+bool CoverageStore::update()
+{
+    if (!isOpen())
+        return false;
+
+    const bool compact = m_needsRewrite || m_fileBytes > 2 * m_compactBytes + COMPACT_SLACK_BYTES;
+    if (m_model->takeChanges(m_changes, compact))
+        return rewrite();
+
+    return m_changes.empty() || append();
+}
+
+void CoverageStore::close()
+{
+    if (!isOpen())
+        return;
+
+    update();
+    m_model->setTrackChanges(false);
+    m_model = nullptr;
+    m_output.reset();
+    m_changes.clear();
+    m_records.clear();
+}
+
+//==============================================================================
+void CoverageStore::encodeChanges()
+{
+    m_records.clear();
+    for (const auto& panner : m_changes)
+    {
+        const size_t headerOffset = m_records.size();
+        m_records.resize(headerOffset + CoverageRecordHeader::SIZE);
+        encodePanner(panner, m_records);
+
+        CoverageRecordHeader header;
+        header.payloadSize = static_cast<uint32_t>(m_records.size() - headerOffset - CoverageRecordHeader::SIZE);
+        header.checksum = Crc32c::compute(m_records.data() + headerOffset + CoverageRecordHeader::SIZE, header.payloadSize);
+        std::memcpy(m_records.data() + headerOffset, &header, CoverageRecordHeader::SIZE);
+    }
+}
+
+bool CoverageStore::rewrite()
+{
+    m_output.reset();
+    encodeChanges();
+
+    // Written aside and moved over the old file, so a crash leaves one or the other
+    bool written = false;
+    {
+        juce::TemporaryFile temporary(m_file);
+        {
+            juce::FileOutputStream output(temporary.getFile());
+            if (output.openedOk())
+            {
+                CoverageFileHeader fileHeader;
+                output.write(&fileHeader, CoverageFileHeader::SIZE);
+                output.write(m_records.data(), m_records.size());
+                output.flush();
+                written = output.getStatus().wasOk();
+            }
+        }
+        written = written && temporary.overwriteTargetFileWithTemporary();
+    }
+
+    // Unbuffered: an update's records reach the file in one write, without flush()'s sync
+    if (written)
+    {
+        m_output = std::make_unique<juce::FileOutputStream>(m_file, 16);
+        written = m_output->openedOk();
+    }
+
+    m_needsRewrite = !written;
+    m_fileBytes = written ? static_cast<uint64_t>(m_file.getSize()) : 0;
+    m_compactBytes = m_fileBytes;
+    if (!written)
+    {
+        m_output.reset();
+        DBG("[CoverageStore] Failed to write " + m_file.getFullPathName());
+    }
+    return written;
+}
+
+bool CoverageStore::append()
+{
+    if (m_output == nullptr)
+    {
+        m_needsRewrite = true;
+        return false;
+    }
+
+    encodeChanges();
+    if (!m_output->write(m_records.data(), m_records.size()) || m_output->getStatus().failed())
+    {
+        DBG("[CoverageStore] Failed to append to " + m_file.getFullPathName());
+        m_needsRewrite = true;
+        return false;
+    }
+
+    m_fileBytes += m_records.size();
+    return true;
+}
+
+} // namespace Mach1
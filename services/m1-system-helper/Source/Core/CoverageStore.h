@@ -0,0 +1,95 @@
+/*
+    CoverageStore.h
+    ---------------
+    A session's coverage on disk (coverage.m1cov in the session folder), so the timeline
+    of a session captured before, or before the helper restarted, shows up at once
+    instead of after reading its chunks.
+
+    The file is a journal of panner records (see ChunkFormat.h). A record carries a
+    panner's tracking fields and counters as they were, and intervals and dropouts to
+    merge into what the records before it gave (CoverageModel::restorePanner). open()
+    writes every panner in full; update() then appends records for the panners that
+    changed since (CoverageModel::takeChanges), usually just the end of their last
+    interval, so keeping the file current costs tens of bytes per panner per update.
+    Once the journal has grown well past its last full write, update() rewrites the
+    file compacted.
+
+    Intervals are delta- and varint-coded, and every record carries a CRC-32C: load()
+    replays records up to the end of the file or the first torn or damaged one (a crash
+    mid-append), losing at most the last update. Updates are written straight to the
+    file but not synced: the chunk files stay the authority, and CoverageRebuilder
+    recreates the coverage from their indexes when this file is missing.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoverageModel.h"
+#include <memory>
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Keeps a session's coverage file in step with a CoverageModel
+ */
+class CoverageStore
+{
+public:
+    CoverageStore();
+    ~CoverageStore();
+
+    /**
+     * Coverage file of a session folder
+     */
+    static juce::File getCoverageFile(const juce::File& sessionDir);
+
+    /**
+     * Replay a coverage file into model
+     * @return false if there is no such file or its header is unusable (nothing loaded)
+     */
+    static bool load(const juce::File& coverageFile, CoverageModel& model);
+
+    /**
+     * Write model's coverage to coverageFile (replacing it), then track model's changes
+     * for update(). The model must outlive the store, or close() must be called first.
+     */
+    bool open(const juce::File& coverageFile, CoverageModel& model);
+
+    /**
+     * Append what changed since the last update (or rewrite the file, to compact it or
+     * after the model was reset)
+     * @return false if the file could not be written; the next update rewrites it
+     */
+    bool update();
+
+    /**
+     * Final update, then stop tracking the model's changes
+     */
+    void close();
+
+    bool isOpen() const { return m_model != nullptr; }
+    uint64_t getFileBytes() const { return m_fileBytes; }
+
+private:
+    // Rewrite once the journal is this much larger than twice its last full write
+    static constexpr uint64_t COMPACT_SLACK_BYTES = 64 * 1024;
+
+    juce::File m_file;
+    CoverageModel* m_model = nullptr;
+    std::unique_ptr<juce::FileOutputStream> m_output;
+    std::vector<PannerCoverage> m_changes;  // Reused by every update
+    std::vector<uint8_t> m_records;         // Encoded records of one update
+    uint64_t m_fileBytes = 0;
+    uint64_t m_compactBytes = 0;            // File size after the last full write
+    bool m_needsRewrite = false;            // A write failed: changes since are lost
+
+    bool rewrite();
+    bool append();
+    void encodeChanges();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoverageStore)
+};
+
+} // namespace Mach1
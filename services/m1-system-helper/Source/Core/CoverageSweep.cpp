@@ -0,0 +1,148 @@
+/*
+    CoverageSweep.cpp
+    -----------------
+    Implementation of the k-way coverage sweep.
+*/
+
+#include "CoverageSweep.h"
+#include <algorithm>
+
+namespace Mach1 {
+
+namespace {
+
+/**
+ * A stream's position in the sweep: the interval it is at, and whether the sweep is
+ * inside it (the next point is its end) or before it (the next point is its start)
+ */
+struct Cursor
+{
+    CapturedIntervalSet::const_iterator current;
+    CapturedIntervalSet::const_iterator end;
+    bool inside = false;
+
+    int64_t nextPoint() const { return inside ? (*current).end : (*current).start; }
+};
+
+struct Point
+{
+    int64_t position;
+    uint32_t stream;
+
+    // Min-heap on position
+    bool operator<(const Point& other) const { return position > other.position; }
+};
+
+void appendInterval(std::vector<SampleInterval>& intervals, int64_t start, int64_t end)
+{
+    if (!intervals.empty() && intervals.back().end == start)
+        intervals.back().end = end;
+    else
+        intervals.emplace_back(start, end);
+}
+
+} // namespace
+
+//==============================================================================
+void CoverageSweep::addPanner(const CapturedIntervalSet& coverage, const CapturedIntervalSet* dropouts)
+{
+    m_streams.push_back({ &coverage, Kind::Coverage });
+    if (dropouts != nullptr)
+        m_streams.push_back({ dropouts, Kind::Dropout });
+    m_numPanners++;
+}
+
+void CoverageSweep::clear()
+{
+    m_streams.clear();
+    m_numPanners = 0;
+}
+
+CoverageSweep::Result CoverageSweep::run(uint32_t minPanners) const
+{
+    Result result;
+    result.numPanners = m_numPanners;
+    result.minPanners = std::max(1u, std::min(minPanners, std::max(1u, m_numPanners)));
+
+    std::vector<Cursor> cursors(m_streams.size());
+    std::vector<Point> heap;
+    heap.reserve(m_streams.size());
+    for (size_t i = 0; i < m_streams.size(); ++i)
+    {
+        cursors[i].current = m_streams[i].intervals->begin();
+        cursors[i].end = m_streams[i].intervals->end();
+        if (cursors[i].current != cursors[i].end)
+            heap.push_back({ cursors[i].nextPoint(), static_cast<uint32_t>(i) });
+    }
+    std::make_heap(heap.begin(), heap.end());
+
+    uint32_t covered = 0;       // Panners covered between the previous point and the next
+    uint32_t droppedOut = 0;    // Panners in a dropout
+    int64_t previous = 0;
+    bool started = false;
+    SampleInterval pendingGap;  // Uncovered stretch after coverage; total dropout if coverage resumes
+
+    while (!heap.empty())
+    {
+        const int64_t position = heap.front().position;
+
+        // Report the stretch since the previous point
+        if (started && previous < position)
+        {
+            if (covered > 0)
+            {
+                if (!pendingGap.isEmpty())
+                {
+                    result.totalDropouts.push_back(pendingGap);
+                    pendingGap = SampleInterval();
+                }
+                result.anyCoverage.addInterval(previous, position);
+                if (covered == m_numPanners)
+                    result.allCoverage.addInterval(previous, position);
+                if (covered >= result.minPanners)
+                    result.minCoverage.addInterval(previous, position);
+            }
+            else if (!result.anyCoverage.isEmpty())
+            {
+                pendingGap = pendingGap.isEmpty() ? SampleInterval(previous, position)
+                                                  : SampleInterval(pendingGap.start, position);
+            }
+
+            if (droppedOut > 0)
+                appendInterval(result.anyDropouts, previous, position);
+        }
+
+        // Apply every point at this position before the next stretch
+        while (!heap.empty() && heap.front().position == position)
+        {
+            std::pop_heap(heap.begin(), heap.end());
+            const uint32_t index = heap.back().stream;
+            heap.pop_back();
+
+            Cursor& cursor = cursors[index];
+            uint32_t& count = m_streams[index].kind == Kind::Coverage ? covered : droppedOut;
+            if (!cursor.inside)
+            {
+                count++;
+                cursor.inside = true;
+            }
+            else
+            {
+                count--;
+                cursor.inside = false;
+                if (++cursor.current == cursor.end)
+                    continue;
+            }
+
+            heap.push_back({ cursor.nextPoint(), index });
+            std::push_heap(heap.begin(), heap.end());
+        }
+
+        previous = position;
+        started = true;
+    }
+
+    return result;
+}
+
+} // namespace Mach1
@@ -0,0 +1,77 @@
+/*
+    CoverageSweep.h
+    ---------------
+    One sweep-line pass over every panner's coverage (and dropouts) that yields all the
+    global views CoverageModel reports.
+
+    Each panner contributes its captured intervals and its recorded dropouts as sorted,
+    disjoint sequences (CapturedIntervalSet). Their start and end points are merged k
+    ways through a min-heap holding each sequence's next point, while counting how many
+    panners are covered (and how many are in a dropout) between consecutive points. From
+    those counts, in the same pass:
+    - any coverage (at least one panner), all coverage (every panner) and k-of-n
+      coverage (at least minPanners panners)
+    - total dropouts: where no panner is covered, between the first and last captured
+      sample
+    - any dropouts: the union of every panner's recorded dropouts
+    N points over k panners take O(N log k); the results are built in order, so each
+    interval is appended in O(1).
+
+    Plain C++ (no JUCE).
+*/
+
+#pragma once
+
+#include "CapturedIntervalSet.h"
+#include <cstdint>
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * k-way sweep over per-panner interval sets
+ */
+class CoverageSweep
+{
+public:
+    struct Result
+    {
+        CapturedIntervalSet anyCoverage;            // At least one panner
+        CapturedIntervalSet allCoverage;            // Every panner
+        CapturedIntervalSet minCoverage;            // At least minPanners panners
+        std::vector<SampleInterval> totalDropouts;  // No panner, within anyCoverage's bounds
+        std::vector<SampleInterval> anyDropouts;    // Some panner recorded a dropout
+        uint32_t numPanners = 0;
+        uint32_t minPanners = 1;
+    };
+
+    /**
+     * Add a panner; both sets are only read by run(), so they must outlive it
+     * @param dropouts The panner's recorded dropouts (may be nullptr)
+     */
+    void addPanner(const CapturedIntervalSet& coverage, const CapturedIntervalSet* dropouts = nullptr);
+
+    /**
+     * Sweep every panner added
+     * @param minPanners Threshold for Result::minCoverage (clamped to 1..number of panners)
+     */
+    Result run(uint32_t minPanners = 1) const;
+
+    void clear();
+    size_t getNumPanners() const { return m_numPanners; }
+
+private:
+    enum class Kind : uint8_t { Coverage, Dropout };
+
+    struct Stream
+    {
+        const CapturedIntervalSet* intervals = nullptr;
+        Kind kind = Kind::Coverage;
+    };
+
+    std::vector<Stream> m_streams;
+    uint32_t m_numPanners = 0;
+};
+
+} // namespace Mach1
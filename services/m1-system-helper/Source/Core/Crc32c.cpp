@@ -0,0 +1,177 @@
+/*
+    Crc32c.cpp
+    ----------
+    Implementation of the CRC-32C checksums.
+*/
+
+#include "Crc32c.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define M1_CRC32C_X86 1
+    #include <nmmintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#elif (defined(__aarch64__) || defined(_M_ARM64)) && (defined(__ARM_FEATURE_CRC32) || defined(_MSC_VER))
+    #define M1_CRC32C_ARM 1
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <arm_acle.h>
+    #endif
+#endif
+
+namespace Mach1 {
+
+namespace {
+
+//==============================================================================
+// Slicing-by-8: eight bytes per step through eight 256-entry tables (reflected polynomial)
+struct Tables
+{
+    uint32_t t[8][256];
+
+    Tables()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+            t[0][i] = crc;
+        }
+
+        for (uint32_t i = 0; i < 256; ++i)
+            for (int k = 1; k < 8; ++k)
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+    }
+};
+
+const Tables& getTables()
+{
+    static const Tables tables;
+    return tables;
+}
+
+uint32_t updateTable(uint32_t crc, const uint8_t* p, size_t size)
+{
+    const Tables& tables = getTables();
+    const auto& t = tables.t;
+
+    while (size >= 8)
+    {
+        uint32_t low, high;
+        std::memcpy(&low, p, 4);
+        std::memcpy(&high, p + 4, 4);
+        low ^= crc;     // Little endian, like every platform the helper runs on
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24]
+            ^ t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+        p += 8;
+        size -= 8;
+    }
+
+    while (size-- > 0)
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+
+    return crc;
+}
+
+//==============================================================================
+#if M1_CRC32C_X86
+#if !defined(_MSC_VER)
+__attribute__((target("sse4.2")))
+#endif
+uint32_t updateHardware(uint32_t crc, const uint8_t* p, size_t size)
+{
+    uint64_t crc64 = crc;
+    while (size >= 8)
+    {
+        uint64_t value;
+        std::memcpy(&value, p, 8);
+        crc64 = _mm_crc32_u64(crc64, value);
+        p += 8;
+        size -= 8;
+    }
+
+    uint32_t crc32 = static_cast<uint32_t>(crc64);
+    while (size-- > 0)
+        crc32 = _mm_crc32_u8(crc32, *p++);
+
+    return crc32;
+}
+
+bool detectHardware()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+#elif M1_CRC32C_ARM
+uint32_t updateHardware(uint32_t crc, const uint8_t* p, size_t size)
+{
+    while (size >= 8)
+    {
+        uint64_t value;
+        std::memcpy(&value, p, 8);
+        crc = __crc32cd(crc, value);
+        p += 8;
+        size -= 8;
+    }
+
+    while (size-- > 0)
+        crc = __crc32cb(crc, *p++);
+
+    return crc;
+}
+
+bool detectHardware()
+{
+    return true;
+}
+#endif
+
+} // namespace
+
+//==============================================================================
+uint32_t Crc32c::update(uint32_t crc, const void* data, size_t size)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+
+#if M1_CRC32C_X86 || M1_CRC32C_ARM
+    if (isHardwareAccelerated())
+        return ~updateHardware(crc, p, size);
+#endif
+
+    return ~updateTable(crc, p, size);
+}
+
+uint32_t Crc32c::getChunkChecksum(const ChunkHeader& header, const void* payload, size_t payloadSize)
+{
+    ChunkHeader unsummed = header;
+    unsummed.checksum = 0;
+    return update(compute(&unsummed, ChunkHeader::SIZE), payload, payloadSize);
+}
+
+bool Crc32c::verifyChunk(const ChunkHeader& header, const void* payload, size_t payloadSize)
+{
+    return header.version < ChunkHeader::VERSION_CHECKSUM
+        || getChunkChecksum(header, payload, payloadSize) == header.checksum;
+}
+
+bool Crc32c::isHardwareAccelerated()
+{
+#if M1_CRC32C_X86 || M1_CRC32C_ARM
+    static const bool hardware = detectHardware();
+    return hardware;
+#else
+    return false;
+#endif
+}
+
+} // namespace Mach1
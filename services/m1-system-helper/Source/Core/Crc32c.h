@@ -0,0 +1,55 @@
+/*
+    Crc32c.h
+    --------
+    CRC-32C (Castagnoli) checksums for captured chunks.
+
+    Uses the CPU's CRC32 instructions where there are any (SSE 4.2 on x86-64, checked at
+    run time; the ARMv8 CRC extension on arm64, which every Apple silicon Mac has) and a
+    slicing-by-8 table otherwise. All of them give the same checksums.
+
+    Plain C++ (no JUCE), no allocation.
+*/
+
+#pragma once
+
+#include "ChunkFormat.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * CRC-32C of byte ranges, and of chunks (ChunkHeader::checksum)
+ */
+class Crc32c
+{
+public:
+    /**
+     * Checksum of size bytes
+     */
+    static uint32_t compute(const void* data, size_t size) { return update(0, data, size); }
+
+    /**
+     * Extend a checksum with more bytes: update(compute(a), b) == compute(a followed by b)
+     */
+    static uint32_t update(uint32_t crc, const void* data, size_t size);
+
+    /**
+     * ChunkHeader::checksum for a chunk: its header with the checksum field set to 0,
+     * followed by the payload (state snapshot and audio, payloadSize bytes)
+     */
+    static uint32_t getChunkChecksum(const ChunkHeader& header, const void* payload, size_t payloadSize);
+
+    /**
+     * Whether a chunk matches its checksum; true for chunks written without one (version < 3)
+     */
+    static bool verifyChunk(const ChunkHeader& header, const void* payload, size_t payloadSize);
+
+    /**
+     * Whether the CRC32 instructions are in use
+     */
+    static bool isHardwareAccelerated();
+};
+
+} // namespace Mach1
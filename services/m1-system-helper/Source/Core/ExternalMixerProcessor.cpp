@@ -35,7 +35,6 @@ void ExternalMixerProcessor::initialize(double sr, int maxBlockSize) {
     for (int ch = 0; ch < spatialChannelCount; ++ch)
         decodeOutBuffer[ch].resize(maxBlockSize, 0.0f);
     
-    streamingReadBuffer.setSize(spatialChannelCount, maxBlockSize);
     currentOutputLevels.resize(2, 0.0f); // stereo output
     
     m1Decode = std::make_unique<Mach1Decode<float>>();
@@ -75,67 +74,33 @@ PerPannerEncoder& ExternalMixerProcessor::getOrCreateEncoder(uint32_t processId)
     return it->second;
 }
 
-void ExternalMixerProcessor::configureEncoder(PerPannerEncoder& enc, const MemorySharePannerInfo& panner, int numSamples) {
-    auto& e = *enc.m1Encode;
-    
-    int inputMode  = panner.getInputMode();
-    int outputMode = panner.getOutputMode();
-    int pannerMode = 0; // default IsotropicLinear
-
-    bool autoOrbit = panner.getAutoOrbit();
-    if (panner.parameters.boolParams.count(M1SystemHelperParameterIDs::ISOTROPIC_MODE)) {
-        bool isotropic = panner.parameters.boolParams.at(M1SystemHelperParameterIDs::ISOTROPIC_MODE);
-        bool equalpower = false;
-        if (panner.parameters.boolParams.count(M1SystemHelperParameterIDs::EQUALPOWER_MODE))
-            equalpower = panner.parameters.boolParams.at(M1SystemHelperParameterIDs::EQUALPOWER_MODE);
+PannerEncodeSettings ExternalMixerProcessor::getEncodeSettings(const MemorySharePannerInfo& panner) {
+    PannerEncodeSettings settings;
+    settings.inputMode  = panner.getInputMode();
+    settings.outputMode = panner.getOutputMode();
+    settings.pannerMode = 0; // default IsotropicLinear
+
+    if (panner.parameters.contains(M1SystemHelperParameterIDs::ISOTROPIC_MODE, ParameterType::BOOL)) {
+        bool isotropic = panner.parameters.getBool(M1SystemHelperParameterIDs::ISOTROPIC_MODE);
+        bool equalpower = panner.parameters.getBool(M1SystemHelperParameterIDs::EQUALPOWER_MODE, false);
         
-        if (equalpower)       pannerMode = IsotropicEqualPower;
-        else if (isotropic)   pannerMode = IsotropicLinear;
-        else                  pannerMode = PeriphonicLinear;
-    }
-    
-    // Only reconfigure modes when they change to avoid unnecessary recalculation
-    if (inputMode != enc.lastInputMode) {
-        e.setInputMode(static_cast<Mach1EncodeInputMode>(inputMode));
-        enc.lastInputMode = inputMode;
-    }
-    if (outputMode != enc.lastOutputMode) {
-        e.setOutputMode(static_cast<Mach1EncodeOutputMode>(outputMode));
-        enc.lastOutputMode = outputMode;
-    }
-    if (pannerMode != enc.lastPannerMode) {
-        e.setPannerMode(static_cast<Mach1EncodePannerMode>(pannerMode));
-        enc.lastPannerMode = pannerMode;
+        if (equalpower)       settings.pannerMode = IsotropicEqualPower;
+        else if (isotropic)   settings.pannerMode = IsotropicLinear;
+        else                  settings.pannerMode = PeriphonicLinear;
     }
     
-    e.setAzimuth(panner.getAzimuth());
-    e.setElevation(panner.getElevation());
-    e.setDiverge(panner.getDiverge());
-    e.setStereoSpread(panner.getStereoSpread());
-    e.setAutoOrbit(autoOrbit);
-    e.setOrbitRotation(panner.getStereoOrbitAzimuth());
-
-    if (panner.parameters.boolParams.count(M1SystemHelperParameterIDs::GAIN_COMPENSATION_MODE))
-        e.setGainCompensationActive(panner.parameters.boolParams.at(M1SystemHelperParameterIDs::GAIN_COMPENSATION_MODE));
+    settings.azimuth = panner.getAzimuth();
+    settings.elevation = panner.getElevation();
+    settings.diverge = panner.getDiverge();
+    settings.stereoSpread = panner.getStereoSpread();
+    settings.autoOrbit = panner.getAutoOrbit();
+    settings.orbitRotation = panner.getStereoOrbitAzimuth();
+    settings.gain = PannerEncoder::toInputGain(panner.getGain());
+
+    if (panner.parameters.contains(M1SystemHelperParameterIDs::GAIN_COMPENSATION_MODE, ParameterType::BOOL))
+        settings.gainCompensation = panner.parameters.getBool(M1SystemHelperParameterIDs::GAIN_COMPENSATION_MODE) ? 1 : 0;
     
-    e.generatePointResults();
-    
-    int inChans  = e.getInputChannelsCount();
-    int outChans = e.getOutputChannelsCount();
-    
-    if (enc.allocatedSamples < numSamples || enc.allocatedInputChans != inChans || enc.allocatedOutputChans != outChans) {
-        enc.inputBuf.resize(inChans);
-        for (int ch = 0; ch < inChans; ++ch)
-            enc.inputBuf[ch].resize(numSamples, 0.0f);
-        
-        enc.encodedBuf.resize(outChans);
-        for (int ch = 0; ch < outChans; ++ch)
-            enc.encodedBuf[ch].resize(numSamples, 0.0f);
-        
-        enc.allocatedSamples = numSamples;
-        enc.allocatedInputChans = inChans;
-        enc.allocatedOutputChans = outChans;
-    }
+    return settings;
 }
 
 void ExternalMixerProcessor::cleanupStaleEncoders(const std::vector<MemorySharePannerInfo>& activePanners) {
@@ -164,71 +129,42 @@ void ExternalMixerProcessor::processMemorySharePanners(int numSamples) {
     const auto& panners = memShareTracker->getActivePanners();
     if (panners.empty()) return;
     
-    if (streamingReadBuffer.getNumChannels() < spatialChannelCount ||
-        streamingReadBuffer.getNumSamples() < numSamples)
-        streamingReadBuffer.setSize(spatialChannelCount, numSamples, false, true, false);
-    
     for (const auto& pannerInfo : panners) {
         if (!pannerInfo.isConnected || !pannerInfo.memoryShare || !pannerInfo.memoryShare->isValid())
             continue;
         
-        streamingReadBuffer.clear();
-        
-        ParameterMap currentParams;
-        uint64_t dawTimestamp = 0;
-        double playheadPosition = 0.0;
-        bool isPlaying = false;
-        uint64_t bufferId = 0;
-        uint32_t updateSource = 0;
-
-        bool readSuccess = pannerInfo.memoryShare->readAudioBufferWithGenericParameters(
-            streamingReadBuffer, currentParams, dawTimestamp, playheadPosition, isPlaying, bufferId, updateSource
-        );
-        
-        if (!readSuccess) continue;
-        
-        // Get the actual number of channels in the read buffer (from the panner's write)
-        int readChannels = static_cast<int>(pannerInfo.channels);
-        if (readChannels <= 0) readChannels = 1;
-        readChannels = juce::jmin(readChannels, streamingReadBuffer.getNumChannels());
+        // View the latest block in place; samples are copied once, straight into the encoder input
+        M1MemoryShare::AudioBlockView view;
+        if (!pannerInfo.memoryShare->acquireAudioBlockView(view))
+            continue;
         
-        // Apply per-track gain from the panner parameters
-        float pannerGain = pannerInfo.getGain();
-        // Gain is in dB in some codepaths; if it's in linear [0,1], use directly.
-        // The panner stores gain as a linear float [0..1] based on the PluginProcessor code.
-        pannerGain = juce::jlimit(0.0f, 2.0f, pannerGain);
+        int readChannels = static_cast<int>(view.numChannels);
+        int readSamples = juce::jmin(static_cast<int>(view.numSamples), numSamples);
         
         // Get or create an M1Encode for this panner
+        auto settings = getEncodeSettings(pannerInfo);
         auto& enc = getOrCreateEncoder(pannerInfo.processId);
-        configureEncoder(enc, pannerInfo, numSamples);
+        PannerEncoder::configure(enc, settings, numSamples);
         
+        // Apply per-track gain from the panner parameters
+        float pannerGain = settings.gain;
         int inChans  = enc.m1Encode->getInputChannelsCount();
-        int outChans = enc.m1Encode->getOutputChannelsCount();
         
-        // Copy raw audio into the encoder's input buffer
+        // Copy raw audio from shared memory into the encoder's input buffer
         for (int ch = 0; ch < inChans; ++ch) {
+            int copied = 0;
             if (ch < readChannels) {
-                const float* src = streamingReadBuffer.getReadPointer(ch);
-                for (int i = 0; i < numSamples; ++i)
-                    enc.inputBuf[ch][i] = src[i] * pannerGain;
-            } else {
-                std::fill(enc.inputBuf[ch].begin(), enc.inputBuf[ch].begin() + numSamples, 0.0f);
+                view.copyChannel(static_cast<uint32_t>(ch), enc.inputBuf[ch].data(), static_cast<uint32_t>(readSamples), pannerGain);
+                copied = readSamples;
             }
+            std::fill(enc.inputBuf[ch].begin() + copied, enc.inputBuf[ch].begin() + numSamples, 0.0f);
         }
         
-        // Clear encoded buffer before accumulation
-        for (int ch = 0; ch < outChans; ++ch)
-            std::fill(enc.encodedBuf[ch].begin(), enc.encodedBuf[ch].begin() + numSamples, 0.0f);
-        
-        // M1Encode: raw input → spatial multichannel
-        enc.m1Encode->encodeBuffer(enc.inputBuf, enc.encodedBuf, numSamples);
+        // Drop the block if the panner overwrote it while we were copying
+        if (!pannerInfo.memoryShare->releaseAudioBlockView(view))
+            continue;
         
-        // Mix encoded result into the spatial mix buffer
-        int chansToMix = juce::jmin(outChans, spatialChannelCount);
-        for (int ch = 0; ch < chansToMix; ++ch) {
-            for (int i = 0; i < numSamples; ++i)
-                spatialMixBuffer[ch][i] += enc.encodedBuf[ch][i];
-        }
+        PannerEncoder::encodeAndMix(enc, numSamples, spatialMixBuffer, spatialChannelCount);
     }
     
     cleanupStaleEncoders(panners);
@@ -3,6 +3,7 @@
 #include <JuceHeader.h>
 #include "../Common/Common.h"
 #include "../Managers/PannerTrackingManager.h"
+#include "PannerEncoder.h"
 #include <memory>
 #include <vector>
 #include <unordered_map>
@@ -14,21 +15,6 @@ namespace Mach1 {
 
 class PannerTrackingManager;
 
-struct PerPannerEncoder {
-    std::unique_ptr<Mach1Encode<float>> m1Encode;
-
-    // Working buffers in the format expected by Mach1 API
-    std::vector<std::vector<float>> inputBuf;   // [inputChannels][samples]
-    std::vector<std::vector<float>> encodedBuf; // [outputChannels][samples]
-
-    int lastInputMode = -1;
-    int lastOutputMode = -1;
-    int lastPannerMode = -1;
-    int allocatedSamples = 0;
-    int allocatedInputChans = 0;
-    int allocatedOutputChans = 0;
-};
-
 struct MixerTrackInfo {
     int pluginPort = 0;
     juce::String trackName;
@@ -95,7 +81,7 @@ private:
     void applyMasterDecoding(float* const* channels, int numChannels, int numSamples);
     
     PerPannerEncoder& getOrCreateEncoder(uint32_t processId);
-    void configureEncoder(PerPannerEncoder& enc, const MemorySharePannerInfo& panner, int numSamples);
+    static PannerEncodeSettings getEncodeSettings(const MemorySharePannerInfo& panner);
     void cleanupStaleEncoders(const std::vector<MemorySharePannerInfo>& activePanners);
     
     double sampleRate = 44100.0;
@@ -130,7 +116,6 @@ private:
     juce::File recordingFile;
     
     PannerTrackingManager* pannerTrackingManager = nullptr;
-    juce::AudioBuffer<float> streamingReadBuffer;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ExternalMixerProcessor)
 };
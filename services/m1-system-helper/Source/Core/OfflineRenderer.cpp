@@ -0,0 +1,455 @@
+/*
+    OfflineRenderer.cpp
+    -------------------
+    Implementation of the offline session renderer.
+*/
+
+#include "OfflineRenderer.h"
+#include "ChunkReader.h"
+#include "ChunkSegments.h"
+#include "PannerEncoder.h"
+#include "ThreadPoolJobs.h"
+#include <Mach1Decode.h>
+#include <algorithm>
+
+namespace Mach1 {
+
+//==============================================================================
+struct OfflineRenderer::Track
+{
+    juce::String name;                      // Panner folder name
+    juce::File folder;
+    ChunkReader reader;
+    uint32_t sampleRate = 0;
+    bool usable = false;
+
+    PerPannerEncoder encoder;
+    StateSnapshot encoderState;             // Snapshot the encoder is configured from
+    float inputGain = 1.0f;
+    bool encoderConfigured = false;
+
+    std::vector<std::vector<float>> bed;    // [bedChannels][blockSize]: this panner's encoded window
+    bool bedSilent = true;
+
+    // Window scratch
+    std::vector<ChunkIndexEntry> entries;
+    std::vector<int32_t> owner;             // Per frame: entries index of the chunk heard there, or -1
+    std::vector<float> audio;
+    uint64_t audioOffset = UINT64_MAX;      // Chunk currently decoded into audio (spans windows)
+    ChunkHeader header;
+    StateSnapshot snapshot;
+
+    uint32_t chunksRead = 0;
+    uint32_t chunksSkipped = 0;
+};
+
+namespace {
+
+/**
+ * Encoder output and decode modes of an M1Spatial bed
+ */
+bool getBedModes(int bedChannels, Mach1EncodeOutputMode& outputMode, Mach1DecodeMode& decodeMode)
+{
+    switch (bedChannels)
+    {
+        case 4:  outputMode = M1Spatial_4;  decodeMode = M1DecodeSpatial_4;  return true;
+        case 8:  outputMode = M1Spatial_8;  decodeMode = M1DecodeSpatial_8;  return true;
+        case 14: outputMode = M1Spatial_14; decodeMode = M1DecodeSpatial_14; return true;
+        default: return false;
+    }
+}
+
+} // namespace
+
+//==============================================================================
+double OfflineRenderer::Result::getRealtimeFactor() const
+{
+    if (!rendered || sampleRate == 0 || elapsedSeconds <= 0.0)
+        return 0.0;
+
+    return static_cast<double>(endSample - startSample) / sampleRate / elapsedSeconds;
+}
+
+//==============================================================================
+OfflineRenderer::OfflineRenderer()
+    : OfflineRenderer(Options())
+{
+}
+
+OfflineRenderer::OfflineRenderer(const Options& options)
+    : m_options(options)
+{
+}
+
+OfflineRenderer::~OfflineRenderer() = default;
+
+int OfflineRenderer::getOutputChannelCount(const Options& options)
+{
+    Mach1EncodeOutputMode outputMode;
+    Mach1DecodeMode decodeMode;
+    if (!getBedModes(options.bedChannels, outputMode, decodeMode))
+        return 0;
+
+    return options.output == Output::Stereo ? 2 : options.bedChannels;
+}
+
+double OfflineRenderer::getProgress() const
+{
+    const int64_t total = m_framesTotal.load();
+    return total > 0 ? static_cast<double>(m_framesDone.load()) / static_cast<double>(total) : 0.0;
+}
+
+OfflineRenderer::Result OfflineRenderer::renderSession(const juce::File& sessionDir, const juce::File& outputFile)
+{
+    const double startTime = juce::Time::getMillisecondCounterHiRes();
+    m_cancelled = false;
+    m_framesDone = 0;
+    m_framesTotal = 0;
+
+    Result result;
+    result.outputFile = outputFile;
+
+    Mach1EncodeOutputMode bedMode;
+    Mach1DecodeMode decodeMode;
+    if (!getBedModes(m_options.bedChannels, bedMode, decodeMode))
+    {
+        result.error = "Unsupported bed format: " + juce::String(m_options.bedChannels) + " channels";
+        return result;
+    }
+    const int bedChannels = m_options.bedChannels;
+    const int blockSize = std::max(1, m_options.blockSize);
+
+    // Every panner folder with chunk files is a track; folder order is the mix order
+    auto folders = sessionDir.findChildFiles(juce::File::findDirectories, false);
+    folders.sort();
+
+    std::vector<std::unique_ptr<Track>> tracks;
+    std::vector<std::pair<Track*, size_t>> segments;
+    for (const auto& folder : folders)
+    {
+        auto chunkFiles = ChunkSegments::findSegments(folder, m_options.sealedSegmentsOnly);
+        if (chunkFiles.isEmpty())
+            continue;
+
+        auto track = std::make_unique<Track>();
+        track->name = folder.getFileName();
+        track->folder = folder;
+        track->reader.setSegments(chunkFiles);
+        for (int i = 0; i < chunkFiles.size(); ++i)
+            segments.emplace_back(track.get(), static_cast<size_t>(i));
+        tracks.push_back(std::move(track));
+    }
+
+    if (tracks.empty())
+    {
+        result.error = "No captured panners in " + sessionDir.getFullPathName();
+        return result;
+    }
+
+    const int numThreads = m_options.numThreads > 0 ? m_options.numThreads : juce::SystemStats::getNumCpus();
+    juce::ThreadPool pool(juce::jmax(1, numThreads));
+
+    // Map and index every segment; the sample rate comes from the first readable chunk
+    runOnPool(pool, segments.size(), [&segments](size_t i)
+    {
+        segments[i].first->reader.loadSegment(segments[i].second);
+    }, PROGRESS_INTERVAL_MS, nullptr);
+
+    runOnPool(pool, tracks.size(), [&tracks](size_t i)
+    {
+        auto& track = *tracks[i];
+        if (!track.reader.finishLoading())
+            return;
+
+        const auto& entries = track.reader.getIndex().getEntries();
+        ChunkHeader header;
+        for (size_t e = 0; e < entries.size() && track.sampleRate == 0; ++e)
+        {
+            if (track.reader.readHeader(entries[e], header))
+                track.sampleRate = header.sampleRate;
+        }
+    }, PROGRESS_INTERVAL_MS, nullptr);
+
+    // One rate per render: panners captured at another rate are left out
+    for (const auto& track : tracks)
+    {
+        if (track->sampleRate == 0)
+        {
+            DBG("[OfflineRenderer] No readable chunks in " + track->folder.getFullPathName());
+        }
+        else if (result.sampleRate == 0 || track->sampleRate == result.sampleRate)
+        {
+            result.sampleRate = track->sampleRate;
+            track->usable = true;
+        }
+        else
+        {
+            DBG("[OfflineRenderer] Skipping " + track->name + ": captured at " + juce::String(track->sampleRate) + " Hz");
+        }
+
+        if (track->usable)
+            ++result.pannersRendered;
+        else
+            ++result.pannersSkipped;
+    }
+
+    result.startSample = INT64_MAX;
+    result.endSample = INT64_MIN;
+    for (const auto& track : tracks)
+    {
+        if (!track->usable)
+            continue;
+        result.startSample = std::min(result.startSample, track->reader.getIndex().getStartSample());
+        result.endSample = std::max(result.endSample, track->reader.getIndex().getEndSample());
+    }
+
+    if (result.pannersRendered == 0 || result.endSample <= result.startSample)
+    {
+        result.startSample = result.endSample = 0;
+        result.error = "Nothing captured in " + sessionDir.getFullPathName();
+        return result;
+    }
+
+    // Writer (BWF: the time reference places the render on the session timeline)
+    const int numChannels = getOutputChannelCount(m_options);
+    result.numChannels = static_cast<uint32_t>(numChannels);
+
+    juce::WavAudioFormat wavFormat;
+    juce::StringPairArray metadata;
+    if (m_options.broadcastWave)
+    {
+        metadata = juce::WavAudioFormat::createBWAVMetadata("Mach1 render: " + sessionDir.getFileName(), "Mach1 System Helper",
+                                                            sessionDir.getFileName(), juce::Time::getCurrentTime(),
+                                                            std::max<int64_t>(result.startSample, 0), "");
+    }
+
+    outputFile.getParentDirectory().createDirectory();
+    outputFile.deleteFile();
+    auto output = std::make_unique<juce::FileOutputStream>(outputFile);
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    if (output->openedOk())
+    {
+        writer.reset(wavFormat.createWriterFor(output.get(), result.sampleRate, result.numChannels,
+                                               m_options.bitsPerSample, metadata, 0));
+    }
+
+    if (writer == nullptr)
+    {
+        result.error = "Could not create " + outputFile.getFullPathName();
+        return result;
+    }
+    output.release();   // Owned by the writer
+
+    for (auto& track : tracks)
+    {
+        track->encoder.m1Encode = std::make_unique<Mach1Encode<float>>();
+        track->bed.assign(static_cast<size_t>(bedChannels), std::vector<float>(static_cast<size_t>(blockSize), 0.0f));
+        track->owner.resize(static_cast<size_t>(blockSize));
+    }
+
+    std::vector<std::vector<float>> mix(static_cast<size_t>(bedChannels), std::vector<float>(static_cast<size_t>(blockSize), 0.0f));
+    std::vector<std::vector<float>> decoded;
+    std::unique_ptr<Mach1Decode<float>> decoder;
+    if (m_options.output == Output::Stereo)
+    {
+        decoded.assign(static_cast<size_t>(bedChannels), std::vector<float>(static_cast<size_t>(blockSize), 0.0f));
+        decoder = std::make_unique<Mach1Decode<float>>();
+        decoder->setDecodeMode(decodeMode);
+        decoder->setPlatformType(Mach1PlatformDefault);
+
+        Mach1Point3D rotation;
+        rotation.x = m_options.yaw;
+        rotation.y = m_options.pitch;
+        rotation.z = m_options.roll;
+        decoder->setRotationDegrees(rotation);
+    }
+
+    std::vector<const float*> channelPointers(static_cast<size_t>(numChannels));
+    for (int channel = 0; channel < numChannels; ++channel)
+        channelPointers[channel] = decoder != nullptr ? decoded[channel].data() : mix[channel].data();
+
+    m_framesTotal = result.endSample - result.startSample;
+    const size_t numJobs = std::min(tracks.size(), static_cast<size_t>(juce::jmax(1, numThreads)));
+    double lastProgressTime = startTime;
+
+    bool ok = true;
+    for (int64_t windowStart = result.startSample; windowStart < result.endSample && ok; windowStart += blockSize)
+    {
+        if (m_cancelled.load())
+        {
+            ok = false;
+            break;
+        }
+
+        const int numSamples = static_cast<int>(std::min<int64_t>(blockSize, result.endSample - windowStart));
+
+        // Encode: each job owns a fixed set of panners and their beds
+        runOnPool(pool, numJobs, [this, &tracks, numJobs, windowStart, numSamples](size_t job)
+        {
+            for (size_t t = job; t < tracks.size(); t += numJobs)
+                renderTrack(*tracks[t], windowStart, numSamples);
+        }, PROGRESS_INTERVAL_MS, nullptr);
+
+        // Reduce: each job sums a slice of the window, always adding the beds in panner order
+        const int sliceSize = static_cast<int>((static_cast<size_t>(numSamples) + numJobs - 1) / numJobs);
+        runOnPool(pool, numJobs, [&tracks, &mix, bedChannels, numSamples, sliceSize](size_t job)
+        {
+            const int from = std::min(numSamples, static_cast<int>(job) * sliceSize);
+            const int to = std::min(numSamples, from + sliceSize);
+            for (int channel = 0; channel < bedChannels; ++channel)
+                std::fill(mix[channel].begin() + from, mix[channel].begin() + to, 0.0f);
+
+            for (const auto& track : tracks)
+            {
+                if (track->bedSilent)
+                    continue;   // Adding zeros would not change any sum
+
+                for (int channel = 0; channel < bedChannels; ++channel)
+                {
+                    float* destination = mix[channel].data();
+                    const float* source = track->bed[channel].data();
+                    for (int i = from; i < to; ++i)
+                        destination[i] += source[i];
+                }
+            }
+        }, PROGRESS_INTERVAL_MS, nullptr);
+
+        if (decoder != nullptr)
+            decoder->decodeBuffer(mix, decoded, numSamples);
+
+        ok = writer->writeFromFloatArrays(channelPointers.data(), numChannels, numSamples);
+        m_framesDone += numSamples;
+
+        const double now = juce::Time::getMillisecondCounterHiRes();
+        if (m_options.onProgress && now - lastProgressTime >= PROGRESS_INTERVAL_MS)
+        {
+            m_options.onProgress(getProgress());
+            lastProgressTime = now;
+        }
+    }
+
+    writer.reset();     // Finalises the header
+
+    for (const auto& track : tracks)
+    {
+        result.chunksRead += track->chunksRead;
+        result.chunksSkipped += track->chunksSkipped;
+    }
+
+    result.cancelled = m_cancelled.load();
+    result.elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    if (!ok)
+    {
+        if (!result.cancelled)
+            result.error = "Write failed: " + outputFile.getFullPathName();
+        outputFile.deleteFile();
+        return result;
+    }
+
+    if (m_options.onProgress)
+        m_options.onProgress(getProgress());
+
+    result.rendered = true;
+    DBG("[OfflineRenderer] Rendered " + juce::String(result.pannersRendered) + " panners from "
+        + sessionDir.getFullPathName() + " in " + juce::String(result.elapsedSeconds, 2) + "s ("
+        + juce::String(result.getRealtimeFactor(), 1) + "x realtime)");
+    return result;
+}
+
+//==============================================================================
+void OfflineRenderer::renderTrack(Track& track, int64_t windowStart, int numSamples) const
+{
+    track.bedSilent = true;
+    if (!track.usable)
+        return;
+
+    const int64_t windowEnd = windowStart + numSamples;
+    track.reader.getIndex().findChunks(windowStart, windowEnd, track.entries);
+    if (track.entries.empty())
+        return;
+
+    // Chunks in write order, so where chunks overlap each frame is heard from the most recent capture
+    std::sort(track.entries.begin(), track.entries.end(),
+              [](const ChunkIndexEntry& a, const ChunkIndexEntry& b) { return a.byteOffset < b.byteOffset; });
+    std::fill(track.owner.begin(), track.owner.begin() + numSamples, -1);
+    for (size_t e = 0; e < track.entries.size(); ++e)
+    {
+        const int64_t from = std::max(windowStart, track.entries[e].startSample);
+        const int64_t to = std::min(windowEnd, track.entries[e].endSample());
+        if (to > from)
+            std::fill(track.owner.begin() + (from - windowStart), track.owner.begin() + (to - windowStart), static_cast<int32_t>(e));
+    }
+
+    for (auto& channel : track.bed)
+        std::fill(channel.begin(), channel.begin() + numSamples, 0.0f);
+
+    Mach1EncodeOutputMode bedMode;
+    Mach1DecodeMode decodeMode;
+    getBedModes(m_options.bedChannels, bedMode, decodeMode);
+
+    // Encode each run of frames heard from one chunk with the state that chunk was captured with
+    int runStart = 0;
+    while (runStart < numSamples)
+    {
+        const int32_t e = track.owner[runStart];
+        int runEnd = runStart + 1;
+        while (runEnd < numSamples && track.owner[runEnd] == e)
+            ++runEnd;
+
+        const int runLength = runEnd - runStart;
+        const int offset = runStart;
+        runStart = runEnd;
+        if (e < 0)
+            continue;
+
+        const auto& entry = track.entries[e];
+        if (entry.byteOffset != track.audioOffset)
+        {
+            track.audioOffset = UINT64_MAX;
+            if (!track.reader.read(entry, track.header, &track.snapshot, track.audio)
+                || track.header.sampleRate != track.sampleRate)
+            {
+                ++track.chunksSkipped;
+                continue;
+            }
+            track.audioOffset = entry.byteOffset;
+            ++track.chunksRead;
+        }
+
+        // Reconfigure only when the captured state changed (generatePointResults is not free)
+        if (!track.encoderConfigured || StateTrack::getChangedFields(track.encoderState, track.snapshot) != 0)
+        {
+            auto settings = PannerEncodeSettings::fromSnapshot(track.snapshot);
+            settings.outputMode = bedMode;  // The render format, whatever the panner was set to
+            PannerEncoder::configure(track.encoder, settings, static_cast<int>(track.owner.size()));
+            track.encoderState = track.snapshot;
+            track.inputGain = settings.gain;
+            track.encoderConfigured = true;
+        }
+
+        // Deinterleave the run into the encoder input, with the panner gain as the live mix applies it
+        auto& enc = track.encoder;
+        const int inChans = enc.m1Encode->getInputChannelsCount();
+        const int chunkChannels = track.header.numChannels;
+        const float* source = track.audio.data() + (windowStart + offset - entry.startSample) * chunkChannels;
+        for (int ch = 0; ch < inChans; ++ch)
+        {
+            float* destination = enc.inputBuf[ch].data();
+            if (ch < chunkChannels)
+            {
+                for (int i = 0; i < runLength; ++i)
+                    destination[i] = source[i * chunkChannels + ch] * track.inputGain;
+            }
+            else
+            {
+                std::fill(destination, destination + runLength, 0.0f);
+            }
+        }
+
+        PannerEncoder::encodeAndMix(enc, runLength, track.bed, m_options.bedChannels, offset);
+        track.bedSilent = false;
+    }
+}
+
+} // namespace Mach1
@@ -0,0 +1,128 @@
+/*
+    OfflineRenderer.h
+    -----------------
+    Re-renders a captured session through the Mach1 encode/decode chain, faster than
+    realtime and without the helper running.
+
+    Every panner folder of <capture_root>/<session_id>/ is replayed from its chunks:
+    - Each chunk's audio is encoded with the state it was captured with (its
+      StateSnapshot), through the same PannerEncoder stage as the live
+      ExternalMixerProcessor, into an M1Spatial 4/8/14 bed. Where chunks overlap the most
+      recent capture wins; anything no chunk covers is silence.
+    - The bed is written as is (Output::SpatialBed) or decoded to stereo with Mach1Decode
+      (Output::Stereo) at a fixed orientation.
+    - The session is rendered in windows of Options::blockSize frames. Within a window,
+      panners are encoded in parallel on a thread pool, each into its own bed, and the
+      beds are then summed in panner folder order. Every output sample is therefore the
+      same sum in the same order whatever the thread count or scheduling, so renders are
+      bit-identical between runs and machines with the same build.
+
+    Usable from the helper (on a background thread: renderSession() blocks) and from the
+    m1-capture-export command line tool (--render).
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Captured session to one spatial bed or stereo mix
+ */
+class OfflineRenderer
+{
+public:
+    enum class Output
+    {
+        SpatialBed,     // M1Spatial bed (Options::bedChannels)
+        Stereo          // Bed decoded to stereo
+    };
+
+    struct Options
+    {
+        int bedChannels = 8;                        // M1Spatial 4, 8 or 14
+        Output output = Output::SpatialBed;
+        float yaw = 0.0f;                           // Stereo decode orientation, degrees
+        float pitch = 0.0f;
+        float roll = 0.0f;
+
+        int numThreads = 0;                         // Panners encoded at once (0 = one per CPU core)
+        int blockSize = 8192;                       // Frames rendered per window
+        int bitsPerSample = 32;                     // 16, 24 or 32 (float)
+        bool broadcastWave = true;                  // Write a bext chunk (BWF) with the time reference
+        bool sealedSegmentsOnly = false;            // Skip chunk files capture may still be writing
+
+        // Called with getProgress() every PROGRESS_INTERVAL_MS on the thread running renderSession()
+        std::function<void(double)> onProgress;
+    };
+
+    struct Result
+    {
+        juce::File outputFile;
+        uint32_t numChannels = 0;
+        uint32_t sampleRate = 0;
+        int64_t startSample = 0;
+        int64_t endSample = 0;
+        uint32_t pannersRendered = 0;
+        uint32_t pannersSkipped = 0;        // Unreadable, or captured at another sample rate
+        uint32_t chunksRead = 0;
+        uint32_t chunksSkipped = 0;         // Unreadable or undecodable
+        double elapsedSeconds = 0.0;
+        bool rendered = false;
+        bool cancelled = false;
+        juce::String error;
+
+        /**
+         * Session seconds rendered per second of render time
+         */
+        double getRealtimeFactor() const;
+    };
+
+    OfflineRenderer();
+    explicit OfflineRenderer(const Options& options);
+    ~OfflineRenderer();
+
+    /**
+     * Render every panner folder of a session into outputFile (overwritten)
+     * Blocks until done or cancelled; a cancelled or failed render deletes outputFile.
+     */
+    Result renderSession(const juce::File& sessionDir, const juce::File& outputFile);
+
+    /**
+     * Stop a render in progress (call from another thread)
+     */
+    void cancel() { m_cancelled = true; }
+
+    /**
+     * Fraction of the session's frames rendered so far (0..1)
+     */
+    double getProgress() const;
+
+    /**
+     * Output channel count for the options (bed channels, or 2 for stereo); 0 if the bed
+     * format is not M1Spatial 4, 8 or 14
+     */
+    static int getOutputChannelCount(const Options& options);
+
+private:
+    struct Track;
+
+    static constexpr int PROGRESS_INTERVAL_MS = 100;
+
+    const Options m_options;
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<int64_t> m_framesDone{0};
+    std::atomic<int64_t> m_framesTotal{0};
+
+    void renderTrack(Track& track, int64_t windowStart, int numSamples) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OfflineRenderer)
+};
+
+} // namespace Mach1
@@ -0,0 +1,114 @@
+/*
+    PannerEncoder.cpp
+    -----------------
+    Implementation of the per-panner encode stage.
+*/
+
+#include "PannerEncoder.h"
+
+namespace Mach1 {
+
+//==============================================================================
+PannerEncodeSettings PannerEncodeSettings::fromSnapshot(const StateSnapshot& snapshot)
+{
+    // Snapshots carry the tracked panner state, with the panner mode already resolved
+    PannerEncodeSettings settings;
+    settings.inputMode = snapshot.inputMode;
+    settings.outputMode = snapshot.outputMode;
+    settings.pannerMode = snapshot.pannerMode;
+    settings.azimuth = snapshot.azimuthDeg;
+    settings.elevation = snapshot.elevationDeg;
+    settings.diverge = snapshot.diverge;
+    settings.stereoSpread = snapshot.stereoSpread;
+    settings.orbitRotation = snapshot.stereoOrbitAzimuth;
+    settings.autoOrbit = snapshot.autoOrbit;
+    settings.gain = PannerEncoder::toInputGain(snapshot.gainDb);    // Holds the GAIN parameter as tracked
+    settings.gainCompensation = snapshot.gainCompensation - 1;      // Not captured: leave the encoder's setting
+    return settings;
+}
+
+//==============================================================================
+void PannerEncoder::configure(PerPannerEncoder& enc, const PannerEncodeSettings& settings, int numSamples)
+{
+    auto& e = *enc.m1Encode;
+
+    // Only reconfigure modes when they change to avoid unnecessary recalculation
+    if (settings.inputMode != enc.lastInputMode)
+    {
+        e.setInputMode(static_cast<Mach1EncodeInputMode>(settings.inputMode));
+        enc.lastInputMode = settings.inputMode;
+    }
+    if (settings.outputMode != enc.lastOutputMode)
+    {
+        e.setOutputMode(static_cast<Mach1EncodeOutputMode>(settings.outputMode));
+        enc.lastOutputMode = settings.outputMode;
+    }
+    if (settings.pannerMode != enc.lastPannerMode)
+    {
+        e.setPannerMode(static_cast<Mach1EncodePannerMode>(settings.pannerMode));
+        enc.lastPannerMode = settings.pannerMode;
+    }
+
+    e.setAzimuth(settings.azimuth);
+    e.setElevation(settings.elevation);
+    e.setDiverge(settings.diverge);
+    e.setStereoSpread(settings.stereoSpread);
+    e.setAutoOrbit(settings.autoOrbit);
+    e.setOrbitRotation(settings.orbitRotation);
+
+    if (settings.gainCompensation >= 0)
+        e.setGainCompensationActive(settings.gainCompensation != 0);
+
+    e.generatePointResults();
+
+    const int inChans = e.getInputChannelsCount();
+    const int outChans = e.getOutputChannelsCount();
+
+    if (enc.allocatedSamples < numSamples || enc.allocatedInputChans != inChans || enc.allocatedOutputChans != outChans)
+    {
+        const int samples = juce::jmax(numSamples, enc.allocatedSamples);
+
+        enc.inputBuf.resize(inChans);
+        for (int ch = 0; ch < inChans; ++ch)
+            enc.inputBuf[ch].resize(samples, 0.0f);
+
+        enc.encodedBuf.resize(outChans);
+        for (int ch = 0; ch < outChans; ++ch)
+            enc.encodedBuf[ch].resize(samples, 0.0f);
+
+        enc.allocatedSamples = samples;
+        enc.allocatedInputChans = inChans;
+        enc.allocatedOutputChans = outChans;
+    }
+}
+
+void PannerEncoder::encodeAndMix(PerPannerEncoder& enc, int numSamples, std::vector<std::vector<float>>& mix,
+                                 int mixChannels, int mixOffset)
+{
+    const int outChans = enc.m1Encode->getOutputChannelsCount();
+
+    // Clear encoded buffer before accumulation
+    for (int ch = 0; ch < outChans; ++ch)
+        std::fill(enc.encodedBuf[ch].begin(), enc.encodedBuf[ch].begin() + numSamples, 0.0f);
+
+    // M1Encode: raw input -> spatial multichannel
+    enc.m1Encode->encodeBuffer(enc.inputBuf, enc.encodedBuf, numSamples);
+
+    // Mix encoded result into the spatial mix buffer
+    const int chansToMix = juce::jmin(outChans, mixChannels);
+    for (int ch = 0; ch < chansToMix; ++ch)
+    {
+        float* destination = mix[ch].data() + mixOffset;
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] += enc.encodedBuf[ch][i];
+    }
+}
+
+float PannerEncoder::toInputGain(float pannerGain)
+{
+    // Gain is in dB in some codepaths; if it's in linear [0,1], use directly.
+    // The panner stores gain as a linear float [0..1] based on the PluginProcessor code.
+    return juce::jlimit(0.0f, 2.0f, pannerGain);
+}
+
+} // namespace Mach1
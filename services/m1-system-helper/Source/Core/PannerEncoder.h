@@ -0,0 +1,84 @@
+/*
+    PannerEncoder.h
+    ---------------
+    The per-panner Mach1Encode stage of the mix: panner state -> encoder settings ->
+    spatial (M1Spatial 4/8/14) signal added into a bed.
+
+    Shared by ExternalMixerProcessor (live panners over memory share) and OfflineRenderer
+    (captured chunks and their StateSnapshots), so an offline render encodes exactly what
+    the live mix did.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChunkFormat.h"
+#include <memory>
+#include <vector>
+
+#include <Mach1Encode.h>
+
+namespace Mach1 {
+
+struct PerPannerEncoder {
+    std::unique_ptr<Mach1Encode<float>> m1Encode;
+
+    // Working buffers in the format expected by Mach1 API
+    std::vector<std::vector<float>> inputBuf;   // [inputChannels][samples]
+    std::vector<std::vector<float>> encodedBuf; // [outputChannels][samples]
+
+    int lastInputMode = -1;
+    int lastOutputMode = -1;
+    int lastPannerMode = -1;
+    int allocatedSamples = 0;
+    int allocatedInputChans = 0;
+    int allocatedOutputChans = 0;
+};
+
+//==============================================================================
+/**
+ * Encoder parameters for one panner, from live panner state or a captured StateSnapshot
+ */
+struct PannerEncodeSettings
+{
+    int inputMode = 0;              // Mach1EncodeInputMode
+    int outputMode = 0;             // Mach1EncodeOutputMode
+    int pannerMode = 0;             // Mach1EncodePannerMode
+    float azimuth = 0.0f;
+    float elevation = 0.0f;
+    float diverge = 0.0f;
+    float stereoSpread = 0.0f;
+    float orbitRotation = 0.0f;
+    bool autoOrbit = true;
+    float gain = 1.0f;              // Linear, applied to the input (see PannerEncoder::toInputGain)
+    int gainCompensation = -1;      // -1 = leave the encoder's setting, 0/1 = off/on
+
+    static PannerEncodeSettings fromSnapshot(const StateSnapshot& snapshot);
+};
+
+//==============================================================================
+/**
+ * Stateless helpers driving a PerPannerEncoder
+ */
+class PannerEncoder
+{
+public:
+    /**
+     * Apply settings (modes only when they changed) and size the working buffers
+     * for at least numSamples
+     */
+    static void configure(PerPannerEncoder& enc, const PannerEncodeSettings& settings, int numSamples);
+
+    /**
+     * Encode numSamples of enc.inputBuf and add them to mix[0 .. mixChannels) at mixOffset
+     */
+    static void encodeAndMix(PerPannerEncoder& enc, int numSamples, std::vector<std::vector<float>>& mix,
+                             int mixChannels, int mixOffset = 0);
+
+    /**
+     * Panner GAIN parameter to the linear input gain the mix applies
+     */
+    static float toInputGain(float pannerGain);
+};
+
+} // namespace Mach1
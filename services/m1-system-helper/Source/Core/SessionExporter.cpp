@@ -0,0 +1,391 @@
+/*
+    SessionExporter.cpp
+    -------------------
+    Implementation of the session stem exporter.
+*/
+
+#include "SessionExporter.h"
+#include "ChunkReader.h"
+#include "ChunkSegments.h"
+#include "ThreadPoolJobs.h"
+#include <algorithm>
+
+namespace Mach1 {
+
+//==============================================================================
+struct SessionExporter::Stem
+{
+    StemResult result;
+    juce::File folder;
+    juce::Array<juce::File> chunkFiles;     // Read only by the stem's export job
+    std::vector<SampleInterval> dropouts;   // Sorted by start
+    int64_t startSample = INT64_MAX;        // Captured range of its segments
+    int64_t endSample = INT64_MIN;
+};
+
+namespace {
+
+/**
+ * Sample range of one chunk file segment, found without loading its index for export
+ */
+struct SegmentRange
+{
+    juce::File file;
+    size_t stem = 0;
+    int64_t startSample = INT64_MAX;
+    int64_t endSample = INT64_MIN;
+};
+
+void findRange(SegmentRange& segment)
+{
+    // A sealed segment's footer has it; any other segment is indexed and the entries dropped
+    SegmentFooter footer;
+    if (ChunkSegments::readFooter(segment.file, footer))
+    {
+        if (footer.chunkCount > 0)
+        {
+            segment.startSample = footer.startSample;
+            segment.endSample = footer.endSample;
+        }
+        return;
+    }
+
+    std::vector<ChunkIndexEntry> entries;
+    ChunkIndex::collect(segment.file, entries);
+    for (const auto& entry : entries)
+    {
+        segment.startSample = std::min(segment.startSample, entry.startSample);
+        segment.endSample = std::max(segment.endSample, entry.endSample());
+    }
+}
+
+/**
+ * Dropouts the coverage model recorded for a panner folder (<uuid>_<pid>)
+ */
+std::vector<SampleInterval> getRecordedDropouts(const CoverageModel& coverage, const juce::File& pannerDir)
+{
+    std::vector<SampleInterval> dropouts;
+
+    const PannerId pannerId = ChunkSegments::getPannerId(pannerDir);
+    if (!pannerId.isValid())
+        return dropouts;
+
+    // Copied under the model's lock: capture may still be adding dropouts
+    for (const auto& dropout : coverage.getPannerDropouts(pannerId))
+    {
+        if (dropout.endSample > dropout.startSample)
+            dropouts.emplace_back(dropout.startSample, dropout.endSample);
+    }
+
+    std::sort(dropouts.begin(), dropouts.end());
+    return dropouts;
+}
+
+} // namespace
+
+//==============================================================================
+bool SessionExporter::Result::wasSuccessful() const
+{
+    if (cancelled)
+        return false;
+
+    for (const auto& stem : stems)
+    {
+        if (!stem.exported)
+            return false;
+    }
+
+    return true;
+}
+
+double SessionExporter::Result::getRealtimeFactor() const
+{
+    double audioSeconds = 0.0;
+    for (const auto& stem : stems)
+    {
+        if (stem.exported && stem.sampleRate > 0)
+            audioSeconds += static_cast<double>(endSample - startSample) / stem.sampleRate;
+    }
+
+    return elapsedSeconds > 0.0 ? audioSeconds / elapsedSeconds : 0.0;
+}
+
+//==============================================================================
+SessionExporter::SessionExporter()
+    : SessionExporter(Options())
+{
+}
+
+SessionExporter::SessionExporter(const Options& options)
+    : m_options(options)
+{
+}
+
+double SessionExporter::getProgress() const
+{
+    const int64_t total = m_framesTotal.load();
+    return total > 0 ? static_cast<double>(m_framesDone.load()) / static_cast<double>(total) : 0.0;
+}
+
+SessionExporter::Result SessionExporter::exportSession(const juce::File& sessionDir, const juce::File& outputDir)
+{
+    const double startTime = juce::Time::getMillisecondCounterHiRes();
+    m_cancelled = false;
+    m_framesDone = 0;
+    m_framesTotal = 0;
+
+    Result result;
+
+    // Every panner folder with chunk files becomes a stem
+    auto folders = sessionDir.findChildFiles(juce::File::findDirectories, false);
+    folders.sort();
+
+    std::vector<std::unique_ptr<Stem>> stems;
+    std::vector<SegmentRange> segments;
+    for (const auto& folder : folders)
+    {
+        auto chunkFiles = ChunkSegments::findSegments(folder, m_options.sealedSegmentsOnly);
+        if (chunkFiles.isEmpty())
+            continue;
+
+        auto stem = std::make_unique<Stem>();
+        stem->result.pannerName = folder.getFileName();
+        stem->result.outputFile = outputDir.getChildFile(folder.getFileName() + ".wav");
+        stem->folder = folder;
+        stem->chunkFiles = chunkFiles;
+        for (const auto& chunkFile : chunkFiles)
+        {
+            SegmentRange segment;
+            segment.file = chunkFile;
+            segment.stem = stems.size();
+            segments.push_back(segment);
+        }
+        if (m_options.coverage != nullptr)
+            stem->dropouts = getRecordedDropouts(*m_options.coverage, folder);
+        stems.push_back(std::move(stem));
+    }
+
+    if (stems.empty() || !outputDir.createDirectory())
+    {
+        DBG("[SessionExporter] Nothing to export from " + sessionDir.getFullPathName());
+        return result;
+    }
+
+    const int numThreads = m_options.numThreads > 0 ? m_options.numThreads : juce::SystemStats::getNumCpus();
+    juce::ThreadPool pool(juce::jmax(1, numThreads));
+
+    // The common range comes first, from footers where segments are sealed: segment
+    // indexes are only loaded by their stem's export job, so at most one stem's index
+    // per thread is in memory however long the session
+    runOnPool(pool, segments.size(), [&segments](size_t i)
+    {
+        findRange(segments[i]);
+    }, PROGRESS_INTERVAL_MS, nullptr);
+
+    for (const auto& segment : segments)
+    {
+        auto& stem = *stems[segment.stem];
+        stem.startSample = std::min(stem.startSample, segment.startSample);
+        stem.endSample = std::max(stem.endSample, segment.endSample);
+    }
+
+    // Every stem spans the session's whole captured range
+    result.startSample = INT64_MAX;
+    result.endSample = INT64_MIN;
+    for (const auto& stem : stems)
+    {
+        if (stem->endSample <= stem->startSample)
+        {
+            stem->result.error = "No readable chunks in " + stem->folder.getFullPathName();
+            continue;
+        }
+        result.startSample = std::min(result.startSample, stem->startSample);
+        result.endSample = std::max(result.endSample, stem->endSample);
+    }
+
+    if (result.endSample <= result.startSample)
+    {
+        result.startSample = result.endSample = 0;
+    }
+
+    m_framesTotal = (result.endSample - result.startSample) * static_cast<int64_t>(stems.size());
+
+    runOnPool(pool, stems.size(), [this, &stems, &result](size_t i)
+    {
+        exportStem(*stems[i], result.startSample, result.endSample);
+    }, PROGRESS_INTERVAL_MS, [this]
+    {
+        if (m_options.onProgress)
+            m_options.onProgress(getProgress());
+    });
+
+    for (auto& stem : stems)
+        result.stems.push_back(std::move(stem->result));
+
+    if (m_options.onProgress)
+        m_options.onProgress(getProgress());
+
+    result.cancelled = m_cancelled.load();
+    result.elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    DBG("[SessionExporter] Exported " + juce::String(static_cast<int>(result.stems.size())) + " stems from "
+        + sessionDir.getFullPathName() + " in " + juce::String(result.elapsedSeconds, 2) + "s ("
+        + juce::String(result.getRealtimeFactor(), 1) + "x realtime)");
+    return result;
+}
+
+//==============================================================================
+void SessionExporter::exportStem(Stem& stem, int64_t startSample, int64_t endSample)
+{
+    auto& result = stem.result;
+    const int64_t numFrames = endSample - startSample;
+    if (result.error.isNotEmpty())
+    {
+        m_framesDone += numFrames;
+        return;
+    }
+
+    // Mapped and indexed for this job only: the reader goes when the stem is written
+    ChunkReader reader;
+    if (!reader.open(stem.chunkFiles))
+    {
+        result.error = "Could not read the chunk files in " + stem.folder.getFullPathName();
+        m_framesDone += numFrames;
+        return;
+    }
+
+    // Take the format from the first and last chunk rather than reading every header
+    // (chunks with fewer channels leave the rest silent)
+    const auto& indexEntries = reader.getIndex().getEntries();
+    ChunkHeader header;
+    for (size_t e : { size_t(0), indexEntries.size() - 1 })
+    {
+        if (e < indexEntries.size() && reader.readHeader(indexEntries[e], header))
+        {
+            if (result.sampleRate == 0)
+                result.sampleRate = header.sampleRate;
+            result.numChannels = std::max(result.numChannels, static_cast<uint32_t>(header.numChannels));
+        }
+    }
+
+    if (result.numChannels == 0 || result.sampleRate == 0)
+    {
+        result.error = "No readable chunks in " + stem.folder.getFullPathName();
+        m_framesDone += numFrames;
+        return;
+    }
+
+    // Writer (BWF: the time reference places the stem on the session timeline)
+    juce::WavAudioFormat wavFormat;
+    juce::StringPairArray metadata;
+    if (m_options.broadcastWave)
+    {
+        metadata = juce::WavAudioFormat::createBWAVMetadata("Mach1 capture: " + result.pannerName, "Mach1 System Helper",
+                                                            result.pannerName, juce::Time::getCurrentTime(),
+                                                            std::max<int64_t>(startSample, 0), "");
+    }
+
+    result.outputFile.deleteFile();
+    auto output = std::make_unique<juce::FileOutputStream>(result.outputFile);
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    if (output->openedOk())
+    {
+        writer.reset(wavFormat.createWriterFor(output.get(), result.sampleRate, result.numChannels,
+                                               m_options.bitsPerSample, metadata, 0));
+    }
+
+    if (writer == nullptr)
+    {
+        result.error = "Could not create " + result.outputFile.getFullPathName();
+        m_framesDone += numFrames;
+        return;
+    }
+    output.release();   // Owned by the writer
+
+    const int numChannels = static_cast<int>(result.numChannels);
+    const int blockSize = std::max(1, m_options.blockSize);
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    std::vector<uint8_t> covered(static_cast<size_t>(blockSize));
+    std::vector<ChunkIndexEntry> entries;
+    std::vector<float> audio;
+    uint64_t audioOffset = UINT64_MAX;      // Chunk currently decoded into audio (spans windows)
+    size_t nextDropout = 0;
+
+    bool ok = true;
+    for (int64_t windowStart = startSample; windowStart < endSample && ok; windowStart += blockSize)
+    {
+        if (m_cancelled.load())
+        {
+            ok = false;
+            break;
+        }
+
+        const int numSamples = static_cast<int>(std::min<int64_t>(blockSize, endSample - windowStart));
+        const int64_t windowEnd = windowStart + numSamples;
+        buffer.clear();
+        std::fill(covered.begin(), covered.begin() + numSamples, 0);
+
+        // Apply chunks in write order, so where chunks overlap the most recent capture wins
+        reader.getIndex().findChunks(windowStart, windowEnd, entries);
+        std::sort(entries.begin(), entries.end(),
+                  [](const ChunkIndexEntry& a, const ChunkIndexEntry& b) { return a.byteOffset < b.byteOffset; });
+        for (const auto& entry : entries)
+        {
+            if (entry.byteOffset != audioOffset)
+            {
+                audioOffset = UINT64_MAX;
+                if (!reader.read(entry, header, nullptr, audio) || header.sampleRate != result.sampleRate)
+                {
+                    ++result.chunksSkipped;
+                    continue;
+                }
+                audioOffset = entry.byteOffset;
+                ++result.chunksRead;
+            }
+
+            const int chunkChannels = header.numChannels;
+            const int64_t from = std::max(windowStart, entry.startSample);
+            const int64_t to = std::min(windowEnd, entry.endSample());
+            const int channels = std::min(chunkChannels, numChannels);
+            for (int channel = 0; channel < channels; ++channel)
+            {
+                float* destination = buffer.getWritePointer(channel);
+                const float* source = audio.data() + channel;
+                for (int64_t sample = from; sample < to; ++sample)
+                {
+                    destination[sample - windowStart] = source[(sample - entry.startSample) * chunkChannels];
+                }
+            }
+            std::fill(covered.begin() + (from - windowStart), covered.begin() + (to - windowStart), 1);
+        }
+
+        // Silence recorded dropouts (sorted, so resume from the first that can still overlap)
+        while (nextDropout < stem.dropouts.size() && stem.dropouts[nextDropout].end <= windowStart)
+            ++nextDropout;
+        for (size_t d = nextDropout; d < stem.dropouts.size() && stem.dropouts[d].start < windowEnd; ++d)
+        {
+            const int from = static_cast<int>(std::max(windowStart, stem.dropouts[d].start) - windowStart);
+            const int to = static_cast<int>(std::min(windowEnd, stem.dropouts[d].end) - windowStart);
+            buffer.clear(from, to - from);
+            std::fill(covered.begin() + from, covered.begin() + to, 0);
+        }
+
+        result.silentSamples += std::count(covered.begin(), covered.begin() + numSamples, 0);
+
+        ok = writer->writeFromFloatArrays(buffer.getArrayOfReadPointers(), numChannels, numSamples);
+        m_framesDone += numSamples;
+    }
+
+    writer.reset();     // Finalises the header
+    if (!ok)
+    {
+        if (!m_cancelled.load())
+            result.error = "Write failed: " + result.outputFile.getFullPathName();
+        result.outputFile.deleteFile();
+        return;
+    }
+
+    result.exported = true;
+}
+
+} // namespace Mach1
@@ -0,0 +1,125 @@
+/*
+    SessionExporter.h
+    -----------------
+    Exports captured sessions to WAV / Broadcast WAV stems.
+
+    Each panner folder of <capture_root>/<session_id>/ becomes one multichannel stem:
+    - Stems are sample aligned: every stem starts at the session's earliest captured
+      sample (ChunkHeader::startSample) and runs to its latest, so they line up when
+      dropped into a DAW together. The BWF time reference carries that start sample.
+    - Anything no chunk covers (dropouts, pauses, before a panner joined) is silence.
+      With a CoverageModel, its recorded dropouts are silenced too, even where a chunk
+      was written (e.g. a block that was overwritten while it was being captured).
+    - A panner's chunk files are memory mapped and read through their seek indexes
+      (ChunkIndex); audio is assembled and written in windows of Options::blockSize
+      frames, so memory use does not grow with the session length.
+    - The session range is found first, from the footers of sealed segments and the
+      indexes of the others, in parallel. Panners are then exported in parallel on the
+      same thread pool, one stem per job; a job maps and indexes its panner's segments
+      and releases them when the stem is written, so only the stems being written have
+      an index in memory.
+    - While a session is still being captured, Options::sealedSegmentsOnly exports just
+      the segments capture has finished with.
+
+    Usable from the helper (on a background thread: exportSession() blocks) and from the
+    m1-capture-export command line tool.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoverageModel.h"
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Captured session to per-panner WAV/BWF stems
+ */
+class SessionExporter
+{
+public:
+    struct Options
+    {
+        int numThreads = 0;                         // Stems exported at once (0 = one per CPU core)
+        int blockSize = 1 << 16;                    // Frames assembled per write, per stem
+        int bitsPerSample = 32;                     // 16, 24 or 32 (float)
+        bool broadcastWave = true;                  // Write a bext chunk (BWF) with the time reference
+        const CoverageModel* coverage = nullptr;    // Optional: silence the dropouts it recorded
+        bool sealedSegmentsOnly = false;            // Skip chunk files capture may still be writing
+
+        // Called with getProgress() every PROGRESS_INTERVAL_MS on the thread running exportSession()
+        std::function<void(double)> onProgress;
+    };
+
+    /**
+     * Outcome for one panner folder
+     */
+    struct StemResult
+    {
+        juce::String pannerName;            // Panner folder name
+        juce::File outputFile;
+        uint32_t numChannels = 0;
+        uint32_t sampleRate = 0;
+        uint32_t chunksRead = 0;
+        uint32_t chunksSkipped = 0;         // Unreadable, undecodable or of another channel count / rate
+        int64_t silentSamples = 0;          // Frames no chunk covered, or silenced as dropouts
+        bool exported = false;
+        juce::String error;
+    };
+
+    struct Result
+    {
+        std::vector<StemResult> stems;
+        int64_t startSample = 0;            // Common start of every stem
+        int64_t endSample = 0;
+        double elapsedSeconds = 0.0;
+        bool cancelled = false;
+
+        bool wasSuccessful() const;
+
+        /**
+         * Exported audio seconds per second of export time (over all stems)
+         */
+        double getRealtimeFactor() const;
+    };
+
+    SessionExporter();
+    explicit SessionExporter(const Options& options);
+
+    /**
+     * Export every panner folder of a session into outputDir (created if missing)
+     * Stems are named <panner folder>.wav. Blocks until done or cancelled.
+     */
+    Result exportSession(const juce::File& sessionDir, const juce::File& outputDir);
+
+    /**
+     * Stop an export in progress (call from another thread); stems already
+     * finished are kept, partial ones are deleted
+     */
+    void cancel() { m_cancelled = true; }
+
+    /**
+     * Fraction of the session's frames written so far (0..1)
+     */
+    double getProgress() const;
+
+private:
+    struct Stem;
+
+    static constexpr int PROGRESS_INTERVAL_MS = 100;
+
+    const Options m_options;
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<int64_t> m_framesDone{0};
+    std::atomic<int64_t> m_framesTotal{0};
+
+    void exportStem(Stem& stem, int64_t startSample, int64_t endSample);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SessionExporter)
+};
+
+} // namespace Mach1
@@ -0,0 +1,377 @@
+/*
+    SessionRecovery.cpp
+    -------------------
+    Implementation of the capture session crash recovery.
+*/
+
+#include "SessionRecovery.h"
+#include "ChunkFormat.h"
+#include "ChunkIndex.h"
+#include "ChunkSegments.h"
+#include "CoverageStore.h"
+#include "Crc32c.h"
+#include "StateTrack.h"
+#include "ThreadPoolJobs.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Mach1 {
+
+//==============================================================================
+struct SessionRecovery::Segment
+{
+    /**
+     * An intact chunk, as the coverage model takes it
+     */
+    struct Chunk
+    {
+        int64_t startSample;
+        int32_t numSamples;
+        uint32_t sequenceNumber;
+        uint32_t sampleRate;
+        uint32_t numChannels;
+        uint64_t bufferId;
+    };
+
+    SegmentResult result;
+    std::vector<Chunk> chunks;      // File order; only kept to rebuild coverage
+};
+
+struct SessionRecovery::Panner
+{
+    PannerId pannerId;
+    std::vector<const Segment*> segments;   // Write order
+};
+
+namespace {
+
+// Scanned bytes are counted in steps of this size, for the progress
+constexpr uint64_t PROGRESS_STEP = 64 * 1024 * 1024;
+
+/**
+ * Whether a whole, intact chunk starts at offset: header fields, bounds and checksum
+ */
+bool checkChunk(const uint8_t* data, uint64_t end, uint64_t offset, ChunkHeader& header)
+{
+    if (offset + ChunkHeader::SIZE > end)
+        return false;
+
+    std::memcpy(&header, data + offset, ChunkHeader::SIZE);
+    if (header.magic != ChunkHeader::MAGIC
+        || (header.stateSize != StateSnapshot::SIZE && header.stateSize != 0)
+        || header.numChannels <= 0
+        || header.numSamples < 0)
+        return false;
+
+    const uint64_t payloadSize = static_cast<uint64_t>(header.stateSize) + header.audioDataSize;
+    return offset + ChunkHeader::SIZE + payloadSize <= end
+        && Crc32c::verifyChunk(header, data + offset + ChunkHeader::SIZE, static_cast<size_t>(payloadSize));
+}
+
+/**
+ * Offset of the first intact chunk at or after from, or end if there is none
+ */
+uint64_t findNextChunk(const uint8_t* data, uint64_t end, uint64_t from, ChunkHeader& header)
+{
+    uint8_t magic[4];
+    const uint32_t magicValue = ChunkHeader::MAGIC;
+    std::memcpy(magic, &magicValue, sizeof(magic));
+
+    while (from + ChunkHeader::SIZE <= end)
+    {
+        const void* hit = std::memchr(data + from, magic[0], static_cast<size_t>(end - ChunkHeader::SIZE - from + 1));
+        if (hit == nullptr)
+            break;
+
+        from = static_cast<uint64_t>(static_cast<const uint8_t*>(hit) - data);
+        if (std::memcmp(data + from, magic, sizeof(magic)) == 0 && checkChunk(data, end, from, header))
+            return from;
+        ++from;
+    }
+
+    return end;
+}
+
+} // namespace
+
+//==============================================================================
+bool SessionRecovery::Result::wasSuccessful() const
+{
+    if (cancelled)
+        return false;
+
+    for (const auto& segment : segments)
+    {
+        if (segment.error.isNotEmpty())
+            return false;
+    }
+
+    return true;
+}
+
+size_t SessionRecovery::Result::getNumDamagedSegments() const
+{
+    return static_cast<size_t>(std::count_if(segments.begin(), segments.end(),
+                                             [](const SegmentResult& segment) { return segment.wasDamaged(); }));
+}
+
+double SessionRecovery::Result::getScanRate() const
+{
+    return elapsedSeconds > 0.0 ? static_cast<double>(bytesScanned) / elapsedSeconds : 0.0;
+}
+
+//==============================================================================
+SessionRecovery::SessionRecovery()
+    : SessionRecovery(Options())
+{
+}
+
+SessionRecovery::SessionRecovery(const Options& options)
+    : m_options(options)
+{
+}
+
+double SessionRecovery::getProgress() const
+{
+    const uint64_t total = m_bytesTotal.load();
+    return total > 0 ? static_cast<double>(m_bytesDone.load()) / static_cast<double>(total) : 0.0;
+}
+
+SessionRecovery::Result SessionRecovery::recover(const juce::File& sessionDir)
+{
+    return recover(juce::Array<juce::File>(sessionDir));
+}
+
+SessionRecovery::Result SessionRecovery::recover(const juce::Array<juce::File>& sessionDirs)
+{
+    const double startTime = juce::Time::getMillisecondCounterHiRes();
+    m_cancelled = false;
+    m_bytesDone = 0;
+    m_bytesTotal = 0;
+
+    Result result;
+
+    // Every segment of every panner folder, scanned as one batch
+    std::vector<std::unique_ptr<Segment>> segments;
+    std::vector<Panner> panners;
+    for (const auto& sessionDir : sessionDirs)
+    {
+        if (!sessionDir.isDirectory())
+            continue;
+        result.sessions++;
+
+        auto folders = sessionDir.findChildFiles(juce::File::findDirectories, false);
+        folders.sort();
+        for (const auto& folder : folders)
+        {
+            const auto chunkFiles = ChunkSegments::findSegments(folder);
+            if (chunkFiles.isEmpty())
+                continue;
+
+            Panner panner;
+            panner.pannerId = ChunkSegments::getPannerId(folder);
+            for (const auto& chunkFile : chunkFiles)
+            {
+                auto segment = std::make_unique<Segment>();
+                segment->result.file = chunkFile;
+                segment->result.fileBytes = static_cast<uint64_t>(chunkFile.getSize());
+                m_bytesTotal += segment->result.fileBytes;
+                panner.segments.push_back(segment.get());
+                segments.push_back(std::move(segment));
+            }
+            panners.push_back(std::move(panner));
+        }
+    }
+    result.panners = static_cast<uint32_t>(panners.size());
+
+    const int numThreads = m_options.numThreads > 0 ? m_options.numThreads : juce::SystemStats::getNumCpus();
+    juce::ThreadPool pool(juce::jmax(1, numThreads));
+
+    auto reportProgress = [this]
+    {
+        if (m_options.onProgress)
+            m_options.onProgress(getProgress());
+    };
+
+    runOnPool(pool, segments.size(), [this, &segments](size_t i)
+    {
+        if (!m_cancelled.load())
+            recoverSegment(*segments[i]);
+    }, PROGRESS_INTERVAL_MS, reportProgress);
+
+    // Panners are independent; each one's chunks go in in write order
+    result.cancelled = m_cancelled.load();
+    if (m_options.coverage != nullptr && !result.cancelled)
+    {
+        runOnPool(pool, panners.size(), [this, &panners](size_t i)
+        {
+            rebuildCoverage(panners[i]);
+        }, PROGRESS_INTERVAL_MS, nullptr);
+        m_options.coverage->publishSnapshot();
+    }
+
+    reportProgress();
+
+    // A session's coverage file may list chunks recovery cut away: its next capture rebuilds it
+    for (const auto& segment : segments)
+    {
+        const auto& segmentResult = segment->result;
+        if (!m_options.dryRun && (segmentResult.truncatedBytes > 0 || segmentResult.corruptRegions > 0))
+            CoverageStore::getCoverageFile(segmentResult.file.getParentDirectory().getParentDirectory()).deleteFile();
+    }
+
+    for (auto& segment : segments)
+    {
+        result.chunks += segment->result.chunks;
+        result.segments.push_back(std::move(segment->result));
+    }
+    result.bytesScanned = m_bytesDone.load();
+    result.elapsedSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    DBG("[SessionRecovery] Checked " + juce::String(static_cast<int>(result.segments.size())) + " segments of "
+        + juce::String(static_cast<int>(result.panners)) + " panners in " + juce::String(result.elapsedSeconds, 2)
+        + "s, " + juce::String(static_cast<int>(result.getNumDamagedSegments())) + " damaged");
+    return result;
+}
+
+//==============================================================================
+void SessionRecovery::recoverSegment(Segment& segment)
+{
+    auto& result = segment.result;
+    const juce::File& file = result.file;
+
+    std::vector<ChunkIndexEntry> entries;
+    uint64_t validEnd = 0;
+
+    if (result.fileBytes > 0)
+    {
+        juce::MemoryMappedFile map(file, juce::MemoryMappedFile::readOnly);
+        if (map.getData() == nullptr)
+        {
+            result.error = "Could not map " + file.getFullPathName();
+            m_bytesDone += result.fileBytes;
+            return;
+        }
+
+        const uint8_t* data = static_cast<const uint8_t*>(map.getData());
+        const uint64_t size = static_cast<uint64_t>(map.getSize());
+
+        // A sealed segment's data ends where its footer says
+        uint64_t dataEnd = size;
+        if (size >= SegmentFooter::SIZE)
+        {
+            SegmentFooter footer;
+            std::memcpy(&footer, data + size - SegmentFooter::SIZE, SegmentFooter::SIZE);
+            result.sealed = ChunkSegments::isValidFooter(footer, size);
+            if (result.sealed)
+                dataEnd = footer.dataSize;
+        }
+
+        uint64_t offset = 0;
+        uint64_t counted = 0;
+        ChunkHeader header;
+        while (offset < dataEnd)
+        {
+            if (!checkChunk(data, dataEnd, offset, header))
+            {
+                // Resume at the next intact chunk; none at all means a torn tail
+                const uint64_t next = findNextChunk(data, dataEnd, offset + 1, header);
+                if (next == dataEnd)
+                {
+                    if (result.sealed)
+                        result.corruptRegions++;
+                    break;
+                }
+                result.corruptRegions++;
+                offset = next;
+            }
+
+            ChunkIndexEntry entry;
+            entry.startSample = header.startSample;
+            entry.numSamples = header.numSamples;
+            entry.sequenceNumber = header.sequenceNumber;
+            entry.byteOffset = offset;
+            entries.push_back(entry);
+
+            if (m_options.coverage != nullptr)
+            {
+                segment.chunks.push_back({ header.startSample, header.numSamples, header.sequenceNumber,
+                                           header.sampleRate, static_cast<uint32_t>(header.numChannels),
+                                           header.bufferId });
+            }
+
+            offset += ChunkHeader::SIZE + static_cast<uint64_t>(header.stateSize) + header.audioDataSize;
+            validEnd = offset;
+
+            if (offset - counted >= PROGRESS_STEP)
+            {
+                m_bytesDone += offset - counted;
+                counted = offset;
+            }
+        }
+
+        m_bytesDone += size - counted;
+    }
+
+    result.chunks = static_cast<uint32_t>(entries.size());
+
+    // Cut off the torn tail (the map is closed by now)
+    if (!result.sealed && validEnd < result.fileBytes)
+    {
+        result.truncatedBytes = result.fileBytes - validEnd;
+        if (!m_options.dryRun)
+        {
+            juce::FileOutputStream output(file);
+            if (!output.openedOk() || !output.setPosition(static_cast<juce::int64>(validEnd)) || output.truncate().failed())
+                result.error = "Could not truncate " + file.getFullPathName();
+        }
+    }
+
+    // The sidecar must list exactly the intact chunks
+    if (result.fileBytes > 0)
+    {
+        std::vector<ChunkIndexEntry> sidecar;
+        const bool wellFormed = ChunkIndex::readSidecar(file, sidecar);
+        result.indexRewritten = !wellFormed || sidecar.size() != entries.size()
+            || (!entries.empty() && std::memcmp(sidecar.data(), entries.data(), entries.size() * ChunkIndexEntry::SIZE) != 0);
+        if (result.indexRewritten && !m_options.dryRun && !ChunkIndex::writeSidecar(file, entries))
+            result.error = "Could not write " + ChunkIndex::getIndexFile(file).getFullPathName();
+    }
+
+    const juce::File stateFile = StateTrack::getStateFile(file);
+    if (stateFile.existsAsFile())
+    {
+        StateTrack stateTrack;
+        const uint64_t stateBytes = static_cast<uint64_t>(stateFile.getSize());
+        const uint64_t validStateBytes = stateTrack.load(stateFile) ? stateTrack.getValidBytes() : 0;
+        result.stateTruncatedBytes = stateBytes - std::min(stateBytes, validStateBytes);
+        if (result.stateTruncatedBytes > 0 && !m_options.dryRun && !StateTrack::repair(stateFile))
+            result.error = "Could not repair " + stateFile.getFullPathName();
+    }
+
+    if (result.wasDamaged())
+    {
+        DBG("[SessionRecovery] " + file.getFullPathName() + ": " + juce::String(static_cast<int>(result.chunks))
+            + " chunks, " + juce::String(static_cast<int>(result.corruptRegions)) + " corrupt regions, "
+            + juce::String(static_cast<juce::int64>(result.truncatedBytes)) + " bytes torn");
+    }
+}
+
+void SessionRecovery::rebuildCoverage(const Panner& panner)
+{
+    if (!panner.pannerId.isValid())
+        return;
+
+    CoverageModel& coverage = *m_options.coverage;
+    const auto handle = coverage.internPanner(panner.pannerId);
+    for (const Segment* segment : panner.segments)
+    {
+        for (const auto& chunk : segment->chunks)
+        {
+            coverage.addPannerInterval(handle, chunk.startSample, chunk.numSamples, chunk.sampleRate,
+                                       chunk.numChannels, chunk.sequenceNumber, chunk.bufferId);
+        }
+    }
+}
+
+} // namespace Mach1
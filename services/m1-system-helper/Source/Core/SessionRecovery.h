@@ -0,0 +1,136 @@
+/*
+    SessionRecovery.h
+    -----------------
+    Brings captured sessions back to a consistent state after a crash, and rebuilds
+    their coverage.
+
+    Every chunk file segment of every panner folder is checked, all of them in parallel
+    on one thread pool (sessions, panners and segments alike):
+    - The segment is memory mapped and walked chunk by chunk: header, bounds and, for
+      chunks that carry one, the CRC-32C must check out, so a multi-GB session takes
+      about as long as reading it.
+    - A corrupt chunk inside a segment is stepped over by searching for the next chunk
+      that checks out; its samples stay uncovered.
+    - A torn tail (the chunk a crash cut short, or file space that was never written) is
+      truncated away. Sealed segments are never truncated: their footer says where their
+      data ends.
+    - The index sidecar is rewritten if it does not list exactly the intact chunks, and a
+      torn record at the end of the state stream is dropped (StateTrack::repair).
+
+    Afterwards each panner's intact chunks go into Options::coverage in write order, the
+    way the capture engine adds them, so the rebuilt model has the same captured
+    intervals and sequence gap dropouts.
+
+    A session whose chunks were cut or stepped over loses its coverage file
+    (CoverageStore), which its next capture rebuilds from the repaired indexes.
+
+    Do not run it on a session that is still being captured: it would truncate the
+    segments capture is appending to.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoverageModel.h"
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * Crash recovery for captured sessions
+ */
+class SessionRecovery
+{
+public:
+    struct Options
+    {
+        int numThreads = 0;                 // Segments scanned at once (0 = one per CPU core)
+        bool dryRun = false;                // Only report: truncate and rewrite nothing
+        CoverageModel* coverage = nullptr;  // Optional: receives the sessions' rebuilt coverage
+
+        // Called with getProgress() every PROGRESS_INTERVAL_MS on the thread running recover()
+        std::function<void(double)> onProgress;
+    };
+
+    /**
+     * Outcome for one chunk file segment
+     */
+    struct SegmentResult
+    {
+        juce::File file;
+        uint64_t fileBytes = 0;             // Size before recovery
+        uint32_t chunks = 0;                // Intact chunks
+        uint32_t corruptRegions = 0;        // Stretches between intact chunks that were stepped over
+        uint64_t truncatedBytes = 0;        // Torn tail (removed unless dryRun)
+        uint64_t stateTruncatedBytes = 0;   // Torn end of the state stream
+        bool sealed = false;
+        bool indexRewritten = false;        // Needed rewriting (was rewritten unless dryRun)
+        juce::String error;
+
+        bool wasDamaged() const { return corruptRegions > 0 || truncatedBytes > 0 || stateTruncatedBytes > 0 || indexRewritten; }
+    };
+
+    struct Result
+    {
+        std::vector<SegmentResult> segments;
+        uint32_t sessions = 0;
+        uint32_t panners = 0;
+        uint64_t chunks = 0;
+        uint64_t bytesScanned = 0;
+        double elapsedSeconds = 0.0;
+        bool cancelled = false;
+
+        bool wasSuccessful() const;
+
+        /**
+         * Segments that were damaged (or would have been repaired, after a dry run)
+         */
+        size_t getNumDamagedSegments() const;
+
+        /**
+         * Scanned bytes per second
+         */
+        double getScanRate() const;
+    };
+
+    SessionRecovery();
+    explicit SessionRecovery(const Options& options);
+
+    /**
+     * Recover every panner folder of the given session folders. Blocks until done or cancelled.
+     */
+    Result recover(const juce::Array<juce::File>& sessionDirs);
+    Result recover(const juce::File& sessionDir);
+
+    /**
+     * Stop a recovery in progress (call from another thread); segments already
+     * started are finished
+     */
+    void cancel() { m_cancelled = true; }
+
+    /**
+     * Fraction of the bytes scanned so far (0..1)
+     */
+    double getProgress() const;
+
+private:
+    struct Segment;
+    struct Panner;
+
+    static constexpr int PROGRESS_INTERVAL_MS = 100;
+
+    const Options m_options;
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<uint64_t> m_bytesDone{0};
+    std::atomic<uint64_t> m_bytesTotal{0};
+
+    void recoverSegment(Segment& segment);
+    void rebuildCoverage(const Panner& panner);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SessionRecovery)
+};
+
+} // namespace Mach1
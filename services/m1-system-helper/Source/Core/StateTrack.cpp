@@ -0,0 +1,257 @@
+/*
+    StateTrack.cpp
+    --------------
+    Implementation of the state stream reader and record encoding.
+*/
+
+#include "StateTrack.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Mach1 {
+
+namespace {
+
+uint32_t floatBits(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsToFloat(uint32_t bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint32_t getField(const StateSnapshot& state, int field)
+{
+    switch (field)
+    {
+        case StateTrack::Azimuth:            return floatBits(state.azimuthDeg);
+        case StateTrack::Elevation:          return floatBits(state.elevationDeg);
+        case StateTrack::Diverge:            return floatBits(state.diverge);
+        case StateTrack::Gain:               return floatBits(state.gainDb);
+        case StateTrack::StereoOrbitAzimuth: return floatBits(state.stereoOrbitAzimuth);
+        case StateTrack::StereoSpread:       return floatBits(state.stereoSpread);
+        case StateTrack::StereoInputBalance: return floatBits(state.stereoInputBalance);
+        case StateTrack::AutoOrbit:          return state.autoOrbit ? 1u : 0u;
+        case StateTrack::InputMode:          return static_cast<uint32_t>(state.inputMode);
+        case StateTrack::OutputMode:         return static_cast<uint32_t>(state.outputMode);
+        case StateTrack::PannerMode:         return static_cast<uint32_t>(state.pannerMode);
+        case StateTrack::GainCompensation:   return static_cast<uint32_t>(state.gainCompensation);
+        default:                             return 0;
+    }
+}
+
+void setField(StateSnapshot& state, int field, uint32_t bits)
+{
+    switch (field)
+    {
+        case StateTrack::Azimuth:            state.azimuthDeg = bitsToFloat(bits); break;
+        case StateTrack::Elevation:          state.elevationDeg = bitsToFloat(bits); break;
+        case StateTrack::Diverge:            state.diverge = bitsToFloat(bits); break;
+        case StateTrack::Gain:               state.gainDb = bitsToFloat(bits); break;
+        case StateTrack::StereoOrbitAzimuth: state.stereoOrbitAzimuth = bitsToFloat(bits); break;
+        case StateTrack::StereoSpread:       state.stereoSpread = bitsToFloat(bits); break;
+        case StateTrack::StereoInputBalance: state.stereoInputBalance = bitsToFloat(bits); break;
+        case StateTrack::AutoOrbit:          state.autoOrbit = bits != 0; break;
+        case StateTrack::InputMode:          state.inputMode = static_cast<int32_t>(bits); break;
+        case StateTrack::OutputMode:         state.outputMode = static_cast<int32_t>(bits); break;
+        case StateTrack::PannerMode:         state.pannerMode = static_cast<int32_t>(bits); break;
+        case StateTrack::GainCompensation:   state.gainCompensation = static_cast<int32_t>(bits); break;
+        default:                             break;     // Field from a newer writer
+    }
+}
+
+} // namespace
+
+//==============================================================================
+juce::File StateTrack::getStateFile(const juce::File& chunkFile)
+{
+    // chunks.bin -> state.bin, chunks_0001.bin -> state_0001.bin
+    return chunkFile.getSiblingFile(chunkFile.getFileName().replace("chunks", "state"));
+}
+
+bool StateTrack::repair(const juce::File& stateFile)
+{
+    if (!stateFile.existsAsFile())
+        return true;
+
+    // Not a state stream at all: start a new one
+    StateTrack track;
+    if (!track.load(stateFile))
+        return stateFile.deleteFile();
+
+    if (static_cast<int64_t>(track.m_validBytes) == stateFile.getSize())
+        return true;
+
+    DBG("[StateTrack] Truncating " + stateFile.getFullPathName() + " to " + juce::String(static_cast<juce::int64>(track.m_validBytes))
+        + " bytes (" + juce::String(static_cast<int>(track.m_points.size())) + " records)");
+    juce::FileOutputStream output(stateFile);
+    return output.openedOk()
+        && output.setPosition(static_cast<juce::int64>(track.m_validBytes))
+        && output.truncate().wasOk();
+}
+
+uint16_t StateTrack::getChangedFields(const StateSnapshot& from, const StateSnapshot& to)
+{
+    uint16_t changed = 0;
+    for (int field = 0; field < NUM_FIELDS; ++field)
+    {
+        if (getField(from, field) != getField(to, field))
+            changed |= static_cast<uint16_t>(1u << field);
+    }
+    return changed;
+}
+
+size_t StateTrack::encodeRecord(const StateRecordHeader& header, const StateSnapshot& state, uint8_t* out)
+{
+    std::memcpy(out, &header, StateRecordHeader::SIZE);
+    size_t size = StateRecordHeader::SIZE;
+
+    for (int field = 0; field < NUM_FIELDS; ++field)
+    {
+        if ((header.changedFields & (1u << field)) == 0)
+            continue;
+
+        const uint32_t bits = getField(state, field);
+        std::memcpy(out + size, &bits, sizeof(bits));
+        size += sizeof(bits);
+    }
+
+    return size;
+}
+
+//==============================================================================
+bool StateTrack::load(const juce::File& stateFile)
+{
+    clear();
+
+    juce::FileInputStream input(stateFile);
+    StateStreamHeader streamHeader;
+    if (!input.openedOk()
+        || input.read(&streamHeader, StateStreamHeader::SIZE) != static_cast<int>(StateStreamHeader::SIZE)
+        || streamHeader.magic != StateStreamHeader::MAGIC)
+        return false;
+
+    // The stream holds changes only, so it is small enough to read whole
+    const int64_t length = input.getTotalLength() - static_cast<int64_t>(StateStreamHeader::SIZE);
+    std::vector<uint8_t> data(static_cast<size_t>(std::max<int64_t>(length, 0)));
+    const size_t bytesPerRead = 1 << 24;
+    size_t available = 0;
+    while (available < data.size())
+    {
+        const int bytes = static_cast<int>(std::min(bytesPerRead, data.size() - available));
+        const int read = input.read(data.data() + available, bytes);
+        if (read <= 0)
+            break;
+        available += static_cast<size_t>(read);
+    }
+
+    // Every field its writer knew makes a full state: older streams lack the newer fields
+    const int writerFields = juce::jlimit(1, static_cast<int>(NUM_FIELDS), static_cast<int>(streamHeader.numFields));
+    const uint16_t fullState = static_cast<uint16_t>((1u << writerFields) - 1);
+
+    StatePoint point;
+    bool haveState = false;
+    size_t position = 0;
+    while (position + StateRecordHeader::SIZE <= available)
+    {
+        StateRecordHeader header;
+        std::memcpy(&header, data.data() + position, StateRecordHeader::SIZE);
+
+        // Every field is 4 bytes, including ones from a newer writer
+        const size_t valuesSize = 4 * static_cast<size_t>(juce::countNumberOfBits(static_cast<uint32_t>(header.changedFields)));
+        if (header.magic != StateRecordHeader::MAGIC || position + StateRecordHeader::SIZE + valuesSize > available)
+            break;
+
+        // A capture starts with every field, so deltas only apply on top of a full state
+        if (!haveState && (header.changedFields & fullState) != fullState)
+        {
+            position += StateRecordHeader::SIZE + valuesSize;
+            continue;
+        }
+
+        const uint8_t* value = data.data() + position + StateRecordHeader::SIZE;
+        for (int field = 0; field < 16; ++field)
+        {
+            if ((header.changedFields & (1u << field)) == 0)
+                continue;
+
+            uint32_t bits;
+            std::memcpy(&bits, value, sizeof(bits));
+            setField(point.state, field, bits);
+            value += sizeof(bits);
+        }
+
+        point.samplePosition = header.samplePosition;
+        point.chunkOffset = header.chunkOffset;
+        point.stateSeq = header.stateSeq;
+        point.changedFields = header.changedFields;
+        point.state.stateSeq = header.stateSeq;
+
+        // Offsets only grow within a stream; anything else is damage
+        if (!m_points.empty() && point.chunkOffset < m_points.back().chunkOffset)
+            break;
+
+        m_points.push_back(point);
+        haveState = true;
+        position += StateRecordHeader::SIZE + valuesSize;
+    }
+    m_validBytes = StateStreamHeader::SIZE + position;
+
+    m_timeline.resize(m_points.size());
+    for (size_t i = 0; i < m_timeline.size(); ++i)
+        m_timeline[i] = static_cast<uint32_t>(i);
+    std::stable_sort(m_timeline.begin(), m_timeline.end(), [this](uint32_t a, uint32_t b)
+    {
+        return m_points[a].samplePosition < m_points[b].samplePosition;
+    });
+
+    return true;
+}
+
+void StateTrack::clear()
+{
+    m_points.clear();
+    m_timeline.clear();
+    m_validBytes = 0;
+}
+
+//==============================================================================
+const StatePoint* StateTrack::findForChunk(uint64_t chunkOffset) const
+{
+    auto it = std::upper_bound(m_points.begin(), m_points.end(), chunkOffset,
+                               [](uint64_t offset, const StatePoint& point) { return offset < point.chunkOffset; });
+    return it == m_points.begin() ? nullptr : &*(it - 1);
+}
+
+size_t StateTrack::timelineUpperBound(int64_t sample) const
+{
+    auto it = std::upper_bound(m_timeline.begin(), m_timeline.end(), sample,
+                               [this](int64_t s, uint32_t index) { return s < m_points[index].samplePosition; });
+    return static_cast<size_t>(it - m_timeline.begin());
+}
+
+const StatePoint* StateTrack::findAt(int64_t sample) const
+{
+    const size_t end = timelineUpperBound(sample);
+    return end == 0 ? nullptr : &m_points[m_timeline[end - 1]];
+}
+
+void StateTrack::findChanges(int64_t startSample, int64_t endSample, std::vector<StatePoint>& result) const
+{
+    result.clear();
+
+    size_t i = timelineUpperBound(startSample);
+    if (i > 0)
+        result.push_back(m_points[m_timeline[i - 1]]);
+
+    for (; i < m_timeline.size() && m_points[m_timeline[i]].samplePosition < endSample; ++i)
+        result.push_back(m_points[m_timeline[i]]);
+}
+
+} // namespace Mach1
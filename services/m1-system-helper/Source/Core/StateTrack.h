@@ -0,0 +1,143 @@
+/*
+    StateTrack.h
+    ------------
+    Panner state history of a captured chunk file, from its state stream (state.bin, or
+    state_NNNN.bin next to segment chunks_NNNN.bin).
+
+    The capture engine no longer stamps a StateSnapshot on every chunk. It appends a
+    StateRecordHeader to state.bin only when a panner parameter changes, followed by
+    just the fields that changed (4 bytes each, see Field). The first record of each
+    capture, and the first after a lost record, carries every field. Fields are only
+    ever added at the end: a stream from an older writer (StateStreamHeader::numFields)
+    leaves the newer ones at their StateSnapshot defaults.
+
+    A record takes effect at the first block captured with it: samplePosition is that
+    block's start sample and chunkOffset its chunk's offset in chunks.bin, so a chunk's
+    state is the last record at or before its offset. Changes are therefore as precise
+    as the capture itself (one block); a steady panner costs nothing per block.
+
+    StateTrack loads the stream and resolves every record to a full StateSnapshot, so
+    automation graphs and the offline renderer can query by chunk or by sample range in
+    O(log n). Reading stops at the first torn or damaged record; repair() cuts such a
+    tail off before a capture appends to the stream again.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChunkFormat.h"
+#include <vector>
+
+namespace Mach1 {
+
+//==============================================================================
+/**
+ * One state change, resolved to the full state in effect after it
+ */
+struct StatePoint
+{
+    int64_t samplePosition = 0;
+    uint64_t chunkOffset = 0;
+    uint32_t stateSeq = 0;
+    uint16_t changedFields = 0;   // Fields this record changed (every field for the first)
+    StateSnapshot state;
+};
+
+//==============================================================================
+/**
+ * Loaded state stream of one chunk file
+ */
+class StateTrack
+{
+public:
+    /**
+     * Recorded fields, in stream order (bit i of StateRecordHeader::changedFields)
+     */
+    enum Field
+    {
+        Azimuth = 0,
+        Elevation,
+        Diverge,
+        Gain,
+        StereoOrbitAzimuth,
+        StereoSpread,
+        StereoInputBalance,
+        AutoOrbit,
+        InputMode,
+        OutputMode,
+        PannerMode,
+        GainCompensation,
+        NUM_FIELDS
+    };
+
+    static constexpr uint16_t ALL_FIELDS = (1u << NUM_FIELDS) - 1;
+    static constexpr size_t MAX_RECORD_SIZE = StateRecordHeader::SIZE + NUM_FIELDS * 4;
+
+    /**
+     * State stream path for a chunk file (chunks.bin -> state.bin, chunks_NNNN.bin -> state_NNNN.bin)
+     */
+    static juce::File getStateFile(const juce::File& chunkFile);
+
+    /**
+     * Cut a torn or damaged tail off a state stream before appending to it, so the new
+     * records stay readable (a file that is not a state stream is deleted)
+     * @return false if the file could not be fixed
+     */
+    static bool repair(const juce::File& stateFile);
+
+    /**
+     * Fields whose values differ (bitwise, so every change is kept exactly)
+     */
+    static uint16_t getChangedFields(const StateSnapshot& from, const StateSnapshot& to);
+
+    /**
+     * Serialise a record with the given fields of state into out (MAX_RECORD_SIZE bytes)
+     * @return Bytes written
+     */
+    static size_t encodeRecord(const StateRecordHeader& header, const StateSnapshot& state, uint8_t* out);
+
+    //==========================================================================
+    /**
+     * Load a state stream (replaces the current contents)
+     * @return false if the file is missing or not a state stream
+     */
+    bool load(const juce::File& stateFile);
+    void clear();
+
+    /**
+     * Every record in write order
+     */
+    const std::vector<StatePoint>& getPoints() const { return m_points; }
+    bool isEmpty() const { return m_points.empty(); }
+
+    /**
+     * Bytes of the loaded stream in use: its header and every complete record
+     */
+    size_t getValidBytes() const { return m_validBytes; }
+
+    /**
+     * State a chunk was captured with (nullptr if the stream has no record before it)
+     */
+    const StatePoint* findForChunk(uint64_t chunkOffset) const;
+
+    /**
+     * State in effect at a timeline sample: the record with the highest samplePosition
+     * at or before it (the most recent write among equals)
+     */
+    const StatePoint* findAt(int64_t sample) const;
+
+    /**
+     * Automation over [startSample, endSample): the state in effect at startSample (if
+     * any), then every change inside the range, in timeline order
+     */
+    void findChanges(int64_t startSample, int64_t endSample, std::vector<StatePoint>& result) const;
+
+private:
+    std::vector<StatePoint> m_points;       // Write order (chunkOffset ascending)
+    std::vector<uint32_t> m_timeline;       // m_points indices by samplePosition (ties keep write order)
+    size_t m_validBytes = 0;                // Stream header and complete records
+
+    size_t timelineUpperBound(int64_t sample) const;
+};
+
+} // namespace Mach1
@@ -0,0 +1,45 @@
+/*
+    ThreadPoolJobs.h
+    ----------------
+    Fork/join helper for the offline session tools (SessionExporter, OfflineRenderer,
+    SessionRecovery, CoverageRebuilder).
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+
+namespace Mach1 {
+
+/**
+ * Run fn(0) .. fn(count - 1) on the pool and wait for all of them, calling idle while waiting
+ */
+template <typename Function>
+void runOnPool(juce::ThreadPool& pool, size_t count, Function&& fn, int idleIntervalMs, const std::function<void()>& idle)
+{
+    if (count == 0)
+        return;
+
+    std::atomic<size_t> remaining{count};
+    juce::WaitableEvent done;
+    for (size_t i = 0; i < count; ++i)
+    {
+        pool.addJob([&, i]
+        {
+            fn(i);
+            if (--remaining == 0)
+                done.signal();
+            return juce::ThreadPoolJob::jobHasFinished;
+        });
+    }
+
+    while (!done.wait(idleIntervalMs))
+    {
+        if (idle)
+            idle();
+    }
+}
+
+} // namespace Mach1
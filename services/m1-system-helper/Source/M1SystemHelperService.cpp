@@ -35,6 +35,9 @@ M1SystemHelperService::M1SystemHelperService() {
     // Initialize new panner tracking manager
     pannerTrackingManager = std::make_unique<PannerTrackingManager>(eventSystem);
     
+    // New panners found by the directory watcher are taken in at once, not on the next tick
+    pannerTrackingManager->onScanRequested = [this] { triggerAsyncUpdate(); };
+    
     // Initialize OSC tracker with plugin manager
     pannerTrackingManager->initializeOSCTracker(pluginManager.get());
 
@@ -138,6 +141,12 @@ void M1SystemHelperService::timerCallback() {
     }
 }
 
+void M1SystemHelperService::handleAsyncUpdate() {
+    if (pannerTrackingManager) {
+        pannerTrackingManager->update();
+    }
+}
+
 void M1SystemHelperService::start() {
     // Legacy method - now just calls initialise() for compatibility
     // The actual service runs via JUCE timers on the main message thread
@@ -168,6 +177,7 @@ void M1SystemHelperService::shutdown() {
     
     if (pannerTrackingManager)
         pannerTrackingManager->stop();
+    cancelPendingUpdate();
     
     if (serviceManager)
         serviceManager->killOrientationManager();
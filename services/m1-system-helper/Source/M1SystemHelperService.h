@@ -14,7 +14,7 @@
 
 namespace Mach1 {
 
-class M1SystemHelperService : public juce::Timer {
+class M1SystemHelperService : public juce::Timer, private juce::AsyncUpdater {
 public:
     static M1SystemHelperService& getInstance();
     
@@ -44,6 +44,7 @@ private:
     ~M1SystemHelperService() override;
     
     void timerCallback() override;
+    void handleAsyncUpdate() override;
     void ensureSessionUICreated();
     
 private:
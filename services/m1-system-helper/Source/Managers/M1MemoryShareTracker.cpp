@@ -87,6 +87,7 @@ M1MemoryShareTracker::M1MemoryShareTracker(uint32_t consumerId) : consumerId(con
 }
 
 M1MemoryShareTracker::~M1MemoryShareTracker() {
+    stop();
 }
 
 void M1MemoryShareTracker::start() {
@@ -96,6 +97,30 @@ void M1MemoryShareTracker::start() {
     initialized = true;
     lastScanTime = 0; // Force immediate scan
     
+    // Watch the shared directories before the initial scan so no file falls in between.
+    // The panner creates the primary directory on first use; create it here so it can be watched.
+    auto sharedDirectories = SharedPathUtils::getAllSharedDirectories();
+    juce::File primaryDirectory(SharedPathUtils::getSharedMemoryDirectory());
+    if (!primaryDirectory.exists()) {
+        primaryDirectory.createDirectory();
+    }
+    
+    if (directoryWatcher.start(sharedDirectories, "M1SpatialSystem_", ".mem")) {
+        watcherShouldStop = false;
+        watcherThread = std::thread([this] { runDirectoryWatcher(); });
+        scanForMemorySegments();
+        lastScanTime = juce::Time::currentTimeMillis();
+        DBG("[M1MemoryShareTracker] Watching " + juce::String(directoryWatcher.getWatchCount()) + " directories for panners");
+    } else {
+        DBG("[M1MemoryShareTracker] Directory watcher unavailable, scanning every " + juce::String(SCAN_INTERVAL_MS) + " ms");
+    }
+    
+#if defined(M1_MEMORYSHARE_FD_TRANSPORT)
+    if (!segmentListener.start()) {
+        DBG("[M1MemoryShareTracker] Fd transport unavailable, using file-backed segments only");
+    }
+#endif
+    
     DBG("[M1MemoryShareTracker] Started memory share tracking with consumer ID: " + juce::String(consumerId));
 }
 
@@ -104,6 +129,23 @@ void M1MemoryShareTracker::stop() {
     
     isRunning = false;
     
+    if (watcherThread.joinable()) {
+        watcherShouldStop = true;
+        directoryWatcher.wake();
+        watcherThread.join();
+    }
+    directoryWatcher.stop();
+    
+    {
+        const juce::ScopedLock lock(pannersMutex);
+        discoveredPanners.clear();
+        removedSegmentPaths.clear();
+    }
+    
+#if defined(M1_MEMORYSHARE_FD_TRANSPORT)
+    segmentListener.stop();
+#endif
+    
     // Disconnect from all panners and force cleanup of memory-mapped files
     for (auto& panner : activePanners) {
         disconnectFromPanner(panner);
@@ -122,12 +164,27 @@ void M1MemoryShareTracker::update() {
     
     auto currentTime = juce::Time::currentTimeMillis();
     
-    // Scan for new memory segments periodically
-    if (currentTime - lastScanTime >= SCAN_INTERVAL_MS) {
+    // Announced memfd segments arrive on a socket, no need to wait for the scan
+    receiveAnnouncedSegments();
+    
+    if (directoryWatcher.isWatching()) {
+        // The watcher thread has already connected new panners; a full scan only after lost events
+        mergeWatcherResults();
+        if (rescanRequested.exchange(false)) {
+            scanForMemorySegments();
+            lastScanTime = currentTime;
+        }
+    } else if (currentTime - lastScanTime >= SCAN_INTERVAL_MS) {
+        // Polling fallback
         scanForMemorySegments();
         lastScanTime = currentTime;
     }
     
+    if (currentTime - lastCleanupTime >= STALE_FILE_CLEANUP_INTERVAL_MS) {
+        cleanupStaleMemoryFiles();
+        lastCleanupTime = currentTime;
+    }
+    
     // Update existing panners more frequently
     updateExistingPanners();
     
@@ -157,26 +214,31 @@ bool M1MemoryShareTracker::isAvailable() const {
 }
 
 bool M1MemoryShareTracker::connectToPanner(MemorySharePannerInfo& panner) {
-    if (panner.isConnected || panner.memoryFilePath.empty()) {
+    if (panner.isConnected || (panner.memoryFilePath.empty() && !panner.memoryShare)) {
         return panner.isConnected;
     }
     
     try {
-        DBG("[M1MemoryShareTracker] Connecting to panner at: " + juce::String(panner.memoryFilePath));
-        
-        // Create M1MemoryShare instance with explicit file path
-        panner.memoryShare = std::make_unique<M1MemoryShare>(
-            panner.memorySegmentName, 
-            1024 * 1024, // 1MB default size
-            8,           // maxQueueSize
-            true,        // persistent
-            false,       // createMode = false (open existing)
-            panner.memoryFilePath  // Explicit file path (std::string)
-        );
+        // memfd segments arrive already mapped (see receiveAnnouncedSegments)
+        if (!panner.memoryShare) {
+            DBG("[M1MemoryShareTracker] Connecting to panner at: " + juce::String(panner.memoryFilePath));
+            
+            // Create M1MemoryShare instance with explicit file path
+            panner.memoryShare = std::make_unique<M1MemoryShare>(
+                panner.memorySegmentName, 
+                1024 * 1024, // 1MB default size
+                8,           // maxQueueSize
+                true,        // persistent
+                false,       // createMode = false (open existing)
+                panner.memoryFilePath  // Explicit file path (std::string)
+            );
+        }
         
-        if (panner.memoryShare->isValid()) {
-            // Register as consumer
-            if (panner.memoryShare->registerConsumer(consumerId)) {
+        if (panner.memoryShare->isValid() && panner.memoryShare->isFormatted()) {
+            // The tracker only samples the latest block. On ring segments a registered cursor
+            // would hold slots back from the producer, so it reads unregistered there.
+            bool isRing = panner.memoryShare->getLayoutVersion() == M1MemoryShare::LAYOUT_RING;
+            if (isRing || panner.memoryShare->registerConsumer(consumerId)) {
                 panner.isConnected = true;
                 panner.lastUpdateTime = juce::Time::currentTimeMillis();
                 DBG("[M1MemoryShareTracker] Successfully connected to panner: " + juce::String(panner.name));
@@ -196,8 +258,10 @@ bool M1MemoryShareTracker::connectToPanner(MemorySharePannerInfo& panner) {
 
 void M1MemoryShareTracker::disconnectFromPanner(MemorySharePannerInfo& panner) {
     if (panner.isConnected && panner.memoryShare) {
-        // Unregister as consumer
-        panner.memoryShare->unregisterConsumer(consumerId);
+        // Unregister as consumer (legacy segments only, see connectToPanner)
+        if (panner.memoryShare->getLayoutVersion() != M1MemoryShare::LAYOUT_RING) {
+            panner.memoryShare->unregisterConsumer(consumerId);
+        }
         panner.memoryShare.reset();
         panner.isConnected = false;
     }
@@ -209,8 +273,10 @@ bool M1MemoryShareTracker::updatePannerData(MemorySharePannerInfo& panner) {
     }
     
     try {
-        // Read latest audio buffer data
-        if (readAudioBufferData(panner)) {
+        // Prefer the parameter state page; only panners without one need the audio block
+        bool updated = panner.memoryShare->hasParameterState() ? readParameterState(panner)
+                                                               : readAudioBufferData(panner);
+        if (updated) {
             panner.lastUpdateTime = juce::Time::currentTimeMillis();
             panner.isActive = true;
             return true;
@@ -234,44 +300,87 @@ void M1MemoryShareTracker::extractParametersFromBuffer(MemorySharePannerInfo& pa
     // which read directly from panner.parameters
 }
 
-bool M1MemoryShareTracker::readAudioBufferData(MemorySharePannerInfo& panner) {
-    if (!panner.memoryShare || !panner.memoryShare->isValid()) {
-        return false;
+bool M1MemoryShareTracker::readParameterState(MemorySharePannerInfo& panner) {
+    // Nothing new since the last decode
+    uint32_t version = panner.memoryShare->getParameterStateVersion();
+    if (version == panner.parameterStateVersion) {
+        return true;
     }
     
-    // Try to read latest audio buffer with parameters
-    ParameterMap parameters;
-    juce::AudioBuffer<float> audioBuffer;
+    ParameterMap parameters = panner.parameters;
+    parameters.clearDirty();
     uint64_t dawTimestamp = 0;
     double playheadPosition = 0.0;
     bool isPlaying = false;
-    uint64_t bufferId = 0;
     uint32_t updateSource = 0;
+    if (!panner.memoryShare->readGenericParameters(parameters, dawTimestamp, playheadPosition, isPlaying, updateSource)) {
+        return false;
+    }
     
-    if (panner.memoryShare->readAudioBufferWithGenericParameters(
-            audioBuffer, parameters, dawTimestamp, playheadPosition, isPlaying, bufferId, updateSource)) {
-        
-        // Update panner info with latest data
-        panner.parameters = parameters;
-        panner.dawTimestamp = dawTimestamp;
-        panner.playheadPositionInSeconds = playheadPosition;
-        panner.isPlaying = isPlaying;
-        panner.currentBufferId = bufferId;
-        
-        // Update audio format info from the buffer
-        if (audioBuffer.getNumChannels() > 0) {
-            panner.channels = static_cast<uint32_t>(audioBuffer.getNumChannels());
-        }
-        if (audioBuffer.getNumSamples() > 0) {
-            panner.samplesPerBlock = static_cast<uint32_t>(audioBuffer.getNumSamples());
-        }
-        
-        // Extract display name and other parameters
-        extractParametersFromBuffer(panner);
-        return true;
+    panner.parameters = parameters;
+    panner.parameterStateVersion = version;
+    panner.dawTimestamp = dawTimestamp;
+    panner.playheadPositionInSeconds = playheadPosition;
+    panner.isPlaying = isPlaying;
+    
+    // Audio format comes from the segment header instead of the blocks
+    uint32_t sampleRate = 0, numChannels = 0, samplesPerBlock = 0;
+    if (panner.memoryShare->getAudioFormat(sampleRate, numChannels, samplesPerBlock)) {
+        if (sampleRate > 0) panner.sampleRate = sampleRate;
+        if (numChannels > 0) panner.channels = numChannels;
+        if (samplesPerBlock > 0) panner.samplesPerBlock = samplesPerBlock;
     }
     
-    return false;
+    extractParametersFromBuffer(panner);
+    return true;
+}
+
+bool M1MemoryShareTracker::readAudioBufferData(MemorySharePannerInfo& panner) {
+    if (!panner.memoryShare || !panner.memoryShare->isValid()) {
+        return false;
+    }
+    
+    // View the latest block in place; the tracker only needs its header and parameters
+    M1MemoryShare::AudioBlockView view;
+    if (!panner.memoryShare->acquireAudioBlockView(view)) {
+        return false;
+    }
+    
+    // Refill a copy of the previous values so the dirty mask reflects what changed since the last read
+    ParameterMap parameters = panner.parameters;
+    parameters.clearDirty();
+    M1MemoryShare::readParameters(view, parameters);
+    
+    uint64_t dawTimestamp = view.header->dawTimestamp;
+    double playheadPosition = view.header->playheadPositionInSeconds;
+    bool isPlaying = view.header->isPlaying != 0;
+    uint64_t bufferId = view.header->bufferId;
+    uint32_t numChannels = view.numChannels;
+    uint32_t numSamples = view.numSamples;
+    
+    // Discard the read if the panner overwrote the block meanwhile
+    if (!panner.memoryShare->releaseAudioBlockView(view)) {
+        return false;
+    }
+    
+    // Update panner info with latest data
+    panner.parameters = parameters;
+    panner.dawTimestamp = dawTimestamp;
+    panner.playheadPositionInSeconds = playheadPosition;
+    panner.isPlaying = isPlaying;
+    panner.currentBufferId = bufferId;
+    
+    // Update audio format info from the block
+    if (numChannels > 0) {
+        panner.channels = numChannels;
+    }
+    if (numSamples > 0) {
+        panner.samplesPerBlock = numSamples;
+    }
+    
+    // Extract display name and other parameters
+    extractParametersFromBuffer(panner);
+    return true;
 }
 
 bool M1MemoryShareTracker::registerAsConsumer(uint32_t consumerId) {
@@ -346,67 +455,34 @@ void M1MemoryShareTracker::scanForMemorySegments()
             if (filename.find("M1Panner") == std::string::npos)
                 continue;
 
-            // Parse segment name and details
+            // Known panners only need a refresh; the process and age checks are for new files
             std::string name;
             uint32_t processId = 0;
             uintptr_t memoryAddress = 0;
             uint64_t timestamp = 0;
-            
-            if (parsePannerSegmentName(filename, name, processId, memoryAddress, timestamp))
+            if (!parsePannerSegmentName(filename, name, processId, memoryAddress, timestamp))
+                continue;
+
+            auto existing = findPanner(processId, memoryAddress);
+            if (existing)
             {
-                // PRIMARY CHECK: Is the process still running?
-                // This is more reliable than file modification time
-                bool processAlive = isProcessRunning(processId);
-                
-                if (!processAlive)
-                    continue;
-                
-                // SECONDARY CHECK: File modification time (only as a sanity check for very old files)
-                auto fileModTime = file.getLastModificationTime().toMilliseconds();
-                auto currentTime = juce::Time::currentTimeMillis();
-                auto fileAge = currentTime - fileModTime;
+                // Update existing panner's last seen time
+                existing->lastUpdateTime = juce::Time::currentTimeMillis();
+                foundActiveFiles = true;
                 
-                // Only reject if file is VERY old (1 hour) AND process check passed
-                // This catches orphaned files from crashed processes
-                const int64_t MAX_FILE_AGE_MS = 3600000; // 1 hour
-                bool isValid = (fileAge < MAX_FILE_AGE_MS);
-                
-                if (!isValid)
-                    continue;
-
-                // Check if we already have this panner
-                auto existing = findPanner(processId, memoryAddress);
-                if (!existing)
-                {
-                    // Create new panner info
-                    MemorySharePannerInfo newPanner;
-                    newPanner.name = name;
-                    newPanner.processId = processId;
-                    newPanner.memoryAddress = memoryAddress;
-                    newPanner.creationTimestamp = timestamp;
-                    newPanner.memorySegmentName = filename;
-                    newPanner.memoryFilePath = file.getFullPathName().toStdString();  // Store full path!
-                    newPanner.isActive = true;
-
-                    // Try to connect
-                    if (connectToPanner(newPanner))
-                    {
-                        activePanners.emplace_back(std::move(newPanner));
-                        foundActiveFiles = true;
-                        DBG("[M1MemoryShareTracker] Connected to new panner: " + name + " (PID: " + std::to_string(processId) + ")");
-                    }
-                }
-                else
-                {
-                    // Update existing panner's last seen time
-                    existing->lastUpdateTime = currentTime;
-                    foundActiveFiles = true;
-                    
-                    // Also try to read latest data
-                    if (existing->isConnected) {
-                        updatePannerData(*existing);
-                    }
+                // Also try to read latest data
+                if (existing->isConnected) {
+                    updatePannerData(*existing);
                 }
+                continue;
+            }
+
+            MemorySharePannerInfo newPanner;
+            if (openPannerSegment(file, newPanner) == SegmentOpenResult::Connected)
+            {
+                DBG("[M1MemoryShareTracker] Connected to new panner: " + newPanner.name + " (PID: " + std::to_string(newPanner.processId) + ")");
+                activePanners.emplace_back(std::move(newPanner));
+                foundActiveFiles = true;
             }
         }
         
@@ -416,9 +492,214 @@ void M1MemoryShareTracker::scanForMemorySegments()
             break;
         }
     }
+}
+
+M1MemoryShareTracker::SegmentOpenResult M1MemoryShareTracker::openPannerSegment(const juce::File& file, MemorySharePannerInfo& panner)
+{
+    std::string filename = file.getFileNameWithoutExtension().toStdString();
+    if (filename.find("M1Panner") == std::string::npos)
+        return SegmentOpenResult::Rejected;
+
+    // Parse segment name and details
+    std::string name;
+    uint32_t processId = 0;
+    uintptr_t memoryAddress = 0;
+    uint64_t timestamp = 0;
+    if (!parsePannerSegmentName(filename, name, processId, memoryAddress, timestamp))
+        return SegmentOpenResult::Rejected;
+
+    // PRIMARY CHECK: Is the process still running?
+    // This is more reliable than file modification time
+    if (!isProcessRunning(processId))
+        return SegmentOpenResult::Rejected;
+
+    // SECONDARY CHECK: File modification time (only as a sanity check for very old files)
+    // Only reject if file is VERY old (1 hour) AND process check passed
+    // This catches orphaned files from crashed processes
+    const int64_t MAX_FILE_AGE_MS = 3600000; // 1 hour
+    auto fileAge = juce::Time::currentTimeMillis() - file.getLastModificationTime().toMilliseconds();
+    if (fileAge >= MAX_FILE_AGE_MS)
+        return SegmentOpenResult::Rejected;
+
+    panner.name = name;
+    panner.processId = processId;
+    panner.memoryAddress = memoryAddress;
+    panner.creationTimestamp = timestamp;
+    panner.memorySegmentName = filename;
+    panner.memoryFilePath = file.getFullPathName().toStdString();  // Store full path!
+    panner.isActive = true;
+
+    // A file that was just created may not be formatted yet; the caller retries
+    if (!connectToPanner(panner))
+    {
+        panner.memoryShare.reset();
+        return SegmentOpenResult::NotReady;
+    }
+    return SegmentOpenResult::Connected;
+}
+
+void M1MemoryShareTracker::runDirectoryWatcher()
+{
+    struct PendingFile {
+        std::string path;
+        juce::int64 firstSeen;
+    };
+
+    std::vector<M1MemoryShareDirectoryWatcher::Event> events;
+    std::vector<PendingFile> pending;
+    std::vector<std::string> connectedPaths;
+
+    while (!watcherShouldStop)
+    {
+        // Block until something happens; poll at 1 ms while a producer is still formatting its file
+        // (it writes the header through its mapping, which raises no event)
+        events.clear();
+        directoryWatcher.wait(pending.empty() ? -1 : 1, events);
+        bool handedOver = false;
+
+        for (const auto& event : events)
+        {
+            if (event.type == M1MemoryShareDirectoryWatcher::Event::RESCAN)
+            {
+                rescanRequested = true;
+                handedOver = true;
+                continue;
+            }
+
+            std::string path = juce::File(event.path).getFullPathName().toStdString();
+            auto isPath = [&path](const PendingFile& file) { return file.path == path; };
+
+            if (event.type == M1MemoryShareDirectoryWatcher::Event::REMOVED)
+            {
+                pending.erase(std::remove_if(pending.begin(), pending.end(), isPath), pending.end());
+                connectedPaths.erase(std::remove(connectedPaths.begin(), connectedPaths.end(), path), connectedPaths.end());
+
+                const juce::ScopedLock lock(pannersMutex);
+                removedSegmentPaths.push_back(path);
+                handedOver = true;
+            }
+            else if (std::find(connectedPaths.begin(), connectedPaths.end(), path) == connectedPaths.end()
+                     && std::none_of(pending.begin(), pending.end(), isPath))
+            {
+                pending.push_back({ path, juce::Time::currentTimeMillis() });
+            }
+        }
+
+        auto now = juce::Time::currentTimeMillis();
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            MemorySharePannerInfo panner;
+            auto result = openPannerSegment(juce::File(it->path), panner);
+
+            if (result == SegmentOpenResult::Connected)
+            {
+                DBG("[M1MemoryShareTracker] Connected to new panner: " + panner.name + " (PID: " + std::to_string(panner.processId) + ")");
+                connectedPaths.push_back(it->path);
+
+                const juce::ScopedLock lock(pannersMutex);
+                discoveredPanners.emplace_back(std::move(panner));
+                handedOver = true;
+            }
+            else if (result == SegmentOpenResult::NotReady && now - it->firstSeen < PENDING_CONNECT_TIMEOUT_MS)
+            {
+                ++it;
+                continue;
+            }
+            else if (result == SegmentOpenResult::NotReady)
+            {
+                DBG("[M1MemoryShareTracker] Gave up on unformatted segment: " + juce::String(it->path));
+            }
+            it = pending.erase(it);
+        }
+
+        // update() takes them in; have it run now rather than on its next tick
+        if (handedOver && onWatcherResults)
+            onWatcherResults();
+    }
+}
+
+void M1MemoryShareTracker::mergeWatcherResults()
+{
+    std::vector<MemorySharePannerInfo> discovered;
+    std::vector<std::string> removed;
+    {
+        const juce::ScopedLock lock(pannersMutex);
+        discovered.swap(discoveredPanners);
+        removed.swap(removedSegmentPaths);
+    }
+
+    for (auto& panner : discovered)
+    {
+        // The initial or a recovery scan may have connected it already; keep that connection
+        // and its consumer registration
+        if (findPanner(panner.processId, panner.memoryAddress))
+        {
+            panner.memoryShare.reset();
+            continue;
+        }
+        activePanners.emplace_back(std::move(panner));
+    }
+
+    // A deleted file means the panner went away
+    for (const auto& path : removed)
+    {
+        auto it = std::find_if(activePanners.begin(), activePanners.end(),
+                               [&path](const MemorySharePannerInfo& panner) { return panner.memoryFilePath == path; });
+        if (it != activePanners.end())
+        {
+            DBG("[M1MemoryShareTracker] Removing panner: " + juce::String(it->name) + " (file deleted)");
+            disconnectFromPanner(*it);
+            activePanners.erase(it);
+        }
+    }
+}
+
+void M1MemoryShareTracker::receiveAnnouncedSegments() {
+#if defined(M1_MEMORYSHARE_FD_TRANSPORT)
+    std::vector<M1MemoryShareFdTransport::ReceivedSegment> received;
+    std::vector<int> closed;
+    segmentListener.poll(0, received, closed);
+    
+    // The producer closing its connection means the segment is gone (handled first:
+    // the listener may already have reused the descriptor number for a new connection)
+    for (int connection : closed) {
+        auto it = std::find_if(activePanners.begin(), activePanners.end(),
+                               [connection](const MemorySharePannerInfo& panner) { return panner.transportConnection == connection; });
+        if (it != activePanners.end()) {
+            DBG("[M1MemoryShareTracker] Removing panner: " + juce::String(it->name) + " (transport closed)");
+            disconnectFromPanner(*it);
+            activePanners.erase(it);
+        }
+    }
     
-    // Cleanup old/stale files after scanning
-    cleanupStaleMemoryFiles();
+    for (auto& segment : received) {
+        const auto& announcement = segment.announcement;
+        
+        // A panner that publishes both ways keeps its first connection: don't map or register again
+        if (findPanner(segment.processId, static_cast<uintptr_t>(announcement.memoryAddress))) {
+            close(segment.fd);
+            continue;
+        }
+        
+        MemorySharePannerInfo newPanner;
+        newPanner.name = "M1-Panner (PID " + std::to_string(segment.processId) + ")";
+        newPanner.processId = segment.processId;
+        newPanner.memoryAddress = static_cast<uintptr_t>(announcement.memoryAddress);
+        newPanner.creationTimestamp = announcement.creationTimestamp;
+        newPanner.memorySegmentName = announcement.name;
+        newPanner.transportConnection = segment.connection;
+        newPanner.memoryShare = M1MemoryShare::openFileDescriptor(segment.fd, newPanner.memorySegmentName);
+        newPanner.isActive = true;
+        
+        if (!newPanner.memoryShare || !connectToPanner(newPanner)) {
+            DBG("[M1MemoryShareTracker] Failed to map announced segment: " + juce::String(newPanner.memorySegmentName));
+            continue;
+        }
+        
+        DBG("[M1MemoryShareTracker] Connected to announced panner: " + juce::String(newPanner.memorySegmentName) + " (PID: " + std::to_string(newPanner.processId) + ")");
+        activePanners.emplace_back(std::move(newPanner));
+    }
+#endif
 }
 
 bool M1MemoryShareTracker::parsePannerSegmentName(const std::string& filename,
@@ -4,7 +4,10 @@
     Tracks M1-Panner plugin instances using M1MemoryShare (direct shared memory access).
     
     Logic Flow:
-    1. Scan filesystem for M1MemoryShare files created by M1-Panner plugins
+    1. Discover M1MemoryShare files created by M1-Panner plugins: a watcher thread reacts
+       to files appearing/disappearing (inotify on Linux) and wakes update() through
+       onWatcherResults; other platforms scan at 4 Hz
+       (on Linux, panners may instead hand over a memfd segment through the fd transport)
     2. Connect to each found memory segment as a consumer
     3. Extract panner parameters and audio data from shared memory
     4. Provide real-time updates with buffer acknowledgment
@@ -16,10 +19,14 @@
 
 #include "../Common/Common.h"
 #include "../Common/M1MemoryShare.h"
+#include "../Common/M1MemoryShareDirectoryWatcher.h"
 #include "../Common/TypesForDataExchange.h"
 #include <vector>
 #include <memory>
 #include <string>
+#include <atomic>
+#include <functional>
+#include <thread>
 
 namespace Mach1 {
 
@@ -36,6 +43,7 @@ struct MemorySharePannerInfo {
     // Connection
     std::string memorySegmentName;
     std::string memoryFilePath;  // Full file path for direct opening
+    int transportConnection = -1;  // Fd transport connection for memfd segments (-1 = file-backed)
     std::unique_ptr<M1MemoryShare> memoryShare;
     bool isConnected = false;
     
@@ -53,6 +61,7 @@ struct MemorySharePannerInfo {
     
     // Panner parameters from memory
     ParameterMap parameters;
+    uint32_t parameterStateVersion = 0;  // State page version last decoded (0 = read from audio blocks)
     
     // Buffer tracking
     uint32_t queuedBufferCount = 0;
@@ -114,6 +123,11 @@ public:
     void stop();
     void update();  // Call regularly to scan for new panners and update existing ones
     
+    // Called on the directory watcher thread when it has connected new panners or seen
+    // segment files go: call update() soon, from the thread that normally calls it, so
+    // they show up without waiting for the next tick. Set before start().
+    std::function<void()> onWatcherResults;
+    
     // Panner discovery and access
     const std::vector<MemorySharePannerInfo>& getActivePanners() const;
     MemorySharePannerInfo* findPanner(uint32_t processId, uintptr_t memoryAddress = 0);
@@ -142,6 +156,13 @@ private:
     void updateExistingPanners();
     void cleanupInactivePanners();
     void cleanupStaleMemoryFiles();
+    void receiveAnnouncedSegments();
+    
+    // Event-driven discovery (see M1MemoryShareDirectoryWatcher)
+    enum class SegmentOpenResult { Connected, NotReady, Rejected };
+    SegmentOpenResult openPannerSegment(const juce::File& file, MemorySharePannerInfo& panner);
+    void runDirectoryWatcher();
+    void mergeWatcherResults();
     bool isProcessRunning(uint32_t processId);
     
     // Memory segment management
@@ -159,6 +180,7 @@ private:
     
     // Parameter extraction
     void extractParametersFromBuffer(MemorySharePannerInfo& panner);
+    bool readParameterState(MemorySharePannerInfo& panner);
     bool readAudioBufferData(MemorySharePannerInfo& panner);
     
     // File system scanning
@@ -174,9 +196,25 @@ private:
     bool isRunning = false;
     bool initialized = false;
     
+    // Directory watcher thread; hands connected panners and removed files to update()
+    M1MemoryShareDirectoryWatcher directoryWatcher;
+    std::thread watcherThread;
+    std::atomic<bool> watcherShouldStop{false};
+    std::atomic<bool> rescanRequested{false};
+    std::vector<MemorySharePannerInfo> discoveredPanners;  // Guarded by pannersMutex
+    std::vector<std::string> removedSegmentPaths;          // Guarded by pannersMutex
+    
+#if defined(M1_MEMORYSHARE_FD_TRANSPORT)
+    // Receives memfd segments announced by panners; hang-ups remove them immediately
+    M1MemoryShareFdTransport::Listener segmentListener;
+#endif
+    
     // Timing
     juce::int64 lastScanTime = 0;
-    static constexpr int SCAN_INTERVAL_MS = 250;     // Scan for new panners at 4 Hz
+    juce::int64 lastCleanupTime = 0;
+    static constexpr int SCAN_INTERVAL_MS = 250;     // Scan for new panners at 4 Hz (polling fallback only)
+    static constexpr int PENDING_CONNECT_TIMEOUT_MS = 5000;  // Give up on a new file its producer never formats
+    static constexpr int STALE_FILE_CLEANUP_INTERVAL_MS = 60000;
     static constexpr int UPDATE_INTERVAL_MS = 100;   // Update existing panners every 100ms
     static constexpr int PANNER_TIMEOUT_MS = 30000;  // Consider inactive after 30 seconds (process-based check is more reliable)
     
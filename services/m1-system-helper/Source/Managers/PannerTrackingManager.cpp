@@ -26,12 +26,10 @@
 
 namespace Mach1 {
 
-namespace
+int PannerTrackingManager::resolvePannerMode(const ParameterMap& parameters)
 {
-int resolveMemorySharePannerMode(const MemorySharePannerInfo& info)
-{
-    const bool isotropic = info.parameters.getBool(M1SystemHelperParameterIDs::ISOTROPIC_MODE, true);
-    const bool equalpower = info.parameters.getBool(M1SystemHelperParameterIDs::EQUALPOWER_MODE, false);
+    const bool isotropic = parameters.getBool(M1SystemHelperParameterIDs::ISOTROPIC_MODE, true);
+    const bool equalpower = parameters.getBool(M1SystemHelperParameterIDs::EQUALPOWER_MODE, false);
 
     if (equalpower)
         return static_cast<int>(Mach1EncodePannerMode::IsotropicEqualPower);
@@ -41,7 +39,6 @@ int resolveMemorySharePannerMode(const MemorySharePannerInfo& info)
 
     return static_cast<int>(Mach1EncodePannerMode::PeriphonicLinear);
 }
-}
 
 PannerTrackingManager::PannerTrackingManager(std::shared_ptr<EventSystem> events)
     : eventSystem(std::move(events))
@@ -49,6 +46,11 @@ PannerTrackingManager::PannerTrackingManager(std::shared_ptr<EventSystem> events
 {
     // Initialize tracking components
     memoryShareTracker = std::make_unique<M1MemoryShareTracker>(CONSUMER_ID);
+    memoryShareTracker->onWatcherResults = [this] {
+        scanRequested = true;
+        if (onScanRequested)
+            onScanRequested();
+    };
     // Note: OSC tracker will be initialized when pluginManager is available
     
     DBG("[PannerTrackingManager] Created with consumer ID: " + std::to_string(CONSUMER_ID));
@@ -122,8 +124,8 @@ void PannerTrackingManager::update() {
     
     auto currentTime = juce::Time::currentTimeMillis();
     
-    // Scan for panners at regular intervals
-    if (currentTime - lastScanTime >= SCAN_INTERVAL_MS) {
+    // Scan for panners at regular intervals, or at once when a tracker has new ones
+    if (scanRequested.exchange(false) || currentTime - lastScanTime >= SCAN_INTERVAL_MS) {
         scanForPanners();
         lastScanTime = currentTime;
     }
@@ -264,6 +266,7 @@ void PannerTrackingManager::mergeTrackingResults() {
                 existingPanner.inputMode = foundPanner.inputMode;
                 existingPanner.outputMode = foundPanner.outputMode;
                 existingPanner.pannerMode = foundPanner.pannerMode;
+                existingPanner.gainCompensation = foundPanner.gainCompensation;
                 existingPanner.autoOrbit = foundPanner.autoOrbit;
                 existingPanner.state = foundPanner.state;
                 existingPanner.color = foundPanner.color;
@@ -482,7 +485,9 @@ PannerInfo PannerTrackingManager::convertFromMemoryShare(const MemorySharePanner
     // Modes
     panner.inputMode = info.getInputMode();
     panner.outputMode = info.getOutputMode();
-    panner.pannerMode = resolveMemorySharePannerMode(info);
+    panner.pannerMode = resolvePannerMode(info.parameters);
+    if (info.parameters.contains(M1SystemHelperParameterIDs::GAIN_COMPENSATION_MODE, ParameterType::BOOL))
+        panner.gainCompensation = info.parameters.getBool(M1SystemHelperParameterIDs::GAIN_COMPENSATION_MODE) ? 1 : 0;
     panner.autoOrbit = info.getAutoOrbit();
     panner.state = info.getState();
     
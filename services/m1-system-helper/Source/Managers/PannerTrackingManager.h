@@ -19,6 +19,8 @@
 #include "../Core/EventSystem.h"
 #include "M1MemoryShareTracker.h"
 #include "OSCPannerTracker.h"
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -82,6 +84,7 @@ struct PannerInfo {
     int inputMode = 0;
     int outputMode = 0;
     int pannerMode = 0;
+    int gainCompensation = -1;  // GAIN_COMPENSATION_MODE: -1 = not reported, 0/1 = off/on
     
     bool operator==(const PannerInfo& other) const {
         return port == other.port && processId == other.processId;
@@ -105,6 +108,11 @@ public:
     void stop();
     void update();  // Call regularly to scan for panners
     
+    // Called from a tracker's thread when it has panners for update() (see
+    // M1MemoryShareTracker::onWatcherResults): the next update() scans at once, so call
+    // it soon from the thread that normally does. Set before start().
+    std::function<void()> onScanRequested;
+    
     // Panner discovery and access
     std::vector<PannerInfo> getActivePanners() const;
     PannerInfo* findPanner(int port, uint32_t processId = 0);
@@ -138,6 +146,9 @@ public:
     // Testing: inject fake panners (used by FakePannerSimulator)
     void injectFakePanners(const std::vector<PannerInfo>& panners);
     
+    // Mach1EncodePannerMode a panner's ISOTROPIC_MODE / EQUALPOWER_MODE parameters select
+    static int resolvePannerMode(const ParameterMap& parameters);
+    
     // Statistics
     struct TrackingStats {
         uint32_t memorySharePanners = 0;
@@ -194,6 +205,7 @@ private:
     bool isProcessRunning(uint32_t processId) const;
     
     juce::int64 lastScanTime = 0;
+    std::atomic<bool> scanRequested{false};     // Set by onWatcherResults, on the watcher thread
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PannerTrackingManager)
 };
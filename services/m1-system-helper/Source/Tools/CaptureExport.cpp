@@ -0,0 +1,263 @@
+/*
+    CaptureExport.cpp
+    -----------------
+    m1-capture-export: exports a captured session to WAV/BWF stems from the command line,
+    with the same SessionExporter the helper's EXPORT button uses, re-renders it
+    through the Mach1 encode/decode chain with OfflineRenderer (--render), or repairs
+    sessions left behind by a crash with SessionRecovery (--recover).
+
+    Usage: m1-capture-export <session dir> <output dir> [--threads N] [--bits 16|24|32]
+                             [--block FRAMES] [--no-bwf] [--sealed]
+           m1-capture-export --render 4|8|14 <session dir> <output file> [--stereo]
+                             [--yaw DEG] [--pitch DEG] [--roll DEG] [--threads N]
+                             [--bits 16|24|32] [--block FRAMES] [--no-bwf] [--sealed]
+           m1-capture-export --recover <session dir> [<session dir> ...] [--threads N]
+                             [--dry-run]
+
+    --sealed reads only the chunk file segments capture has finished with, so a session
+    can be exported while it is still being captured. --recover must not be run on a
+    session that is being captured; --dry-run only reports what it would repair.
+*/
+
+#include <JuceHeader.h>
+#include "../Core/SessionExporter.h"
+#include "../Core/OfflineRenderer.h"
+#include "../Core/SessionRecovery.h"
+#include <iostream>
+#include <iomanip>
+
+static int renderSession(const juce::StringArray& args)
+{
+    juce::StringArray paths;
+    Mach1::OfflineRenderer::Options options;
+    for (int i = 0; i < args.size(); ++i)
+    {
+        if (args[i] == "--render" && i + 1 < args.size())
+            options.bedChannels = args[++i].getIntValue();
+        else if (args[i] == "--stereo")
+            options.output = Mach1::OfflineRenderer::Output::Stereo;
+        else if (args[i] == "--yaw" && i + 1 < args.size())
+            options.yaw = args[++i].getFloatValue();
+        else if (args[i] == "--pitch" && i + 1 < args.size())
+            options.pitch = args[++i].getFloatValue();
+        else if (args[i] == "--roll" && i + 1 < args.size())
+            options.roll = args[++i].getFloatValue();
+        else if (args[i] == "--threads" && i + 1 < args.size())
+            options.numThreads = args[++i].getIntValue();
+        else if (args[i] == "--bits" && i + 1 < args.size())
+            options.bitsPerSample = args[++i].getIntValue();
+        else if (args[i] == "--block" && i + 1 < args.size())
+            options.blockSize = args[++i].getIntValue();
+        else if (args[i] == "--no-bwf")
+            options.broadcastWave = false;
+        else if (args[i] == "--sealed")
+            options.sealedSegmentsOnly = true;
+        else
+            paths.add(args[i]);
+    }
+
+    if (paths.size() != 2 || Mach1::OfflineRenderer::getOutputChannelCount(options) == 0
+        || (options.bitsPerSample != 16 && options.bitsPerSample != 24 && options.bitsPerSample != 32))
+    {
+        std::cerr << "Usage: m1-capture-export --render 4|8|14 <session dir> <output file> [--stereo]"
+                     " [--yaw DEG] [--pitch DEG] [--roll DEG] [--threads N] [--bits 16|24|32]"
+                     " [--block FRAMES] [--no-bwf] [--sealed]\n";
+        return 2;
+    }
+
+    const juce::File sessionDir = juce::File::getCurrentWorkingDirectory().getChildFile(paths[0]);
+    const juce::File outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(paths[1]);
+    if (!sessionDir.isDirectory())
+    {
+        std::cerr << "Not a capture session folder: " << sessionDir.getFullPathName() << "\n";
+        return 1;
+    }
+
+    options.onProgress = [](double progress) {
+        std::cerr << "\rRendering " << std::setw(3) << static_cast<int>(progress * 100.0) << "%" << std::flush;
+    };
+
+    Mach1::OfflineRenderer renderer(options);
+    const auto result = renderer.renderSession(sessionDir, outputFile);
+    std::cerr << "\n";
+
+    if (!result.rendered)
+    {
+        std::cout << "FAILED " << result.error << "\n";
+        return 1;
+    }
+
+    std::cout << result.outputFile.getFullPathName() << ": " << result.numChannels << " ch, "
+              << result.sampleRate << " Hz, " << result.pannersRendered << " panners, "
+              << result.chunksRead << " chunks";
+    if (result.pannersSkipped > 0)
+        std::cout << ", " << result.pannersSkipped << " panners skipped";
+    if (result.chunksSkipped > 0)
+        std::cout << ", " << result.chunksSkipped << " chunks skipped";
+    std::cout << "\n";
+
+    std::cout << "Samples " << result.startSample << " - " << result.endSample << ", " << std::fixed
+              << std::setprecision(2) << result.elapsedSeconds << " s (" << std::setprecision(1)
+              << result.getRealtimeFactor() << "x realtime)\n";
+    return 0;
+}
+
+static int recoverSessions(const juce::StringArray& args)
+{
+    juce::Array<juce::File> sessionDirs;
+    Mach1::CoverageModel coverage;
+    Mach1::SessionRecovery::Options options;
+    options.coverage = &coverage;
+    for (int i = 0; i < args.size(); ++i)
+    {
+        if (args[i] == "--recover")
+            continue;
+        else if (args[i] == "--threads" && i + 1 < args.size())
+            options.numThreads = args[++i].getIntValue();
+        else if (args[i] == "--dry-run")
+            options.dryRun = true;
+        else
+            sessionDirs.add(juce::File::getCurrentWorkingDirectory().getChildFile(args[i]));
+    }
+
+    if (sessionDirs.isEmpty())
+    {
+        std::cerr << "Usage: m1-capture-export --recover <session dir> [<session dir> ...] [--threads N] [--dry-run]\n";
+        return 2;
+    }
+
+    for (const auto& sessionDir : sessionDirs)
+    {
+        if (!sessionDir.isDirectory())
+        {
+            std::cerr << "Not a capture session folder: " << sessionDir.getFullPathName() << "\n";
+            return 1;
+        }
+    }
+
+    options.onProgress = [](double progress) {
+        std::cerr << "\rScanning " << std::setw(3) << static_cast<int>(progress * 100.0) << "%" << std::flush;
+    };
+
+    Mach1::SessionRecovery recovery(options);
+    const auto result = recovery.recover(sessionDirs);
+    std::cerr << "\n";
+
+    const char* repaired = options.dryRun ? "to repair" : "repaired";
+    for (const auto& segment : result.segments)
+    {
+        if (segment.error.isNotEmpty())
+        {
+            std::cout << segment.file.getFullPathName() << ": FAILED " << segment.error << "\n";
+            continue;
+        }
+        if (!segment.wasDamaged())
+            continue;
+
+        std::cout << segment.file.getFullPathName() << ": " << segment.chunks << " intact chunks";
+        if (segment.corruptRegions > 0)
+            std::cout << ", " << segment.corruptRegions << " corrupt regions skipped";
+        if (segment.truncatedBytes > 0)
+            std::cout << ", " << segment.truncatedBytes << " byte torn tail " << repaired;
+        if (segment.stateTruncatedBytes > 0)
+            std::cout << ", state stream " << repaired;
+        if (segment.indexRewritten)
+            std::cout << ", index " << repaired;
+        std::cout << "\n";
+    }
+
+    for (const auto& pannerId : coverage.getPannerIds())
+    {
+        if (const auto* pannerCoverage = coverage.getPannerCoverage(pannerId))
+        {
+            std::cout << pannerId.sessionId << "/" << pannerId.instanceUuid << "_" << pannerId.processId << ": "
+                      << std::fixed << std::setprecision(2) << pannerCoverage->getCapturedDurationSeconds() << " s captured, "
+                      << std::setprecision(1) << pannerCoverage->getCoveragePercent() << "% coverage, "
+                      << pannerCoverage->dropouts.size() << " dropouts\n";
+        }
+    }
+
+    std::cout << result.sessions << " sessions, " << result.panners << " panners, " << result.segments.size()
+              << " segments, " << result.chunks << " chunks, " << result.getNumDamagedSegments() << " segments "
+              << repaired << ", " << std::fixed << std::setprecision(2) << result.elapsedSeconds << " s ("
+              << std::setprecision(0) << result.getScanRate() / (1024.0 * 1024.0) << " MB/s)\n";
+
+    return result.wasSuccessful() ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(juce::String::fromUTF8(argv[i]));
+
+    if (args.contains("--render"))
+        return renderSession(args);
+
+    if (args.contains("--recover"))
+        return recoverSessions(args);
+
+    juce::StringArray paths;
+    Mach1::SessionExporter::Options options;
+    for (int i = 0; i < args.size(); ++i)
+    {
+        if (args[i] == "--threads" && i + 1 < args.size())
+            options.numThreads = args[++i].getIntValue();
+        else if (args[i] == "--bits" && i + 1 < args.size())
+            options.bitsPerSample = args[++i].getIntValue();
+        else if (args[i] == "--block" && i + 1 < args.size())
+            options.blockSize = args[++i].getIntValue();
+        else if (args[i] == "--no-bwf")
+            options.broadcastWave = false;
+        else if (args[i] == "--sealed")
+            options.sealedSegmentsOnly = true;
+        else
+            paths.add(args[i]);
+    }
+
+    if (paths.size() != 2 || (options.bitsPerSample != 16 && options.bitsPerSample != 24 && options.bitsPerSample != 32))
+    {
+        std::cerr << "Usage: m1-capture-export <session dir> <output dir> [--threads N] [--bits 16|24|32]"
+                     " [--block FRAMES] [--no-bwf] [--sealed]\n";
+        return 2;
+    }
+
+    const juce::File sessionDir = juce::File::getCurrentWorkingDirectory().getChildFile(paths[0]);
+    const juce::File outputDir = juce::File::getCurrentWorkingDirectory().getChildFile(paths[1]);
+    if (!sessionDir.isDirectory())
+    {
+        std::cerr << "Not a capture session folder: " << sessionDir.getFullPathName() << "\n";
+        return 1;
+    }
+
+    options.onProgress = [](double progress) {
+        std::cerr << "\rExporting " << std::setw(3) << static_cast<int>(progress * 100.0) << "%" << std::flush;
+    };
+
+    Mach1::SessionExporter exporter(options);
+    const auto result = exporter.exportSession(sessionDir, outputDir);
+    std::cerr << "\n";
+
+    for (const auto& stem : result.stems)
+    {
+        if (stem.exported)
+        {
+            std::cout << stem.outputFile.getFullPathName() << ": " << stem.numChannels << " ch, "
+                      << stem.sampleRate << " Hz, " << stem.chunksRead << " chunks, "
+                      << stem.silentSamples << " silent samples";
+            if (stem.chunksSkipped > 0)
+                std::cout << ", " << stem.chunksSkipped << " chunks skipped";
+            std::cout << "\n";
+        }
+        else
+        {
+            std::cout << stem.pannerName << ": FAILED " << stem.error << "\n";
+        }
+    }
+
+    std::cout << result.stems.size() << " stems, samples " << result.startSample << " - " << result.endSample
+              << ", " << std::fixed << std::setprecision(2) << result.elapsedSeconds << " s ("
+              << std::setprecision(1) << result.getRealtimeFactor() << "x realtime)\n";
+
+    return result.wasSuccessful() ? 0 : 1;
+}
@@ -56,9 +56,6 @@ CaptureTimelinePanel::CaptureTimelinePanel()
     m_exportButton->setColour(juce::TextButton::buttonColourId, m_buttonColour);
     m_exportButton->setColour(juce::TextButton::textColourOffId, m_textColour);
     m_exportButton->onClick = [this]() {
-        // TODO: Implement export dialog
-        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon,
-            "Export", "Export functionality is not yet implemented.\nCaptured chunks are stored in the capture directory.");
         if (onExportClicked)
             onExportClicked();
     };
@@ -306,6 +303,14 @@ void CaptureTimelinePanel::drawTimeline(juce::Graphics& g)
     g.setColour(m_rulerColour);
     g.drawRect(m_timelineBounds);
     
+    // The view moved or was resized since the columns were taken
+    if (m_engine && (m_cachedData.columnsViewStart != m_viewStartSample || m_cachedData.columnsViewEnd != m_viewEndSample
+                     || m_cachedData.columns.size() != static_cast<size_t>(m_timelineBounds.getWidth())))
+    {
+        if (auto coverage = m_engine->getCoverageModel().getSnapshot())
+            updateColumns(*coverage);
+    }
+    
     // Draw coverage and dropouts
     drawCoverageIntervals(g);
     drawDropouts(g);
@@ -314,7 +319,7 @@ void CaptureTimelinePanel::drawTimeline(juce::Graphics& g)
     // Draw placeholder if no data
     if (m_cacheMutex.tryEnter())
     {
-        if (m_cachedData.coverageIntervals.empty())
+        if (m_cachedData.stats.totalCapturedSamples == 0)
         {
             g.setColour(m_textColour.withAlpha(0.5f));
             g.setFont(juce::Font(14.0f));
@@ -329,18 +334,17 @@ void CaptureTimelinePanel::drawCoverageIntervals(juce::Graphics& g)
     // Use try-lock to avoid blocking paint on slow cache updates
     if (m_cacheMutex.tryEnter())
     {
-        g.setColour(m_coverageColour);
-        
-        for (const auto& interval : m_cachedData.coverageIntervals)
+        // One column per pixel, shaded by how much of it was captured
+        for (const auto& column : m_cachedData.columns)
         {
-            int x1 = sampleToPixel(interval.start);
-            int x2 = sampleToPixel(interval.end);
+            if (column.coveredSamples <= 0)
+                continue;
             
-            if (x2 > m_timelineBounds.getX() && x1 < m_timelineBounds.getRight())
+            int x1 = std::max(sampleToPixel(column.start), m_timelineBounds.getX());
+            int x2 = std::min(sampleToPixel(column.end), m_timelineBounds.getRight());
+            if (x2 > x1)
             {
-                x1 = std::max(x1, m_timelineBounds.getX());
-                x2 = std::min(x2, m_timelineBounds.getRight());
-                
+                g.setColour(m_coverageColour.withMultipliedAlpha(0.35f + 0.65f * column.getCoveredFraction()));
                 g.fillRect(x1, m_timelineBounds.getY() + 4, x2 - x1, m_timelineBounds.getHeight() - 8);
             }
         }
@@ -355,41 +359,37 @@ void CaptureTimelinePanel::drawDropouts(juce::Graphics& g)
     if (!m_cacheMutex.tryEnter())
         return;
     
-    // Draw partial dropouts (some panners missing)
-    g.setColour(m_partialDropoutColour.withAlpha(0.6f));
-    for (const auto& dropout : m_cachedData.anyDropouts)
+    bool previousDropout = false;
+    for (const auto& column : m_cachedData.columns)
     {
-        int x1 = sampleToPixel(dropout.start);
-        int x2 = sampleToPixel(dropout.end);
-        
-        if (x2 > m_timelineBounds.getX() && x1 < m_timelineBounds.getRight())
+        int x1 = std::max(sampleToPixel(column.start), m_timelineBounds.getX());
+        int x2 = std::min(sampleToPixel(column.end), m_timelineBounds.getRight());
+        if (x2 <= x1)
         {
-            x1 = std::max(x1, m_timelineBounds.getX());
-            x2 = std::min(x2, m_timelineBounds.getRight());
-            
-            // Draw hash pattern for partial dropout
-            for (int x = x1; x < x2; x += 4)
-            {
-                g.drawLine((float)x, (float)m_timelineBounds.getY() + 4,
-                          (float)x, (float)m_timelineBounds.getBottom() - 4, 1.0f);
-            }
+            previousDropout = false;
+            continue;
         }
-    }
-    
-    // Draw total dropouts (all panners missing)
-    g.setColour(m_totalDropoutColour);
-    for (const auto& dropout : m_cachedData.allDropouts)
-    {
-        int x1 = sampleToPixel(dropout.start);
-        int x2 = sampleToPixel(dropout.end);
         
-        if (x2 > m_timelineBounds.getX() && x1 < m_timelineBounds.getRight())
+        // Total dropouts (all panners missing), stronger the less was captured
+        if (column.gap)
         {
-            x1 = std::max(x1, m_timelineBounds.getX());
-            x2 = std::min(x2, m_timelineBounds.getRight());
-            
+            g.setColour(m_totalDropoutColour.withMultipliedAlpha(std::max(0.35f, 1.0f - column.getCoveredFraction())));
             g.fillRect(x1, m_timelineBounds.getY() + 4, x2 - x1, m_timelineBounds.getHeight() - 8);
         }
+        
+        // Partial dropouts (some panners missing): hash pattern, starting at each dropout
+        if (column.dropout)
+        {
+            g.setColour(m_partialDropoutColour.withAlpha(0.6f));
+            for (int x = x1; x < x2; ++x)
+            {
+                if (!previousDropout || (x - m_timelineBounds.getX()) % 4 == 0)
+                    g.drawLine((float)x, (float)m_timelineBounds.getY() + 4,
+                              (float)x, (float)m_timelineBounds.getBottom() - 4, 1.0f);
+                previousDropout = true;
+            }
+        }
+        previousDropout = column.dropout;
     }
     
     m_cacheMutex.exit();
@@ -618,27 +618,38 @@ void CaptureTimelinePanel::updateCache()
     
     auto& coverageModel = m_engine->getCoverageModel();
     
-    // Get lightweight stats first (fast, minimal locking)
-    auto stats = coverageModel.getGlobalStats();
+    // Latest published coverage: taking it never blocks capture
+    auto coverage = coverageModel.getSnapshot();
+    if (coverage == nullptr)
+        return;
+    
     auto latestSample = coverageModel.getLatestSamplePosition();
     auto sampleRate = coverageModel.getSampleRate();
     bool capturing = m_engine->isCapturing();
     
-    // Get coverage intervals (this may take longer)
-    auto anyCoverage = coverageModel.getAnyCoverage();
-    
     // Now update the cached data with a short lock
     {
         const juce::ScopedLock lock(m_cacheMutex);
         
-        m_cachedData.stats = stats;
-        m_cachedData.coverageIntervals = anyCoverage.getIntervals();
-        m_cachedData.anyDropouts = coverageModel.getAnyDropouts();
-        m_cachedData.allDropouts = coverageModel.getAllDropouts();
+        m_cachedData.stats = coverage->stats;
         m_cachedData.latestSample = latestSample;
         m_cachedData.sampleRate = sampleRate;
         m_cachedData.capturing = capturing;
     }
+    
+    updateColumns(*coverage);
+}
+
+void CaptureTimelinePanel::updateColumns(const CoverageModel::Snapshot& coverage)
+{
+    // One value per pixel of the current view, from the published pyramid: O(width)
+    // whatever the session length, and the model's lock is never taken
+    coverage.getCoverageColumns(m_viewStartSample, m_viewEndSample, m_timelineBounds.getWidth(), m_columnScratch);
+    
+    const juce::ScopedLock lock(m_cacheMutex);
+    m_cachedData.columns.swap(m_columnScratch);
+    m_cachedData.columnsViewStart = m_viewStartSample;
+    m_cachedData.columnsViewEnd = m_viewEndSample;
 }
 
 //==============================================================================
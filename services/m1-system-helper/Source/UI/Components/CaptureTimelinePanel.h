@@ -10,7 +10,7 @@
     - Time ruler with sample-to-seconds conversion
     - Playhead marker (latest received sample position)
     - Stats display (% captured, duration, dropout count)
-    - Controls: Reset, Lock Range, Export (stub), Fill Gaps toggle
+    - Controls: Reset, Lock Range, Export (stems via onExportClicked), Fill Gaps toggle
     - Mouse wheel zoom, click-drag pan, double-click fit
 */
 
@@ -81,15 +81,16 @@ private:
     struct CachedData
     {
         CoverageModel::GlobalStats stats;
-        std::vector<SampleInterval> coverageIntervals;  // Copy for thread safety
-        std::vector<SampleInterval> anyDropouts;
-        std::vector<SampleInterval> allDropouts;
+        std::vector<CoverageModel::CoverageColumn> columns;  // One per timeline pixel
+        int64_t columnsViewStart = 0;   // View the columns were taken for
+        int64_t columnsViewEnd = 0;
         int64_t latestSample = 0;
         uint32_t sampleRate = 44100;
         bool capturing = false;
         bool needsRepaint = false;
     };
     CachedData m_cachedData;
+    std::vector<CoverageModel::CoverageColumn> m_columnScratch;  // Swapped with m_cachedData.columns
     std::atomic<bool> m_cacheUpdatePending{false};
     juce::CriticalSection m_cacheMutex;
     
@@ -147,6 +148,7 @@ private:
     void panView(int deltaPixels);
     void updateViewFromCoverage();
     void updateCache();
+    void updateColumns(const CoverageModel::Snapshot& coverage);
     
     // Helpers
     juce::String formatTime(double seconds) const;
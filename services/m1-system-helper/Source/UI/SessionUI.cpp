@@ -5,6 +5,7 @@
 */
 
 #include "SessionUI.h"
+#include "../Core/SessionExporter.h"
 #include "BinaryData.h"
 
 namespace Mach1 {
@@ -18,6 +19,73 @@ constexpr int kTrayMenuDelayMs = 50;
 // SessionMainComponent
 //==============================================================================
 
+/**
+ * Runs a SessionExporter on its own thread behind a progress window
+ */
+class SessionMainComponent::ExportWindow : public juce::ThreadWithProgressWindow
+{
+public:
+    ExportWindow(const juce::File& sessionDir, const juce::File& outputDir, const CoverageModel* coverage,
+                 std::function<void()> finished)
+        : juce::ThreadWithProgressWindow("Exporting captured stems", true, true)
+        , m_sessionDir(sessionDir)
+        , m_outputDir(outputDir)
+        , m_coverage(coverage)
+        , m_finished(std::move(finished))
+    {
+    }
+    
+    void run() override
+    {
+        SessionExporter* exporter = nullptr;
+        
+        SessionExporter::Options options;
+        options.coverage = m_coverage;
+        options.onProgress = [this, &exporter](double progress) {
+            setProgress(progress);
+            if (threadShouldExit() && exporter != nullptr)
+                exporter->cancel();
+        };
+        
+        SessionExporter sessionExporter(options);
+        exporter = &sessionExporter;
+        m_result = sessionExporter.exportSession(m_sessionDir, m_outputDir);
+    }
+    
+    void threadComplete(bool userPressedCancel) override
+    {
+        if (!userPressedCancel)
+        {
+            int exported = 0;
+            juce::String errors;
+            for (const auto& stem : m_result.stems)
+            {
+                if (stem.exported)
+                    ++exported;
+                else
+                    errors += "\n" + stem.pannerName + ": " + stem.error;
+            }
+            
+            juce::AlertWindow::showMessageBoxAsync(
+                m_result.wasSuccessful() ? juce::AlertWindow::InfoIcon : juce::AlertWindow::WarningIcon,
+                "Export",
+                "Exported " + juce::String(exported) + " of " + juce::String(static_cast<int>(m_result.stems.size()))
+                    + " stems to " + m_outputDir.getFullPathName() + " ("
+                    + juce::String(m_result.getRealtimeFactor(), 1) + "x realtime)" + errors);
+        }
+        
+        if (m_finished)
+            m_finished();
+    }
+    
+private:
+    juce::File m_sessionDir;
+    juce::File m_outputDir;
+    const CoverageModel* m_coverage;
+    std::function<void()> m_finished;
+    SessionExporter::Result m_result;
+};
+
 SessionMainComponent::SessionMainComponent(PannerTrackingManager& manager, ClientManager& clientManagerRef, OSCHandler& oscHandlerRef, bool debugFakeBlocks)
     : pannerManager(manager)
     , clientManager(clientManagerRef)
@@ -61,7 +129,7 @@ SessionMainComponent::SessionMainComponent(PannerTrackingManager& manager, Clien
     
     captureTimelinePanel->onExportClicked = [this]() {
         DBG("[SessionMainComponent] Timeline export clicked");
-        // TODO: Implement export
+        exportCapture();
     };
     
     // Add as visible children
@@ -87,6 +155,9 @@ SessionMainComponent::~SessionMainComponent()
 {
     stopTimer();
     
+    // Cancel a running export before the capture engine (and its coverage model) goes away
+    exportWindow.reset();
+    
     // Stop capture engine
     if (captureEngine)
     {
@@ -144,6 +215,40 @@ bool SessionMainComponent::isCapturing() const
     return captureEngine && captureEngine->isCapturing();
 }
 
+void SessionMainComponent::exportCapture()
+{
+    if (!captureEngine || exportWindow != nullptr)
+        return;
+    
+    juce::File sessionDir = captureEngine->getCaptureRoot().getChildFile(captureEngine->getSessionId());
+    if (!sessionDir.isDirectory())
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon, "Export", "Nothing has been captured yet.");
+        return;
+    }
+    
+    exportChooser = std::make_unique<juce::FileChooser>("Export captured stems to...",
+        juce::File::getSpecialLocation(juce::File::userDocumentsDirectory));
+    exportChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectDirectories,
+        [this, sessionDir](const juce::FileChooser& chooser) {
+            juce::File outputDir = chooser.getResult();
+            if (outputDir == juce::File() || captureEngine == nullptr)
+                return;
+            
+            juce::Component::SafePointer<SessionMainComponent> safeThis(this);
+            exportWindow = std::make_unique<ExportWindow>(
+                sessionDir, outputDir.getChildFile(sessionDir.getFileName()), &captureEngine->getCoverageModel(),
+                [safeThis]() {
+                    // Not from inside the window's own callback
+                    juce::MessageManager::callAsync([safeThis]() {
+                        if (safeThis != nullptr)
+                            safeThis->exportWindow.reset();
+                    });
+                });
+            exportWindow->launchThread();
+        });
+}
+
 void SessionMainComponent::setupLayout()
 {
     // Main vertical layout: [Main content] [Resizer] [Timeline]
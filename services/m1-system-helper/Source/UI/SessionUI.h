@@ -78,6 +78,11 @@ public:
     bool startCapture(const juce::String& sessionId = "");
     void stopCapture();
     bool isCapturing() const;
+    
+    /**
+     * Ask for a folder and export the current capture session there as WAV/BWF stems
+     */
+    void exportCapture();
 
 private:
     void setupLayout();
@@ -91,6 +96,11 @@ private:
     // Capture Engine (background thread)
     std::unique_ptr<CaptureEngine> captureEngine;
     
+    // Stem export (runs behind a progress window)
+    class ExportWindow;
+    std::unique_ptr<juce::FileChooser> exportChooser;
+    std::unique_ptr<ExportWindow> exportWindow;
+    
     // UI Components
     std::unique_ptr<InputPanelContainer> inputPanelContainer;
     std::unique_ptr<Panner3DViewPanel> view3DComponent;
@@ -0,0 +1,245 @@
+/**
+ * Capture Worker Scheduling Benchmark
+ *
+ * Compares the two ways CaptureEngine has serviced panners:
+ *   - single: one capture thread visits every ring in turn, reads up to 64 blocks from each,
+ *     then waits on the first ring's doorbell for at most 5 ms (the old CaptureEngine loop)
+ *   - workers: one thread per ring, blocked on that ring's doorbell and draining everything
+ *     pending when woken (PannerWorker)
+ *
+ * Each "panner" is a thread publishing a timestamped block into its own ring every
+ * [period] ms. Every captured block costs [work] microseconds, standing in for the
+ * chunk write. Reports publish-to-capture latency and the blocks the producers had to
+ * drop because the capture side fell behind (the ring has 8 slots, like a panner's).
+ *
+ * Build: clang++ -std=c++17 -O2 -pthread -o bench_capture_workers bench_capture_workers.cpp
+ * Usage: ./bench_capture_workers [panners] [seconds] [period ms] [work us]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+
+#include "../Source/Common/M1MemoryShareRing.h"
+
+static constexpr uint32_t SLOT_COUNT = 8;
+static constexpr size_t SEGMENT_SIZE = 256 * 1024;
+static constexpr uint32_t CONSUMER_ID = 9002;
+static constexpr int MAX_BLOCKS_PER_PASS = 64;
+static constexpr int POLL_INTERVAL_MS = 5;
+static constexpr int IDLE_WAIT_MS = 50;
+
+static uint64_t nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static void spinFor(uint64_t ns)
+{
+    const uint64_t end = nowNs() + ns;
+    while (nowNs() < end)
+    {
+    }
+}
+
+struct Panner
+{
+    void* base = nullptr;
+    M1MemoryShareRing producer;
+    M1MemoryShareRing consumer;     // Mapped separately, as the helper does
+    int consumerIndex = -1;
+    uint64_t published = 0;
+};
+
+struct RunResult
+{
+    std::vector<double> latenciesNs;
+    uint64_t published = 0;
+    uint64_t captured = 0;
+    uint64_t dropped = 0;
+};
+
+/**
+ * Read every pending block from one ring, at most MAX_BLOCKS_PER_PASS
+ * @return true if the batch filled up (more may be pending)
+ */
+static bool drain(Panner& panner, uint64_t workNs, std::vector<double>& latencies, uint64_t& captured)
+{
+    for (int i = 0; i < MAX_BLOCKS_PER_PASS; ++i)
+    {
+        uint64_t sequence = 0, lost = 0;
+        uint32_t payloadSize = 0;
+        const uint8_t* payload = panner.consumer.acquireNext(panner.consumerIndex, sequence, payloadSize, lost);
+        if (payload == nullptr)
+            return false;
+
+        uint64_t publishedNs = 0;
+        std::memcpy(&publishedNs, payload, sizeof(publishedNs));
+        latencies.push_back(static_cast<double>(nowNs() - publishedNs));
+        spinFor(workNs);
+        panner.consumer.release(panner.consumerIndex, sequence);
+        ++captured;
+    }
+    return true;
+}
+
+static RunResult run(bool perPannerWorkers, int panners, double seconds, int periodMs, uint64_t workNs)
+{
+    RunResult result;
+    std::vector<std::unique_ptr<Panner>> rings;
+    for (int p = 0; p < panners; ++p)
+    {
+        auto panner = std::make_unique<Panner>();
+        panner->base = mmap(nullptr, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (panner->base == MAP_FAILED || !panner->producer.create(panner->base, SEGMENT_SIZE, SLOT_COUNT, 0, "bench")
+            || !panner->consumer.attach(panner->base, SEGMENT_SIZE))
+        {
+            std::cerr << "ERROR: could not set up ring " << p << "\n";
+            return result;
+        }
+        panner->consumerIndex = panner->consumer.registerConsumer(CONSUMER_ID);
+        rings.push_back(std::move(panner));
+    }
+
+    std::atomic<bool> stop{false};
+    std::mutex resultMutex;
+    std::vector<std::thread> threads;
+
+    // Producers: one block per period, dropped (not waited for) when the ring is full
+    for (auto& ring : rings)
+    {
+        threads.emplace_back([&, panner = ring.get()]
+        {
+            auto next = std::chrono::steady_clock::now();
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                uint64_t sequence = 0;
+                if (uint8_t* payload = panner->producer.beginWrite(sequence))
+                {
+                    const uint64_t stamp = nowNs();
+                    std::memcpy(payload, &stamp, sizeof(stamp));
+                    panner->producer.commitWrite(sequence, sizeof(stamp));
+                    ++panner->published;
+                }
+                next += std::chrono::milliseconds(periodMs);
+                std::this_thread::sleep_until(next);
+            }
+        });
+    }
+
+    // Capture side
+    std::vector<std::thread> consumers;
+    if (perPannerWorkers)
+    {
+        for (auto& ring : rings)
+        {
+            consumers.emplace_back([&, panner = ring.get()]
+            {
+                std::vector<double> latencies;
+                uint64_t captured = 0;
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    if (drain(*panner, workNs, latencies, captured))
+                        continue;
+                    panner->consumer.waitForPublish(panner->consumerIndex, IDLE_WAIT_MS);
+                }
+                std::lock_guard<std::mutex> lock(resultMutex);
+                result.latenciesNs.insert(result.latenciesNs.end(), latencies.begin(), latencies.end());
+                result.captured += captured;
+            });
+        }
+    }
+    else
+    {
+        consumers.emplace_back([&]
+        {
+            std::vector<double> latencies;
+            uint64_t captured = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                for (auto& ring : rings)
+                    drain(*ring, workNs, latencies, captured);
+
+                // One thread can only block on one doorbell: the first ring, for the poll interval
+                rings.front()->consumer.waitForPublish(rings.front()->consumerIndex,
+                                                       rings.size() == 1 ? IDLE_WAIT_MS : POLL_INTERVAL_MS);
+            }
+            std::lock_guard<std::mutex> lock(resultMutex);
+            result.latenciesNs.insert(result.latenciesNs.end(), latencies.begin(), latencies.end());
+            result.captured += captured;
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;     // Blocked workers notice within IDLE_WAIT_MS
+    for (auto& thread : threads)
+        thread.join();
+    for (auto& thread : consumers)
+        thread.join();
+
+    for (auto& ring : rings)
+    {
+        result.published += ring->published;
+        result.dropped += ring->producer.getDroppedBlocks();
+        munmap(ring->base, SEGMENT_SIZE);
+    }
+    return result;
+}
+
+static void printResult(const char* name, RunResult r)
+{
+    std::sort(r.latenciesNs.begin(), r.latenciesNs.end());
+    auto pct = [&r](double p) { return r.latenciesNs.empty() ? 0.0 : r.latenciesNs[std::min(r.latenciesNs.size() - 1, static_cast<size_t>(p * r.latenciesNs.size()))]; };
+
+    std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << pct(0.50) / 1000.0
+              << std::setw(12) << pct(0.99) / 1000.0
+              << std::setw(12) << (r.latenciesNs.empty() ? 0.0 : r.latenciesNs.back() / 1000.0)
+              << std::setw(12) << r.published
+              << std::setw(12) << r.captured
+              << std::setw(10) << r.dropped << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int panners = argc > 1 ? std::atoi(argv[1]) : 8;
+    double seconds = argc > 2 ? std::atof(argv[2]) : 2.0;
+    int periodMs = argc > 3 ? std::atoi(argv[3]) : 10;
+    uint64_t workNs = static_cast<uint64_t>(argc > 4 ? std::atoi(argv[4]) : 50) * 1000ull;
+
+    if (panners < 1 || periodMs < 1)
+    {
+        std::cerr << "ERROR: need at least one panner and a period of at least 1 ms\n";
+        return 1;
+    }
+
+    std::cout << "Capture scheduling: " << panners << " panners, one block per " << periodMs << " ms each, "
+              << workNs / 1000 << " us per captured block, " << seconds << " s, "
+              << std::thread::hardware_concurrency() << " hardware threads\n\n";
+    std::cout << std::left << std::setw(10) << "capture" << std::right
+              << std::setw(12) << "p50 (us)" << std::setw(12) << "p99 (us)" << std::setw(12) << "max (us)"
+              << std::setw(12) << "published" << std::setw(12) << "captured" << std::setw(10) << "dropped" << "\n";
+
+    RunResult single = run(false, panners, seconds, periodMs, workNs);
+    printResult("single", single);
+    RunResult workers = run(true, panners, seconds, periodMs, workNs);
+    printResult("workers", workers);
+
+    // Whatever was published and not dropped must have been captured, give or take the
+    // blocks still in flight when the run stopped
+    const uint64_t slack = static_cast<uint64_t>(panners) * SLOT_COUNT;
+    bool passed = workers.captured + slack >= workers.published && single.captured + slack >= single.published;
+    std::cout << "\n" << (passed ? "PASS" : "FAIL") << ": every published block was captured in both modes\n";
+    return passed ? 0 : 1;
+}
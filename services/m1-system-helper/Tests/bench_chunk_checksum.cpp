@@ -0,0 +1,254 @@
+/**
+ * Chunk Checksum and Checkpoint Benchmark (POSIX)
+ *
+ * Measures the two costs crash consistency adds to capture and recovery:
+ *   - Crc32c, the CRC-32C every chunk carries: checked against the standard test
+ *     vectors and a bitwise reference, then timed per chunk size (capture computes one
+ *     per chunk) and as bulk throughput, from which the time to verify a session of
+ *     [session GB] is estimated (what SessionRecovery does, per thread)
+ *   - durability: [files] files are appended chunk by chunk as the ChunkWriter does,
+ *     once with an fdatasync (fsync on macOS) after every chunk and once with group
+ *     commit (every file synced once per [interval ms] checkpoint), reporting chunk
+ *     throughput and the number of syncs
+ *
+ * Build: clang++ -std=c++17 -O2 -o bench_chunk_checksum bench_chunk_checksum.cpp ../Source/Core/Crc32c.cpp
+ * Usage: ./bench_chunk_checksum [files] [interval ms] [session GB] [directory]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../Source/Core/Crc32c.h"
+
+using Mach1::Crc32c;
+
+static constexpr size_t CHUNK_BYTES = 80 + 512 * 2 * 4;    // Header + 512 stereo float32 frames
+static constexpr double SYNC_TEST_SECONDS = 2.0;
+
+static double nowSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint32_t referenceCrc(const uint8_t* data, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
+
+static int syncFile(int fd)
+{
+#if defined(__APPLE__)
+    return fsync(fd);
+#else
+    return fdatasync(fd);
+#endif
+}
+
+//==============================================================================
+static bool checkCorrectness()
+{
+    const char* vector = "123456789";
+    if (Crc32c::compute(vector, 9) != 0xE3069283u)
+    {
+        std::cout << "FAIL: CRC-32C(\"123456789\") = 0x" << std::hex << Crc32c::compute(vector, 9) << std::dec << "\n";
+        return false;
+    }
+
+    uint8_t zeros[32] = {};
+    uint8_t ones[32];
+    std::memset(ones, 0xFF, sizeof(ones));
+    if (Crc32c::compute(zeros, 32) != 0x8A9136AAu || Crc32c::compute(ones, 32) != 0x62A8AB43u)
+    {
+        std::cout << "FAIL: RFC 3720 test vectors\n";
+        return false;
+    }
+
+    // Every length and alignment around the 8-byte steps, and split updates
+    std::mt19937 rng(7);
+    std::vector<uint8_t> data(4096 + 16);
+    for (auto& byte : data)
+        byte = static_cast<uint8_t>(rng());
+
+    for (size_t offset = 0; offset < 8; ++offset)
+    {
+        for (size_t size = 0; size < 300; ++size)
+        {
+            const uint8_t* p = data.data() + offset;
+            const uint32_t expected = referenceCrc(p, size);
+            const size_t split = size / 3;
+            if (Crc32c::compute(p, size) != expected
+                || Crc32c::update(Crc32c::compute(p, split), p + split, size - split) != expected)
+            {
+                std::cout << "FAIL: size " << size << " offset " << offset << "\n";
+                return false;
+            }
+        }
+    }
+
+    // A chunk checksum catches a flipped bit anywhere in header or payload
+    Mach1::ChunkHeader header;
+    header.version = Mach1::ChunkHeader::VERSION_CHECKSUM;
+    header.audioDataSize = 4096;
+    header.checksum = Crc32c::getChunkChecksum(header, data.data(), 4096);
+    if (!Crc32c::verifyChunk(header, data.data(), 4096))
+    {
+        std::cout << "FAIL: chunk does not verify\n";
+        return false;
+    }
+    data[1234] ^= 0x10;
+    const bool payloadCaught = !Crc32c::verifyChunk(header, data.data(), 4096);
+    data[1234] ^= 0x10;
+    header.startSample ^= 1;
+    const bool headerCaught = !Crc32c::verifyChunk(header, data.data(), 4096);
+    if (!payloadCaught || !headerCaught)
+    {
+        std::cout << "FAIL: corrupted chunk verifies\n";
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+static double measureThroughput(size_t blockSize, size_t totalBytes)
+{
+    std::vector<uint8_t> data(blockSize);
+    std::mt19937 rng(1);
+    for (auto& byte : data)
+        byte = static_cast<uint8_t>(rng());
+
+    const size_t iterations = std::max<size_t>(1, totalBytes / blockSize);
+    volatile uint32_t sink = 0;
+    const double start = nowSeconds();
+    for (size_t i = 0; i < iterations; ++i)
+        sink = sink ^ Crc32c::compute(data.data(), data.size());
+    const double elapsed = nowSeconds() - start;
+
+    return static_cast<double>(iterations * blockSize) / elapsed / (1024.0 * 1024.0 * 1024.0);
+}
+
+//==============================================================================
+struct SyncResult
+{
+    uint64_t chunks = 0;
+    uint64_t syncs = 0;
+    double seconds = 0.0;
+};
+
+static SyncResult measureSync(const std::string& directory, int numFiles, int intervalMs)
+{
+    std::vector<int> fds;
+    std::vector<std::string> paths;
+    for (int i = 0; i < numFiles; ++i)
+    {
+        paths.push_back(directory + "/bench_checksum_" + std::to_string(i) + ".bin");
+        fds.push_back(open(paths.back().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+        if (fds.back() < 0)
+        {
+            std::cerr << "Could not create " << paths.back() << "\n";
+            std::exit(1);
+        }
+    }
+
+    std::vector<uint8_t> chunk(CHUNK_BYTES, 0x5A);
+    SyncResult result;
+    const double start = nowSeconds();
+    double lastCheckpoint = start;
+    while (nowSeconds() - start < SYNC_TEST_SECONDS)
+    {
+        for (int fd : fds)
+        {
+            if (write(fd, chunk.data(), chunk.size()) != static_cast<ssize_t>(chunk.size()))
+            {
+                std::cerr << "Write failed\n";
+                std::exit(1);
+            }
+            result.chunks++;
+
+            if (intervalMs == 0)
+            {
+                syncFile(fd);
+                result.syncs++;
+            }
+        }
+
+        if (intervalMs > 0 && (nowSeconds() - lastCheckpoint) * 1000.0 >= intervalMs)
+        {
+            for (int fd : fds)
+                syncFile(fd);
+            result.syncs += fds.size();
+            lastCheckpoint = nowSeconds();
+        }
+    }
+    result.seconds = nowSeconds() - start;
+
+    for (size_t i = 0; i < fds.size(); ++i)
+    {
+        close(fds[i]);
+        unlink(paths[i].c_str());
+    }
+    return result;
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const int numFiles = argc > 1 ? std::atoi(argv[1]) : 8;
+    const int intervalMs = argc > 2 ? std::atoi(argv[2]) : 1000;
+    const double sessionGb = argc > 3 ? std::atof(argv[3]) : 4.0;
+    const std::string directory = argc > 4 ? argv[4] : ".";
+    if (numFiles <= 0 || intervalMs <= 0 || sessionGb <= 0.0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [files] [interval ms] [session GB] [directory]\n";
+        return 1;
+    }
+
+    std::cout << "CRC-32C: " << (Crc32c::isHardwareAccelerated() ? "CPU instructions" : "table (no CRC32 instructions)") << "\n";
+    if (!checkCorrectness())
+        return 1;
+    std::cout << "Test vectors, lengths, alignments and corruption detection: OK\n\n";
+
+    std::cout << std::setw(14) << "block bytes" << std::setw(12) << "GB/s" << std::setw(16) << "ns per block" << "\n";
+    double bulk = 0.0;
+    for (size_t blockSize : { size_t(256), CHUNK_BYTES, size_t(16384), size_t(1 << 20) })
+    {
+        const double gbPerSecond = measureThroughput(blockSize, size_t(1) << 30);
+        std::cout << std::setw(14) << blockSize << std::setw(12) << std::fixed << std::setprecision(2) << gbPerSecond
+                  << std::setw(16) << std::setprecision(1) << blockSize / (gbPerSecond * 1.073741824) << "\n";
+        bulk = gbPerSecond;
+    }
+    std::cout << "Verifying a " << std::setprecision(1) << sessionGb << " GB session: " << std::setprecision(2)
+              << sessionGb / bulk << " s on one thread (page cache warm)\n\n";
+
+    std::cout << "Appending " << CHUNK_BYTES << "-byte chunks to " << numFiles << " files in " << directory
+              << " for " << SYNC_TEST_SECONDS << " s each:\n";
+    const SyncResult perChunk = measureSync(directory, numFiles, 0);
+    const SyncResult group = measureSync(directory, numFiles, intervalMs);
+    for (const auto& [name, result] : { std::make_pair("sync per chunk", perChunk),
+                                        std::make_pair("group commit", group) })
+    {
+        std::cout << std::setw(16) << name << ": " << std::setw(10) << static_cast<uint64_t>(result.chunks / result.seconds)
+                  << " chunks/s, " << std::setw(8) << result.syncs << " syncs\n";
+    }
+    std::cout << "Group commit every " << intervalMs << " ms: "
+              << std::setprecision(1) << (group.chunks / group.seconds) / std::max(1.0, perChunk.chunks / perChunk.seconds)
+              << "x the chunk rate\n";
+
+    return 0;
+}
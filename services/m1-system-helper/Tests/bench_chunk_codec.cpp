@@ -0,0 +1,278 @@
+/**
+ * Chunk Audio Codec Benchmark
+ *
+ * Measures ChunkCodec (the lossless codec CaptureEngine applies to chunk audio) the way
+ * the engine uses it: one encode per captured block, falling back to raw float32 when
+ * a block does not shrink. For each input it reports the compression ratio, encode and
+ * decode throughput (MB/s of raw float32), and checks every block decodes bit for bit.
+ *
+ * Synthetic inputs cover what panners actually send: digital silence, material that
+ * came from 16- and 24-bit sources (the common case: float samples with many zero low
+ * mantissa bits), and full-precision float synthesis and noise (the worst case).
+ * Real material can be added as a WAV file (16/24-bit PCM or 32-bit float) or as raw
+ * interleaved float32 (any other extension, read with [channels]).
+ *
+ * Build: clang++ -std=c++17 -O2 -o bench_chunk_codec bench_chunk_codec.cpp
+ * Usage: ./bench_chunk_codec [block samples] [channels] [audio file]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "../Source/Core/ChunkCodec.h"
+
+using Mach1::ChunkCodec;
+
+static constexpr double SECONDS_PER_INPUT = 10.0;   // Of audio at 48 kHz
+static constexpr uint32_t SAMPLE_RATE = 48000;
+
+struct Input
+{
+    std::string name;
+    uint32_t channels = 0;
+    std::vector<float> samples;     // Interleaved
+};
+
+static double nowSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//==============================================================================
+static Input makeSynthetic(const std::string& name, uint32_t channels, int bits, bool noise)
+{
+    Input input;
+    input.name = name;
+    input.channels = channels;
+
+    const size_t frames = static_cast<size_t>(SECONDS_PER_INPUT * SAMPLE_RATE);
+    input.samples.resize(frames * channels);
+
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> gaussian(0.0f, 0.1f);
+    const double scale = bits > 0 ? std::ldexp(1.0, bits - 1) : 0.0;
+
+    for (size_t frame = 0; frame < frames; ++frame)
+    {
+        for (uint32_t channel = 0; channel < channels; ++channel)
+        {
+            double value = 0.0;
+            if (bits >= 0)
+            {
+                // A few partials plus a little noise floor, per channel slightly detuned
+                const double t = static_cast<double>(frame) / SAMPLE_RATE;
+                const double f = 220.0 * (1.0 + 0.01 * channel);
+                value = noise ? gaussian(rng)
+                              : 0.5 * std::sin(2.0 * M_PI * f * t) + 0.2 * std::sin(2.0 * M_PI * 3.0 * f * t)
+                                + 0.01 * gaussian(rng);
+            }
+
+            if (scale > 0.0)
+                value = std::round(value * scale) / scale;
+
+            input.samples[frame * channels + channel] = static_cast<float>(value);
+        }
+    }
+
+    return input;
+}
+
+/**
+ * WAV (PCM 16/24/32-bit or float32) or raw interleaved float32
+ */
+static bool loadFile(const std::string& path, uint32_t rawChannels, Input& input)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    input.name = path.substr(path.find_last_of('/') + 1);
+
+    if (data.size() < 12 || std::memcmp(data.data(), "RIFF", 4) != 0 || std::memcmp(data.data() + 8, "WAVE", 4) != 0)
+    {
+        input.channels = rawChannels;
+        input.samples.resize(data.size() / sizeof(float));
+        std::memcpy(input.samples.data(), data.data(), input.samples.size() * sizeof(float));
+        return true;
+    }
+
+    auto read16 = [&data](size_t at) { return static_cast<uint32_t>(data[at] | (data[at + 1] << 8)); };
+    auto read32 = [&data](size_t at) { uint32_t v; std::memcpy(&v, data.data() + at, 4); return v; };
+
+    uint32_t format = 0, bitsPerSample = 0;
+    for (size_t at = 12; at + 8 <= data.size();)
+    {
+        const uint32_t size = read32(at + 4);
+        const size_t body = at + 8;
+        const size_t available = std::min<size_t>(size, data.size() - body);
+
+        if (std::memcmp(data.data() + at, "fmt ", 4) == 0 && available >= 16)
+        {
+            format = read16(body);
+            input.channels = read16(body + 2);
+            bitsPerSample = read16(body + 14);
+            if (format == 0xFFFE && available >= 26)
+                format = read16(body + 24);     // WAVE_FORMAT_EXTENSIBLE subformat
+        }
+        else if (std::memcmp(data.data() + at, "data", 4) == 0 && input.channels > 0)
+        {
+            const uint32_t bytesPerSample = bitsPerSample / 8;
+            if (bytesPerSample == 0 || (format != 1 && format != 3))
+                return false;
+
+            const size_t count = available / bytesPerSample;
+            input.samples.resize(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const uint8_t* p = data.data() + body + i * bytesPerSample;
+                if (format == 3 && bytesPerSample == 4)
+                    std::memcpy(&input.samples[i], p, 4);
+                else if (bytesPerSample == 2)
+                    input.samples[i] = static_cast<int16_t>(p[0] | (p[1] << 8)) / 32768.0f;
+                else if (bytesPerSample == 3)
+                    input.samples[i] = static_cast<float>(static_cast<int32_t>((p[0] << 8) | (p[1] << 16) | (p[2] << 24)) / 2147483648.0);
+                else if (bytesPerSample == 4)
+                    input.samples[i] = static_cast<float>(static_cast<int32_t>(read32(body + i * 4)) / 2147483648.0);
+                else
+                    return false;
+            }
+            return true;
+        }
+
+        at = body + size + (size & 1);
+    }
+
+    return false;
+}
+
+//==============================================================================
+struct Result
+{
+    double ratio = 0.0;
+    double encodeMBps = 0.0;
+    double decodeMBps = 0.0;
+    double rawBlocksPercent = 0.0;
+    bool exact = true;
+};
+
+static Result run(const Input& input, uint32_t blockSamples)
+{
+    Result result;
+    const uint32_t channels = input.channels;
+    const size_t blockValues = static_cast<size_t>(blockSamples) * channels;
+    const size_t blocks = input.samples.size() / blockValues;
+    const size_t rawBlockBytes = blockValues * sizeof(float);
+
+    std::vector<uint8_t> encoded(blocks * rawBlockBytes);
+    std::vector<size_t> sizes(blocks);
+    std::vector<float> decoded(blockValues);
+
+    // Encode exactly like CaptureEngine::writeChunk: anything not smaller is stored raw
+    uint64_t storedBytes = 0;
+    size_t rawBlocks = 0;
+    const double encodeStart = nowSeconds();
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        const float* block = input.samples.data() + b * blockValues;
+        uint8_t* out = encoded.data() + b * rawBlockBytes;
+        sizes[b] = ChunkCodec::encode(block, channels, blockSamples, out, rawBlockBytes - 1);
+        if (sizes[b] == 0)
+        {
+            std::memcpy(out, block, rawBlockBytes);
+            ++rawBlocks;
+        }
+        storedBytes += sizes[b] > 0 ? sizes[b] : rawBlockBytes;
+    }
+    const double encodeSeconds = nowSeconds() - encodeStart;
+
+    double decodeSeconds = 0.0;
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        const float* block = input.samples.data() + b * blockValues;
+        const uint8_t* in = encoded.data() + b * rawBlockBytes;
+
+        const double decodeStart = nowSeconds();
+        bool ok = true;
+        if (sizes[b] > 0)
+            ok = ChunkCodec::decode(in, sizes[b], channels, blockSamples, decoded.data());
+        else
+            std::memcpy(decoded.data(), in, rawBlockBytes);
+        decodeSeconds += nowSeconds() - decodeStart;
+
+        if (!ok || std::memcmp(decoded.data(), block, rawBlockBytes) != 0)
+            result.exact = false;
+    }
+
+    const double rawMB = static_cast<double>(blocks * rawBlockBytes) / (1024.0 * 1024.0);
+    result.ratio = storedBytes > 0 ? static_cast<double>(blocks * rawBlockBytes) / storedBytes : 0.0;
+    result.encodeMBps = encodeSeconds > 0.0 ? rawMB / encodeSeconds : 0.0;
+    result.decodeMBps = decodeSeconds > 0.0 ? rawMB / decodeSeconds : 0.0;
+    result.rawBlocksPercent = blocks > 0 ? 100.0 * rawBlocks / blocks : 0.0;
+    return result;
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const uint32_t blockSamples = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 512;
+    const uint32_t channels = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 2;
+    if (blockSamples == 0 || channels == 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [block samples] [channels] [audio file]\n";
+        return 1;
+    }
+
+    std::vector<Input> inputs;
+    inputs.push_back(makeSynthetic("silence", channels, -1, false));
+    inputs.push_back(makeSynthetic("sine 16-bit", channels, 16, false));
+    inputs.push_back(makeSynthetic("sine 24-bit", channels, 24, false));
+    inputs.push_back(makeSynthetic("noise 16-bit", channels, 16, true));
+    inputs.push_back(makeSynthetic("noise 24-bit", channels, 24, true));
+    inputs.push_back(makeSynthetic("sine float", channels, 0, false));
+    inputs.push_back(makeSynthetic("noise float", channels, 0, true));
+
+    if (argc > 3)
+    {
+        Input file;
+        if (!loadFile(argv[3], channels, file) || file.channels == 0 || file.samples.empty())
+        {
+            std::cerr << "Could not read audio from " << argv[3] << "\n";
+            return 1;
+        }
+        inputs.push_back(std::move(file));
+    }
+
+    std::cout << "Chunk codec: " << blockSamples << " samples per chunk, ratio = raw float32 / stored\n\n";
+    std::cout << std::left << std::setw(22) << "input" << std::right
+              << std::setw(4) << "ch" << std::setw(9) << "ratio"
+              << std::setw(13) << "enc MB/s" << std::setw(13) << "dec MB/s"
+              << std::setw(10) << "raw %" << std::setw(8) << "exact" << "\n";
+
+    bool passed = true;
+    for (const auto& input : inputs)
+    {
+        const Result result = run(input, blockSamples);
+        passed = passed && result.exact;
+
+        std::cout << std::left << std::setw(22) << input.name.substr(0, 21) << std::right << std::fixed
+                  << std::setw(4) << input.channels
+                  << std::setprecision(2) << std::setw(9) << result.ratio
+                  << std::setprecision(0) << std::setw(13) << result.encodeMBps << std::setw(13) << result.decodeMBps
+                  << std::setprecision(1) << std::setw(10) << result.rawBlocksPercent
+                  << std::setw(8) << (result.exact ? "yes" : "NO") << "\n";
+    }
+
+    std::cout << "\n" << (passed ? "PASS" : "FAIL") << ": every chunk decoded bit for bit\n";
+    return passed ? 0 : 1;
+}
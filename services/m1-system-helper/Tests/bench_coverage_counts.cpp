@@ -0,0 +1,185 @@
+/**
+ * Incremental Coverage Aggregates Benchmark
+ *
+ * Measures what CoverageModel now does per captured block and per stats query:
+ *   - update: each panner's CapturedIntervalSet reports the samples it newly covers,
+ *             which raise the CoverageCounts step function (any and all coverage kept
+ *             up to date); capture order, [panners] panners round-robin with random
+ *             dropouts and slightly out-of-phase blocks
+ *   - query:  global captured/full-coverage samples read from the aggregates, against
+ *             a CoverageSweep over every panner (the previous per-query rebuild)
+ * The aggregates are checked against the sweep (any, all and every k-of-n threshold)
+ * several times during the run, and after out-of-order and overlapping adds.
+ *
+ * Build: clang++ -std=c++17 -O2 -o bench_coverage_counts bench_coverage_counts.cpp ../Source/Core/CoverageCounts.cpp ../Source/Core/CoverageSweep.cpp ../Source/Core/CapturedIntervalSet.cpp
+ * Usage: ./bench_coverage_counts [panners] [minutes]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+#include "../Source/Core/CoverageCounts.h"
+#include "../Source/Core/CoverageSweep.h"
+
+using Mach1::CapturedIntervalSet;
+using Mach1::CoverageCounts;
+using Mach1::CoverageSweep;
+
+static constexpr int64_t BLOCK_SAMPLES = 512;
+static constexpr int64_t SAMPLE_RATE = 48000;
+static constexpr double DROPOUT_CHANCE = 0.002;     // Per block
+
+static double nowSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Model
+{
+    std::vector<CapturedIntervalSet> panners;
+    CoverageCounts counts;
+
+    explicit Model(size_t numPanners) : panners(numPanners)
+    {
+        counts.setNumPanners(static_cast<uint32_t>(numPanners));
+    }
+
+    void add(size_t panner, int64_t start, int64_t end)
+    {
+        panners[panner].addInterval(start, end, [this](int64_t s, int64_t e) { counts.add(s, e); });
+    }
+};
+
+static bool matchesSweep(const Model& model, bool everyThreshold)
+{
+    CoverageSweep sweep;
+    for (const auto& panner : model.panners)
+        sweep.addPanner(panner);
+
+    const auto result = sweep.run();
+    if (result.anyCoverage.getIntervals() != model.counts.getAnyCoverage().getIntervals()
+        || result.allCoverage.getIntervals() != model.counts.getAllCoverage().getIntervals())
+        return false;
+
+    for (uint32_t k = 1; everyThreshold && k <= model.panners.size(); ++k)
+    {
+        if (sweep.run(k).minCoverage.getIntervals() != model.counts.getCoverage(k).getIntervals())
+            return false;
+    }
+    return true;
+}
+
+static bool checkCorrectness()
+{
+    std::mt19937_64 rng(9);
+    for (int round = 0; round < 50; ++round)
+    {
+        const size_t numPanners = 1 + rng() % 6;
+        Model model(numPanners);
+        for (int i = 0; i < 300; ++i)
+        {
+            const int64_t start = static_cast<int64_t>(rng() % 4000);
+            model.add(rng() % numPanners, start, start + static_cast<int64_t>(rng() % 300));
+        }
+        if (!matchesSweep(model, true))
+        {
+            std::cout << "FAIL: random adds, round " << round << "\n";
+            return false;
+        }
+
+        // A panner joining: all coverage is empty until it covers something
+        model.panners.emplace_back();
+        model.counts.setNumPanners(static_cast<uint32_t>(model.panners.size()));
+        model.add(numPanners, 1000, 2000);
+        if (!matchesSweep(model, true))
+        {
+            std::cout << "FAIL: panner joining, round " << round << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const int numPanners = argc > 1 ? std::atoi(argv[1]) : 100;
+    const double minutes = argc > 2 ? std::atof(argv[2]) : 10.0;
+    if (numPanners <= 0 || minutes <= 0.0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [panners] [minutes]\n";
+        return 1;
+    }
+
+    if (!checkCorrectness())
+        return 1;
+    std::cout << "Aggregates match the sweep (random adds, k of n, panners joining): OK\n\n";
+
+    // Capture order: every panner delivers its next block in turn
+    const int64_t numBlocks = static_cast<int64_t>(minutes * 60.0 * SAMPLE_RATE / BLOCK_SAMPLES);
+    Model model(static_cast<size_t>(numPanners));
+    std::vector<int64_t> positions(static_cast<size_t>(numPanners));
+    std::mt19937_64 rng(4);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    for (auto& position : positions)
+        position = static_cast<int64_t>(rng() % BLOCK_SAMPLES);
+
+    uint64_t updates = 0;
+    double updateSeconds = 0.0;
+    const int64_t checkEvery = std::max<int64_t>(1, numBlocks / 4);
+    for (int64_t block = 0; block < numBlocks; ++block)
+    {
+        const double start = nowSeconds();
+        for (size_t p = 0; p < positions.size(); ++p)
+        {
+            if (chance(rng) < DROPOUT_CHANCE)
+                positions[p] += BLOCK_SAMPLES * static_cast<int64_t>(1 + rng() % 4);
+            model.add(p, positions[p], positions[p] + BLOCK_SAMPLES);
+            positions[p] += BLOCK_SAMPLES;
+        }
+        updateSeconds += nowSeconds() - start;
+        updates += positions.size();
+
+        if ((block + 1) % checkEvery == 0 && !matchesSweep(model, false))
+        {
+            std::cout << "FAIL: aggregates differ from the sweep after block " << block << "\n";
+            return 1;
+        }
+    }
+
+    std::cout << numPanners << " panners, " << minutes << " min, " << updates << " blocks, "
+              << model.counts.getNumSteps() << " count steps, "
+              << model.counts.getAnyCoverage().getIntervalCount() << " any / "
+              << model.counts.getAllCoverage().getIntervalCount() << " all intervals\n";
+
+    // Stats queries
+    const int queries = 20;
+    volatile int64_t sink = 0;
+    double start = nowSeconds();
+    for (int i = 0; i < queries * 1000; ++i)
+        sink = sink + model.counts.getAnyCoverage().getTotalCapturedSamples() + model.counts.getAllCoverage().getTotalCapturedSamples();
+    const double incrementalQuery = (nowSeconds() - start) / (queries * 1000);
+
+    start = nowSeconds();
+    for (int i = 0; i < queries; ++i)
+    {
+        CoverageSweep sweep;
+        for (const auto& panner : model.panners)
+            sweep.addPanner(panner);
+        const auto result = sweep.run();
+        sink = sink + result.anyCoverage.getTotalCapturedSamples() + result.allCoverage.getTotalCapturedSamples();
+    }
+    const double sweepQuery = (nowSeconds() - start) / queries;
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "update per block:          " << std::setw(12) << updateSeconds * 1e9 / static_cast<double>(updates) << " ns\n"
+              << "stats query, incremental:  " << std::setw(12) << incrementalQuery * 1e9 << " ns\n"
+              << "stats query, full sweep:   " << std::setw(12) << sweepQuery * 1e9 << " ns\n";
+
+    return 0;
+}
@@ -0,0 +1,312 @@
+/**
+ * Coverage Pyramid Benchmark
+ *
+ * Measures what a timeline refresh costs for sessions of growing length:
+ *   - intervals: copy the any-coverage intervals, its gaps and the dropouts, and turn
+ *                every one into a pixel span (what CaptureTimelinePanel::updateCache and
+ *                paint did; each span was also a fillRect or a run of hatch lines)
+ *   - pyramid:   one CoveragePyramid column per pixel, with the exact intervals refining
+ *                partly covered edge buckets
+ *   - snapshot:  one column per pixel from a published copy, without the intervals
+ *                (what CoverageModel::getCoverageColumns does)
+ *   - publish:   capture the next block, then publish the pyramid (what the capture and
+ *                CoverageModel::publishSnapshot cost; the spare copy takes the blocks
+ *                written since it was last published)
+ * Coverage is captured block by block with random dropouts, so it is fragmented.
+ * Columns are checked against the exact intervals (covered samples, dropouts and gaps)
+ * over random sets and views, and the estimate without the intervals is checked to be
+ * off by less than a base bucket at each column edge. A copy must keep its columns
+ * while the original goes on capturing, and every published copy must match the
+ * original, including after blocks were added in front and after a clear().
+ *
+ * Build: clang++ -std=c++17 -O2 -o bench_coverage_pyramid bench_coverage_pyramid.cpp ../Source/Core/CoveragePyramid.cpp ../Source/Core/CapturedIntervalSet.cpp
+ * Usage: ./bench_coverage_pyramid [pixels]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <random>
+
+#include "../Source/Core/CoveragePyramid.h"
+
+using Mach1::CapturedIntervalSet;
+using Mach1::CoveragePyramid;
+using Mach1::SampleInterval;
+
+static constexpr int64_t BLOCK_SAMPLES = 512;
+static constexpr int64_t SAMPLE_RATE = 48000;
+static constexpr double DROPOUT_CHANCE = 0.002;     // Per block
+
+static double nowSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Coverage
+{
+    CapturedIntervalSet intervals;
+    CapturedIntervalSet dropouts;
+    CoveragePyramid pyramid;
+
+    void add(int64_t start, int64_t end)
+    {
+        intervals.addInterval(start, end, [this](int64_t s, int64_t e) { pyramid.addCovered(s, e); });
+    }
+
+    void addDropout(int64_t start, int64_t end)
+    {
+        dropouts.addInterval(start, end);
+        pyramid.addDropout(start, end);
+    }
+};
+
+static bool matchesIntervals(const Coverage& coverage, int64_t viewStart, int64_t viewEnd, int numColumns)
+{
+    std::vector<CoveragePyramid::Column> exact(static_cast<size_t>(numColumns));
+    std::vector<CoveragePyramid::Column> estimated(static_cast<size_t>(numColumns));
+    coverage.pyramid.getColumns(viewStart, viewEnd, numColumns, exact.data(), &coverage.intervals, &coverage.dropouts);
+    coverage.pyramid.getColumns(viewStart, viewEnd, numColumns, estimated.data());
+
+    const auto bounds = coverage.intervals.getBoundingInterval();
+    for (int c = 0; c < numColumns; ++c)
+    {
+        const auto& column = exact[static_cast<size_t>(c)];
+        const SampleInterval range(column.start, column.end);
+        const int64_t covered = coverage.intervals.getCoveredSamples(range);
+        const int64_t inBounds = std::min(range.end, bounds.end) - std::max(range.start, bounds.start);
+        if (column.coveredSamples != covered
+            || column.dropout != (coverage.dropouts.getCoveredSamples(range) > 0)
+            || column.gap != (covered < inBounds))
+            return false;
+
+        // Off by less than a base bucket at each edge
+        if (std::llabs(estimated[static_cast<size_t>(c)].coveredSamples - covered) >= 2 * (int64_t(1) << CoveragePyramid::BASE_SHIFT))
+            return false;
+    }
+    return true;
+}
+
+static bool sameColumns(const std::vector<CoveragePyramid::Column>& a, const std::vector<CoveragePyramid::Column>& b)
+{
+    for (size_t c = 0; c < a.size(); ++c)
+    {
+        if (a[c].start != b[c].start || a[c].end != b[c].end || a[c].coveredSamples != b[c].coveredSamples
+            || a[c].dropout != b[c].dropout || a[c].gap != b[c].gap)
+            return false;
+    }
+    return a.size() == b.size();
+}
+
+static bool checkCopies()
+{
+    std::mt19937_64 rng(23);
+    Coverage coverage;
+    Mach1::CoveragePyramidPublisher publisher;
+    std::shared_ptr<const CoveragePyramid> held;
+    int64_t position = 0;
+    for (int round = 0; round < 50; ++round)
+    {
+        // Every third round a reader holds on to the copy, so the next publish cannot reuse it
+        const auto copy = publisher.publish(coverage.pyramid);
+        if (round % 3 == 0)
+            held = copy;
+        const auto bounds = coverage.pyramid.getBoundingInterval();
+        const int64_t viewEnd = bounds.end + (int64_t(1) << 22);
+        std::vector<CoveragePyramid::Column> before(300), after(300), original(300);
+        copy->getColumns(bounds.start, viewEnd, 300, before.data());
+        coverage.pyramid.getColumns(bounds.start, viewEnd, 300, original.data());
+        if (!sameColumns(before, original))
+        {
+            std::cout << "FAIL: a published copy differs from the original (round " << round << ")\n";
+            return false;
+        }
+
+        // Capture on, with a dropout and an earlier block now and then
+        for (int i = 0; i < 2000; ++i)
+        {
+            if (rng() % 100 == 0)
+            {
+                coverage.addDropout(position, position + BLOCK_SAMPLES);
+                position += BLOCK_SAMPLES;
+            }
+            coverage.add(position, position + BLOCK_SAMPLES);
+            position += BLOCK_SAMPLES;
+        }
+        coverage.add(-(int64_t(1) << 24) - round * BLOCK_SAMPLES * 2, -(int64_t(1) << 24) - round * BLOCK_SAMPLES * 2 + BLOCK_SAMPLES);
+
+        copy->getColumns(bounds.start, viewEnd, 300, after.data());
+        if (!sameColumns(before, after))
+        {
+            std::cout << "FAIL: a copy changed when the original was written to (round " << round << ")\n";
+            return false;
+        }
+
+        if (round == 30)
+        {
+            coverage.intervals = CapturedIntervalSet();
+            coverage.dropouts = CapturedIntervalSet();
+            coverage.pyramid.clear();
+            position = int64_t(1) << 30;
+        }
+    }
+
+    const auto bounds = coverage.intervals.getBoundingInterval();
+    if (!matchesIntervals(coverage, bounds.start, bounds.end, 500))
+    {
+        std::cout << "FAIL: columns after copies were taken\n";
+        return false;
+    }
+    return true;
+}
+
+static bool checkCorrectness()
+{
+    std::mt19937_64 rng(11);
+    for (int round = 0; round < 200; ++round)
+    {
+        Coverage coverage;
+        const int64_t span = int64_t(1) << (14 + rng() % 12);
+        for (int i = 0; i < 200; ++i)
+        {
+            const int64_t start = static_cast<int64_t>(rng() % static_cast<uint64_t>(span)) - span / 4;
+            const int64_t length = 1 + static_cast<int64_t>(rng() % static_cast<uint64_t>(span / 16));
+            if (rng() % 8 == 0)
+                coverage.addDropout(start, start + length);
+            else
+                coverage.add(start, start + length);
+        }
+
+        for (int view = 0; view < 10; ++view)
+        {
+            const int64_t viewStart = static_cast<int64_t>(rng() % static_cast<uint64_t>(span)) - span / 2;
+            const int64_t viewEnd = viewStart + 1 + static_cast<int64_t>(rng() % static_cast<uint64_t>(span * 2));
+            const int numColumns = 1 + static_cast<int>(rng() % 700);
+            if (!matchesIntervals(coverage, viewStart, viewEnd, numColumns))
+            {
+                std::cout << "FAIL: round " << round << ", view [" << viewStart << ", " << viewEnd
+                          << ") in " << numColumns << " columns\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const int pixels = argc > 1 ? std::atoi(argv[1]) : 1200;
+    if (pixels <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [pixels]\n";
+        return 1;
+    }
+
+    if (!checkCorrectness())
+        return 1;
+    std::cout << "Columns match the intervals (covered samples, dropouts, gaps; estimate within a bucket): OK\n";
+    if (!checkCopies())
+        return 1;
+    std::cout << "Copies keep their columns while the original captures on: OK\n\n";
+
+    std::cout << std::setw(8) << "minutes" << std::setw(10) << "spans" << std::setw(12) << "pyramid KB"
+              << std::setw(16) << "intervals us" << std::setw(14) << "pyramid us" << std::setw(15) << "snapshot us"
+              << std::setw(14) << "publish us" << "\n";
+
+    std::mt19937_64 rng(5);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    for (double minutes : { 1.0, 10.0, 60.0, 240.0, 720.0, 1440.0 })
+    {
+        Coverage coverage;
+        const int64_t numBlocks = static_cast<int64_t>(minutes * 60.0 * SAMPLE_RATE / BLOCK_SAMPLES);
+        int64_t position = 0;
+        for (int64_t block = 0; block < numBlocks; ++block)
+        {
+            if (chance(rng) < DROPOUT_CHANCE)
+            {
+                const int64_t missed = BLOCK_SAMPLES * static_cast<int64_t>(1 + rng() % 4);
+                coverage.addDropout(position, position + missed);
+                position += missed;
+            }
+            coverage.add(position, position + BLOCK_SAMPLES);
+            position += BLOCK_SAMPLES;
+        }
+
+        const auto bounds = coverage.intervals.getBoundingInterval();
+        if (!matchesIntervals(coverage, bounds.start, bounds.end, pixels))
+        {
+            std::cout << "FAIL: full view of " << minutes << " min\n";
+            return 1;
+        }
+
+        // Full view, as an auto-zoomed timeline shows it
+        const int refreshes = 20;
+        volatile int64_t sink = 0;
+        double start = nowSeconds();
+        size_t spans = 0;
+        for (int i = 0; i < refreshes; ++i)
+        {
+            const double samplesPerPixel = static_cast<double>(bounds.length()) / pixels;
+            spans = 0;
+            for (const auto& list : { coverage.intervals.getIntervals(), coverage.intervals.getGaps(),
+                                      coverage.dropouts.getIntervals() })
+            {
+                for (const auto& interval : list)
+                    sink = sink + static_cast<int64_t>((interval.start - bounds.start) / samplesPerPixel)
+                                + static_cast<int64_t>((interval.end - bounds.start) / samplesPerPixel);
+                spans += list.size();
+            }
+        }
+        const double intervalRefresh = (nowSeconds() - start) / refreshes;
+
+        std::vector<CoveragePyramid::Column> columns(static_cast<size_t>(pixels));
+        start = nowSeconds();
+        for (int i = 0; i < refreshes; ++i)
+        {
+            coverage.pyramid.getColumns(bounds.start, bounds.end, pixels, columns.data(),
+                                        &coverage.intervals, &coverage.dropouts);
+            sink = sink + columns.back().coveredSamples;
+        }
+        const double pyramidRefresh = (nowSeconds() - start) / refreshes;
+
+        Mach1::CoveragePyramidPublisher publisher;
+        auto published = publisher.publish(coverage.pyramid);
+        start = nowSeconds();
+        for (int i = 0; i < refreshes; ++i)
+        {
+            published->getColumns(bounds.start, bounds.end, pixels, columns.data());
+            sink = sink + columns.back().coveredSamples;
+        }
+        const double snapshotRefresh = (nowSeconds() - start) / refreshes;
+
+        // Done drawing, so the copy can be reused; one more block makes the second copy
+        published.reset();
+        coverage.add(position, position + BLOCK_SAMPLES);
+        position += BLOCK_SAMPLES;
+        publisher.publish(coverage.pyramid);
+        start = nowSeconds();
+        for (int i = 0; i < refreshes; ++i)
+        {
+            coverage.add(position, position + BLOCK_SAMPLES);
+            position += BLOCK_SAMPLES;
+            sink = sink + static_cast<int64_t>(publisher.publish(coverage.pyramid)->isEmpty());
+        }
+        const double publish = (nowSeconds() - start) / refreshes;
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(8) << minutes
+                  << std::setw(10) << spans
+                  << std::setw(12) << static_cast<double>(coverage.pyramid.getMemoryBytes()) / 1024.0
+                  << std::setw(16) << intervalRefresh * 1e6
+                  << std::setw(14) << pyramidRefresh * 1e6
+                  << std::setw(15) << snapshotRefresh * 1e6
+                  << std::setw(14) << publish * 1e6 << "\n";
+    }
+
+    return 0;
+}
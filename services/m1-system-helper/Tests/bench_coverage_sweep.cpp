@@ -0,0 +1,241 @@
+/**
+ * Coverage Sweep Benchmark
+ *
+ * Compares CoverageSweep (one k-way sweep-line pass yielding any, all and k-of-n
+ * coverage, total dropouts and the union of recorded dropouts) with what
+ * CoverageModel did before for one timeline refresh: getGlobalStats, getAnyCoverage,
+ * getAnyDropouts and getAllDropouts, each rebuilding its own view, with all coverage
+ * intersected panner by panner in nested loops.
+ *
+ * Every panner captures [minutes] of 512-sample blocks at 48 kHz with random dropouts
+ * (coverage gets more fragmented with [dropouts per minute]). Results are first
+ * checked against a per-sample count on a small session.
+ *
+ * Build: clang++ -std=c++17 -O2 -o bench_coverage_sweep bench_coverage_sweep.cpp ../Source/Core/CoverageSweep.cpp ../Source/Core/CapturedIntervalSet.cpp
+ * Usage: ./bench_coverage_sweep [panners] [minutes] [dropouts per minute]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+#include "../Source/Core/CoverageSweep.h"
+
+using Mach1::CapturedIntervalSet;
+using Mach1::CoverageSweep;
+using Mach1::SampleInterval;
+
+static constexpr int64_t BLOCK_SAMPLES = 512;
+static constexpr int64_t SAMPLE_RATE = 48000;
+
+static double nowSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Panner
+{
+    CapturedIntervalSet coverage;
+    CapturedIntervalSet dropouts;
+};
+
+static std::vector<Panner> makePanners(int numPanners, int64_t numSamples, double dropoutsPerMinute, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    const double dropoutChance = dropoutsPerMinute * BLOCK_SAMPLES / (60.0 * SAMPLE_RATE);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    std::vector<Panner> panners(static_cast<size_t>(numPanners));
+    for (auto& panner : panners)
+    {
+        int64_t position = static_cast<int64_t>(rng() % 16) * BLOCK_SAMPLES;    // Panners start apart
+        while (position < numSamples)
+        {
+            if (chance(rng) < dropoutChance)
+            {
+                const int64_t missed = (1 + static_cast<int64_t>(rng() % 8)) * BLOCK_SAMPLES;
+                panner.dropouts.addInterval(position, position + missed);
+                position += missed;
+                continue;
+            }
+            panner.coverage.addInterval(position, position + BLOCK_SAMPLES);
+            position += BLOCK_SAMPLES;
+        }
+    }
+    return panners;
+}
+
+//==============================================================================
+// The previous CoverageModel queries, kept here only as the baseline
+
+static CapturedIntervalSet previousAnyCoverage(const std::vector<Panner>& panners)
+{
+    CapturedIntervalSet combined;
+    for (const auto& panner : panners)
+        for (const auto& interval : panner.coverage)
+            combined.addInterval(interval);
+    return combined;
+}
+
+static CapturedIntervalSet previousAllCoverage(const std::vector<Panner>& panners)
+{
+    if (panners.empty())
+        return CapturedIntervalSet();
+
+    std::vector<SampleInterval> result = panners[0].coverage.getIntervals();
+    for (size_t p = 1; p < panners.size(); ++p)
+    {
+        std::vector<SampleInterval> intersection;
+        for (const auto& r : result)
+        {
+            for (const auto& o : panners[p].coverage)
+            {
+                const int64_t start = std::max(r.start, o.start);
+                const int64_t end = std::min(r.end, o.end);
+                if (start < end)
+                    intersection.push_back(SampleInterval(start, end));
+            }
+        }
+        result = std::move(intersection);
+    }
+
+    CapturedIntervalSet allCoverage;
+    for (const auto& interval : result)
+        allCoverage.addInterval(interval);
+    return allCoverage;
+}
+
+static std::vector<SampleInterval> previousAnyDropouts(const std::vector<Panner>& panners)
+{
+    CapturedIntervalSet dropoutSet;
+    for (const auto& panner : panners)
+        for (const auto& dropout : panner.dropouts)
+            dropoutSet.addInterval(dropout);
+    return dropoutSet.getIntervals();
+}
+
+struct Refresh
+{
+    int64_t captured = 0;
+    int64_t full = 0;
+    std::vector<SampleInterval> coverage;
+    std::vector<SampleInterval> anyDropouts;
+    std::vector<SampleInterval> allDropouts;
+};
+
+static Refresh previousRefresh(const std::vector<Panner>& panners)
+{
+    Refresh refresh;
+    refresh.captured = previousAnyCoverage(panners).getTotalCapturedSamples();     // getGlobalStats
+    refresh.full = previousAllCoverage(panners).getTotalCapturedSamples();
+    refresh.coverage = previousAnyCoverage(panners).getIntervals();                // getAnyCoverage
+    refresh.anyDropouts = previousAnyDropouts(panners);                            // getAnyDropouts
+    refresh.allDropouts = previousAnyCoverage(panners).getGaps();                  // getAllDropouts
+    return refresh;
+}
+
+static Refresh sweepRefresh(const std::vector<Panner>& panners)
+{
+    CoverageSweep sweep;
+    for (const auto& panner : panners)
+        sweep.addPanner(panner.coverage, &panner.dropouts);
+    auto result = sweep.run();
+
+    Refresh refresh;
+    refresh.captured = result.anyCoverage.getTotalCapturedSamples();
+    refresh.full = result.allCoverage.getTotalCapturedSamples();
+    refresh.coverage = result.anyCoverage.getIntervals();
+    refresh.anyDropouts = std::move(result.anyDropouts);
+    refresh.allDropouts = std::move(result.totalDropouts);
+    return refresh;
+}
+
+//==============================================================================
+static bool checkCorrectness()
+{
+    for (uint64_t seed = 1; seed <= 20; ++seed)
+    {
+        const int numPanners = 1 + static_cast<int>(seed % 7);
+        const int64_t numSamples = 200 * BLOCK_SAMPLES;
+        const auto panners = makePanners(numPanners, numSamples, 3000.0, seed);
+
+        const Refresh previous = previousRefresh(panners);
+        const Refresh swept = sweepRefresh(panners);
+        if (previous.captured != swept.captured || previous.full != swept.full || previous.coverage != swept.coverage
+            || previous.anyDropouts != swept.anyDropouts || previous.allDropouts != swept.allDropouts)
+        {
+            std::cout << "FAIL: sweep differs from the previous queries (seed " << seed << ")\n";
+            return false;
+        }
+
+        // k of n against a per-sample count
+        const int64_t end = numSamples + 16 * BLOCK_SAMPLES;
+        std::vector<int> counts(static_cast<size_t>(end), 0);
+        for (const auto& panner : panners)
+            for (const auto& interval : panner.coverage)
+                for (int64_t s = interval.start; s < interval.end; ++s)
+                    counts[static_cast<size_t>(s)]++;
+
+        CoverageSweep sweep;
+        for (const auto& panner : panners)
+            sweep.addPanner(panner.coverage);
+        for (int k = 1; k <= numPanners; ++k)
+        {
+            const auto result = sweep.run(static_cast<uint32_t>(k));
+            for (int64_t s = 0; s < end; ++s)
+            {
+                if (result.minCoverage.isCovered(s) != (counts[static_cast<size_t>(s)] >= k))
+                {
+                    std::cout << "FAIL: " << k << " of " << numPanners << " coverage at sample " << s << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const int numPanners = argc > 1 ? std::atoi(argv[1]) : 100;
+    const double minutes = argc > 2 ? std::atof(argv[2]) : 10.0;
+    const double dropoutsPerMinute = argc > 3 ? std::atof(argv[3]) : 6.0;
+    if (numPanners <= 0 || minutes <= 0.0 || dropoutsPerMinute < 0.0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [panners] [minutes] [dropouts per minute]\n";
+        return 1;
+    }
+
+    if (!checkCorrectness())
+        return 1;
+    std::cout << "Sweep matches the previous queries and a per-sample count: OK\n\n";
+
+    const auto panners = makePanners(numPanners, static_cast<int64_t>(minutes * 60.0 * SAMPLE_RATE), dropoutsPerMinute, 42);
+    size_t intervals = 0;
+    for (const auto& panner : panners)
+        intervals += panner.coverage.getIntervalCount() + panner.dropouts.getIntervalCount();
+    std::cout << numPanners << " panners, " << minutes << " min, " << intervals << " intervals\n";
+
+    auto time = [](auto&& refresh, int runs) {
+        size_t sink = 0;
+        const double start = nowSeconds();
+        for (int i = 0; i < runs; ++i)
+            sink += refresh().coverage.size();
+        return std::make_pair((nowSeconds() - start) * 1000.0 / runs, sink);
+    };
+
+    const auto previous = time([&] { return previousRefresh(panners); }, 3);
+    const auto swept = time([&] { return sweepRefresh(panners); }, 20);
+    std::cout << std::fixed << std::setprecision(3)
+              << "previous queries: " << std::setw(10) << previous.first << " ms per refresh\n"
+              << "sweep:            " << std::setw(10) << swept.first << " ms per refresh ("
+              << std::setprecision(1) << previous.first / swept.first << "x)\n";
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+/**
+ * M1MemoryShare Doorbell Latency Benchmark
+ *
+ * Measures how long a consumer takes to notice a newly published ring block, and how
+ * much CPU it burns while waiting, for:
+ *   - polling with a fixed sleep (what CaptureEngine did, 5 ms)
+ *   - blocking on the ring doorbell (M1MemoryShareRing::waitForPublish)
+ *
+ * The producer runs in a forked process and publishes into a MAP_SHARED mapping, so the
+ * doorbell is exercised across processes exactly as between the panner and the helper.
+ *
+ * Build: clang++ -std=c++17 -O2 -o bench_doorbell_latency bench_doorbell_latency.cpp
+ * Usage: ./bench_doorbell_latency [blocks] [intervalUs]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../Source/Common/M1MemoryShareRing.h"
+
+static uint64_t nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static double cpuSeconds()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+struct RunResult
+{
+    std::vector<double> latenciesUs;
+    double cpuSeconds = 0.0;
+    double wallSeconds = 0.0;
+};
+
+/**
+ * Publish `blocks` blocks, each stamped with its publish time, `intervalUs` apart
+ */
+static void runProducer(void* base, size_t size, int blocks, int intervalUs)
+{
+    M1MemoryShareRing ring;
+    if (!ring.attach(base, size))
+        _exit(1);
+
+    // Give the consumer time to block before the first publish
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    for (int i = 0; i < blocks; ++i)
+    {
+        uint64_t sequence = 0;
+        uint8_t* payload = ring.beginWrite(sequence);
+        if (payload != nullptr)
+        {
+            uint64_t stamp = nowNs();
+            std::memcpy(payload, &stamp, sizeof(stamp));
+            ring.commitWrite(sequence, sizeof(stamp));
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(intervalUs));
+    }
+    _exit(0);
+}
+
+static RunResult runConsumer(bool useDoorbell, int blocks, int intervalUs)
+{
+    const size_t size = M1MemoryShareRing::segmentSizeFor(64, M1MemoryShareRing::slotStrideFor(64), 0);
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        std::cerr << "ERROR: mmap failed\n";
+        std::exit(1);
+    }
+
+    M1MemoryShareRing ring;
+    ring.create(base, size, 64, 0, "bench");
+    int consumer = ring.registerConsumer(1);
+
+    RunResult result;
+    result.latenciesUs.reserve(static_cast<size_t>(blocks));
+
+    double cpuStart = cpuSeconds();
+    uint64_t wallStart = nowNs();
+
+    pid_t pid = fork();
+    if (pid == 0)
+        runProducer(base, size, blocks, intervalUs);
+
+    // Stop after the last block, or if the producer stalls for a second
+    uint64_t lastActivity = nowNs();
+    while (static_cast<int>(result.latenciesUs.size()) < blocks && nowNs() - lastActivity < 1000000000ull)
+    {
+        if (useDoorbell)
+            ring.waitForPublish(consumer, 100);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        uint64_t sequence = 0, lost = 0;
+        uint32_t payloadSize = 0;
+        while (const uint8_t* payload = ring.acquireNext(consumer, sequence, payloadSize, lost))
+        {
+            uint64_t stamp = 0;
+            std::memcpy(&stamp, payload, sizeof(stamp));
+            result.latenciesUs.push_back((nowNs() - stamp) / 1000.0);
+            ring.release(consumer, sequence);
+            lastActivity = nowNs();
+        }
+    }
+
+    result.wallSeconds = (nowNs() - wallStart) / 1e9;
+    result.cpuSeconds = cpuSeconds() - cpuStart;
+
+    waitpid(pid, nullptr, 0);
+    munmap(base, size);
+    return result;
+}
+
+static void printResult(const char* name, RunResult result)
+{
+    auto& l = result.latenciesUs;
+    std::sort(l.begin(), l.end());
+    auto pct = [&l](double p) { return l.empty() ? 0.0 : l[std::min(l.size() - 1, static_cast<size_t>(p * l.size()))]; };
+
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << l.size()
+              << std::setw(12) << pct(0.50)
+              << std::setw(12) << pct(0.99)
+              << std::setw(12) << (l.empty() ? 0.0 : l.back())
+              << std::setw(12) << std::setprecision(2) << (100.0 * result.cpuSeconds / result.wallSeconds) << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int blocks = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int intervalUs = argc > 2 ? std::atoi(argv[2]) : 2900;   // ~512 samples at 176.4 kHz / 128 at 44.1 kHz
+
+    std::cout << "Doorbell latency: " << blocks << " blocks, " << intervalUs << " us apart\n";
+    std::cout << "Native wait available: " << (M1MemoryShareDoorbell::isNativeWaitAvailable() ? "yes" : "no (sleep fallback)") << "\n\n";
+    std::cout << std::left << std::setw(18) << "mode" << std::right
+              << std::setw(8) << "blocks" << std::setw(12) << "p50 (us)" << std::setw(12) << "p99 (us)"
+              << std::setw(12) << "max (us)" << std::setw(12) << "cpu (%)" << "\n";
+
+    printResult("poll 5 ms", runConsumer(false, blocks, intervalUs));
+    printResult("doorbell", runConsumer(true, blocks, intervalUs));
+
+    // Idle cost: two blocks one second apart
+    std::cout << "\nIdle (2 blocks, 1 s apart):\n";
+    printResult("poll 5 ms", runConsumer(false, 2, 1000000));
+    printResult("doorbell", runConsumer(true, 2, 1000000));
+
+    return 0;
+}
@@ -0,0 +1,290 @@
+/**
+ * CapturedIntervalSet Benchmark
+ *
+ * Compares the tree-based CapturedIntervalSet against the previous sorted-vector
+ * implementation (in-place merge with two binary searches, linear isCovered) at
+ * 10^3 to 10^6 disjoint intervals, for the work the coverage model does:
+ *   - append:  capture order, 512-sample blocks with a dropout gap every few blocks
+ *              (the per-block CoverageModel::addPannerInterval path)
+ *   - random:  the same intervals added in random order (recovery, out-of-order blocks)
+ *   - covered: isCovered lookups at random sample positions
+ *   - range:   covered samples in a random window of ~1% of the session
+ * Every workload is first checked against the baseline on randomized overlapping
+ * inputs. Baseline runs that would take minutes are skipped ("-").
+ *
+ * Build: clang++ -std=c++17 -O2 -o bench_interval_set bench_interval_set.cpp ../Source/Core/CapturedIntervalSet.cpp
+ * Usage: ./bench_interval_set [max intervals]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+#include "../Source/Core/CapturedIntervalSet.h"
+
+using Mach1::CapturedIntervalSet;
+using Mach1::SampleInterval;
+
+static constexpr int64_t BLOCK_SAMPLES = 512;
+static constexpr int BLOCKS_PER_INTERVAL = 4;      // Blocks between dropout gaps
+static constexpr size_t BASELINE_RANDOM_LIMIT = 100000;
+static constexpr double BASELINE_SCAN_BUDGET = 2e9; // Interval visits per baseline lookup run
+
+static double nowSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * The previous CapturedIntervalSet, kept here only as the baseline
+ */
+class VectorIntervalSet
+{
+public:
+    void addInterval(int64_t start, int64_t end)
+    {
+        if (end <= start) return;
+
+        auto first = std::lower_bound(m_intervals.begin(), m_intervals.end(), start,
+                                      [](const SampleInterval& interval, int64_t value) { return interval.end < value; });
+        auto last = std::upper_bound(first, m_intervals.end(), end,
+                                     [](int64_t value, const SampleInterval& interval) { return value < interval.start; });
+
+        if (first == last)
+        {
+            m_intervals.insert(first, SampleInterval(start, end));
+            return;
+        }
+
+        first->start = std::min(first->start, start);
+        first->end = std::max((last - 1)->end, end);
+        m_intervals.erase(first + 1, last);
+    }
+
+    bool isCovered(int64_t sample) const
+    {
+        for (const auto& interval : m_intervals)
+        {
+            if (interval.contains(sample))
+                return true;
+        }
+        return false;
+    }
+
+    int64_t getCoveredSamples(const SampleInterval& range) const
+    {
+        int64_t covered = 0;
+        for (const auto& interval : m_intervals)
+        {
+            const int64_t start = std::max(interval.start, range.start);
+            const int64_t end = std::min(interval.end, range.end);
+            if (start < end)
+                covered += end - start;
+        }
+        return covered;
+    }
+
+    int64_t getTotalCapturedSamples() const
+    {
+        int64_t total = 0;
+        for (const auto& interval : m_intervals)
+            total += interval.length();
+        return total;
+    }
+
+    const std::vector<SampleInterval>& getIntervals() const { return m_intervals; }
+
+private:
+    std::vector<SampleInterval> m_intervals;
+};
+
+//==============================================================================
+static bool checkCorrectness()
+{
+    std::mt19937_64 rng(11);
+    for (int round = 0; round < 200; ++round)
+    {
+        CapturedIntervalSet tree;
+        VectorIntervalSet vector;
+        const int64_t span = 1 + static_cast<int64_t>(rng() % 5000);
+        const int operations = 1 + static_cast<int>(rng() % 400);
+        for (int i = 0; i < operations; ++i)
+        {
+            // Mostly short intervals, some long ones, some appends, some empty
+            int64_t start = static_cast<int64_t>(rng() % span) - span / 4;
+            int64_t length = static_cast<int64_t>(rng() % (rng() % 8 == 0 ? span : 40)) - 2;
+            if (rng() % 4 == 0 && !vector.getIntervals().empty())
+                start = vector.getIntervals().back().end - static_cast<int64_t>(rng() % 3);
+            tree.addInterval(start, start + length);
+            vector.addInterval(start, start + length);
+        }
+
+        if (tree.getIntervals() != vector.getIntervals()
+            || tree.getTotalCapturedSamples() != vector.getTotalCapturedSamples())
+        {
+            std::cout << "FAIL: intervals differ in round " << round << "\n";
+            return false;
+        }
+
+        for (int q = 0; q < 500; ++q)
+        {
+            const int64_t sample = static_cast<int64_t>(rng() % (2 * span)) - span / 2;
+            const SampleInterval range(sample, sample + static_cast<int64_t>(rng() % 200));
+            bool rangeCovered = true;
+            for (int64_t s = range.start; s < range.end && rangeCovered; ++s)
+                rangeCovered = vector.isCovered(s);
+            if (tree.isCovered(sample) != vector.isCovered(sample)
+                || tree.getCoveredSamples(range) != vector.getCoveredSamples(range)
+                || tree.isCovered(range) != rangeCovered)
+            {
+                std::cout << "FAIL: query at " << sample << " in round " << round << "\n";
+                return false;
+            }
+
+            int64_t clipped = 0;
+            for (const auto& interval : tree.getIntervalsInRange(range))
+                clipped += interval.length();
+            if (clipped != tree.getCoveredSamples(range))
+            {
+                std::cout << "FAIL: getIntervalsInRange at " << sample << " in round " << round << "\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//==============================================================================
+struct Timing
+{
+    double tree = 0.0;      // ns per operation
+    double vector = -1.0;   // -1: skipped
+};
+
+static std::vector<SampleInterval> makeCaptureBlocks(size_t numIntervals)
+{
+    std::vector<SampleInterval> blocks;
+    blocks.reserve(numIntervals * BLOCKS_PER_INTERVAL);
+    int64_t position = 0;
+    for (size_t i = 0; i < numIntervals; ++i)
+    {
+        for (int b = 0; b < BLOCKS_PER_INTERVAL; ++b, position += BLOCK_SAMPLES)
+            blocks.emplace_back(position, position + BLOCK_SAMPLES);
+        position += BLOCK_SAMPLES;  // Dropout
+    }
+    return blocks;
+}
+
+template <typename Set>
+static double timeAdds(const std::vector<SampleInterval>& intervals, Set& set)
+{
+    const double start = nowSeconds();
+    for (const auto& interval : intervals)
+        set.addInterval(interval.start, interval.end);
+    return (nowSeconds() - start) * 1e9 / static_cast<double>(intervals.size());
+}
+
+template <typename Set, typename Query>
+static double timeQueries(const Set& set, size_t numQueries, int64_t span, Query&& query)
+{
+    std::mt19937_64 rng(5);
+    std::vector<int64_t> samples(numQueries);
+    for (auto& sample : samples)
+        sample = static_cast<int64_t>(rng() % static_cast<uint64_t>(span));
+
+    volatile int64_t sink = 0;
+    const double start = nowSeconds();
+    for (int64_t sample : samples)
+        sink = sink + query(set, sample);
+    return (nowSeconds() - start) * 1e9 / static_cast<double>(numQueries);
+}
+
+static void printRow(const std::string& name, size_t numIntervals, const Timing& timing)
+{
+    std::cout << std::setw(10) << name << std::setw(10) << numIntervals << std::setw(14) << std::fixed
+              << std::setprecision(1) << timing.tree;
+    if (timing.vector >= 0.0)
+        std::cout << std::setw(14) << timing.vector << std::setw(10) << std::setprecision(1) << timing.vector / timing.tree << "x";
+    else
+        std::cout << std::setw(14) << "-" << std::setw(11) << "-";
+    std::cout << "\n";
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const size_t maxIntervals = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 1000000;
+    if (maxIntervals < 1000)
+    {
+        std::cerr << "Usage: " << argv[0] << " [max intervals >= 1000]\n";
+        return 1;
+    }
+
+    if (!checkCorrectness())
+        return 1;
+    std::cout << "Randomized comparison with the sorted-vector baseline: OK\n\n";
+
+    std::cout << std::setw(10) << "workload" << std::setw(10) << "intervals" << std::setw(14) << "tree ns/op"
+              << std::setw(14) << "vector ns/op" << std::setw(11) << "speedup" << "\n";
+
+    for (size_t numIntervals = 1000; numIntervals <= maxIntervals; numIntervals *= 10)
+    {
+        const auto blocks = makeCaptureBlocks(numIntervals);
+        const int64_t span = blocks.back().end;
+
+        // Capture order
+        Timing append;
+        CapturedIntervalSet tree;
+        VectorIntervalSet vector;
+        append.tree = timeAdds(blocks, tree);
+        append.vector = timeAdds(blocks, vector);
+        printRow("append", numIntervals, append);
+
+        // Random order, one add per interval
+        std::vector<SampleInterval> shuffled;
+        shuffled.reserve(numIntervals);
+        for (size_t i = 0; i < numIntervals; ++i)
+            shuffled.push_back(SampleInterval(blocks[i * BLOCKS_PER_INTERVAL].start,
+                                              blocks[i * BLOCKS_PER_INTERVAL + BLOCKS_PER_INTERVAL - 1].end));
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937_64(3));
+        Timing random;
+        CapturedIntervalSet randomTree;
+        random.tree = timeAdds(shuffled, randomTree);
+        if (numIntervals <= BASELINE_RANDOM_LIMIT)
+        {
+            VectorIntervalSet randomVector;
+            random.vector = timeAdds(shuffled, randomVector);
+        }
+        printRow("random", numIntervals, random);
+
+        // Lookups; the baseline scans every interval, so it gets fewer queries
+        const size_t queries = 1000000;
+        const size_t baselineQueries = std::max<size_t>(10, std::min(queries, static_cast<size_t>(BASELINE_SCAN_BUDGET / numIntervals)));
+        Timing covered;
+        covered.tree = timeQueries(tree, queries, span, [](const CapturedIntervalSet& set, int64_t sample) {
+            return set.isCovered(sample) ? 1 : 0;
+        });
+        covered.vector = timeQueries(vector, baselineQueries, span, [](const VectorIntervalSet& set, int64_t sample) {
+            return set.isCovered(sample) ? 1 : 0;
+        });
+        printRow("covered", numIntervals, covered);
+
+        const int64_t window = std::max<int64_t>(BLOCK_SAMPLES, span / 100);
+        Timing range;
+        range.tree = timeQueries(tree, queries / 10, span, [window](const CapturedIntervalSet& set, int64_t sample) {
+            return set.getCoveredSamples(SampleInterval(sample, sample + window));
+        });
+        range.vector = timeQueries(vector, baselineQueries, span, [window](const VectorIntervalSet& set, int64_t sample) {
+            return set.getCoveredSamples(SampleInterval(sample, sample + window));
+        });
+        printRow("range", numIntervals, range);
+    }
+
+    return 0;
+}
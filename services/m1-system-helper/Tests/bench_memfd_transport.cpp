@@ -0,0 +1,179 @@
+/**
+ * M1MemoryShare memfd Transport Benchmark (Linux)
+ *
+ * Measures discovery through M1MemoryShareFdTransport instead of the file scan:
+ *   - each round forks a "panner" that creates a sealed memfd ring segment, announces it
+ *     to the listener, and exits a few milliseconds later
+ *   - the "helper" (this process) polls the listener, maps the received descriptor,
+ *     checks the ring, the size seal and the producer's process ID (from the socket's
+ *     credentials), then waits for the hang-up
+ *
+ * Reports announce-to-mapped latency and exit-to-hang-up latency (p50/p99/max). With the
+ * file transport the corresponding numbers are bounded by the 250 ms scan interval and,
+ * for removal, by the 30 s timeout plus a process check.
+ *
+ * Build: clang++ -std=c++17 -O2 -o bench_memfd_transport bench_memfd_transport.cpp
+ * Usage: ./bench_memfd_transport [rounds] [--huge-pages]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/wait.h>
+
+#include "../Source/Common/M1MemoryShareFdTransport.h"
+#include "../Source/Common/M1MemoryShareRing.h"
+
+#if !defined(M1_MEMORYSHARE_FD_TRANSPORT)
+int main()
+{
+    std::cout << "The memfd transport is only available on Linux\n";
+    return 0;
+}
+#else
+
+static uint64_t nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static const size_t SEGMENT_SIZE = 1024 * 1024;
+
+// Panner side: create, format, announce, then exit and leave the helper to notice
+static void runPanner(int round, uint32_t options)
+{
+    std::string name = "M1SpatialSystem_M1Panner_PID" + std::to_string(getpid()) + "_PTR0_T" + std::to_string(round);
+
+    size_t size = 0;
+    int fd = M1MemoryShareFdTransport::createSegment(name, SEGMENT_SIZE, options, size);
+    if (fd < 0)
+        _exit(2);
+
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    M1MemoryShareRing ring;
+    if (base == MAP_FAILED || !ring.create(base, size, 8, 0, name.c_str()))
+        _exit(3);
+
+    M1MemoryShareFdTransport::SegmentAnnouncement announcement;
+    announcement.processId = static_cast<uint32_t>(getpid());
+    announcement.creationTimestamp = nowNs();
+    announcement.segmentSize = size;
+    std::strncpy(announcement.name, name.c_str(), sizeof(announcement.name) - 1);
+
+    int connection = M1MemoryShareFdTransport::announceSegment(fd, announcement);
+    if (connection < 0)
+        _exit(4);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    // Exit time goes where the helper can read it after the hang-up
+    const uint8_t noParameters[1] = {};
+    ParameterStateFields fields = {};
+    fields.dawTimestamp = nowNs();
+    M1MemoryShareStatePage::write(*ring.getStatePage(), fields, noParameters);
+    _exit(0);
+}
+
+static void printLatency(const char* name, std::vector<double> l)
+{
+    std::sort(l.begin(), l.end());
+    auto pct = [&l](double p) { return l.empty() ? 0.0 : l[std::min(l.size() - 1, static_cast<size_t>(p * l.size()))]; };
+
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << pct(0.50) / 1000.0
+              << std::setw(10) << pct(0.99) / 1000.0
+              << std::setw(10) << (l.empty() ? 0.0 : l.back() / 1000.0) << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 200;
+    uint32_t options = M1MemoryShareFdTransport::SEGMENT_SEALED;
+    for (int i = 1; i < argc; ++i)
+        if (std::strcmp(argv[i], "--huge-pages") == 0)
+            options |= M1MemoryShareFdTransport::SEGMENT_HUGE_PAGES;
+
+    M1MemoryShareFdTransport::Listener listener;
+    if (!listener.start())
+    {
+        std::cerr << "ERROR: could not listen (is a helper already running?)\n";
+        return 1;
+    }
+
+    std::vector<double> discoveryNs, hangupNs;
+    int failures = 0;
+
+    for (int round = 0; round < rounds; ++round)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            listener.stop();
+            runPanner(round, options);
+        }
+
+        std::vector<M1MemoryShareFdTransport::ReceivedSegment> received;
+        std::vector<int> closed;
+        void* base = nullptr;
+        size_t size = 0;
+        int connection = -1;
+        M1MemoryShareRing ring;
+
+        // Wait for the announcement, then for the hang-up
+        const uint64_t deadline = nowNs() + 2000000000ull;
+        while (nowNs() < deadline)
+        {
+            received.clear();
+            closed.clear();
+            listener.poll(100, received, closed);
+
+            for (auto& segment : received)
+            {
+                discoveryNs.push_back(static_cast<double>(nowNs() - segment.announcement.creationTimestamp));
+                size = M1MemoryShareFdTransport::getSegmentSize(segment.fd);
+                base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, segment.fd, 0);
+                if (base == MAP_FAILED || !ring.attach(base, size) || !M1MemoryShareFdTransport::isSizeSealed(segment.fd)
+                    || segment.processId != static_cast<uint32_t>(pid)
+                    || std::strncmp(ring.getHeader()->name, segment.announcement.name, sizeof(segment.announcement.name)) != 0)
+                    ++failures;
+                close(segment.fd);
+                connection = segment.connection;
+            }
+
+            if (connection >= 0 && std::find(closed.begin(), closed.end(), connection) != closed.end())
+            {
+                const uint64_t detected = nowNs();
+                ParameterStateSnapshot snapshot;
+                if (ring.isAttached() && M1MemoryShareStatePage::read(*ring.getStatePage(), snapshot) && snapshot.fields.dawTimestamp != 0)
+                    hangupNs.push_back(static_cast<double>(detected - snapshot.fields.dawTimestamp));
+                break;
+            }
+        }
+
+        if (connection < 0)
+            ++failures;
+        if (base != nullptr && base != MAP_FAILED)
+            munmap(base, size);
+        waitpid(pid, nullptr, 0);
+    }
+
+    std::cout << "memfd transport: " << rounds << " rounds, "
+              << ((options & M1MemoryShareFdTransport::SEGMENT_HUGE_PAGES) != 0 ? "huge pages requested" : "normal pages") << "\n\n";
+    std::cout << std::left << std::setw(22) << "latency" << std::right
+              << std::setw(10) << "p50 (us)" << std::setw(10) << "p99 (us)" << std::setw(10) << "max (us)" << "\n";
+    printLatency("announce -> mapped", discoveryNs);
+    printLatency("exit -> hang-up", hangupNs);
+
+    std::cout << "\n" << (failures == 0 ? "PASS" : "FAIL") << ": " << failures << " rounds failed\n";
+    return failures == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,414 @@
+/**
+ * M1MemoryShare Loopback Throughput Benchmark
+ *
+ * Runs the panner-side write path against helper-side consumers on one machine:
+ *   - N forked producer processes, each with its own ring segment (MAP_SHARED), serialize
+ *     blocks exactly like M1MemoryShare::writeAudioBufferWithGenericParameters
+ *     (M1MemoryShareBlock::write + ring publish + parameter state page)
+ *   - C consumer threads, each registered on every ring, decode the parameters and copy
+ *     the audio out like the capture engine does
+ *
+ * For every channel count / block size it reports consumed blocks per second, the
+ * producer-to-consumer latency (p50/p99/p999, stamped in a BUFFER_TIMESTAMP parameter)
+ * and the fraction of blocks the producers dropped because a consumer fell behind. Dropped
+ * blocks use up a sequence number like the real write path's, and the last column is the
+ * share of them the consumers saw as sequence gaps (drops after the last published block
+ * cannot show).
+ *
+ * By default producers write flat out (load test); --realtime paces each producer at
+ * its block duration like a DAW would. Consumers spin between blocks so the latency
+ * numbers reflect the transport rather than a wake-up interval. --planar makes the
+ * producers write AUDIO_PLANAR blocks (no interleave pass).
+ *
+ * Before the runs, an interleaved and a planar block are written and read back through the
+ * audioLayout strides the helper uses (M1MemoryShare::parseBlock); a mismatch exits with 1.
+ *
+ * Build: clang++ -std=c++17 -O2 -pthread -o bench_memory_share_loopback bench_memory_share_loopback.cpp
+ * Usage: ./bench_memory_share_loopback [producers] [consumers] [seconds] [--realtime] [--planar]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../Source/Common/M1MemoryShareRing.h"
+#include "../Source/Common/M1MemoryShareBlock.h"
+
+using IDs = M1SystemHelperParameterIDs;
+
+static constexpr uint32_t SAMPLE_RATE = 48000;
+static constexpr uint32_t SLOT_COUNT = 8;           // M1MemoryShare's default maxQueueSize
+static constexpr size_t PARAMETER_BUDGET = 512;     // Room reserved per slot for the parameter stream
+
+static uint64_t nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+struct Segment
+{
+    void* base = nullptr;
+    size_t size = 0;
+    M1MemoryShareRing ring;
+};
+
+struct Config
+{
+    int producers = 4;
+    int consumers = 1;
+    double seconds = 1.0;
+    bool realtime = false;
+    uint32_t audioLayout = GenericAudioBufferHeader::AUDIO_INTERLEAVED;
+};
+
+struct RunResult
+{
+    uint64_t consumed = 0;
+    uint64_t published = 0;
+    uint64_t dropped = 0;
+    uint64_t gaps = 0;                  // Sequence numbers the consumers saw skipped (summed over consumers)
+    double seconds = 0.0;
+    std::vector<double> latenciesUs;
+};
+
+static void fillPannerParameters(ParameterMap& parameters)
+{
+    parameters.addFloat(IDs::AZIMUTH, 45.0f);
+    parameters.addFloat(IDs::ELEVATION, 10.0f);
+    parameters.addFloat(IDs::DIVERGE, 50.0f);
+    parameters.addFloat(IDs::GAIN, 0.0f);
+    parameters.addFloat(IDs::STEREO_ORBIT_AZIMUTH, 0.0f);
+    parameters.addFloat(IDs::STEREO_SPREAD, 50.0f);
+    parameters.addFloat(IDs::STEREO_INPUT_BALANCE, 0.0f);
+    parameters.addBool(IDs::AUTO_ORBIT, true);
+    parameters.addBool(IDs::ISOTROPIC_MODE, true);
+    parameters.addBool(IDs::EQUALPOWER_MODE, false);
+    parameters.addBool(IDs::GAIN_COMPENSATION_MODE, true);
+    parameters.addBool(IDs::LOCK_OUTPUT_LAYOUT, false);
+    parameters.addInt(IDs::INPUT_MODE, 1);
+    parameters.addInt(IDs::OUTPUT_MODE, 4);
+    parameters.addInt(IDs::PORT, 9001);
+    parameters.addInt(IDs::STATE, 1);
+    parameters.addInt(IDs::COLOR_R, 255);
+    parameters.addInt(IDs::COLOR_G, 128);
+    parameters.addInt(IDs::COLOR_B, 0);
+    parameters.addInt(IDs::COLOR_A, 255);
+    parameters.addString(IDs::DISPLAY_NAME, "Loopback Producer");
+}
+
+/**
+ * Producer process: same steps as writeAudioBufferWithGenericParameters on a ring segment
+ */
+static void runProducer(Segment& segment, uint32_t numChannels, uint32_t numSamples, const Config& config)
+{
+    std::vector<std::vector<float>> audio(numChannels, std::vector<float>(numSamples, 0.25f));
+    std::vector<const float*> channels;
+    for (auto& channel : audio)
+        channels.push_back(channel.data());
+
+    ParameterMap parameters;
+    fillPannerParameters(parameters);
+
+    const uint64_t blockNs = static_cast<uint64_t>(numSamples) * 1000000000ull / SAMPLE_RATE;
+    const uint64_t start = nowNs();
+    const uint64_t end = start + static_cast<uint64_t>(config.seconds * 1e9);
+    uint64_t deadline = start;
+    double playhead = 0.0;
+
+    while (nowNs() < end)
+    {
+        parameters.addUInt64(IDs::BUFFER_TIMESTAMP, nowNs());
+
+        uint8_t parameterData[PARAMETER_BUDGET];
+        uint32_t parameterCount = 0;
+        size_t parameterBytes = M1MemoryShareBlock::encodeParameters(parameters, parameterData, sizeof(parameterData), parameterCount);
+
+        GenericAudioBufferHeader header;
+        header.playheadPositionInSeconds = playhead;
+        header.isPlaying = 1;
+        header.sampleRate = SAMPLE_RATE;
+
+        uint64_t sequence = 0;
+        if (uint8_t* slot = segment.ring.beginWrite(sequence))
+        {
+            header.bufferId = sequence + 1;
+            header.sequenceNumber = static_cast<uint32_t>(sequence + segment.ring.getDroppedBlocks());
+            size_t blockSize = M1MemoryShareBlock::write(slot, segment.ring.getPayloadCapacity(), header,
+                                                         parameterData, parameterBytes, parameterCount,
+                                                         channels.data(), numChannels, numSamples, config.audioLayout);
+            segment.ring.commitWrite(sequence, static_cast<uint32_t>(blockSize));
+
+            ParameterStateFields fields = {};
+            fields.parameterCount = parameterCount;
+            fields.dataSize = static_cast<uint32_t>(parameterBytes);
+            fields.isPlaying = 1;
+            fields.playheadPositionInSeconds = playhead;
+            M1MemoryShareStatePage::write(*segment.ring.getStatePage(), fields, parameterData);
+        }
+
+        playhead += static_cast<double>(numSamples) / SAMPLE_RATE;
+        if (config.realtime)
+        {
+            deadline += blockNs;
+            uint64_t now = nowNs();
+            if (deadline > now)
+                std::this_thread::sleep_for(std::chrono::nanoseconds(deadline - now));
+        }
+    }
+    _exit(0);
+}
+
+/**
+ * Consumer thread: drain every ring, decode parameters and copy the audio out
+ */
+static void runConsumer(std::vector<Segment>& segments, uint32_t consumerId, std::atomic<bool>& stop,
+                        std::vector<double>& latenciesUs, uint64_t& consumed, uint64_t& gaps)
+{
+    std::vector<int> indices;
+    std::vector<uint32_t> nextSequence(segments.size(), 0);
+    for (auto& segment : segments)
+        indices.push_back(segment.ring.findConsumer(consumerId));
+
+    std::vector<float> scratch;
+    ParameterMap parameters;
+
+    while (true)
+    {
+        const bool stopping = stop.load(std::memory_order_acquire);
+        bool readAny = false;
+
+        for (size_t s = 0; s < segments.size(); ++s)
+        {
+            M1MemoryShareRing& ring = segments[s].ring;
+            uint64_t sequence = 0, lost = 0;
+            uint32_t payloadSize = 0;
+            const uint8_t* payload = ring.acquireNext(indices[s], sequence, payloadSize, lost);
+            if (payload == nullptr)
+                continue;
+
+            GenericAudioBufferHeader header;
+            std::memcpy(&header, payload, sizeof(header));
+            M1MemoryShareBlock::decodeParameters(payload + sizeof(header), header.headerSize - sizeof(header),
+                                                 header.parameterCount, parameters);
+            gaps += header.sequenceNumber - nextSequence[s];
+            nextSequence[s] = header.sequenceNumber + 1;
+
+            const size_t audioBytes = static_cast<size_t>(header.channels) * header.samples * sizeof(float);
+            scratch.resize(audioBytes / sizeof(float));
+            std::memcpy(scratch.data(), payload + header.headerSize, audioBytes);
+
+            if (ring.release(indices[s], sequence))
+            {
+                latenciesUs.push_back((nowNs() - parameters.getUInt64(IDs::BUFFER_TIMESTAMP)) / 1000.0);
+                ++consumed;
+            }
+            readAny = true;
+        }
+
+        if (!readAny)
+        {
+            if (stopping)
+                break;
+            std::this_thread::yield();
+        }
+    }
+}
+
+/**
+ * Write one block in the given layout and read every sample back the way the helper does
+ */
+static bool checkLayoutRoundTrip(uint32_t audioLayout)
+{
+    constexpr uint32_t numChannels = 3, numSamples = 37;
+    std::vector<std::vector<float>> audio(numChannels, std::vector<float>(numSamples));
+    std::vector<const float*> channels;
+    for (uint32_t channel = 0; channel < numChannels; ++channel)
+    {
+        for (uint32_t sample = 0; sample < numSamples; ++sample)
+            audio[channel][sample] = static_cast<float>(channel * 1000 + sample);
+        channels.push_back(audio[channel].data());
+    }
+
+    ParameterMap parameters;
+    fillPannerParameters(parameters);
+    uint8_t parameterData[PARAMETER_BUDGET];
+    uint32_t parameterCount = 0;
+    size_t parameterBytes = M1MemoryShareBlock::encodeParameters(parameters, parameterData, sizeof(parameterData), parameterCount);
+
+    std::vector<uint8_t> block(M1MemoryShareBlock::blockSizeFor(parameterBytes, numChannels, numSamples));
+    if (M1MemoryShareBlock::write(block.data(), block.size(), GenericAudioBufferHeader(), parameterData, parameterBytes,
+                                  parameterCount, channels.data(), numChannels, numSamples, audioLayout) != block.size())
+        return false;
+
+    GenericAudioBufferHeader header;
+    std::memcpy(&header, block.data(), sizeof(header));
+    if (header.audioLayout != audioLayout || header.channels != numChannels || header.samples != numSamples)
+        return false;
+
+    const bool planar = header.audioLayout == GenericAudioBufferHeader::AUDIO_PLANAR;
+    const size_t sampleStride = planar ? 1 : header.channels;
+    const size_t channelStride = planar ? header.samples : 1;
+    for (uint32_t channel = 0; channel < numChannels; ++channel)
+    {
+        for (uint32_t sample = 0; sample < numSamples; ++sample)
+        {
+            float value;
+            std::memcpy(&value, block.data() + header.headerSize + (channel * channelStride + sample * sampleStride) * sizeof(float), sizeof(value));
+            if (value != audio[channel][sample])
+                return false;
+        }
+    }
+    return true;
+}
+
+static RunResult runConfig(uint32_t numChannels, uint32_t numSamples, const Config& config)
+{
+    const size_t payload = M1MemoryShareBlock::blockSizeFor(PARAMETER_BUDGET, numChannels, numSamples);
+    const size_t size = M1MemoryShareRing::segmentSizeFor(SLOT_COUNT, M1MemoryShareRing::slotStrideFor(payload), 0);
+
+    std::vector<Segment> segments(static_cast<size_t>(config.producers));
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        Segment& segment = segments[i];
+        segment.size = size;
+        segment.base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (segment.base == MAP_FAILED)
+        {
+            std::cerr << "ERROR: mmap failed\n";
+            std::exit(1);
+        }
+        segment.ring.create(segment.base, size, SLOT_COUNT, 0, ("loopback" + std::to_string(i)).c_str());
+
+        // Register before the producers start so no block bypasses a consumer
+        for (int c = 0; c < config.consumers; ++c)
+            segment.ring.registerConsumer(static_cast<uint32_t>(c + 1));
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<std::vector<double>> latencies(static_cast<size_t>(config.consumers));
+    std::vector<uint64_t> consumed(static_cast<size_t>(config.consumers), 0);
+    std::vector<uint64_t> gaps(static_cast<size_t>(config.consumers), 0);
+    for (auto& l : latencies)
+        l.reserve(1 << 20);
+
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < config.consumers; ++c)
+    {
+        consumers.emplace_back(runConsumer, std::ref(segments), static_cast<uint32_t>(c + 1), std::ref(stop),
+                               std::ref(latencies[static_cast<size_t>(c)]), std::ref(consumed[static_cast<size_t>(c)]), std::ref(gaps[static_cast<size_t>(c)]));
+    }
+
+    const uint64_t start = nowNs();
+    std::vector<pid_t> pids;
+    for (auto& segment : segments)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+            runProducer(segment, numChannels, numSamples, config);
+        pids.push_back(pid);
+    }
+
+    for (pid_t pid : pids)
+        waitpid(pid, nullptr, 0);
+
+    stop.store(true, std::memory_order_release);
+    for (auto& consumer : consumers)
+        consumer.join();
+
+    RunResult result;
+    result.seconds = (nowNs() - start) / 1e9;
+    for (auto& segment : segments)
+    {
+        result.published += segment.ring.getHead();
+        result.dropped += segment.ring.getDroppedBlocks();
+        munmap(segment.base, segment.size);
+    }
+    for (size_t c = 0; c < consumed.size(); ++c)
+    {
+        result.consumed += consumed[c];
+        result.gaps += gaps[c];
+        result.latenciesUs.insert(result.latenciesUs.end(), latencies[c].begin(), latencies[c].end());
+    }
+    return result;
+}
+
+static void printResult(uint32_t numChannels, uint32_t numSamples, const Config& config, RunResult result)
+{
+    auto& l = result.latenciesUs;
+    std::sort(l.begin(), l.end());
+    auto pct = [&l](double p) { return l.empty() ? 0.0 : l[std::min(l.size() - 1, static_cast<size_t>(p * l.size()))]; };
+
+    const double attempted = static_cast<double>(result.published + result.dropped);
+    std::cout << std::right << std::setw(4) << numChannels << std::setw(8) << numSamples
+              << std::fixed << std::setprecision(0)
+              << std::setw(14) << result.consumed / result.seconds / config.consumers
+              << std::setw(12) << static_cast<double>(result.consumed) * numChannels * numSamples * sizeof(float)
+                                  / result.seconds / config.consumers / (1024.0 * 1024.0)
+              << std::setprecision(1)
+              << std::setw(11) << pct(0.50)
+              << std::setw(11) << pct(0.99)
+              << std::setw(11) << pct(0.999)
+              << std::setprecision(2)
+              << std::setw(10) << (attempted > 0 ? 100.0 * result.dropped / attempted : 0.0)
+              << std::setw(10) << (result.dropped > 0 ? 100.0 * result.gaps / config.consumers / result.dropped : 100.0) << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    Config config;
+    int positional = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--realtime")
+            config.realtime = true;
+        else if (arg == "--planar")
+            config.audioLayout = GenericAudioBufferHeader::AUDIO_PLANAR;
+        else if (positional == 0 && ++positional)
+            config.producers = std::max(1, std::atoi(argv[i]));
+        else if (positional == 1 && ++positional)
+            config.consumers = std::max(1, std::atoi(argv[i]));
+        else if (positional == 2 && ++positional)
+            config.seconds = std::max(0.1, std::atof(argv[i]));
+    }
+
+    for (uint32_t audioLayout : { GenericAudioBufferHeader::AUDIO_INTERLEAVED, GenericAudioBufferHeader::AUDIO_PLANAR })
+    {
+        if (!checkLayoutRoundTrip(audioLayout))
+        {
+            std::cerr << "FAIL: audio layout " << audioLayout << " did not round-trip\n";
+            return 1;
+        }
+    }
+
+    std::cout << "M1MemoryShare loopback: " << config.producers << " producer process(es), "
+              << config.consumers << " consumer(s), " << config.seconds << " s per run, "
+              << (config.realtime ? "real-time paced" : "flat out") << ", "
+              << (config.audioLayout == GenericAudioBufferHeader::AUDIO_PLANAR ? "planar" : "interleaved") << ", "
+              << SLOT_COUNT << " slots\n\n";
+    std::cout << std::right << std::setw(4) << "ch" << std::setw(8) << "block"
+              << std::setw(14) << "blocks/s" << std::setw(12) << "MiB/s"
+              << std::setw(11) << "p50 (us)" << std::setw(11) << "p99 (us)" << std::setw(11) << "p999 (us)"
+              << std::setw(10) << "drop (%)" << std::setw(10) << "gap (%)" << "\n";
+    std::cout << "(blocks/s and MiB/s per consumer, summed over producers)\n";
+
+    for (uint32_t numChannels : { 1u, 2u, 8u })
+    {
+        for (uint32_t numSamples : { 128u, 512u, 2048u })
+            printResult(numChannels, numSamples, config, runConfig(numChannels, numSamples, config));
+    }
+
+    return 0;
+}
@@ -0,0 +1,204 @@
+/**
+ * ParameterMap Microbenchmark
+ *
+ * Compares the fixed-slot ParameterMap against the previous seven-std::map implementation
+ * for the work the helper does per block and per tracker update:
+ *   - parse: decode a serialized GenericParameter stream (as M1MemoryShare::readParameters)
+ *   - copy:  copy the map into the panner info (as M1MemoryShareTracker)
+ *   - get:   the lookups ExternalMixerProcessor::configureEncoder does per block
+ *
+ * Build: clang++ -std=c++17 -O2 -o bench_parameter_map bench_parameter_map.cpp
+ * Usage: ./bench_parameter_map [iterations]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "../Source/Common/TypesForDataExchange.h"
+
+using IDs = M1SystemHelperParameterIDs;
+
+/**
+ * The previous ParameterMap layout, kept here only as the baseline
+ */
+struct MapParameterMap
+{
+    std::map<uint32_t, float> floatParams;
+    std::map<uint32_t, int32_t> intParams;
+    std::map<uint32_t, bool> boolParams;
+    std::map<uint32_t, std::string> stringParams;
+    std::map<uint32_t, double> doubleParams;
+    std::map<uint32_t, uint32_t> uint32Params;
+    std::map<uint32_t, uint64_t> uint64Params;
+
+    void addFloat(uint32_t id, float value) { floatParams[id] = value; }
+    void addInt(uint32_t id, int32_t value) { intParams[id] = value; }
+    void addBool(uint32_t id, bool value) { boolParams[id] = value; }
+    void addString(uint32_t id, const char* value, size_t length) { stringParams[id] = std::string(value, length); }
+    void addDouble(uint32_t id, double value) { doubleParams[id] = value; }
+    void addUInt32(uint32_t id, uint32_t value) { uint32Params[id] = value; }
+    void addUInt64(uint32_t id, uint64_t value) { uint64Params[id] = value; }
+
+    float getFloat(uint32_t id, float defaultValue = 0.0f) const
+    {
+        auto it = floatParams.find(id);
+        return it != floatParams.end() ? it->second : defaultValue;
+    }
+
+    int32_t getInt(uint32_t id, int32_t defaultValue = 0) const
+    {
+        auto it = intParams.find(id);
+        return it != intParams.end() ? it->second : defaultValue;
+    }
+
+    bool getBool(uint32_t id, bool defaultValue = false) const
+    {
+        auto it = boolParams.find(id);
+        return it != boolParams.end() ? it->second : defaultValue;
+    }
+
+    void clear()
+    {
+        floatParams.clear();
+        intParams.clear();
+        boolParams.clear();
+        stringParams.clear();
+        doubleParams.clear();
+        uint32Params.clear();
+        uint64Params.clear();
+    }
+};
+
+//==============================================================================
+// A parameter stream shaped like the panner's (21 parameters incl. display name)
+
+template <typename T>
+static void appendParameter(std::vector<uint8_t>& out, uint32_t id, ParameterType type, const T& value)
+{
+    GenericParameter param(id, type, sizeof(T));
+    out.insert(out.end(), reinterpret_cast<const uint8_t*>(&param), reinterpret_cast<const uint8_t*>(&param) + sizeof(param));
+    out.insert(out.end(), reinterpret_cast<const uint8_t*>(&value), reinterpret_cast<const uint8_t*>(&value) + sizeof(T));
+}
+
+static std::vector<uint8_t> makeParameterStream(uint32_t& count)
+{
+    std::vector<uint8_t> out;
+    const uint32_t floats[] = { IDs::AZIMUTH, IDs::ELEVATION, IDs::DIVERGE, IDs::GAIN,
+                                IDs::STEREO_ORBIT_AZIMUTH, IDs::STEREO_SPREAD, IDs::STEREO_INPUT_BALANCE };
+    const uint32_t bools[] = { IDs::AUTO_ORBIT, IDs::ISOTROPIC_MODE, IDs::EQUALPOWER_MODE,
+                               IDs::GAIN_COMPENSATION_MODE, IDs::LOCK_OUTPUT_LAYOUT };
+    const uint32_t ints[] = { IDs::INPUT_MODE, IDs::OUTPUT_MODE, IDs::PORT, IDs::STATE,
+                              IDs::COLOR_R, IDs::COLOR_G, IDs::COLOR_B, IDs::COLOR_A };
+
+    count = 0;
+    for (uint32_t id : floats) { appendParameter(out, id, ParameterType::FLOAT, 0.25f * (count + 1)); ++count; }
+    for (uint32_t id : bools) { appendParameter(out, id, ParameterType::BOOL, (count & 1) != 0); ++count; }
+    for (uint32_t id : ints) { appendParameter(out, id, ParameterType::INT, static_cast<int32_t>(count)); ++count; }
+
+    const char name[] = "Lead Vocal (Stereo)";
+    GenericParameter param(IDs::DISPLAY_NAME, ParameterType::STRING, sizeof(name));
+    out.insert(out.end(), reinterpret_cast<const uint8_t*>(&param), reinterpret_cast<const uint8_t*>(&param) + sizeof(param));
+    out.insert(out.end(), name, name + sizeof(name));
+    ++count;
+
+    return out;
+}
+
+// Same decode loop as M1MemoryShare::readParameters
+template <typename Map>
+static void parseStream(const std::vector<uint8_t>& stream, uint32_t count, Map& parameters)
+{
+    parameters.clear();
+    const uint8_t* readPtr = stream.data();
+    const uint8_t* endPtr = stream.data() + stream.size();
+
+    for (uint32_t i = 0; i < count && readPtr + sizeof(GenericParameter) <= endPtr; ++i)
+    {
+        GenericParameter param;
+        std::memcpy(&param, readPtr, sizeof(param));
+        readPtr += sizeof(GenericParameter);
+
+        switch (param.parameterType)
+        {
+            case ParameterType::FLOAT: { float v; std::memcpy(&v, readPtr, sizeof(v)); parameters.addFloat(param.parameterID, v); break; }
+            case ParameterType::INT: { int32_t v; std::memcpy(&v, readPtr, sizeof(v)); parameters.addInt(param.parameterID, v); break; }
+            case ParameterType::BOOL: parameters.addBool(param.parameterID, *readPtr != 0); break;
+            case ParameterType::STRING:
+                parameters.addString(param.parameterID, reinterpret_cast<const char*>(readPtr),
+                                     strnlen(reinterpret_cast<const char*>(readPtr), param.dataSize));
+                break;
+            case ParameterType::DOUBLE: { double v; std::memcpy(&v, readPtr, sizeof(v)); parameters.addDouble(param.parameterID, v); break; }
+            case ParameterType::UINT32: { uint32_t v; std::memcpy(&v, readPtr, sizeof(v)); parameters.addUInt32(param.parameterID, v); break; }
+            case ParameterType::UINT64: { uint64_t v; std::memcpy(&v, readPtr, sizeof(v)); parameters.addUInt64(param.parameterID, v); break; }
+        }
+        readPtr += param.dataSize;
+    }
+}
+
+// The lookups configureEncoder performs per block
+template <typename Map>
+static float lookups(const Map& parameters)
+{
+    float sum = parameters.getFloat(IDs::AZIMUTH) + parameters.getFloat(IDs::ELEVATION)
+              + parameters.getFloat(IDs::DIVERGE) + parameters.getFloat(IDs::STEREO_SPREAD)
+              + parameters.getFloat(IDs::STEREO_ORBIT_AZIMUTH) + parameters.getFloat(IDs::GAIN, 1.0f);
+    sum += static_cast<float>(parameters.getInt(IDs::INPUT_MODE) + parameters.getInt(IDs::OUTPUT_MODE));
+    sum += parameters.getBool(IDs::AUTO_ORBIT) ? 1.0f : 0.0f;
+    sum += parameters.getBool(IDs::ISOTROPIC_MODE) ? 1.0f : 0.0f;
+    sum += parameters.getBool(IDs::EQUALPOWER_MODE) ? 1.0f : 0.0f;
+    sum += parameters.getBool(IDs::GAIN_COMPENSATION_MODE) ? 1.0f : 0.0f;
+    return sum;
+}
+
+//==============================================================================
+static volatile float g_sink = 0.0f;
+
+template <typename Fn>
+static double nsPerOp(int iterations, Fn&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        fn();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+template <typename Map>
+static void runSuite(const char* name, int iterations, const std::vector<uint8_t>& stream, uint32_t count)
+{
+    Map parsed;
+    Map copy;
+
+    double parseNs = nsPerOp(iterations, [&] { parseStream(stream, count, parsed); });
+    double copyNs = nsPerOp(iterations, [&] { copy = parsed; g_sink = g_sink + copy.getFloat(IDs::AZIMUTH); });
+    double getNs = nsPerOp(iterations, [&] { g_sink = g_sink + lookups(parsed); });
+
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << parseNs << std::setw(12) << copyNs << std::setw(12) << getNs << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+    uint32_t count = 0;
+    auto stream = makeParameterStream(count);
+
+    std::cout << "ParameterMap benchmark: " << count << " parameters, " << stream.size() << " bytes, "
+              << iterations << " iterations\n";
+    std::cout << "sizeof(ParameterMap) = " << sizeof(ParameterMap) << " bytes\n\n";
+    std::cout << std::left << std::setw(22) << "implementation" << std::right
+              << std::setw(12) << "parse (ns)" << std::setw(12) << "copy (ns)" << std::setw(12) << "get (ns)" << "\n";
+
+    runSuite<MapParameterMap>("std::map x7 (old)", iterations, stream, count);
+    runSuite<ParameterMap>("fixed slots", iterations, stream, count);
+
+    return 0;
+}
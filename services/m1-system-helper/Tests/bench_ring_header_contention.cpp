@@ -0,0 +1,277 @@
+/**
+ * M1MemoryShare Ring Header Contention Benchmark
+ *
+ * Runs the ring's hot path (producer beginWrite/commitWrite, consumers acquireNext/release)
+ * on the packed version 2 header and on the cache-line-aware version 3 header, with the
+ * producer and consumers on separate threads. In version 2, head, tail, every consumer
+ * cursor, the doorbell and the control indices share a few cache lines, so each publish
+ * and each release invalidates the line the other side is using. Version 3 keeps the
+ * producer's, the consumers' and each cursor's fields on their own lines.
+ *
+ * Reports publishes and releases per second; both must see every block in order. Needs at
+ * least (1 + consumers) cores to show the difference: with fewer, the threads time-slice
+ * and never touch the lines concurrently.
+ *
+ * The version 2 segment is formatted here the way older panners did, which also checks
+ * that M1MemoryShareRing still attaches to it. Before the runs, a second consumer
+ * registers while the first is behind, which must leave the first one's cursor (and the
+ * blocks it has yet to read) alone. Then a consumer whose process has exited must be
+ * evicted once it fills the ring, while a live consumer that is as far behind keeps its slot.
+ *
+ * Build: clang++ -std=c++17 -O2 -pthread -o bench_ring_header_contention bench_ring_header_contention.cpp
+ * Usage: ./bench_ring_header_contention [seconds] [max consumers]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../Source/Common/M1MemoryShareRing.h"
+
+static constexpr uint32_t SLOT_COUNT = 64;
+static constexpr size_t SEGMENT_SIZE = 256 * 1024;
+
+/**
+ * Format a mapping with the packed version 2 header (as panners built before version 3 do)
+ */
+static bool formatVersion2(void* base, size_t size, uint32_t slotCount)
+{
+    const size_t headerBytes = (sizeof(RingSegmentHeaderV2) + M1MemoryShareRing::SLOT_ALIGNMENT - 1) & ~(M1MemoryShareRing::SLOT_ALIGNMENT - 1);
+    const size_t slotsStart = headerBytes + sizeof(ParameterStatePage);
+    if (size < slotsStart + slotCount * M1MemoryShareRing::slotStrideFor(0))
+        return false;
+
+    std::memset(base, 0, size);
+    auto* info = static_cast<RingSegmentInfo*>(base);
+    info->version = 2;
+    info->headerSize = static_cast<uint32_t>(sizeof(RingSegmentHeaderV2));
+    info->slotCount = slotCount;
+    info->slotStride = static_cast<uint32_t>(((size - slotsStart) / slotCount) & ~(M1MemoryShareRing::SLOT_ALIGNMENT - 1));
+    info->statePageOffset = static_cast<uint32_t>(headerBytes);
+    info->statePageSize = static_cast<uint32_t>(sizeof(ParameterStatePage));
+    std::atomic_thread_fence(std::memory_order_release);
+    info->magic = RingSegmentInfo::MAGIC;
+    return true;
+}
+
+/**
+ * A consumer registering must not move another consumer's cursor, or the producer would
+ * reuse slots the first one has not read yet
+ */
+static bool checkLateRegistration()
+{
+    void* base = mmap(nullptr, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+        return false;
+
+    M1MemoryShareRing ring;
+    bool passed = ring.create(base, SEGMENT_SIZE, SLOT_COUNT, 0, "late");
+    const int first = ring.registerConsumer(100);
+
+    // The first consumer reads 3 of 10 published blocks
+    for (uint64_t i = 0; i < 10; ++i)
+    {
+        uint64_t sequence = 0;
+        if (uint8_t* payload = ring.beginWrite(sequence))
+        {
+            std::memcpy(payload, &sequence, sizeof(sequence));
+            ring.commitWrite(sequence, sizeof(sequence));
+        }
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        uint64_t sequence = 0, lost = 0;
+        uint32_t payloadSize = 0;
+        passed = passed && ring.acquireNext(first, sequence, payloadSize, lost) != nullptr && ring.release(first, sequence);
+    }
+
+    const int second = ring.registerConsumer(101);
+    passed = passed && first >= 0 && second >= 0 && second != first
+        && ring.getCursor(first) == 3 && ring.getCursor(second) == 10 && ring.getTail() <= 3;
+
+    // Filling the ring must stop at the first consumer's unread blocks
+    uint64_t written = 10;
+    uint64_t sequence = 0;
+    while (ring.beginWrite(sequence) != nullptr)
+    {
+        ring.commitWrite(sequence, 0);
+        ++written;
+    }
+    passed = passed && written == 3 + SLOT_COUNT && ring.getCursor(first) == 3;
+
+    munmap(base, SEGMENT_SIZE);
+    return passed;
+}
+
+/**
+ * A consumer that died while registered must not hold the tail (and drop every block) forever
+ */
+static bool checkDeadConsumerEviction()
+{
+    void* base = mmap(nullptr, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+        return false;
+
+    // A process that has certainly exited
+    pid_t dead = fork();
+    if (dead == 0)
+        _exit(0);
+    waitpid(dead, nullptr, 0);
+
+    M1MemoryShareRing ring;
+    bool passed = ring.create(base, SEGMENT_SIZE, SLOT_COUNT, 0, "dead");
+    const int crashed = ring.registerConsumer(200, static_cast<uint32_t>(dead));
+    passed = passed && crashed >= 0 && ring.getConsumerOwner(crashed) == static_cast<uint32_t>(dead);
+
+    // The first full write evicts it, so nothing is dropped
+    uint64_t sequence = 0;
+    for (uint32_t i = 0; i < 2 * SLOT_COUNT; ++i)
+    {
+        passed = passed && ring.beginWrite(sequence) != nullptr;
+        ring.commitWrite(sequence, 0);
+    }
+    passed = passed && ring.getDroppedBlocks() == 0 && ring.findConsumer(200) < 0 && ring.getConsumerOwner(crashed) == 0;
+
+    // A live consumer that stopped reading keeps its slot, and the ring drops
+    const int stalled = ring.registerConsumer(201);
+    for (uint32_t i = 0; i < 2 * SLOT_COUNT; ++i)
+    {
+        if (ring.beginWrite(sequence) != nullptr)
+            ring.commitWrite(sequence, 0);
+    }
+    passed = passed && stalled >= 0 && ring.findConsumer(201) == stalled && ring.getDroppedBlocks() == SLOT_COUNT;
+
+    munmap(base, SEGMENT_SIZE);
+    return passed;
+}
+
+struct RunResult
+{
+    double publishesPerSecond = 0.0;
+    double releasesPerSecond = 0.0;
+    bool inOrder = true;
+};
+
+static RunResult run(bool version3, int consumers, double seconds)
+{
+    RunResult result;
+    void* base = mmap(nullptr, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+        return result;
+
+    M1MemoryShareRing ring;
+    bool ready = version3 ? ring.create(base, SEGMENT_SIZE, SLOT_COUNT, 0, "bench")
+                          : formatVersion2(base, SEGMENT_SIZE, SLOT_COUNT) && ring.attach(base, SEGMENT_SIZE);
+    if (!ready || ring.getHeaderVersion() != (version3 ? RingSegmentHeader::VERSION : 2u))
+    {
+        std::cerr << "ERROR: could not set up a version " << (version3 ? 3 : 2) << " ring\n";
+        munmap(base, SEGMENT_SIZE);
+        result.inOrder = false;
+        return result;
+    }
+
+    std::vector<int> indices;
+    for (int c = 0; c < consumers; ++c)
+        indices.push_back(ring.registerConsumer(static_cast<uint32_t>(100 + c)));
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> releases{0};
+    std::atomic<bool> ordered{true};
+    std::vector<std::thread> threads;
+
+    for (int c = 0; c < consumers; ++c)
+    {
+        threads.emplace_back([&, index = indices[static_cast<size_t>(c)]]
+        {
+            M1MemoryShareRing view;     // Each side maps the segment on its own
+            view.attach(base, SEGMENT_SIZE);
+
+            uint64_t expected = 0, count = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                uint64_t sequence = 0, lost = 0;
+                uint32_t payloadSize = 0;
+                if (view.acquireNext(index, sequence, payloadSize, lost) == nullptr)
+                    continue;
+
+                if (sequence != expected || lost != 0 || payloadSize != sizeof(uint64_t))
+                    ordered = false;
+                expected = sequence + 1;
+                view.release(index, sequence);
+                ++count;
+            }
+            releases += count;
+        });
+    }
+
+    uint64_t publishes = 0;
+    const auto start = std::chrono::steady_clock::now();
+    const auto end = start + std::chrono::duration<double>(seconds);
+    while (std::chrono::steady_clock::now() < end)
+    {
+        for (int i = 0; i < 256; ++i)
+        {
+            uint64_t sequence = 0;
+            if (uint8_t* payload = ring.beginWrite(sequence))
+            {
+                std::memcpy(payload, &sequence, sizeof(sequence));
+                ring.commitWrite(sequence, sizeof(sequence));
+                ++publishes;
+            }
+        }
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    stop = true;
+    for (auto& thread : threads)
+        thread.join();
+
+    result.publishesPerSecond = publishes / elapsed;
+    result.releasesPerSecond = releases.load() / elapsed;
+    result.inOrder = ordered.load() && ring.getHead() == publishes;
+    munmap(base, SEGMENT_SIZE);
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+    int maxConsumers = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    std::cout << "Ring header contention: " << seconds << " s per run, " << std::thread::hardware_concurrency() << " hardware threads\n";
+    std::cout << "  v2 header " << sizeof(RingSegmentHeaderV2) << " bytes (packed), v3 header "
+              << sizeof(RingSegmentHeader) << " bytes (" << RingSegmentHeader::CACHE_LINE << "-byte lines)\n\n";
+    bool passed = checkLateRegistration();
+    std::cout << (passed ? "PASS" : "FAIL") << ": a late consumer leaves an earlier consumer's cursor where it was\n";
+    const bool evicted = checkDeadConsumerEviction();
+    std::cout << (evicted ? "PASS" : "FAIL") << ": a consumer whose process exited is evicted, a stalled live one is not\n\n";
+    passed = passed && evicted;
+
+    std::cout << std::setw(10) << "consumers" << std::setw(16) << "v2 publish/s" << std::setw(16) << "v3 publish/s"
+              << std::setw(16) << "v2 release/s" << std::setw(16) << "v3 release/s" << std::setw(10) << "speedup" << "\n";
+
+    for (int consumers = 1; consumers <= maxConsumers; ++consumers)
+    {
+        RunResult packed = run(false, consumers, seconds);
+        RunResult aligned = run(true, consumers, seconds);
+        passed = passed && packed.inOrder && aligned.inOrder;
+
+        std::cout << std::fixed << std::setprecision(0) << std::setw(10) << consumers
+                  << std::setw(16) << packed.publishesPerSecond << std::setw(16) << aligned.publishesPerSecond
+                  << std::setw(16) << packed.releasesPerSecond << std::setw(16) << aligned.releasesPerSecond
+                  << std::setprecision(2) << std::setw(9)
+                  << (packed.releasesPerSecond > 0 ? aligned.releasesPerSecond / packed.releasesPerSecond : 0.0) << "x\n";
+    }
+
+    std::cout << "\n" << (passed ? "PASS" : "FAIL") << ": every consumer saw every block in order on both header versions\n";
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,400 @@
+/**
+ * M1MemoryShare Segment Discovery Benchmark (Linux)
+ *
+ * Compares the tracker's two discovery backends:
+ *   - event-driven: M1MemoryShareDirectoryWatcher (inotify) on a watcher thread, retrying
+ *     at 1 ms until the producer has formatted the ring (as the tracker does)
+ *   - polling: a full directory scan every 250 ms with a name parse, kill(pid, 0) and a
+ *     stat per file (what the tracker did before, and still does without inotify)
+ *
+ * A forked "panner" creates segment files the way M1MemoryShare does (zero-filled file,
+ * then the ring formatted through a mapping). Reported latency runs from the file being
+ * created to the helper seeing a formatted ring. The cost of one polling scan is measured
+ * with a directory holding [stale files] leftovers, which the watcher never looks at.
+ *
+ * The tracker rows go on to the tracker itself showing the panner: its watcher thread
+ * hands connected panners over to update(), which runs on the helper's 100 ms timer
+ *   - tick:  update() takes them in on its next tick (what the tracker did before)
+ *   - woken: the watcher wakes update() as soon as it hands a panner over
+ *            (M1MemoryShareTracker::onWatcherResults), the timer still ticking
+ *
+ * Build: clang++ -std=c++17 -O2 -pthread -o bench_segment_discovery bench_segment_discovery.cpp
+ * Usage: ./bench_segment_discovery [panners] [stale files]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "../Source/Common/M1MemoryShareDirectoryWatcher.h"
+#include "../Source/Common/M1MemoryShareRing.h"
+
+#if !defined(M1_MEMORYSHARE_DIRECTORY_WATCHER)
+int main()
+{
+    std::cout << "The directory watcher is only available on Linux\n";
+    return 0;
+}
+#else
+
+static uint64_t nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static const size_t SEGMENT_SIZE = 256 * 1024;
+static const int SCAN_INTERVAL_MS = 250;
+static const int UPDATE_INTERVAL_MS = 100;
+
+// File name carries the creation time in the _T field, like the panner's timestamp
+static std::string segmentName(int index, uint64_t createdNs)
+{
+    return "M1SpatialSystem_M1Panner_PID" + std::to_string(getpid()) + "_PTR" + std::to_string(index)
+         + "_T" + std::to_string(createdNs) + ".mem";
+}
+
+static uint64_t parseCreatedNs(const std::string& path)
+{
+    size_t t = path.rfind("_T");
+    return t == std::string::npos ? 0 : std::strtoull(path.c_str() + t + 2, nullptr, 10);
+}
+
+// Panner side: zero-filled file first, ring formatted through the mapping afterwards
+static void createSegment(const std::string& directory, int index)
+{
+    std::string path = directory + "/" + segmentName(index, nowNs());
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    std::vector<uint8_t> zeros(SEGMENT_SIZE, 0);
+    if (fd < 0 || write(fd, zeros.data(), zeros.size()) != static_cast<ssize_t>(zeros.size()))
+        _exit(2);
+    close(fd);
+
+    fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+    void* base = mmap(nullptr, SEGMENT_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    M1MemoryShareRing ring;
+    if (base == MAP_FAILED || !ring.create(base, SEGMENT_SIZE, 8, 0, "bench"))
+        _exit(3);
+    munmap(base, SEGMENT_SIZE);
+    close(fd);
+}
+
+static bool isFormatted(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    uint8_t header[sizeof(RingSegmentHeader)] = {};
+    bool formatted = pread(fd, header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))
+                  && M1MemoryShareRing::isRingSegment(header, sizeof(header));
+    close(fd);
+    return formatted;
+}
+
+// One polling pass as the old tracker did it: list, parse, check the process, stat
+static size_t scanDirectory(const std::string& directory, std::vector<std::string>& found)
+{
+    size_t files = 0;
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr)
+        return 0;
+
+    while (dirent* entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name.compare(0, 16, "M1SpatialSystem_") != 0 || name.size() < 4 || name.compare(name.size() - 4, 4, ".mem") != 0)
+            continue;
+        ++files;
+
+        size_t pid = name.find("_PID");
+        if (pid == std::string::npos || kill(static_cast<pid_t>(std::strtoul(name.c_str() + pid + 4, nullptr, 10)), 0) != 0)
+            continue;
+
+        std::string path = directory + "/" + name;
+        struct stat info;
+        if (stat(path.c_str(), &info) == 0)
+            found.push_back(path);
+    }
+    closedir(dir);
+    return files;
+}
+
+static void printLatency(const char* name, std::vector<double> l)
+{
+    std::sort(l.begin(), l.end());
+    auto pct = [&l](double p) { return l.empty() ? 0.0 : l[std::min(l.size() - 1, static_cast<size_t>(p * l.size()))]; };
+
+    std::cout << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << pct(0.50) / 1000.0
+              << std::setw(12) << pct(0.99) / 1000.0
+              << std::setw(12) << (l.empty() ? 0.0 : l.back() / 1000.0)
+              << std::setw(8) << l.size() << "\n";
+}
+
+static std::vector<double> runWatcher(const std::string& directory, int panners)
+{
+    M1MemoryShareDirectoryWatcher watcher;
+    std::vector<double> latencies;
+    if (!watcher.start({ directory }, "M1SpatialSystem_", ".mem"))
+        return latencies;
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        for (int i = 0; i < panners; ++i)
+        {
+            createSegment(directory, i);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        _exit(0);
+    }
+
+    std::vector<M1MemoryShareDirectoryWatcher::Event> events;
+    std::vector<std::string> pending, seen;
+    const uint64_t deadline = nowNs() + static_cast<uint64_t>(panners) * 20000000ull + 2000000000ull;
+    while (static_cast<int>(seen.size()) < panners && nowNs() < deadline)
+    {
+        events.clear();
+        watcher.wait(pending.empty() ? 100 : 1, events);
+        for (const auto& event : events)
+        {
+            if (event.type == M1MemoryShareDirectoryWatcher::Event::CREATED
+                && std::find(pending.begin(), pending.end(), event.path) == pending.end()
+                && std::find(seen.begin(), seen.end(), event.path) == seen.end())
+                pending.push_back(event.path);
+        }
+
+        for (auto it = pending.begin(); it != pending.end();)
+        {
+            if (!isFormatted(*it))
+            {
+                ++it;
+                continue;
+            }
+            latencies.push_back(static_cast<double>(nowNs() - parseCreatedNs(*it)));
+            seen.push_back(*it);
+            it = pending.erase(it);
+        }
+    }
+
+    waitpid(pid, nullptr, 0);
+    for (const auto& path : seen)
+        unlink(path.c_str());
+    return latencies;
+}
+
+// Watcher thread and update() as the tracker runs them; latency is to the panner being in update()'s list
+static std::vector<double> runTracker(const std::string& directory, int panners, bool wakeUpdate)
+{
+    M1MemoryShareDirectoryWatcher watcher;
+    std::vector<double> latencies;
+    if (!watcher.start({ directory }, "M1SpatialSystem_", ".mem"))
+        return latencies;
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        for (int i = 0; i < panners; ++i)
+        {
+            createSegment(directory, i);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        _exit(0);
+    }
+
+    std::mutex mutex;
+    std::condition_variable handedOver;
+    std::vector<std::string> discovered;    // Guarded by mutex
+    bool stop = false;                      // Guarded by mutex
+
+    std::thread watcherThread([&]
+    {
+        std::vector<M1MemoryShareDirectoryWatcher::Event> events;
+        std::vector<std::string> pending;
+        for (;;)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stop)
+                    break;
+            }
+
+            events.clear();
+            watcher.wait(pending.empty() ? -1 : 1, events);
+            for (const auto& event : events)
+            {
+                if (event.type == M1MemoryShareDirectoryWatcher::Event::CREATED
+                    && std::find(pending.begin(), pending.end(), event.path) == pending.end())
+                    pending.push_back(event.path);
+            }
+
+            bool found = false;
+            for (auto it = pending.begin(); it != pending.end();)
+            {
+                if (!isFormatted(*it))
+                {
+                    ++it;
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                discovered.push_back(*it);
+                found = true;
+                it = pending.erase(it);
+            }
+            if (found && wakeUpdate)
+                handedOver.notify_one();
+        }
+    });
+
+    // update(): on the timer, or woken by the watcher
+    std::vector<std::string> active, merged;
+    const uint64_t deadline = nowNs() + static_cast<uint64_t>(panners) * 20000000ull + 2000000000ull;
+    auto nextTick = std::chrono::steady_clock::now() + std::chrono::milliseconds(UPDATE_INTERVAL_MS);
+    while (static_cast<int>(active.size()) < panners && nowNs() < deadline)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (wakeUpdate)
+                handedOver.wait_until(lock, nextTick, [&discovered] { return !discovered.empty(); });
+            else
+                handedOver.wait_until(lock, nextTick);
+            merged.swap(discovered);
+        }
+        if (std::chrono::steady_clock::now() >= nextTick)
+            nextTick += std::chrono::milliseconds(UPDATE_INTERVAL_MS);
+
+        for (const auto& path : merged)
+        {
+            latencies.push_back(static_cast<double>(nowNs() - parseCreatedNs(path)));
+            active.push_back(path);
+        }
+        merged.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    watcher.wake();
+    watcherThread.join();
+
+    waitpid(pid, nullptr, 0);
+    for (const auto& path : active)
+        unlink(path.c_str());
+    return latencies;
+}
+
+static std::vector<double> runPolling(const std::string& directory, int panners, double& scanUs, size_t& filesPerScan)
+{
+    std::vector<double> latencies, scanNs;
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        for (int i = 0; i < panners; ++i)
+        {
+            createSegment(directory, i);
+            std::this_thread::sleep_for(std::chrono::milliseconds(37));    // Not a multiple of the scan interval
+        }
+        _exit(0);
+    }
+
+    std::vector<std::string> seen, found;
+    const uint64_t deadline = nowNs() + static_cast<uint64_t>(panners) * 37000000ull + 2000000000ull;
+    while (static_cast<int>(seen.size()) < panners && nowNs() < deadline)
+    {
+        found.clear();
+        uint64_t start = nowNs();
+        filesPerScan = scanDirectory(directory, found);
+        scanNs.push_back(static_cast<double>(nowNs() - start));
+
+        for (const auto& path : found)
+        {
+            if (path.find("_PTR") != std::string::npos && std::find(seen.begin(), seen.end(), path) == seen.end()
+                && path.find("_PID" + std::to_string(pid) + "_") != std::string::npos && isFormatted(path))
+            {
+                latencies.push_back(static_cast<double>(nowNs() - parseCreatedNs(path)));
+                seen.push_back(path);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(SCAN_INTERVAL_MS));
+    }
+
+    waitpid(pid, nullptr, 0);
+    for (const auto& path : seen)
+        unlink(path.c_str());
+
+    std::sort(scanNs.begin(), scanNs.end());
+    scanUs = scanNs.empty() ? 0.0 : scanNs[scanNs.size() / 2] / 1000.0;
+    return latencies;
+}
+
+int main(int argc, char* argv[])
+{
+    int panners = argc > 1 ? std::atoi(argv[1]) : 20;
+    int staleFiles = argc > 2 ? std::atoi(argv[2]) : 500;
+
+    char directoryTemplate[] = "/tmp/m1_discovery_XXXXXX";
+    if (mkdtemp(directoryTemplate) == nullptr)
+    {
+        std::cerr << "ERROR: could not create a temporary directory\n";
+        return 1;
+    }
+    std::string directory = directoryTemplate;
+
+    // Leftovers from crashed panners: PID 1 is alive, so every file costs a full check
+    for (int i = 0; i < staleFiles; ++i)
+    {
+        std::string path = directory + "/M1SpatialSystem_M1Panner_PID1_PTRdead" + std::to_string(i) + "_T0.mem";
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (fd >= 0)
+            close(fd);
+    }
+
+    std::cout << "Segment discovery: " << panners << " new panners, " << staleFiles << " stale files\n\n";
+    std::cout << std::left << std::setw(14) << "backend" << std::right
+              << std::setw(12) << "p50 (us)" << std::setw(12) << "p99 (us)" << std::setw(12) << "max (us)" << std::setw(8) << "found" << "\n";
+
+    std::vector<double> watched = runWatcher(directory, panners);
+    printLatency("inotify", watched);
+
+    std::vector<double> ticked = runTracker(directory, panners, false);
+    printLatency("tracker tick", ticked);
+
+    std::vector<double> woken = runTracker(directory, panners, true);
+    printLatency("tracker woken", woken);
+
+    double scanUs = 0.0;
+    size_t filesPerScan = 0;
+    std::vector<double> polled = runPolling(directory, panners, scanUs, filesPerScan);
+    printLatency("polling", polled);
+
+    std::cout << "\nOne polling scan: " << std::fixed << std::setprecision(1) << scanUs << " us over "
+              << filesPerScan << " files (x4 per second); the watcher does no work while idle\n";
+
+    for (int i = 0; i < staleFiles; ++i)
+        unlink((directory + "/M1SpatialSystem_M1Panner_PID1_PTRdead" + std::to_string(i) + "_T0.mem").c_str());
+    rmdir(directory.c_str());
+
+    bool passed = static_cast<int>(watched.size()) == panners && static_cast<int>(polled.size()) == panners
+               && static_cast<int>(ticked.size()) == panners && static_cast<int>(woken.size()) == panners;
+    std::cout << "\n" << (passed ? "PASS" : "FAIL") << ": every panner was discovered by both backends and reached the tracker\n";
+    return passed ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,169 @@
+/**
+ * M1MemoryShare Parameter State Page Benchmark
+ *
+ * Measures how long a consumer takes to take a consistent snapshot of the seqlock
+ * parameter page (M1MemoryShareStatePage::read), with the producer idle and with the
+ * producer rewriting the page as fast as it can from another process.
+ *
+ * Every write fills all values with the same counter, so any snapshot mixing two writes
+ * is detected; the benchmark fails if such a torn snapshot was ever accepted.
+ *
+ * Build: clang++ -std=c++17 -O2 -o bench_state_page bench_state_page.cpp
+ * Usage: ./bench_state_page [reads] [parameters]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../Source/Common/M1MemoryShareStatePage.h"
+
+static uint64_t nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// One GenericParameter-sized entry: 12 byte header + float value, like the panner's
+static constexpr size_t ENTRY_BYTES = 16;
+
+static void writeState(ParameterStatePage& page, uint32_t parameters, uint32_t counter)
+{
+    uint8_t data[ParameterStatePage::DATA_CAPACITY];
+    for (uint32_t i = 0; i < parameters; ++i)
+    {
+        uint32_t entry[4] = { 0x1A2B3C4D + i, 0, sizeof(float), counter };
+        std::memcpy(data + i * ENTRY_BYTES, entry, sizeof(entry));
+    }
+
+    ParameterStateFields fields = {};
+    fields.parameterCount = parameters;
+    fields.dataSize = parameters * ENTRY_BYTES;
+    fields.dawTimestamp = counter;
+    fields.playheadPositionInSeconds = counter;
+    M1MemoryShareStatePage::write(page, fields, data);
+}
+
+static bool isConsistent(const ParameterStateSnapshot& snapshot)
+{
+    const uint32_t counter = static_cast<uint32_t>(snapshot.fields.dawTimestamp);
+    if (snapshot.fields.playheadPositionInSeconds != static_cast<double>(counter))
+        return false;
+
+    for (uint32_t i = 0; i < snapshot.fields.parameterCount; ++i)
+    {
+        uint32_t value = 0;
+        std::memcpy(&value, snapshot.data + i * ENTRY_BYTES + 12, sizeof(value));
+        if (value != counter)
+            return false;
+    }
+    return true;
+}
+
+struct RunResult
+{
+    std::vector<double> readNs;
+    uint64_t failedReads = 0;
+    uint64_t tornReads = 0;
+    uint64_t inconsistent = 0;
+};
+
+static RunResult runReader(ParameterStatePage& page, int reads, uint32_t parameters, bool busyProducer)
+{
+    writeState(page, parameters, 1);
+
+    pid_t pid = -1;
+    if (busyProducer)
+    {
+        pid = fork();
+        if (pid == 0)
+        {
+            for (uint32_t counter = 2;; ++counter)
+                writeState(page, parameters, counter);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    RunResult result;
+    result.readNs.reserve(static_cast<size_t>(reads));
+
+    ParameterStateSnapshot snapshot;
+    for (int i = 0; i < reads; ++i)
+    {
+        uint64_t start = nowNs();
+        bool ok = M1MemoryShareStatePage::read(page, snapshot);
+        result.readNs.push_back(static_cast<double>(nowNs() - start));
+
+        result.tornReads += snapshot.tornReads;
+        if (!ok)
+            ++result.failedReads;
+        else if (!isConsistent(snapshot))
+            ++result.inconsistent;
+    }
+
+    if (pid > 0)
+    {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    }
+    return result;
+}
+
+static void printResult(const char* name, RunResult result)
+{
+    auto& l = result.readNs;
+    std::sort(l.begin(), l.end());
+    auto pct = [&l](double p) { return l.empty() ? 0.0 : l[std::min(l.size() - 1, static_cast<size_t>(p * l.size()))]; };
+
+    std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(10) << pct(0.50)
+              << std::setw(10) << pct(0.99)
+              << std::setw(10) << pct(0.999)
+              << std::setw(12) << result.tornReads
+              << std::setw(10) << result.failedReads
+              << std::setw(14) << result.inconsistent << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    int reads = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    uint32_t parameters = argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2])) : 22;
+    parameters = std::min<uint32_t>(parameters, ParameterStatePage::DATA_CAPACITY / ENTRY_BYTES);
+
+    void* mapping = mmap(nullptr, sizeof(ParameterStatePage), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "ERROR: mmap failed\n";
+        return 1;
+    }
+    auto* page = new (mapping) ParameterStatePage();
+
+    std::cout << "State page snapshot: " << reads << " reads, " << parameters << " parameters ("
+              << parameters * ENTRY_BYTES << " bytes)\n\n";
+    std::cout << std::left << std::setw(16) << "producer" << std::right
+              << std::setw(10) << "p50 (ns)" << std::setw(10) << "p99 (ns)" << std::setw(10) << "p999 (ns)"
+              << std::setw(12) << "torn/retry" << std::setw(10) << "gave up" << std::setw(14) << "inconsistent" << "\n";
+
+    RunResult idle = runReader(*page, reads, parameters, false);
+    RunResult busy = runReader(*page, reads, parameters, true);
+    bool passed = idle.inconsistent == 0 && busy.inconsistent == 0;
+
+    printResult("idle", std::move(idle));
+    printResult("writing flat out", std::move(busy));
+
+    munmap(mapping, sizeof(ParameterStatePage));
+
+    std::cout << "\n" << (passed ? "PASS: no torn snapshot was accepted" : "FAIL: torn snapshot accepted") << "\n";
+    return passed ? 0 : 1;
+}
@@ -7,6 +7,7 @@
  *   - m1-panner/Source/TypesForDataExchange.h
  *   - services/m1-system-helper/Source/Common/M1MemoryShare.h
  *   - services/m1-system-helper/Source/Common/TypesForDataExchange.h
+ *   - services/m1-system-helper/Source/Common/M1MemoryShareRing.h (ring layout, included directly)
  * 
  * Build: clang++ -std=c++17 -o read_memory_share read_memory_share.cpp
  * Usage: ./read_memory_share <memory_file.mem>
@@ -25,6 +26,9 @@
 #include <unistd.h>
 #include <dirent.h>
 #include <ctime>
+#include <cmath>
+
+#include "../Source/Common/M1MemoryShareRing.h"
 
 // ============================================================================
 // STRUCT DEFINITIONS - Must match M1MemoryShare.h exactly
@@ -86,8 +90,11 @@ struct GenericAudioBufferHeader {
     uint32_t requiresAcknowledgment;        // 80: Whether this buffer requires acknowledgment
     uint32_t consumerCount;                 // 84: Number of consumers that need to acknowledge
     uint32_t acknowledgedCount;             // 88: Number of consumers that have acknowledged
-    uint32_t reserved[2];                   // 92-99: Reserved for future expansion
-    // Total size: 104 bytes (with padding)
+    // 4 bytes padding for int64_t alignment
+    int64_t startSamplePosition;            // 96: Sample position in DAW timeline
+    uint32_t sampleRate;                    // 104: Sample rate for this buffer
+    uint32_t audioLayout;                   // 108: 0 = interleaved, 1 = planar
+    // Total size: 112 bytes
 };
 
 /**
@@ -239,84 +246,157 @@ int analyzeMemoryFile(const char* filepath) {
     
     const uint8_t* rawData = static_cast<const uint8_t*>(mapped);
     
-    // ========================================================================
-    // Parse SharedMemoryHeader
-    // ========================================================================
-    std::cout << "--- SharedMemoryHeader (offset 0) ---\n";
-    
-    if (st.st_size < sizeof(SharedMemoryHeader)) {
-        std::cerr << "ERROR: File too small for SharedMemoryHeader\n";
-        munmap(mapped, st.st_size);
-        close(fd);
-        return 1;
-    }
-    
-    const SharedMemoryHeader* header = static_cast<const SharedMemoryHeader*>(mapped);
-    
-    std::cout << "  writeIndex:         " << header->writeIndex << "\n";
-    std::cout << "  readIndex:          " << header->readIndex << "\n";
-    std::cout << "  dataSize:           " << header->dataSize << " bytes\n";
-    std::cout << "  hasData:            " << (header->hasData ? "YES" : "NO") << "\n";
-    std::cout << "  bufferSize:         " << header->bufferSize << " bytes\n";
-    std::cout << "  sampleRate:         " << header->sampleRate << " Hz\n";
-    std::cout << "  numChannels:        " << header->numChannels << "\n";
-    std::cout << "  samplesPerBlock:    " << header->samplesPerBlock << "\n";
-    std::cout << "  name:               \"" << header->name << "\"\n";
-    std::cout << "  queueSize:          " << header->queueSize << "\n";
-    std::cout << "  maxQueueSize:       " << header->maxQueueSize << "\n";
-    std::cout << "  nextSequenceNumber: " << header->nextSequenceNumber << "\n";
-    std::cout << "  nextBufferId:       " << header->nextBufferId << "\n";
-    std::cout << "  consumerCount:      " << header->consumerCount << "\n";
-    
-    if (header->consumerCount > 0 && header->consumerCount <= 16) {
-        std::cout << "  consumerIds:        [";
-        for (uint32_t i = 0; i < header->consumerCount; ++i) {
-            if (i > 0) std::cout << ", ";
-            std::cout << header->consumerIds[i];
-        }
-        std::cout << "]\n";
-    }
-    
-    std::cout << "  controlMsgCount:    " << header->controlMessageCount << "\n";
-    std::cout << "  controlReadIdx:     " << header->controlReadIndex << "\n";
-    std::cout << "  controlWriteIdx:    " << header->controlWriteIndex << "\n";
-    std::cout << "\n";
-    
-    // Show raw hex of header for debugging
-    std::cout << "--- SharedMemoryHeader Raw Hex (first 64 bytes) ---\n";
-    printHex(rawData, 64, 0);
-    std::cout << "\n";
+    const uint8_t* dataSection = nullptr;
+    size_t dataOffset = 0;
+    size_t dataSize = 0;
     
     // ========================================================================
-    // Parse Data Section
+    // Parse RingSegmentHeader (layout 2)
     // ========================================================================
-    if (!header->hasData || header->dataSize == 0) {
-        std::cout << "No data available in shared memory.\n";
-        munmap(mapped, st.st_size);
-        close(fd);
-        return 0;
+    if (M1MemoryShareRing::isRingSegment(mapped, st.st_size)) {
+        std::cout << "--- RingSegmentHeader (offset 0, layout 2) ---\n";
+        
+        M1MemoryShareRing ring;
+        if (!ring.attach(mapped, st.st_size)) {
+            std::cerr << "ERROR: Ring header has an invalid geometry\n";
+            munmap(mapped, st.st_size);
+            close(fd);
+            return 1;
+        }
+        
+        const RingSegmentInfo* ringHeader = ring.getHeader();
+        std::cout << "  version:            " << ringHeader->version << (ringHeader->version < RingSegmentHeader::VERSION ? " (packed header)" : "") << "\n";
+        std::cout << "  slotCount:          " << ringHeader->slotCount << "\n";
+        std::cout << "  slotStride:         " << ringHeader->slotStride << " bytes\n";
+        std::cout << "  sampleRate:         " << ringHeader->sampleRate << " Hz\n";
+        std::cout << "  numChannels:        " << ringHeader->numChannels << "\n";
+        std::cout << "  samplesPerBlock:    " << ringHeader->samplesPerBlock << "\n";
+        std::cout << "  name:               \"" << std::string(ringHeader->name, strnlen(ringHeader->name, sizeof(ringHeader->name))) << "\"\n";
+        std::cout << "  head:               " << ring.getHead() << "\n";
+        std::cout << "  tail:               " << ring.getTail() << "\n";
+        std::cout << "  droppedBlocks:      " << ring.getDroppedBlocks() << "\n";
+        std::cout << "  consumers:          " << ring.getConsumerCount() << "\n";
+        for (uint32_t i = 0; i < RingSegmentHeader::MAX_CONSUMERS; ++i) {
+            uint32_t id = ring.getConsumerId(static_cast<int>(i));
+            if (id != 0) {
+                std::cout << "    id " << id << " cursor=" << ring.getCursor(static_cast<int>(i))
+                          << " pending=" << ring.getPendingCount(static_cast<int>(i)) << "\n";
+            }
+        }
+        std::cout << "  controlReadIdx:     " << ring.getControlReadIndex().load() << "\n";
+        std::cout << "  controlWriteIdx:    " << ring.getControlWriteIndex().load() << "\n";
+        std::cout << "\n";
+        
+        // State page: the producer's latest parameters, independent of the audio blocks
+        ParameterStateSnapshot state;
+        std::cout << "--- Parameter state page (offset " << ringHeader->statePageOffset << ") ---\n";
+        if (M1MemoryShareStatePage::read(*ring.getStatePage(), state)) {
+            std::cout << "  version:            " << state.sequence << " (" << state.tornReads << " torn reads retried)\n";
+            std::cout << "  parameterCount:     " << state.fields.parameterCount << "\n";
+            std::cout << "  dataSize:           " << state.fields.dataSize << " bytes\n";
+            std::cout << "  dawTimestamp:       " << state.fields.dawTimestamp << "\n";
+            std::cout << "  playhead:           " << state.fields.playheadPositionInSeconds << " s\n";
+            std::cout << "  isPlaying:          " << (state.fields.isPlaying ? "YES" : "NO") << "\n";
+        } else {
+            std::cout << "  (not published)\n";
+        }
+        std::cout << "\n";
+        
+        uint64_t sequence = 0;
+        uint32_t payloadSize = 0;
+        dataSection = ring.peekLatest(sequence, payloadSize);
+        if (dataSection == nullptr) {
+            std::cout << "No data available in shared memory.\n";
+            munmap(mapped, st.st_size);
+            close(fd);
+            return 0;
+        }
+        
+        dataOffset = static_cast<size_t>(dataSection - rawData);
+        dataSize = payloadSize;
+        std::cout << "Latest block: sequence " << sequence << " in slot " << (sequence % ringHeader->slotCount)
+                  << ", " << payloadSize << " bytes\n\n";
+    } else {
+        // ========================================================================
+        // Parse SharedMemoryHeader
+        // ========================================================================
+        std::cout << "--- SharedMemoryHeader (offset 0) ---\n";
+        
+        if (st.st_size < sizeof(SharedMemoryHeader)) {
+            std::cerr << "ERROR: File too small for SharedMemoryHeader\n";
+            munmap(mapped, st.st_size);
+            close(fd);
+            return 1;
+        }
+        
+        const SharedMemoryHeader* header = static_cast<const SharedMemoryHeader*>(mapped);
+        
+        std::cout << "  writeIndex:         " << header->writeIndex << "\n";
+        std::cout << "  readIndex:          " << header->readIndex << "\n";
+        std::cout << "  dataSize:           " << header->dataSize << " bytes\n";
+        std::cout << "  hasData:            " << (header->hasData ? "YES" : "NO") << "\n";
+        std::cout << "  bufferSize:         " << header->bufferSize << " bytes\n";
+        std::cout << "  sampleRate:         " << header->sampleRate << " Hz\n";
+        std::cout << "  numChannels:        " << header->numChannels << "\n";
+        std::cout << "  samplesPerBlock:    " << header->samplesPerBlock << "\n";
+        std::cout << "  name:               \"" << header->name << "\"\n";
+        std::cout << "  queueSize:          " << header->queueSize << "\n";
+        std::cout << "  maxQueueSize:       " << header->maxQueueSize << "\n";
+        std::cout << "  nextSequenceNumber: " << header->nextSequenceNumber << "\n";
+        std::cout << "  nextBufferId:       " << header->nextBufferId << "\n";
+        std::cout << "  consumerCount:      " << header->consumerCount << "\n";
+        
+        if (header->consumerCount > 0 && header->consumerCount <= 16) {
+            std::cout << "  consumerIds:        [";
+            for (uint32_t i = 0; i < header->consumerCount; ++i) {
+                if (i > 0) std::cout << ", ";
+                std::cout << header->consumerIds[i];
+            }
+            std::cout << "]\n";
+        }
+        
+        std::cout << "  controlMsgCount:    " << header->controlMessageCount << "\n";
+        std::cout << "  controlReadIdx:     " << header->controlReadIndex << "\n";
+        std::cout << "  controlWriteIdx:    " << header->controlWriteIndex << "\n";
+        std::cout << "\n";
+        
+        // Show raw hex of header for debugging
+        std::cout << "--- SharedMemoryHeader Raw Hex (first 64 bytes) ---\n";
+        printHex(rawData, 64, 0);
+        std::cout << "\n";
+        
+        // ========================================================================
+        // Parse Data Section
+        // ========================================================================
+        if (!header->hasData || header->dataSize == 0) {
+            std::cout << "No data available in shared memory.\n";
+            munmap(mapped, st.st_size);
+            close(fd);
+            return 0;
+        }
+        
+        // Data buffer is AFTER SharedMemoryHeader AND QueuedBuffer array
+        // Layout: SharedMemoryHeader | QueuedBuffer[maxQueueSize] | DataBuffer
+        size_t queuedBuffersSize = header->maxQueueSize * sizeof(QueuedBuffer);
+        dataOffset = sizeof(SharedMemoryHeader) + queuedBuffersSize;
+        dataSection = rawData + dataOffset;
+        dataSize = header->dataSize;
+        
+        std::cout << "QueuedBuffer array size: " << queuedBuffersSize << " bytes (" 
+                  << header->maxQueueSize << " x " << sizeof(QueuedBuffer) << ")\n";
+        std::cout << "Data section starts at offset: " << dataOffset << "\n\n";
     }
     
-    // Data buffer is AFTER SharedMemoryHeader AND QueuedBuffer array
-    // Layout: SharedMemoryHeader | QueuedBuffer[maxQueueSize] | DataBuffer
-    size_t queuedBuffersSize = header->maxQueueSize * sizeof(QueuedBuffer);
-    size_t dataOffset = sizeof(SharedMemoryHeader) + queuedBuffersSize;
-    const uint8_t* dataSection = rawData + dataOffset;
-    
-    std::cout << "QueuedBuffer array size: " << queuedBuffersSize << " bytes (" 
-              << header->maxQueueSize << " x " << sizeof(QueuedBuffer) << ")\n";
-    std::cout << "Data section starts at offset: " << dataOffset << "\n\n";
-    
     std::cout << "--- Data Section (offset " << dataOffset << ") ---\n";
     std::cout << "Data section raw hex (first 128 bytes):\n";
-    printHex(dataSection, std::min((size_t)128, (size_t)header->dataSize), dataOffset);
+    printHex(dataSection, std::min((size_t)128, (size_t)dataSize), dataOffset);
     std::cout << "\n";
     
     // ========================================================================
     // Parse GenericAudioBufferHeader
     // ========================================================================
-    if (header->dataSize < sizeof(GenericAudioBufferHeader)) {
-        std::cerr << "WARNING: Data size (" << header->dataSize << ") too small for GenericAudioBufferHeader (" 
+    if (dataSize < sizeof(GenericAudioBufferHeader)) {
+        std::cerr << "WARNING: Data size (" << dataSize << ") too small for GenericAudioBufferHeader (" 
                   << sizeof(GenericAudioBufferHeader) << ")\n";
         munmap(mapped, st.st_size);
         close(fd);
@@ -348,6 +428,9 @@ int analyzeMemoryFile(const char* filepath) {
     std::cout << "  requiresAck:        " << (audioHeader->requiresAcknowledgment ? "YES" : "NO") << "\n";
     std::cout << "  consumerCount:      " << audioHeader->consumerCount << "\n";
     std::cout << "  acknowledgedCount:  " << audioHeader->acknowledgedCount << "\n";
+    std::cout << "  startSamplePos:     " << audioHeader->startSamplePosition << "\n";
+    std::cout << "  sampleRate:         " << audioHeader->sampleRate << " Hz\n";
+    std::cout << "  audioLayout:        " << audioHeader->audioLayout << " (0=INTERLEAVED, 1=PLANAR)\n";
     std::cout << "\n";
     
     // Validate header
@@ -363,7 +446,7 @@ int analyzeMemoryFile(const char* filepath) {
         std::cout << "--- Parameters (" << audioHeader->parameterCount << " total) ---\n";
         
         const uint8_t* paramPtr = dataSection + sizeof(GenericAudioBufferHeader);
-        size_t remainingSize = header->dataSize - sizeof(GenericAudioBufferHeader);
+        size_t remainingSize = dataSize - sizeof(GenericAudioBufferHeader);
         
         for (uint32_t i = 0; i < audioHeader->parameterCount && remainingSize >= sizeof(GenericParameter); ++i) {
             const GenericParameter* param = reinterpret_cast<const GenericParameter*>(paramPtr);
@@ -429,9 +512,11 @@ int analyzeMemoryFile(const char* filepath) {
             const float* audioData = reinterpret_cast<const float*>(rawData + audioDataOffset);
             
             // Show first few samples
+            // Planar blocks store each channel contiguously
+            size_t sampleStride = audioHeader->audioLayout == 1 ? 1 : audioHeader->channels;
             std::cout << "  First 10 samples (channel 0): ";
             for (int i = 0; i < 10 && i < (int)audioHeader->samples; ++i) {
-                std::cout << std::fixed << std::setprecision(4) << audioData[i * audioHeader->channels] << " ";
+                std::cout << std::fixed << std::setprecision(4) << audioData[i * sampleStride] << " ";
             }
             std::cout << "\n";
             